@@ -0,0 +1,84 @@
+#include "Camera.h"
+
+#include <algorithm>
+
+void Camera::FrameBounds(const BoundingBox& bounds)
+{
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    const float radius = std::max(Length(bounds.GetExtent()), 1e-4f);
+    m_target = bounds.GetCenter();
+    m_distance = radius / std::sin(m_fovY * 0.5f);
+
+    m_nearPlane = std::max(m_distance - radius, m_distance * 0.001f) * 0.5f;
+    m_farPlane = (m_distance + radius) * 2.0f;
+}
+
+void Camera::Orbit(float yawDelta, float pitchDelta)
+{
+    const float maxPitch = 1.55f;
+    const float twoPi = 6.28318530718f;
+
+    m_yaw = std::fmod(m_yaw + yawDelta, twoPi);
+    m_pitch = std::min(std::max(m_pitch + pitchDelta, -maxPitch), maxPitch);
+}
+
+void Camera::Zoom(float distanceScale)
+{
+    m_distance = std::min(std::max(m_distance * distanceScale, m_nearPlane), m_farPlane * 0.5f);
+}
+
+Camera Camera::Interpolate(const Camera& from, const Camera& to, float alpha)
+{
+    const float pi = 3.14159265359f;
+    const float twoPi = 6.28318530718f;
+
+    // Orbiting wraps yaw around, so two cameras close to each other may have angles almost a turn apart.
+    float yawDelta = std::fmod(to.m_yaw - from.m_yaw, twoPi);
+    if (yawDelta > pi)
+    {
+        yawDelta -= twoPi;
+    }
+    else if (yawDelta < -pi)
+    {
+        yawDelta += twoPi;
+    }
+
+    Camera camera = to;
+    camera.m_target = from.m_target + (to.m_target - from.m_target) * alpha;
+    camera.m_distance = from.m_distance + (to.m_distance - from.m_distance) * alpha;
+    camera.m_yaw = from.m_yaw + yawDelta * alpha;
+    camera.m_pitch = from.m_pitch + (to.m_pitch - from.m_pitch) * alpha;
+    return camera;
+}
+
+Vector3 Camera::GetPosition() const
+{
+    const Vector3 offset = {    std::cos(m_pitch) * std::sin(m_yaw),
+                                std::sin(m_pitch),
+                                std::cos(m_pitch) * std::cos(m_yaw)};
+    return m_target + offset * m_distance;
+}
+
+Matrix4x4 Camera::GetViewMatrix() const
+{
+    return Matrix4x4::LookAt(GetPosition(), m_target, Vector3{0.0f, 1.0f, 0.0f});
+}
+
+void Camera::GetViewRay(float normalizedX, float normalizedY, float aspect, Vector3& outOrigin, Vector3& outDirection) const
+{
+    // Same basis as the view matrix: the projection maps a direction at unit depth along the forward axis to [-1, 1] NDC coordinates.
+    const Vector3 forward = GetForward();
+    const Vector3 right = Normalize(Cross(forward, Vector3{0.0f, 1.0f, 0.0f}));
+    const Vector3 up = Cross(right, forward);
+
+    const float tanHalfFovY = std::tan(m_fovY * 0.5f);
+    const float ndcX = normalizedX * 2.0f - 1.0f;
+    const float ndcY = 1.0f - normalizedY * 2.0f;
+
+    outOrigin = GetPosition();
+    outDirection = Normalize(forward + right * (ndcX * tanHalfFovY * aspect) + up * (ndcY * tanHalfFovY));
+}
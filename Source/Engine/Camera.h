@@ -0,0 +1,78 @@
+/*
+    Orbit camera used by the Engine to view the loaded model.
+*/
+
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "VectorMath.h"
+#include "Mesh.h"
+
+/// @brief Camera orbiting around a target point at a given distance, oriented by yaw & pitch angles.
+/// This is the natural camera for a model viewer: the model stays centered while the user turns around it.
+class Camera
+{
+public:
+
+    Camera() : m_target{0.0f, 0.0f, 0.0f}, m_distance(3.0f), m_yaw(0.0f), m_pitch(0.0f),
+        m_fovY(0.9f), m_nearPlane(0.01f), m_farPlane(100.0f)
+    {}
+
+    /// @brief Places the camera target at the center of the passed bounds and backs away enough for the whole box to be in view.
+    /// Near & far planes are adjusted to the size of the box.
+    void FrameBounds(const BoundingBox& bounds);
+
+    /// @brief Rotates the camera around its target.
+    /// @param yawDelta Angle in radians to rotate by around the vertical axis.
+    /// @param pitchDelta Angle in radians to rotate by around the horizontal axis. Resulting pitch is clamped short of the poles.
+    void Orbit(float yawDelta, float pitchDelta);
+
+    /// @brief Moves the camera towards or away from its target.
+    /// @param distanceScale Factor to scale the distance to the target by, below 1 to get closer. Resulting distance is clamped so the
+    /// target stays between the near & far planes.
+    void Zoom(float distanceScale);
+
+    /// @brief Returns a camera partway between two others, for rendering in between two Engine ticks. Yaw goes the shortest way around.
+    /// @param alpha Progress from the first camera (0) to the second one (1).
+    static Camera Interpolate(const Camera& from, const Camera& to, float alpha);
+
+    /// @brief Whether both cameras view exactly the same thing, which spares rendering the same frame twice.
+    bool operator==(const Camera& other) const
+    {
+        return m_target.x == other.m_target.x && m_target.y == other.m_target.y && m_target.z == other.m_target.z && m_distance == other.m_distance
+            && m_yaw == other.m_yaw && m_pitch == other.m_pitch && m_fovY == other.m_fovY && m_nearPlane == other.m_nearPlane && m_farPlane == other.m_farPlane;
+    }
+    bool operator!=(const Camera& other) const { return !(*this == other); }
+
+    Vector3 GetPosition() const;
+    Vector3 GetForward() const { return Normalize(m_target - GetPosition()); }
+
+    Matrix4x4 GetViewMatrix() const;
+    Matrix4x4 GetProjectionMatrix(float aspect) const { return Matrix4x4::Perspective(m_fovY, aspect, m_nearPlane, m_farPlane); }
+
+    float GetFovY() const { return m_fovY; }
+
+    /// @brief Computes the ray going from the camera through a point of the image.
+    /// @param normalizedX Horizontal position within the image, 0 on the left edge and 1 on the right edge.
+    /// @param normalizedY Vertical position within the image, 0 on the top edge and 1 on the bottom edge.
+    /// @param aspect Width over height of the image.
+    /// @param outOrigin Set to the camera position.
+    /// @param outDirection Set to the normalized direction of the ray.
+    void GetViewRay(float normalizedX, float normalizedY, float aspect, Vector3& outOrigin, Vector3& outDirection) const;
+
+private:
+
+    Vector3 m_target;
+    float m_distance;
+
+    // Orbit angles in radians. Zero yaw & pitch places the camera on the +Z axis of the target.
+    float m_yaw;
+    float m_pitch;
+
+    // Vertical field of view in radians.
+    float m_fovY;
+    float m_nearPlane;
+    float m_farPlane;
+};
+
+#endif // CAMERA_H
@@ -0,0 +1,42 @@
+#include "CpuFeatures.h"
+
+#if defined(_MSC_VER) && defined(ENGINE_AVX2_KERNELS)
+    #include <intrin.h>
+#endif
+
+bool CpuFeatures::HasAvx2()
+{
+#if defined(ENGINE_AVX2_KERNELS) && defined(_MSC_VER)
+    // CPUID leaf 1 tells whether the CPU supports AVX and the OS enabled XSAVE, XGETBV whether the OS saves SSE & AVX registers on
+    // context switches, and leaf 7 whether the CPU supports AVX2.
+    int registers[4];
+    __cpuid(registers, 0);
+    if (registers[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(registers, 1);
+    const int OSXSAVE_BIT = 1 << 27;
+    const int AVX_BIT = 1 << 28;
+    if ((registers[2] & (OSXSAVE_BIT | AVX_BIT)) != (OSXSAVE_BIT | AVX_BIT) || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+    __cpuidex(registers, 7, 0);
+    const int AVX2_BIT = 1 << 5;
+    return (registers[1] & AVX2_BIT) != 0;
+#elif defined(ENGINE_AVX2_KERNELS)
+    // Checks OS support as well. Initializing is only required when called from static constructors, but costs little.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+SimdPaths CpuFeatures::DetectSimdPaths()
+{
+    SimdPaths simdPaths;
+    simdPaths.bUseAvx2 = HasAvx2();
+    return simdPaths;
+}
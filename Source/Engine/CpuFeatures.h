@@ -0,0 +1,54 @@
+/*
+    Detection of the CPU features SIMD kernels may use beyond those of the compilation target, so a single build runs the widest kernels the
+    CPU it runs on supports.
+    AVX2 kernels get compiled whatever the target, within ENGINE_AVX2_BEGIN & ENGINE_AVX2_END in translation units of their own (or marked
+    ENGINE_AVX2_TARGET). The Engine queries the CPU once at initialization and passes the resulting SimdPaths down to the entry points of
+    its kernels, which only run AVX2 code when told to.
+    #NOTE: Kernels could cache the query themselves, but the Engine keeps no static memory: SimdPaths lives in the Engine-owned objects
+    calling kernels, and costs them a well predicted branch per call.
+*/
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// ENGINE_AVX2_KERNELS is defined when the compiler can emit AVX2 code for some functions only. GCC & Clang do it through target attributes,
+// applied to every function of a region by pragmas; MSVC accepts AVX2 intrinsics in any function whatever /arch.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #define ENGINE_AVX2_KERNELS
+    #define ENGINE_AVX2_TARGET __attribute__((target("avx2")))
+    #if defined(__clang__)
+        #define ENGINE_AVX2_BEGIN _Pragma("clang attribute push(__attribute__((target(\"avx2\"))), apply_to = function)")
+        #define ENGINE_AVX2_END _Pragma("clang attribute pop")
+    #else
+        #define ENGINE_AVX2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+        #define ENGINE_AVX2_END _Pragma("GCC pop_options")
+    #endif
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #define ENGINE_AVX2_KERNELS
+    #define ENGINE_AVX2_TARGET
+    #define ENGINE_AVX2_BEGIN
+    #define ENGINE_AVX2_END
+#endif
+
+// ENGINE_SSE2_KERNELS is defined when SSE2 is part of the compilation target, as it is of every x86-64 target. Kernels compiled with SIMD
+// use it, unless AVX2 is available as well.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ENGINE_SSE2_KERNELS
+#endif
+
+/// @brief SIMD paths kernels take beyond those of the compilation target. Default constructed, kernels stick to the compilation target.
+struct SimdPaths
+{
+    bool bUseAvx2 = false;
+};
+
+namespace CpuFeatures
+{
+    /// @brief Returns whether the CPU supports AVX2 and the OS saves the registers it uses. Queries the CPU on every call.
+    bool HasAvx2();
+
+    /// @brief Returns the widest SIMD paths the CPU supports. Queries the CPU, so it is meant to be called once at initialization.
+    SimdPaths DetectSimdPaths();
+}
+
+#endif // CPU_FEATURES_H
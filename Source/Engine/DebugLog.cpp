@@ -0,0 +1,193 @@
+#include "DebugLog.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace
+{
+    /// Appends printf-formatted text to a string.
+    void AppendFormatted(std::string& text, const char* format, ...)
+    {
+        char buff[128];
+        va_list arguments;
+        va_start(arguments, format);
+        const int length = vsnprintf(buff, sizeof(buff), format, arguments);
+        va_end(arguments);
+        if (length < 0)
+        {
+            return;
+        }
+
+        if (static_cast<size_t>(length) < sizeof(buff))
+        {
+            text.append(buff, length);
+        }
+        else
+        {
+            // Only wide fields & long strings take this path.
+            const size_t offset = text.size();
+            text.resize(offset + length + 1);
+            va_start(arguments, format);
+            vsnprintf(&text[offset], length + 1, format, arguments);
+            va_end(arguments);
+            text.resize(offset + length);
+        }
+    }
+
+    /// Reads a value of a packed argument, advancing the read cursor.
+    template<typename T>
+    T ReadPackedValue(const uint8_t*& cursor)
+    {
+        T value;
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+}
+
+void DebugLog::PackedArguments::PackString(const char* text, size_t length)
+{
+    if (m_size + 1 + sizeof(uint16_t) > CAPACITY)
+    {
+        return;
+    }
+
+    const uint16_t packedLength = static_cast<uint16_t>(std::min(length, CAPACITY - m_size - 1 - sizeof(uint16_t)));
+    m_data[m_size] = static_cast<uint8_t>(ArgumentType::STRING);
+    memcpy(m_data + m_size + 1, &packedLength, sizeof(uint16_t));
+    memcpy(m_data + m_size + 1 + sizeof(uint16_t), text, packedLength);
+    m_size += 1 + sizeof(uint16_t) + packedLength;
+}
+
+void DebugLog::FormatMessage(const char* format, const uint8_t* packedArguments, size_t packedArgumentsSize, std::string& outText)
+{
+    outText.clear();
+    const uint8_t* argumentCursor = packedArguments;
+    const uint8_t* argumentsEnd = packedArguments + packedArgumentsSize;
+    std::string stringArgument;
+
+    const char* character = format;
+    while (*character != '\0')
+    {
+        const char* specificationStart = strchr(character, '%');
+        if (specificationStart == nullptr)
+        {
+            outText.append(character);
+            break;
+        }
+        outText.append(character, specificationStart - character);
+
+        if (specificationStart[1] == '%')
+        {
+            outText.push_back('%');
+            character = specificationStart + 2;
+            continue;
+        }
+
+        // Keep flags, width & precision, drop length modifiers: the packed argument's type picks the one to use.
+        char specification[32] = "%";
+        size_t specificationLength = 1;
+        character = specificationStart + 1;
+        while (*character != '\0' && strchr("-+ #0123456789.", *character) != nullptr)
+        {
+            if (specificationLength < sizeof(specification) - 4)
+            {
+                specification[specificationLength++] = *character;
+            }
+            character++;
+        }
+        while (*character != '\0' && strchr("hlLzjt", *character) != nullptr)
+        {
+            character++;
+        }
+        if (*character == '\0')
+        {
+            break;
+        }
+        const char conversion = *character++;
+
+        if (argumentCursor >= argumentsEnd)
+        {
+            outText.push_back('?');
+            continue;
+        }
+
+        const PackedArguments::ArgumentType type = static_cast<PackedArguments::ArgumentType>(*argumentCursor++);
+        const bool bFloatingConversion = strchr("fFeEgGaA", conversion) != nullptr;
+        switch (type)
+        {
+            case(PackedArguments::ArgumentType::INT):
+            case(PackedArguments::ArgumentType::UINT):
+            {
+                const uint64_t bits = ReadPackedValue<uint64_t>(argumentCursor);
+                if (bFloatingConversion)
+                {
+                    const double value = type == PackedArguments::ArgumentType::INT ? static_cast<double>(static_cast<int64_t>(bits)) : static_cast<double>(bits);
+                    specification[specificationLength] = conversion;
+                    specification[specificationLength + 1] = '\0';
+                    AppendFormatted(outText, specification, value);
+                }
+                else if (conversion == 'c')
+                {
+                    specification[specificationLength] = 'c';
+                    specification[specificationLength + 1] = '\0';
+                    AppendFormatted(outText, specification, static_cast<int>(bits));
+                }
+                else
+                {
+                    // Signedness follows the conversion, as with printf.
+                    const char integerConversion = strchr("diuoxX", conversion) != nullptr ? conversion : (type == PackedArguments::ArgumentType::INT ? 'd' : 'u');
+                    specification[specificationLength] = 'l';
+                    specification[specificationLength + 1] = 'l';
+                    specification[specificationLength + 2] = integerConversion;
+                    specification[specificationLength + 3] = '\0';
+                    AppendFormatted(outText, specification, static_cast<unsigned long long>(bits));
+                }
+            }
+            break;
+            case(PackedArguments::ArgumentType::DOUBLE):
+            {
+                const double value = ReadPackedValue<double>(argumentCursor);
+                if (bFloatingConversion)
+                {
+                    specification[specificationLength] = conversion;
+                    specification[specificationLength + 1] = '\0';
+                    AppendFormatted(outText, specification, value);
+                }
+                else
+                {
+                    specification[specificationLength] = 'l';
+                    specification[specificationLength + 1] = 'l';
+                    specification[specificationLength + 2] = 'd';
+                    specification[specificationLength + 3] = '\0';
+                    AppendFormatted(outText, specification, static_cast<long long>(value));
+                }
+            }
+            break;
+            case(PackedArguments::ArgumentType::POINTER):
+            {
+                const uint64_t value = ReadPackedValue<uint64_t>(argumentCursor);
+                specification[specificationLength] = 'p';
+                specification[specificationLength + 1] = '\0';
+                AppendFormatted(outText, specification, reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+            }
+            break;
+            case(PackedArguments::ArgumentType::STRING):
+            {
+                const uint16_t length = ReadPackedValue<uint16_t>(argumentCursor);
+                stringArgument.assign(reinterpret_cast<const char*>(argumentCursor), length);
+                argumentCursor += length;
+                specification[specificationLength] = 's';
+                specification[specificationLength + 1] = '\0';
+                AppendFormatted(outText, specification, stringArgument.c_str());
+            }
+            break;
+            default:
+                // Corrupted arguments: display what was formatted so far.
+                argumentCursor = argumentsEnd;
+                outText.push_back('?');
+            break;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/*
+    Debug log message categories and deferred formatting of debug log messages.
+    Formatted messages don't get formatted by the thread logging them: it only records a pointer to the format string along with its arguments
+    packed in binary form, and whichever thread displays the message formats it later on. Logging a formatted message thus never allocates.
+    Messages of categories below DEBUG_LOG_MIN_CATEGORY compile out (see PlatformDebugger::Log), so verbose diagnostics can stay in hot code.
+    Their arguments still get evaluated unless the call site checks IsCategoryCompiledIn itself.
+*/
+
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Least severe category of messages logged through PlatformDebugger::Log that get compiled in, as a DebugLogMessage::Category name.
+// Build with -DDEBUG_LOG_MIN_CATEGORY=VERBOSE to get verbose diagnostics.
+#ifndef DEBUG_LOG_MIN_CATEGORY
+#define DEBUG_LOG_MIN_CATEGORY LOG
+#endif
+
+struct DebugLogMessage
+{
+    // Categories are ordered by severity.
+    enum class Category
+    {
+        VERBOSE, // Detailed diagnostic message, usually logged every frame. Compiled out unless DEBUG_LOG_MIN_CATEGORY asks for it.
+        LOG, // Standard message indicating a fact that is in itself neither good or bad.
+        SUCCESS, // Message indicating something went well !
+        WARNING, // Standard message indicating something irregular / incorrect happened, but not in a way that will necessarily cause a problem.
+        ERROR_NONFATAL, // Message indicating something went wrong, but not to the point the program will require an Engine restart.
+        ERROR_FATAL // Message indicating something went *very* wrong to the point it will require a Engine restart. Logging in this category will trigger
+        // an Engine shutdown.
+    };
+
+    std::string LogMessage;
+    Category LogCategory;
+};
+
+namespace DebugLog
+{
+    constexpr DebugLogMessage::Category MIN_CATEGORY = DebugLogMessage::Category::DEBUG_LOG_MIN_CATEGORY;
+
+    /// @brief Returns whether messages of a category get compiled in.
+    constexpr bool IsCategoryCompiledIn(DebugLogMessage::Category category) { return category >= MIN_CATEGORY; }
+
+    /// @brief Arguments of a formatted message, packed one after the other as a type tag followed by the value. Strings get copied, so they
+    /// don't have to outlive the call logging them.
+    class PackedArguments
+    {
+    public:
+
+        // Bytes arguments can take. Strings get truncated to fit, and arguments that don't fit at all get displayed as '?'.
+        static constexpr size_t CAPACITY = 384;
+
+        enum class ArgumentType : uint8_t
+        {
+            INT, // int64_t
+            UINT, // uint64_t
+            DOUBLE, // double
+            POINTER, // uint64_t
+            STRING // uint16_t length followed by the characters, not null-terminated.
+        };
+
+        PackedArguments() : m_size(0)
+        {}
+
+        /// @brief Packs an argument after the previous ones. Supports integers, enums, floating point numbers, pointers, C strings and std::string.
+        template<typename T>
+        void Pack(const T& value)
+        {
+            using Type = std::decay_t<T>;
+            if constexpr (std::is_same_v<Type, std::string>)
+            {
+                PackString(value.data(), value.size());
+            }
+            else if constexpr (std::is_array_v<T>)
+            {
+                // Character arrays, such as string literals & stack buffers.
+                PackString(value, strlen(value));
+            }
+            else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+            {
+                if (value != nullptr)
+                {
+                    PackString(value, strlen(value));
+                }
+                else
+                {
+                    PackString("(null)", 6);
+                }
+            }
+            else if constexpr (std::is_floating_point_v<Type>)
+            {
+                PackValue(ArgumentType::DOUBLE, static_cast<double>(value));
+            }
+            else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+            {
+                PackValue(ArgumentType::INT, static_cast<int64_t>(value));
+            }
+            else if constexpr (std::is_integral_v<Type>)
+            {
+                PackValue(ArgumentType::UINT, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_enum_v<Type>)
+            {
+                Pack(static_cast<std::underlying_type_t<Type>>(value));
+            }
+            else if constexpr (std::is_pointer_v<Type>)
+            {
+                PackValue(ArgumentType::POINTER, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+            else
+            {
+                static_assert(!std::is_same_v<Type, Type>, "Unsupported debug log argument type.");
+            }
+        }
+
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+
+        template<typename T>
+        void PackValue(ArgumentType type, T value)
+        {
+            if (m_size + 1 + sizeof(T) <= CAPACITY)
+            {
+                m_data[m_size] = static_cast<uint8_t>(type);
+                memcpy(m_data + m_size + 1, &value, sizeof(T));
+                m_size += 1 + sizeof(T);
+            }
+        }
+
+        void PackString(const char* text, size_t length);
+
+        uint8_t m_data[CAPACITY];
+        size_t m_size;
+    };
+
+    /// @brief Formats a message from its printf-style format string and packed arguments. Length modifiers in the format string are ignored,
+    /// as packed arguments carry their own type; '*' widths & precisions aren't supported.
+    /// @param packedArguments Arguments packed by a PackedArguments object.
+    /// @param packedArgumentsSize Size of the packed arguments in bytes.
+    /// @param outText Formatted message, replacing its previous content.
+    void FormatMessage(const char* format, const uint8_t* packedArguments, size_t packedArgumentsSize, std::string& outText);
+}
+
+#endif // DEBUG_LOG_H
@@ -0,0 +1,82 @@
+#include "DebugLogQueue.h"
+
+#include <algorithm>
+#include <thread>
+
+DebugLogQueue::DebugLogQueue(uint32_t slotCount, OverflowPolicy overflowPolicy)
+    : m_overflowPolicy(overflowPolicy), m_enqueuePosition(0), m_droppedMessageCount(0), m_dequeuePosition(0)
+{
+    m_slotCount = MAX_SLOTS_PER_MESSAGE;
+    while (m_slotCount < slotCount)
+    {
+        m_slotCount *= 2;
+    }
+    m_positionMask = m_slotCount - 1;
+
+    m_slots.reset(new Slot[m_slotCount]);
+    for (uint64_t slotIndex = 0; slotIndex < m_slotCount; slotIndex++)
+    {
+        m_slots[slotIndex].Sequence.store(slotIndex, std::memory_order_relaxed);
+    }
+    m_consumerData.resize(SLOT_DATA_CAPACITY * MAX_SLOTS_PER_MESSAGE);
+}
+
+bool DebugLogQueue::Push(DebugLogMessage::Category category, const char* format, const void* data, size_t size)
+{
+    size = std::min(size, SLOT_DATA_CAPACITY * MAX_SLOTS_PER_MESSAGE);
+    const uint64_t spannedSlotCount = std::max<uint64_t>(1, (size + SLOT_DATA_CAPACITY - 1) / SLOT_DATA_CAPACITY);
+
+    // Reserve every slot of the message at once. The consumer frees slots in order, so the last one being free for its position means all
+    // the ones before it are too.
+    uint64_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        const uint64_t lastPosition = position + spannedSlotCount - 1;
+        const uint64_t sequence = m_slots[lastPosition & m_positionMask].Sequence.load(std::memory_order_acquire);
+        const int64_t difference = static_cast<int64_t>(sequence - lastPosition);
+        if (difference == 0)
+        {
+            if (m_enqueuePosition.compare_exchange_weak(position, position + spannedSlotCount, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds a message from the previous lap: the queue is full.
+            if (m_overflowPolicy == OverflowPolicy::DROP)
+            {
+                m_droppedMessageCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            std::this_thread::yield();
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // Another producer reserved this position first.
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    for (uint64_t slotIndex = 0; slotIndex < spannedSlotCount; slotIndex++)
+    {
+        Slot& slot = m_slots[(position + slotIndex) & m_positionMask];
+        const size_t slotDataOffset = slotIndex * SLOT_DATA_CAPACITY;
+        const size_t slotDataSize = std::min(SLOT_DATA_CAPACITY, size - slotDataOffset);
+        memcpy(slot.Data, static_cast<const uint8_t*>(data) + slotDataOffset, slotDataSize);
+        slot.DataSize = static_cast<uint16_t>(slotDataSize);
+    }
+
+    // Publish continuation slots first and the first slot last, which is the one the consumer waits on.
+    Slot& firstSlot = m_slots[position & m_positionMask];
+    firstSlot.Format = format;
+    firstSlot.LogCategory = category;
+    firstSlot.SpannedSlotCount = static_cast<uint16_t>(spannedSlotCount);
+    for (uint64_t slotIndex = 1; slotIndex < spannedSlotCount; slotIndex++)
+    {
+        m_slots[(position + slotIndex) & m_positionMask].Sequence.store(position + slotIndex + 1, std::memory_order_release);
+    }
+    firstSlot.Sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,128 @@
+/*
+    Bounded multi-producer / single-consumer queue of debug log messages, shared by platform debuggers.
+    Messages are either plain text or a format string pointer along with packed arguments (see DebugLog.h), formatted by the consumer.
+    They get copied into a ring of preallocated fixed-size slots (Vyukov's bounded queue, one sequence number per slot), so logging only
+    costs a compare & swap and a copy: no lock, no allocation. Messages longer than a slot span several consecutive ones, reserved with a single
+    compare & swap. The consumer drains messages in batches without ever blocking producers, so slow console output can't stall the threads
+    writing to it.
+*/
+
+#ifndef DEBUG_LOG_QUEUE_H
+#define DEBUG_LOG_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "DebugLog.h"
+
+class DebugLogQueue
+{
+public:
+
+    /// @brief What producers do when the queue is full.
+    enum class OverflowPolicy
+    {
+        DROP, // Discard the message and count it, never blocking the producer.
+        BLOCK // Yield until the consumer frees enough slots. Only safe when the consumer runs on its own thread.
+    };
+
+    // Message bytes each slot holds.
+    static constexpr size_t SLOT_DATA_CAPACITY = 104;
+    // Slots a single message can span. Longer messages get truncated.
+    static constexpr uint32_t MAX_SLOTS_PER_MESSAGE = 16;
+
+    /// @param slotCount Amount of preallocated slots, rounded up to a power of two no smaller than MAX_SLOTS_PER_MESSAGE.
+    /// @param overflowPolicy What producers do when the queue is full.
+    DebugLogQueue(uint32_t slotCount, OverflowPolicy overflowPolicy);
+
+    /// @brief Copies a message into the queue. Can be called from any thread.
+    /// @param format Format string the message data are packed arguments of, which must outlive the message. Null for plain text messages.
+    /// @param data Message characters (not necessarily null-terminated) or packed arguments.
+    /// @param size Size of data in bytes.
+    /// @return Whether the message was queued. Always true with the BLOCK policy.
+    bool Push(DebugLogMessage::Category category, const char* format, const void* data, size_t size);
+
+    /// @brief Pops queued messages in order, handing each of them to a consumer function. Must only be called from a single thread at a time.
+    /// @param consumer Function called as consumer(category, format, data, size) for every message, with arguments as pushed. Data only stays
+    /// valid during the call.
+    /// @param maxMessageCount Amount of messages after which to stop even if more are queued, so a flood of messages can't starve the consumer.
+    /// @return Amount of popped messages.
+    template<typename Consumer>
+    uint32_t Flush(Consumer&& consumer, uint32_t maxMessageCount = UINT32_MAX)
+    {
+        uint32_t messageCount = 0;
+        while (messageCount < maxMessageCount)
+        {
+            Slot& firstSlot = m_slots[m_dequeuePosition & m_positionMask];
+            // The first slot of a message gets published last, so every continuation slot is written once it is.
+            if (firstSlot.Sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1)
+            {
+                break;
+            }
+
+            const uint32_t spannedSlotCount = firstSlot.SpannedSlotCount;
+            size_t size = 0;
+            for (uint32_t slotIndex = 0; slotIndex < spannedSlotCount; slotIndex++)
+            {
+                const Slot& slot = m_slots[(m_dequeuePosition + slotIndex) & m_positionMask];
+                memcpy(m_consumerData.data() + size, slot.Data, slot.DataSize);
+                size += slot.DataSize;
+            }
+
+            consumer(firstSlot.LogCategory, firstSlot.Format, static_cast<const void*>(m_consumerData.data()), size);
+
+            // Hand slots back to producers, one lap further around the ring.
+            for (uint32_t slotIndex = 0; slotIndex < spannedSlotCount; slotIndex++)
+            {
+                Slot& slot = m_slots[(m_dequeuePosition + slotIndex) & m_positionMask];
+                slot.Sequence.store(m_dequeuePosition + slotIndex + m_slotCount, std::memory_order_release);
+            }
+            m_dequeuePosition += spannedSlotCount;
+            messageCount++;
+        }
+        return messageCount;
+    }
+
+    /// @brief Returns whether a message is ready to be popped. Must only be called from the thread flushing the queue.
+    bool HasQueuedMessages() const
+    {
+        return m_slots[m_dequeuePosition & m_positionMask].Sequence.load(std::memory_order_acquire) == m_dequeuePosition + 1;
+    }
+
+    /// @brief Returns the amount of messages dropped since the previous call, and resets it.
+    uint64_t TakeDroppedMessageCount() { return m_droppedMessageCount.exchange(0, std::memory_order_relaxed); }
+
+private:
+
+    // Slots are sized & aligned to whole cache lines, so producers writing neighboring slots don't false share more than they have to.
+    struct alignas(64) Slot
+    {
+        // Position the slot is free for, or that position plus one once the slot holds a published message.
+        std::atomic<uint64_t> Sequence;
+        // Category, format & amount of slots the message spans are only meaningful in its first slot.
+        const char* Format;
+        DebugLogMessage::Category LogCategory;
+        uint16_t SpannedSlotCount;
+        uint16_t DataSize;
+        uint8_t Data[SLOT_DATA_CAPACITY];
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    uint64_t m_slotCount;
+    uint64_t m_positionMask;
+    OverflowPolicy m_overflowPolicy;
+
+    // Next position producers reserve slots at.
+    alignas(64) std::atomic<uint64_t> m_enqueuePosition;
+    std::atomic<uint64_t> m_droppedMessageCount;
+
+    // Consumer-only state.
+    alignas(64) uint64_t m_dequeuePosition;
+    // Messages get reassembled here, as their slots can wrap around the end of the ring.
+    std::vector<uint8_t> m_consumerData;
+};
+
+#endif // DEBUG_LOG_QUEUE_H
@@ -0,0 +1,89 @@
+#include "DisplayDamage.h"
+
+#include <algorithm>
+
+namespace
+{
+    /// Returns the smallest rectangle containing both rectangles.
+    DisplayRect GetBoundingRect(const DisplayRect& a, const DisplayRect& b)
+    {
+        const uint32_t minX = std::min(a.X, b.X);
+        const uint32_t minY = std::min(a.Y, b.Y);
+        const uint32_t maxX = std::max(a.X + a.Width, b.X + b.Width);
+        const uint32_t maxY = std::max(a.Y + a.Height, b.Y + b.Height);
+        return DisplayRect{ static_cast<uint16_t>(minX), static_cast<uint16_t>(minY), static_cast<uint16_t>(maxX - minX), static_cast<uint16_t>(maxY - minY) };
+    }
+
+    /// Returns whether two rectangles share at least one pixel.
+    bool Overlap(const DisplayRect& a, const DisplayRect& b)
+    {
+        return a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+    }
+}
+
+void DisplayDamage::AddRect(const DisplayRect& rect)
+{
+    if (rect.Width == 0 || rect.Height == 0)
+    {
+        return;
+    }
+
+    // Absorb rectangles the new one overlaps or lines up with exactly (their bounding rectangle covering nothing else), until it stands alone.
+    DisplayRect newRect = rect;
+    uint32_t rectIndex = 0;
+    while (rectIndex < m_rectCount)
+    {
+        const DisplayRect boundingRect = GetBoundingRect(newRect, m_rects[rectIndex]);
+        if (Overlap(newRect, m_rects[rectIndex]) || boundingRect.GetArea() == newRect.GetArea() + m_rects[rectIndex].GetArea())
+        {
+            newRect = boundingRect;
+            m_rects[rectIndex] = m_rects[--m_rectCount];
+            rectIndex = 0;
+        }
+        else
+        {
+            rectIndex++;
+        }
+    }
+
+    if (m_rectCount < MAX_RECT_COUNT)
+    {
+        m_rects[m_rectCount++] = newRect;
+        return;
+    }
+
+    // No room left: merge with the rectangle whose bounding rectangle wastes the fewest pixels, then add the result over again as it may
+    // now overlap others.
+    uint32_t bestRectIndex = 0;
+    uint64_t bestWastedArea = UINT64_MAX;
+    for (rectIndex = 0; rectIndex < m_rectCount; rectIndex++)
+    {
+        const uint64_t wastedArea = GetBoundingRect(newRect, m_rects[rectIndex]).GetArea() - newRect.GetArea() - m_rects[rectIndex].GetArea();
+        if (wastedArea < bestWastedArea)
+        {
+            bestWastedArea = wastedArea;
+            bestRectIndex = rectIndex;
+        }
+    }
+    newRect = GetBoundingRect(newRect, m_rects[bestRectIndex]);
+    m_rects[bestRectIndex] = m_rects[--m_rectCount];
+    AddRect(newRect);
+}
+
+void DisplayDamage::Merge(const DisplayDamage& other)
+{
+    for (uint32_t rectIndex = 0; rectIndex < other.m_rectCount; rectIndex++)
+    {
+        AddRect(other.m_rects[rectIndex]);
+    }
+}
+
+uint32_t DisplayDamage::GetArea() const
+{
+    uint32_t area = 0;
+    for (uint32_t rectIndex = 0; rectIndex < m_rectCount; rectIndex++)
+    {
+        area += m_rects[rectIndex].GetArea();
+    }
+    return area;
+}
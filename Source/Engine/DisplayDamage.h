@@ -0,0 +1,50 @@
+/*
+    Damage regions: the parts of a frame that differ from the frame presented before it, so platforms only present those (see
+    PlatformRenderer::PresentDisplayDrawer). A region is a short list of disjoint rectangles. Rectangles that overlap or share a whole edge get
+    merged, and once the list is full new rectangles get merged into the one they grow the least, so regions stay conservative and bounded.
+*/
+
+#ifndef DISPLAY_DAMAGE_H
+#define DISPLAY_DAMAGE_H
+
+#include <cstdint>
+
+/// @brief Rectangle of display pixels, covering [X, X + Width) x [Y, Y + Height).
+struct DisplayRect
+{
+    uint16_t X, Y, Width, Height;
+
+    uint32_t GetArea() const { return static_cast<uint32_t>(Width) * Height; }
+};
+
+class DisplayDamage
+{
+public:
+
+    static constexpr uint32_t MAX_RECT_COUNT = 32;
+
+    DisplayDamage() : m_rectCount(0)
+    {}
+
+    /// @brief Adds a rectangle to the region. Empty rectangles are ignored.
+    void AddRect(const DisplayRect& rect);
+
+    /// @brief Adds every rectangle of another region to this one.
+    void Merge(const DisplayDamage& other);
+
+    void Clear() { m_rectCount = 0; }
+
+    bool IsEmpty() const { return m_rectCount == 0; }
+    uint32_t GetRectCount() const { return m_rectCount; }
+    const DisplayRect& GetRect(uint32_t rectIndex) const { return m_rects[rectIndex]; }
+
+    /// @brief Returns the amount of pixels in the region.
+    uint32_t GetArea() const;
+
+private:
+
+    DisplayRect m_rects[MAX_RECT_COUNT];
+    uint32_t m_rectCount;
+};
+
+#endif // DISPLAY_DAMAGE_H
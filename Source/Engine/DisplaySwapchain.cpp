@@ -0,0 +1,64 @@
+#include "DisplaySwapchain.h"
+
+DisplaySwapchain::DisplaySwapchain() : m_queuedBufferIndex(-1)
+{
+    for (BufferState& bufferState : m_bufferStates)
+    {
+        bufferState = BufferState::FREE;
+    }
+}
+
+int32_t DisplaySwapchain::AcquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_mutex_BufferStates);
+    for (uint32_t bufferIndex = 0; bufferIndex < BUFFER_COUNT; bufferIndex++)
+    {
+        if (m_bufferStates[bufferIndex] == BufferState::FREE)
+        {
+            m_bufferStates[bufferIndex] = BufferState::DRAWING;
+            return static_cast<int32_t>(bufferIndex);
+        }
+    }
+    return -1;
+}
+
+void DisplaySwapchain::ReleaseBuffer(uint32_t bufferIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex_BufferStates);
+    m_bufferStates[bufferIndex] = BufferState::FREE;
+}
+
+void DisplaySwapchain::QueueBuffer(uint32_t bufferIndex, const DisplayDamage& damage)
+{
+    std::lock_guard<std::mutex> lock(m_mutex_BufferStates);
+    if (m_queuedBufferIndex >= 0)
+    {
+        m_bufferStates[m_queuedBufferIndex] = BufferState::FREE;
+        m_queuedDamage.Merge(damage);
+    }
+    else
+    {
+        m_queuedDamage = damage;
+    }
+    m_bufferStates[bufferIndex] = BufferState::QUEUED;
+    m_queuedBufferIndex = static_cast<int32_t>(bufferIndex);
+}
+
+int32_t DisplaySwapchain::BeginPresentingBuffer(DisplayDamage& outDamage)
+{
+    std::lock_guard<std::mutex> lock(m_mutex_BufferStates);
+    const int32_t bufferIndex = m_queuedBufferIndex;
+    if (bufferIndex >= 0)
+    {
+        m_bufferStates[bufferIndex] = BufferState::PRESENTING;
+        outDamage = m_queuedDamage;
+        m_queuedBufferIndex = -1;
+    }
+    return bufferIndex;
+}
+
+void DisplaySwapchain::EndPresentingBuffer(uint32_t bufferIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex_BufferStates);
+    m_bufferStates[bufferIndex] = BufferState::FREE;
+}
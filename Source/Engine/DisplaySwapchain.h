@@ -0,0 +1,62 @@
+/*
+    Rotation of the persistent full-display drawers platform renderers hand to the Engine (see PlatformRenderer::AcquireDisplayDrawer), shared
+    by platform renderers. It only tracks which buffer is in which state: buffers themselves are owned by the platform.
+    With three buffers, the Engine draws on one while the platform presents another and the third holds the latest finished frame, so neither
+    side ever waits on the other. A finished frame that didn't get presented before a newer one got finished is dropped, its damage region
+    carried over to the newer one since the display still shows the frame before it.
+*/
+
+#ifndef DISPLAY_SWAPCHAIN_H
+#define DISPLAY_SWAPCHAIN_H
+
+#include <cstdint>
+#include <mutex>
+
+#include "DisplayDamage.h"
+
+class DisplaySwapchain
+{
+public:
+
+    static constexpr uint32_t BUFFER_COUNT = 3;
+
+    enum class BufferState : uint8_t
+    {
+        FREE, // Available to the Engine.
+        DRAWING, // Acquired by the Engine.
+        QUEUED, // Finished by the Engine, waiting to be presented.
+        PRESENTING // Being presented by the platform.
+    };
+
+    DisplaySwapchain();
+
+    /// @brief Picks a free buffer for the Engine to draw on. Never blocks.
+    /// @return Index of the buffer, or -1 if every buffer is in use.
+    int32_t AcquireBuffer();
+
+    /// @brief Gives an acquired buffer back without presenting it.
+    void ReleaseBuffer(uint32_t bufferIndex);
+
+    /// @brief Queues a buffer the Engine finished drawing on for presentation. The previously queued buffer is freed if it didn't get
+    /// presented yet.
+    /// @param damage Regions of the buffer that differ from the previously queued frame.
+    void QueueBuffer(uint32_t bufferIndex, const DisplayDamage& damage);
+
+    /// @brief Takes the queued buffer for presentation.
+    /// @param outDamage Regions of the buffer that differ from the frame presented last, which are the only ones to present.
+    /// @return Index of the buffer, or -1 if no buffer is queued.
+    int32_t BeginPresentingBuffer(DisplayDamage& outDamage);
+
+    /// @brief Frees a buffer once the platform is done presenting it.
+    void EndPresentingBuffer(uint32_t bufferIndex);
+
+private:
+
+    std::mutex m_mutex_BufferStates;
+    BufferState m_bufferStates[BUFFER_COUNT];
+    // Index of the queued buffer, -1 if none, and its damage.
+    int32_t m_queuedBufferIndex;
+    DisplayDamage m_queuedDamage;
+};
+
+#endif // DISPLAY_SWAPCHAIN_H
@@ -10,24 +10,76 @@
 
 #include <string>
 
+#include "DebugLog.h"
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "MeshLod.h"
+#include "Camera.h"
+#include "MeshRenderer.h"
+#include "JobSystem.h"
+#include "ModelLoader.h"
+#include "FrameTimeStatistics.h"
+#include "InputEventQueue.h"
+#include "MemoryArena.h"
+
 // Abstract platform services forward declaration.
 class PlatformDebugger;
 class PlatformRenderer;
+class PlatformFileSystem;
+class PlatformClock;
 
-struct DebugLogMessage
+/// @brief Memory arenas the platform hands to the Engine at initialization. The platform owns them, and they must outlive the Engine.
+struct EngineMemory
 {
-    enum class Category
+    // Allocations living as long as the Engine, such as buffers sized after the viewed model. Reset by every initialization.
+    MemoryArena* PersistentArena = nullptr;
+    // Scratch memory of Engine updates. Updates alternate between both arenas, resetting the one they use first, so memory allocated by an
+    // update stays valid during the next one.
+    MemoryArena* FrameArenas[2] = { nullptr, nullptr };
+};
+
+/// @brief Engine settings chosen by the platform at initialization.
+struct EngineConfiguration
+{
+    // Amount of worker threads the Engine spawns for parallel work such as rendering, on top of the thread running Engine updates.
+    // A negative value spawns one worker per hardware thread, minus one for the Engine thread itself.
+    int32_t WorkerThreadCount = -1;
+
+    // Path of the model file to view, UTF-8 encoded. When empty, a generated test model is viewed instead.
+    std::string ModelFilePath;
+
+    // Processing of the loaded model: optimization, and whether & where it gets cached so later launches skip parsing it.
+    ModelLoader::LoadSettings ModelLoading;
+
+    // How far, in pixels, simplified levels of detail may deviate on screen from the full detail mesh. 0 always renders at full detail.
+    float LodErrorPixels = 1.0f;
+
+    // How Engine updates are paced.
+    enum class FramePacing
     {
-        SUCCESS, // Message indicating something went well !
-        LOG, // Standard message indicating a fact that is in itself neither good or bad.
-        WARNING, // Standard message indicating something irregular / incorrect happened, but not in a way that will necessarily cause a problem.
-        ERROR_NONFATAL, // Message indicating something went wrong, but not to the point the program will require an Engine restart.
-        ERROR_FATAL // Message indicating something went *very* wrong to the point it will require a Engine restart. Logging in this category will trigger
-        // an Engine shutdown.
+        UNLIMITED, // Updates run back to back, as fast as the Engine can go. Meant for benchmarking.
+        PRESENT_BOUND, // Updates don't present a frame until the platform displayed the previous one, so no frame gets drawn only to be dropped.
+        TARGET_RATE // Updates sleep so as to run at TargetFrameRate at most.
     };
+    FramePacing Pacing = FramePacing::UNLIMITED;
+
+    // Maximum amount of updates per second when pacing at a target rate.
+    float TargetFrameRate = 60.0f;
 
-    std::string LogMessage;
-    Category LogCategory;
+    // Simulated time each Tick advances by, in seconds. Updates run as many ticks as real time elapsed allows, and render the view
+    // interpolated between the last two.
+    double TickStepSeconds = 0.01;
+
+    // Longest elapsed time an update accounts for, in seconds. Time beyond it is dropped so that updates slower than the ticks they run
+    // can't fall further & further behind, making the view slow down instead.
+    double MaxUpdateTimeSeconds = 0.25;
+
+    // Whether updates skip rendering & the platform render update altogether when neither the view nor the display changed since the last
+    // rendered frame, which the platform keeps displaying.
+    bool bRenderOnDemand = false;
+
+    // Whether the camera slowly orbits around the model until the user takes control of it.
+    bool bAutoOrbit = true;
 };
 
 /// @brief Main Engine class, to be linked to an abstract Platform Implementation object. 
@@ -73,8 +125,15 @@ class Engine
     /// @param platform Shared pointer to the underlying platform debugger implementation.
     /// @Note(Marc): Is it wise to make each "service" a separate parameter here ? Perhaps a structure combining them together would work better. I don't know the total amount
     // of Service classes there will be yet so doing it might be premature.
+    /// @param platformFileSystem Shared pointer to the underlying platform file system implementation, used to load models.
+    /// @param memory Arenas the Engine allocates from, every one of them set. See EngineMemory.
+    /// @param configuration Engine settings, see EngineConfiguration.
     void Initialize(std::shared_ptr<PlatformDebugger> platformDebugger,
-                    std::shared_ptr<PlatformRenderer> platformRenderer);
+                    std::shared_ptr<PlatformRenderer> platformRenderer,
+                    std::shared_ptr<PlatformFileSystem> platformFileSystem,
+                    std::shared_ptr<PlatformClock> platformClock,
+                    const EngineMemory& memory,
+                    const EngineConfiguration& configuration = EngineConfiguration());
 
     /// @brief Performs a full update of the Engine, taking into account incoming events, the passage of time, and
     /// consequently updating render elements and the general state of the program as needed.
@@ -89,6 +148,14 @@ class Engine
     // complex integration.
     void Tick(double timeSeconds);
 
+    /// @brief Finds the triangle of the viewed model under a point of the last rendered frame.
+    /// #NOTE: Reads the camera & mesh without synchronization, so it must be called from the thread running Engine updates, between them.
+    /// @param normalizedX Horizontal position within the frame, 0 on the left edge and 1 on the right edge.
+    /// @param normalizedY Vertical position within the frame, 0 on the top edge and 1 on the bottom edge.
+    /// @param outHit Filled with the picked triangle, if any.
+    /// @return True if a triangle is under the point.
+    bool PickTriangle(float normalizedX, float normalizedY, RaycastHit& outHit) const;
+
     /// @brief Shuts down the Engine, making it cleanly release any and all resources it might be using, and gracefully
     /// exit any sort of editing process.
     void OnShutdown();
@@ -101,9 +168,30 @@ class Engine
 
     std::shared_ptr<PlatformDebugger> GetDebugger() const { return m_platformDebugger; }
     std::shared_ptr<PlatformRenderer> GetRenderer() const { return m_platformRenderer; }
+    std::shared_ptr<PlatformFileSystem> GetFileSystem() const { return m_platformFileSystem; }
+    std::shared_ptr<PlatformClock> GetClock() const { return m_platformClock; }
+
+    /// @brief Returns counters describing the work done rendering the last frame.
+    const RenderStatistics& GetLastFrameStatistics() const { return m_meshRenderer.GetLastFrameStatistics(); }
+
+    /// @brief Returns rolling statistics over the time taken by the last updates, measured on the platform clock from one update to the next.
+    const FrameTimeStatistics& GetFrameTimeStatistics() const { return m_frameTimeStatistics; }
+
+    /// @brief Returns the amount of frames rendered since initialization. Falls behind the amount of updates when rendering on demand.
+    uint64_t GetRenderedFrameCount() const { return m_renderedFrameCount; }
+
+    /// @brief Returns the queue the platform pushes input events into, from a single thread at a time. Events get handled at the start of
+    /// the next update.
+    InputEventQueue& GetInputEventQueue() { return m_inputEvents; }
 
 private:
 
+    /// @brief Updates held keys & buttons with an input event, and applies direct camera manipulation (dragging, wheel) right away.
+    void HandleInputEvent(const InputEvent& event);
+
+    bool IsInputKeyHeld(InputKey key) const { return (m_heldInputKeys & (1u << static_cast<uint32_t>(key))) != 0; }
+    bool IsMouseButtonHeld(InputMouseButton button) const { return (m_heldMouseButtons & (1u << static_cast<uint32_t>(button))) != 0; }
+
     // Whether the engine has been flagged for shutting down. This will trigger the shutting down of the Engine and then the whole program
     // after current frame ends.
     bool m_shouldShutdown;
@@ -119,6 +207,74 @@ private:
 
     // Shared pointer to underlying Platform Renderer implementation.
     std::shared_ptr<PlatformRenderer> m_platformRenderer;
+
+    // Shared pointer to underlying Platform File System implementation.
+    std::shared_ptr<PlatformFileSystem> m_platformFileSystem;
+
+    // Shared pointer to underlying Platform Clock implementation.
+    std::shared_ptr<PlatformClock> m_platformClock;
+
+    // Arenas handed by the platform, and amount of updates ran so far, which picks the frame arena of the next one.
+    EngineMemory m_memory;
+    uint64_t m_updateCount = 0;
+
+    // Pacing of updates: policy, clock ticks between updates and clock time the next one may start at when pacing at a target rate, and
+    // whether a presented frame may still be waiting to be displayed when bound to presentation.
+    EngineConfiguration::FramePacing m_framePacing = EngineConfiguration::FramePacing::UNLIMITED;
+    uint64_t m_targetFrameClockTicks = 0;
+    uint64_t m_nextFrameClockTime = 0;
+    bool m_bAwaitingPresentation = false;
+
+    // Fixed-step ticking: clock time of the previous update, elapsed clock ticks not ticked yet, and duration of a tick and longest elapsed
+    // time an update accounts for, in clock ticks.
+    uint64_t m_lastUpdateClockTime = 0;
+    uint64_t m_tickAccumulator = 0;
+    uint64_t m_tickStepClockTicks = 1;
+    uint64_t m_maxUpdateClockTicks = 1;
+    double m_tickStepSeconds = 0.01;
+
+    // Input events pushed by the platform, and keys & mouse buttons currently held, one bit each.
+    InputEventQueue m_inputEvents;
+    uint32_t m_heldInputKeys = 0;
+    uint32_t m_heldMouseButtons = 0;
+    // Whether the camera orbits on its own, which stops as soon as the user takes control of it.
+    bool m_bAutoOrbit = true;
+
+    // Durations of the last updates, and clock time at which to log them next.
+    FrameTimeStatistics m_frameTimeStatistics;
+    uint64_t m_nextStatisticsLogClockTime = 0;
+
+    // Model currently being viewed.
+    Mesh m_mesh;
+
+    // Hierarchy over the viewed model, used for frustum culling & picking.
+    MeshBvh m_meshBvh;
+
+    // Simplified levels of the hierarchy's chunks, drawn instead of them when far enough.
+    MeshLods m_meshLods;
+
+    // Rendering on demand: whether it is on, version of the view bumped by anything changing what frames show, versions of the view &
+    // platform display the last frame got rendered at, and amount of frames rendered.
+    bool m_bRenderOnDemand = false;
+    uint64_t m_viewVersion = 0;
+    uint64_t m_renderedViewVersion = 0;
+    uint64_t m_renderedDisplayVersion = 0;
+    uint64_t m_renderedFrameCount = 0;
+
+    // Width over height of the last rendered frame, which picking positions are relative to.
+    float m_lastFrameAspect = 1.0f;
+
+    // Camera the model is viewed through, as of the last tick and the one before it, and camera the last frame got rendered with,
+    // interpolated between the two.
+    Camera m_camera;
+    Camera m_previousCamera;
+    Camera m_renderCamera;
+
+    // Software geometry pipeline & rasterizer drawing the model to platform drawers.
+    MeshRenderer m_meshRenderer;
+
+    // Worker threads shared by every parallel Engine system.
+    JobSystem m_jobSystem;
 };
 
 #endif // ENGINE_H
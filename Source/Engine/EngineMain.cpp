@@ -1,5 +1,36 @@
 #include "Engine.h"
 #include "Platform.h"
+#include "ModelLoader.h"
+#include "CpuFeatures.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    /// Longest time a present-bound update waits for the platform to display the previous frame, so the Engine keeps updating (and may
+    /// shut down) if the platform stops displaying frames, for instance while its window is minimized.
+    constexpr uint32_t PRESENT_WAIT_TIMEOUT_MS = 100;
+
+    /// Clock time between two logs of frame time statistics, in seconds.
+    constexpr double STATISTICS_LOG_INTERVAL_SECONDS = 1.0;
+
+    /// Camera control: orbit per pixel the cursor gets dragged by and per second a key gets held for, and factor the distance to the target
+    /// gets scaled by per wheel notch turned away from the user and per second a zoom key gets held for.
+    constexpr float DRAG_ORBIT_RADIANS_PER_PIXEL = 0.008f;
+    constexpr float KEY_ORBIT_RADIANS_PER_SECOND = 1.5f;
+    constexpr float WHEEL_ZOOM_SCALE_PER_NOTCH = 0.85f;
+    constexpr float KEY_ZOOM_SCALE_PER_SECOND = 0.4f;
+
+    /// Converts a duration in seconds to platform clock ticks, never less than one.
+    uint64_t SecondsToClockTicks(double seconds, const PlatformClock& clock)
+    {
+        return std::max<uint64_t>(static_cast<uint64_t>(seconds * clock.GetTicksPerSecond() + 0.5), 1);
+    }
+}
 
 // Standard Platform functions
 
@@ -10,78 +41,320 @@ void PlatformDebugger::DisplayDebugMessage(std::string&& msgStr, DebugLogMessage
 
 // Engine implementation
 
-void Engine::Initialize(std::shared_ptr<PlatformDebugger> platformDebugger, std::shared_ptr<PlatformRenderer> platformRenderer)
+void Engine::Initialize(std::shared_ptr<PlatformDebugger> platformDebugger, std::shared_ptr<PlatformRenderer> platformRenderer,
+    std::shared_ptr<PlatformFileSystem> platformFileSystem, std::shared_ptr<PlatformClock> platformClock, const EngineMemory& memory, const EngineConfiguration& configuration)
 {
     m_platformDebugger = platformDebugger;
     m_platformRenderer = platformRenderer;
-}
+    m_platformFileSystem = platformFileSystem;
+    m_platformClock = platformClock;
+
+    m_memory = memory;
+    m_updateCount = 0;
+    m_memory.PersistentArena->Reset();
+    m_meshRenderer.SetPersistentArena(*m_memory.PersistentArena);
+    m_meshRenderer.SetSimdPaths(CpuFeatures::DetectSimdPaths());
+
+    m_framePacing = configuration.Pacing;
+    m_targetFrameClockTicks = SecondsToClockTicks(1.0 / std::max(configuration.TargetFrameRate, 1.0f), *m_platformClock);
+    m_bAwaitingPresentation = false;
+
+    m_tickStepSeconds = configuration.TickStepSeconds;
+    m_tickStepClockTicks = SecondsToClockTicks(configuration.TickStepSeconds, *m_platformClock);
+    m_maxUpdateClockTicks = std::max(SecondsToClockTicks(configuration.MaxUpdateTimeSeconds, *m_platformClock), m_tickStepClockTicks);
+    m_tickAccumulator = 0;
+    m_frameTimeStatistics.Clear();
+
+    m_heldInputKeys = 0;
+    m_heldMouseButtons = 0;
+    m_bAutoOrbit = configuration.bAutoOrbit;
+    m_bRenderOnDemand = configuration.bRenderOnDemand;
+    m_renderedFrameCount = 0;
+
+    uint32_t workerThreadCount = static_cast<uint32_t>(configuration.WorkerThreadCount);
+    if (configuration.WorkerThreadCount < 0)
+    {
+        const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+        workerThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+    }
+    m_jobSystem.Initialize(workerThreadCount);
+
+    if (!configuration.ModelFilePath.empty())
+    {
+        if (!ModelLoader::LoadModel(configuration.ModelFilePath, configuration.ModelLoading, *m_platformFileSystem, *m_platformDebugger, m_jobSystem, m_mesh, m_meshBvh, m_meshLods))
+        {
+            TriggerShutdown(ShutdownReason::BAD_INIT);
+            return;
+        }
+    }
+    else
+    {
+        // #TEST: No model to view, so view a generated sphere.
+        m_mesh = Mesh::CreateUVSphere(256, 512);
+    }
 
-std::shared_ptr<PlatformRenderer::MemoryMapDrawer> lineDrawer = nullptr;
+    // Caches written without a hierarchy still load, so build it here whenever the model came without one.
+    if (m_meshBvh.IsEmpty())
+    {
+        ModelLoader::BuildMeshBvh(m_mesh, m_jobSystem, *m_platformDebugger, m_meshBvh);
+    }
+    if (configuration.ModelLoading.bGenerateLods && m_meshLods.IsEmpty())
+    {
+        ModelLoader::BuildMeshLods(m_mesh, m_meshBvh, m_jobSystem, *m_platformDebugger, m_meshLods);
+    }
+    m_meshRenderer.SetLodErrorThreshold(configuration.LodErrorPixels);
+    m_camera.FrameBounds(m_mesh.Bounds);
+    m_previousCamera = m_camera;
+    m_renderCamera = m_camera;
+    // A new model is viewed: whatever got rendered before doesn't show it.
+    m_viewVersion++;
+
+    m_platformDebugger->Log<DebugLogMessage::Category::LOG>("Viewing mesh with %zu vertices & %zu triangles. Rasterizer SIMD path: %s, vertex transform SIMD path: %s, %u worker threads.",
+        m_mesh.GetVertexCount(), m_mesh.GetTriangleCount(), Rasterizer::GetSimdPathName(m_meshRenderer.GetSimdPaths()),
+        VertexTransform::GetSimdPathName(m_meshRenderer.GetSimdPaths()), m_jobSystem.GetWorkerThreadCount());
+
+    // Start measuring time from here, so loading doesn't count as time the first update has to tick through.
+    const uint64_t clockTime = m_platformClock->GetTicks();
+    m_lastUpdateClockTime = clockTime;
+    m_nextFrameClockTime = clockTime;
+    m_nextStatisticsLogClockTime = clockTime + SecondsToClockTicks(STATISTICS_LOG_INTERVAL_SECONDS, *m_platformClock);
+}
 
 void Engine::Update()
 {
     // Run full Engine update: read input events, tick time-based elements, and update rendering.
+    PROFILE_ZONE("Engine::Update");
+
+    if (m_framePacing == EngineConfiguration::FramePacing::TARGET_RATE)
+    {
+        // Sleep until this update's turn. An update running late pushes later ones back rather than letting them catch up in a burst.
+        PROFILE_ZONE("Engine::Update pacing");
+        const uint64_t clockTime = m_platformClock->GetTicks();
+        if (m_nextFrameClockTime > clockTime)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>(static_cast<double>(m_nextFrameClockTime - clockTime) / m_platformClock->GetTicksPerSecond()));
+        }
+        m_nextFrameClockTime = std::max(m_nextFrameClockTime + m_targetFrameClockTicks, m_platformClock->GetTicks());
+    }
+
+    // Handle input pushed since the previous update. Reading it after pacing gets the freshest events into this update.
+    {
+        PROFILE_ZONE("Engine::Update input");
+        m_inputEvents.Drain([this](const InputEvent& event) { HandleInputEvent(event); });
+
+        const uint64_t droppedEventCount = m_inputEvents.TakeDroppedEventCount();
+        if (droppedEventCount > 0)
+        {
+            m_platformDebugger->Log<DebugLogMessage::Category::WARNING>("%llu input events were dropped, the input event queue was full.", droppedEventCount);
+        }
+    }
+
+    // Measure time elapsed since the previous update, and tick through it in fixed steps. Time left over is carried to the next update.
+    const uint64_t clockTime = m_platformClock->GetTicks();
+    const uint64_t elapsedClockTicks = clockTime - m_lastUpdateClockTime;
+    m_lastUpdateClockTime = clockTime;
+    m_frameTimeStatistics.AddFrameTime(static_cast<double>(elapsedClockTicks) / m_platformClock->GetTicksPerSecond());
+
+    m_tickAccumulator += std::min(elapsedClockTicks, m_maxUpdateClockTicks);
+    while (m_tickAccumulator >= m_tickStepClockTicks)
+    {
+        m_previousCamera = m_camera;
+        Tick(m_tickStepSeconds);
+        m_tickAccumulator -= m_tickStepClockTicks;
+    }
 
-    //#TODO(Marc): Input handling.
+    // Render the view as it was partway between the last two ticks, as much as the time left over makes up of a tick. This lags a tick
+    // behind, but moves smoothly whatever the amount of ticks per update.
+    const float tickAlpha = static_cast<float>(static_cast<double>(m_tickAccumulator) / m_tickStepClockTicks);
+    const Camera renderCamera = Camera::Interpolate(m_previousCamera, m_camera, tickAlpha);
+    if (renderCamera != m_renderCamera)
+    {
+        m_renderCamera = renderCamera;
+        m_viewVersion++;
+    }
 
-    Tick(0.01); // #TODO(Marc): Let's measure time so we can make Tick be real-time-based.
+    // Percentiles copy & partially sort the whole window, so they only get computed when verbose messages are compiled in.
+    if constexpr (DebugLog::IsCategoryCompiledIn(DebugLogMessage::Category::VERBOSE))
+    {
+        if (clockTime >= m_nextStatisticsLogClockTime)
+        {
+            m_platformDebugger->Log<DebugLogMessage::Category::VERBOSE>("Frame time over the last %u updates (ms): mean %.3f | min %.3f | p50 %.3f | p99 %.3f | max %.3f.",
+                m_frameTimeStatistics.GetFrameCount(), m_frameTimeStatistics.GetMean() * 1000.0, m_frameTimeStatistics.GetMinimum() * 1000.0,
+                m_frameTimeStatistics.GetPercentile(50.0) * 1000.0, m_frameTimeStatistics.GetPercentile(99.0) * 1000.0, m_frameTimeStatistics.GetMaximum() * 1000.0);
+            m_nextStatisticsLogClockTime = clockTime + SecondsToClockTicks(STATISTICS_LOG_INTERVAL_SECONDS, *m_platformClock);
+        }
+    }
 
-    // #TEST: Draw a red line on screen.
-    if (lineDrawer == nullptr)
+    // Nothing changed since the last rendered frame, which the platform still displays: drawing it again would only burn time & power.
+    const uint64_t displayVersion = m_platformRenderer->GetDisplayVersion();
+    if (m_bRenderOnDemand && m_viewVersion == m_renderedViewVersion && displayVersion == m_renderedDisplayVersion)
     {
-        lineDrawer = m_platformRenderer->AllocateFullDisplayDrawer();
+        return;
     }
 
-    if (lineDrawer != nullptr)
+    // Scratch memory of the previous update stays untouched, as the platform may still be presenting what it produced.
+    MemoryArena& frameArena = *m_memory.FrameArenas[m_updateCount % 2];
+    frameArena.Reset();
+    m_updateCount++;
+
+    // Draw the model over the whole display, on the next drawer of the swapchain.
+    PlatformRenderer::MemoryMapDrawer* drawer = m_platformRenderer->AcquireDisplayDrawer();
+    if (drawer != nullptr)
     {
-        uint16_t width, height;
-        width = lineDrawer->GetWidth();
-        height = lineDrawer->GetHeight();
+        m_lastFrameAspect = static_cast<float>(drawer->GetWidth()) / std::max<uint16_t>(drawer->GetHeight(), 1);
+        m_meshRenderer.Render(m_mesh, m_meshBvh, m_meshLods, m_renderCamera, drawer->GetPixelBufferPtr(), drawer->GetWidth(), drawer->GetHeight(), frameArena,
+            m_jobSystem);
 
-        Pixel_RGBA* pixelsBuffer = lineDrawer->GetPixelBufferPtr();
+        const RenderStatistics& statistics = m_meshRenderer.GetLastFrameStatistics();
+        m_platformDebugger->Log<DebugLogMessage::Category::VERBOSE>("Frame rendered: %u chunks (%u simplified), %u occlusion culled, %u frustum culled, %u triangles submitted.",
+            statistics.ChunksRendered, statistics.ChunksSimplified, statistics.ChunksOcclusionCulled, statistics.ChunksFrustumCulled, statistics.TrianglesSubmitted);
 
-        // Let's draw a line at arbitrary coordinates.
-        for(int y = 200; y < 210; y++)
+        DisplayDamage damage;
+        m_meshRenderer.GetLastFrameDamage(damage);
+
+        // Drawing happened while the platform displayed the previous frame: only wait for it to be done before presenting this one.
+        if (m_framePacing == EngineConfiguration::FramePacing::PRESENT_BOUND && m_bAwaitingPresentation)
         {
-            for(int x = 100; x < 500; x++)
-            {
-                pixelsBuffer[y * width + x].pixel = 0xFFFF0000;
-            }
+            PROFILE_ZONE("Engine::Update pacing");
+            m_platformRenderer->GetPresentSignal().Wait(PRESENT_WAIT_TIMEOUT_MS);
         }
+        m_platformRenderer->PresentDisplayDrawer(drawer, damage);
+        m_bAwaitingPresentation = true;
 
-        lineDrawer->SetReadyToDraw();
-        lineDrawer->Discard();
-        lineDrawer = nullptr;
+        m_renderedViewVersion = m_viewVersion;
+        m_renderedDisplayVersion = displayVersion;
+        m_renderedFrameCount++;
     }
 
     // Perform platform rendering update.
+    PROFILE_ZONE("PlatformRenderer::RenderUpdate");
     m_platformRenderer->RenderUpdate();
 }
 
 void Engine::Tick(double timeSeconds)
 {
+    PROFILE_ZONE("Engine::Tick");
+    // #TEST: Slowly orbit around the model until the user takes control of the camera.
+    if (m_bAutoOrbit)
+    {
+        m_camera.Orbit(static_cast<float>(0.5 * timeSeconds), 0.0f);
+    }
+
+    // Held keys move the camera at a steady rate.
+    const float seconds = static_cast<float>(timeSeconds);
+    const float yawDirection = (IsInputKeyHeld(InputKey::ORBIT_RIGHT) ? 1.0f : 0.0f) - (IsInputKeyHeld(InputKey::ORBIT_LEFT) ? 1.0f : 0.0f);
+    const float pitchDirection = (IsInputKeyHeld(InputKey::ORBIT_UP) ? 1.0f : 0.0f) - (IsInputKeyHeld(InputKey::ORBIT_DOWN) ? 1.0f : 0.0f);
+    const float zoomDirection = (IsInputKeyHeld(InputKey::ZOOM_IN) ? 1.0f : 0.0f) - (IsInputKeyHeld(InputKey::ZOOM_OUT) ? 1.0f : 0.0f);
+    if (yawDirection != 0.0f || pitchDirection != 0.0f)
+    {
+        m_camera.Orbit(yawDirection * KEY_ORBIT_RADIANS_PER_SECOND * seconds, pitchDirection * KEY_ORBIT_RADIANS_PER_SECOND * seconds);
+    }
+    if (zoomDirection != 0.0f)
+    {
+        m_camera.Zoom(std::pow(KEY_ZOOM_SCALE_PER_SECOND, zoomDirection * seconds));
+    }
+}
+
+void Engine::HandleInputEvent(const InputEvent& event)
+{
+    // Input may change the view in ways cameras don't tell, such as held keys starting to move it next tick. Only the cursor merely moving
+    // over the display is sure to leave it as is.
+    if (event.Type != InputEventType::MOUSE_MOVE || IsMouseButtonHeld(InputMouseButton::LEFT))
+    {
+        m_viewVersion++;
+    }
+
+    switch(event.Type)
+    {
+        case(InputEventType::KEY_DOWN):
+            if (event.Key < InputKey::COUNT)
+            {
+                m_heldInputKeys |= 1u << static_cast<uint32_t>(event.Key);
+                m_bAutoOrbit = false;
+            }
+            if (event.Key == InputKey::RESET_VIEW)
+            {
+                m_camera = Camera();
+                m_camera.FrameBounds(m_mesh.Bounds);
+                m_previousCamera = m_camera;
+            }
+        break;
+        case(InputEventType::KEY_UP):
+            if (event.Key < InputKey::COUNT)
+            {
+                m_heldInputKeys &= ~(1u << static_cast<uint32_t>(event.Key));
+            }
+        break;
+        case(InputEventType::MOUSE_BUTTON_DOWN):
+            if (event.Button < InputMouseButton::COUNT)
+            {
+                m_heldMouseButtons |= 1u << static_cast<uint32_t>(event.Button);
+                m_bAutoOrbit = false;
+            }
+        break;
+        case(InputEventType::MOUSE_BUTTON_UP):
+            if (event.Button < InputMouseButton::COUNT)
+            {
+                m_heldMouseButtons &= ~(1u << static_cast<uint32_t>(event.Button));
+            }
+        break;
+        case(InputEventType::MOUSE_MOVE):
+            // Dragging grabs the model: the camera turns the other way. Both ticked cameras move, so interpolating between them doesn't
+            // leave the view a tick behind the cursor.
+            if (IsMouseButtonHeld(InputMouseButton::LEFT))
+            {
+                const float yawDelta = -event.DeltaX * DRAG_ORBIT_RADIANS_PER_PIXEL;
+                const float pitchDelta = event.DeltaY * DRAG_ORBIT_RADIANS_PER_PIXEL;
+                m_camera.Orbit(yawDelta, pitchDelta);
+                m_previousCamera.Orbit(yawDelta, pitchDelta);
+            }
+        break;
+        case(InputEventType::MOUSE_WHEEL):
+        {
+            const float distanceScale = std::pow(WHEEL_ZOOM_SCALE_PER_NOTCH, event.DeltaY);
+            m_camera.Zoom(distanceScale);
+            m_previousCamera.Zoom(distanceScale);
+            m_bAutoOrbit = false;
+        }
+        break;
+        case(InputEventType::FOCUS_LOST):
+            // Keys & buttons released while the platform wasn't receiving input never send events.
+            m_heldInputKeys = 0;
+            m_heldMouseButtons = 0;
+        break;
+    }
+}
 
+bool Engine::PickTriangle(float normalizedX, float normalizedY, RaycastHit& outHit) const
+{
+    Vector3 rayOrigin;
+    Vector3 rayDirection;
+    m_renderCamera.GetViewRay(normalizedX, normalizedY, m_lastFrameAspect, rayOrigin, rayDirection);
+    return m_meshBvh.Raycast(m_mesh, rayOrigin, rayDirection, outHit);
 }
 
 void Engine::OnShutdown()
 {
+    // Parallel work is over: release worker threads.
+    m_jobSystem.Shutdown();
+
     // Display a debug message on the platform informing the user why Engine has shut down.
     switch(GetShutdownReason())
     {
         case(Engine::ShutdownReason::REQUESTED):
-            m_platformDebugger->DisplayDebugMessage("Engine Shutdown on user request.", DebugLogMessage::Category::LOG);
+            m_platformDebugger->Log<DebugLogMessage::Category::LOG>("Engine Shutdown on user request.");
             break;
         case(Engine::ShutdownReason::BAD_INIT):
-            m_platformDebugger->DisplayDebugMessage("Engine Shutdown due to initialization failure ! Check initialization parameters.", DebugLogMessage::Category::ERROR_FATAL);
+            m_platformDebugger->Log<DebugLogMessage::Category::ERROR_FATAL>("Engine Shutdown due to initialization failure ! Check initialization parameters.");
             break;
         case(Engine::ShutdownReason::RUNTIME_ERROR):
-            m_platformDebugger->DisplayDebugMessage("Engine Shutdown due to runtime error ! Check previous messages for a fatal error.", DebugLogMessage::Category::ERROR_NONFATAL);
+            m_platformDebugger->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Engine Shutdown due to runtime error ! Check previous messages for a fatal error.");
             break;
         case(Engine::ShutdownReason::PLATFORM):
-            m_platformDebugger->DisplayDebugMessage("Engine Shutdown by request of Platform.", DebugLogMessage::Category::WARNING);
+            m_platformDebugger->Log<DebugLogMessage::Category::WARNING>("Engine Shutdown by request of Platform.");
             break;
         default:
-            m_platformDebugger->DisplayDebugMessage("Engine Shutdown reason unknown ! Something has gone very wrong.", DebugLogMessage::Category::ERROR_FATAL);
+            m_platformDebugger->Log<DebugLogMessage::Category::ERROR_FATAL>("Engine Shutdown reason unknown ! Something has gone very wrong.");
             break;
     }
 }
@@ -0,0 +1,69 @@
+#include "FrameTimeStatistics.h"
+
+#include <algorithm>
+
+void FrameTimeStatistics::AddFrameTime(double frameTimeSeconds)
+{
+    if (m_sampleCount == WINDOW_FRAME_COUNT)
+    {
+        m_sampleSum -= m_samples[m_nextSampleIndex];
+    }
+    else
+    {
+        m_sampleCount++;
+    }
+
+    m_samples[m_nextSampleIndex] = frameTimeSeconds;
+    m_sampleSum += frameTimeSeconds;
+    m_nextSampleIndex = (m_nextSampleIndex + 1) % WINDOW_FRAME_COUNT;
+
+    // Evicting samples leaves rounding errors in the sum: recompute it once per lap around the ring so they can't build up.
+    if (m_nextSampleIndex == 0)
+    {
+        m_sampleSum = 0.0;
+        for (uint32_t sampleIndex = 0; sampleIndex < m_sampleCount; sampleIndex++)
+        {
+            m_sampleSum += m_samples[sampleIndex];
+        }
+    }
+}
+
+double FrameTimeStatistics::GetLatest() const
+{
+    return m_sampleCount > 0 ? m_samples[(m_nextSampleIndex + WINDOW_FRAME_COUNT - 1) % WINDOW_FRAME_COUNT] : 0.0;
+}
+
+double FrameTimeStatistics::GetMinimum() const
+{
+    if (m_sampleCount == 0)
+    {
+        return 0.0;
+    }
+    return *std::min_element(m_samples, m_samples + m_sampleCount);
+}
+
+double FrameTimeStatistics::GetMaximum() const
+{
+    if (m_sampleCount == 0)
+    {
+        return 0.0;
+    }
+    return *std::max_element(m_samples, m_samples + m_sampleCount);
+}
+
+double FrameTimeStatistics::GetPercentile(double percentile) const
+{
+    if (m_sampleCount == 0)
+    {
+        return 0.0;
+    }
+
+    // Samples only fill the start of the ring until it wraps, so the first m_sampleCount ones are always the window.
+    double windowSamples[WINDOW_FRAME_COUNT];
+    std::copy(m_samples, m_samples + m_sampleCount, windowSamples);
+
+    uint32_t rank = static_cast<uint32_t>(percentile / 100.0 * m_sampleCount + 0.5);
+    rank = std::min(std::max<uint32_t>(rank, 1), m_sampleCount);
+    std::nth_element(windowSamples, windowSamples + rank - 1, windowSamples + m_sampleCount);
+    return windowSamples[rank - 1];
+}
@@ -0,0 +1,48 @@
+/*
+    Rolling statistics over the durations of the last frames the Engine ran, as measured on the platform clock. Meant to be queried at any
+    time by benchmarks & debugging displays, so it keeps a fixed window of samples and never allocates.
+*/
+
+#ifndef FRAME_TIME_STATISTICS_H
+#define FRAME_TIME_STATISTICS_H
+
+#include <cstdint>
+
+class FrameTimeStatistics
+{
+public:
+
+    // Amount of most recent frames statistics are computed over.
+    static constexpr uint32_t WINDOW_FRAME_COUNT = 128;
+
+    FrameTimeStatistics() : m_nextSampleIndex(0), m_sampleCount(0), m_sampleSum(0.0)
+    {}
+
+    /// @brief Records the duration of a frame, evicting the oldest one once the window is full.
+    void AddFrameTime(double frameTimeSeconds);
+
+    void Clear() { m_nextSampleIndex = 0; m_sampleCount = 0; m_sampleSum = 0.0; }
+
+    /// @brief Returns the amount of frames statistics are computed over, at most WINDOW_FRAME_COUNT.
+    uint32_t GetFrameCount() const { return m_sampleCount; }
+
+    // Statistics over the window, in seconds. All of them are 0 while no frame got recorded.
+    double GetLatest() const;
+    double GetMean() const { return m_sampleCount > 0 ? m_sampleSum / m_sampleCount : 0.0; }
+    double GetMinimum() const;
+    double GetMaximum() const;
+
+    /// @brief Returns the frame time at the given percentile (0 - 100) of the window, using nearest-rank.
+    double GetPercentile(double percentile) const;
+
+private:
+
+    // Ring of the frame times in the window, the oldest one being overwritten next once it is full.
+    double m_samples[WINDOW_FRAME_COUNT];
+    uint32_t m_nextSampleIndex;
+    uint32_t m_sampleCount;
+    // Sum of the frame times in the window, kept up to date as they come & go.
+    double m_sampleSum;
+};
+
+#endif // FRAME_TIME_STATISTICS_H
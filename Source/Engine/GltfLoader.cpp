@@ -0,0 +1,884 @@
+#include "GltfLoader.h"
+#include "Json.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    const uint32_t GLB_VERSION = 2;
+    const uint32_t GLB_CHUNK_TYPE_JSON = 0x4E4F534A; // "JSON"
+    const uint32_t GLB_CHUNK_TYPE_BIN = 0x004E4942; // "BIN\0"
+
+    const uint32_t COMPONENT_TYPE_BYTE = 5120;
+    const uint32_t COMPONENT_TYPE_UNSIGNED_BYTE = 5121;
+    const uint32_t COMPONENT_TYPE_SHORT = 5122;
+    const uint32_t COMPONENT_TYPE_UNSIGNED_SHORT = 5123;
+    const uint32_t COMPONENT_TYPE_UNSIGNED_INT = 5125;
+    const uint32_t COMPONENT_TYPE_FLOAT = 5126;
+
+    const uint32_t PRIMITIVE_MODE_TRIANGLES = 4;
+    const uint32_t PRIMITIVE_MODE_TRIANGLE_STRIP = 5;
+    const uint32_t PRIMITIVE_MODE_TRIANGLE_FAN = 6;
+
+    const int64_t NO_ACCESSOR = -1;
+
+    // Elements converted per job, so conversions of large accessors spread across threads.
+    const size_t CONVERSION_BATCH_SIZE = 1 << 16;
+
+    inline uint32_t ReadUint32(const uint8_t* bytes)
+    {
+        // GLB is little endian, as is every platform the Engine runs on.
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    /// Returns a non-negative integer member of a JSON object, or the default value if it is missing or isn't one.
+    int64_t GetInteger(const JsonValue& object, const char* name, int64_t defaultValue)
+    {
+        const JsonValue* member = object.FindMember(name);
+        if (member == nullptr || !member->IsNumber())
+        {
+            return defaultValue;
+        }
+
+        const double number = member->GetNumber();
+        return number >= 0.0 && number <= 9.0e15 && number == std::floor(number) ? static_cast<int64_t>(number) : defaultValue;
+    }
+
+    /// Typed, validated view of a glTF accessor's elements inside the BIN chunk.
+    struct AccessorView
+    {
+        // First byte of the first element. Null when the accessor has no buffer view, meaning all of its elements are zero.
+        const uint8_t* Data = nullptr;
+        size_t Count = 0;
+        size_t Stride = 0;
+        uint32_t ComponentType = 0;
+        uint32_t ComponentSize = 0;
+        uint32_t ComponentCount = 0;
+        bool bNormalized = false;
+
+        const JsonValue* Min = nullptr;
+        const JsonValue* Max = nullptr;
+
+        /// Whether elements are tightly packed arrays of componentCount floats, exactly like the Engine's own vector types.
+        inline bool IsTightFloatArray(uint32_t componentCount) const
+        {
+            return Data != nullptr && ComponentType == COMPONENT_TYPE_FLOAT && ComponentCount == componentCount
+                && Stride == componentCount * sizeof(float) && reinterpret_cast<uintptr_t>(Data) % alignof(float) == 0;
+        }
+    };
+
+    /// Triangle primitive of the scene, along with the transform it is drawn with.
+    struct PrimitiveDraw
+    {
+        int64_t PositionAccessor = NO_ACCESSOR;
+        int64_t NormalAccessor = NO_ACCESSOR;
+        int64_t TexCoordAccessor = NO_ACCESSOR;
+        int64_t IndexAccessor = NO_ACCESSOR;
+        uint32_t Mode = PRIMITIVE_MODE_TRIANGLES;
+
+        Matrix4x4 WorldMatrix;
+        bool bIdentityTransform = true;
+    };
+
+    /// Parsed document & BIN chunk location.
+    struct GltfDocument
+    {
+        JsonValue Root;
+        const uint8_t* BinData = nullptr;
+        size_t BinSize = 0;
+    };
+
+    uint32_t GetComponentSize(uint32_t componentType)
+    {
+        switch (componentType)
+        {
+            case COMPONENT_TYPE_BYTE:
+            case COMPONENT_TYPE_UNSIGNED_BYTE:
+                return 1;
+            case COMPONENT_TYPE_SHORT:
+            case COMPONENT_TYPE_UNSIGNED_SHORT:
+                return 2;
+            case COMPONENT_TYPE_UNSIGNED_INT:
+            case COMPONENT_TYPE_FLOAT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    uint32_t GetComponentCount(const std::string& type)
+    {
+        const char* typeNames[] = { "SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4" };
+        const uint32_t componentCounts[] = { 1, 2, 3, 4, 4, 9, 16 };
+        for (size_t typeIndex = 0; typeIndex < sizeof(componentCounts) / sizeof(componentCounts[0]); typeIndex++)
+        {
+            if (type == typeNames[typeIndex])
+            {
+                return componentCounts[typeIndex];
+            }
+        }
+        return 0;
+    }
+
+    /// Resolves an accessor to its location in the BIN chunk, checking every element lies within the buffer view it belongs to.
+    bool ResolveAccessor(const GltfDocument& document, int64_t accessorIndex, AccessorView& outView, std::string& outError)
+    {
+        const JsonValue* accessors = document.Root.FindMember("accessors");
+        const JsonValue* accessor = accessors != nullptr ? accessors->FindElement(static_cast<size_t>(accessorIndex)) : nullptr;
+        if (accessorIndex < 0 || accessor == nullptr || !accessor->IsObject())
+        {
+            outError = "Missing accessor " + std::to_string(accessorIndex) + ".";
+            return false;
+        }
+
+        const JsonValue* type = accessor->FindMember("type");
+        outView = AccessorView{};
+        outView.Count = static_cast<size_t>(GetInteger(*accessor, "count", 0));
+        outView.ComponentType = static_cast<uint32_t>(GetInteger(*accessor, "componentType", 0));
+        outView.ComponentSize = GetComponentSize(outView.ComponentType);
+        outView.ComponentCount = type != nullptr ? GetComponentCount(type->GetString()) : 0;
+        outView.bNormalized = accessor->FindMember("normalized") != nullptr && accessor->FindMember("normalized")->GetBoolean();
+        outView.Min = accessor->FindMember("min");
+        outView.Max = accessor->FindMember("max");
+
+        if (outView.ComponentSize == 0 || outView.ComponentCount == 0)
+        {
+            outError = "Accessor " + std::to_string(accessorIndex) + " has an invalid component type or element type.";
+            return false;
+        }
+
+        if (accessor->FindMember("sparse") != nullptr)
+        {
+            outError = "Accessor " + std::to_string(accessorIndex) + " is sparse, which is not supported.";
+            return false;
+        }
+
+        const size_t elementSize = static_cast<size_t>(outView.ComponentSize) * outView.ComponentCount;
+        const int64_t bufferViewIndex = GetInteger(*accessor, "bufferView", NO_ACCESSOR);
+        if (bufferViewIndex == NO_ACCESSOR)
+        {
+            outView.Stride = elementSize;
+            return true;
+        }
+
+        const JsonValue* bufferViews = document.Root.FindMember("bufferViews");
+        const JsonValue* bufferView = bufferViews != nullptr ? bufferViews->FindElement(static_cast<size_t>(bufferViewIndex)) : nullptr;
+        if (bufferView == nullptr || !bufferView->IsObject())
+        {
+            outError = "Accessor " + std::to_string(accessorIndex) + " references a missing buffer view.";
+            return false;
+        }
+
+        // Only the GLB-stored buffer is supported: it is the first buffer and has no URI.
+        const int64_t bufferIndex = GetInteger(*bufferView, "buffer", NO_ACCESSOR);
+        const JsonValue* buffers = document.Root.FindMember("buffers");
+        const JsonValue* buffer = buffers != nullptr ? buffers->FindElement(static_cast<size_t>(bufferIndex)) : nullptr;
+        if (bufferIndex != 0 || buffer == nullptr || buffer->FindMember("uri") != nullptr || document.BinData == nullptr)
+        {
+            outError = "Accessor " + std::to_string(accessorIndex) + " references data outside of the GLB binary chunk, which is not supported.";
+            return false;
+        }
+
+        const size_t viewOffset = static_cast<size_t>(GetInteger(*bufferView, "byteOffset", 0));
+        const size_t viewLength = static_cast<size_t>(GetInteger(*bufferView, "byteLength", 0));
+        const size_t accessorOffset = static_cast<size_t>(GetInteger(*accessor, "byteOffset", 0));
+        const size_t viewStride = static_cast<size_t>(GetInteger(*bufferView, "byteStride", 0));
+        outView.Stride = viewStride != 0 ? viewStride : elementSize;
+
+        const bool bViewInBuffer = viewOffset <= document.BinSize && viewLength <= document.BinSize - viewOffset;
+        const bool bAccessorInView = outView.Count == 0 || (outView.Stride >= elementSize && accessorOffset <= viewLength
+            && elementSize <= viewLength - accessorOffset && outView.Count - 1 <= (viewLength - accessorOffset - elementSize) / outView.Stride);
+        if (!bViewInBuffer || !bAccessorInView)
+        {
+            outError = "Accessor " + std::to_string(accessorIndex) + " lies outside of its buffer view or buffer.";
+            return false;
+        }
+
+        outView.Data = document.BinData + viewOffset + accessorOffset;
+        return true;
+    }
+
+    inline float ReadFloatComponent(const uint8_t* component, uint32_t componentType, bool bNormalized)
+    {
+        switch (componentType)
+        {
+            case COMPONENT_TYPE_FLOAT:
+            {
+                float value;
+                memcpy(&value, component, sizeof(value));
+                return value;
+            }
+            case COMPONENT_TYPE_BYTE:
+            {
+                const float value = static_cast<float>(static_cast<int8_t>(component[0]));
+                return bNormalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case COMPONENT_TYPE_UNSIGNED_BYTE:
+            {
+                const float value = static_cast<float>(component[0]);
+                return bNormalized ? value / 255.0f : value;
+            }
+            case COMPONENT_TYPE_SHORT:
+            {
+                int16_t integer;
+                memcpy(&integer, component, sizeof(integer));
+                return bNormalized ? std::max(integer / 32767.0f, -1.0f) : static_cast<float>(integer);
+            }
+            case COMPONENT_TYPE_UNSIGNED_SHORT:
+            {
+                uint16_t integer;
+                memcpy(&integer, component, sizeof(integer));
+                return bNormalized ? integer / 65535.0f : static_cast<float>(integer);
+            }
+            default:
+            {
+                uint32_t integer;
+                memcpy(&integer, component, sizeof(integer));
+                return static_cast<float>(integer);
+            }
+        }
+    }
+
+    inline uint32_t ReadIndex(const uint8_t* element, uint32_t componentType)
+    {
+        switch (componentType)
+        {
+            case COMPONENT_TYPE_UNSIGNED_BYTE:
+                return element[0];
+            case COMPONENT_TYPE_UNSIGNED_SHORT:
+            {
+                uint16_t index;
+                memcpy(&index, element, sizeof(index));
+                return index;
+            }
+            default:
+            {
+                uint32_t index;
+                memcpy(&index, element, sizeof(index));
+                return index;
+            }
+        }
+    }
+
+    /// Reads up to 4 components of an element as floats. Missing components are left as they are.
+    inline void ReadFloatElement(const AccessorView& view, size_t elementIndex, float* outComponents, uint32_t componentCount)
+    {
+        if (view.Data == nullptr)
+        {
+            for (uint32_t component = 0; component < componentCount; component++)
+            {
+                outComponents[component] = 0.0f;
+            }
+            return;
+        }
+
+        const uint8_t* element = view.Data + elementIndex * view.Stride;
+        const uint32_t readCount = std::min(componentCount, view.ComponentCount);
+        for (uint32_t component = 0; component < readCount; component++)
+        {
+            outComponents[component] = ReadFloatComponent(element + component * view.ComponentSize, view.ComponentType, view.bNormalized);
+        }
+    }
+
+    /// Computes the matrix transforming normals for a given transform (cofactors of its upper 3x3 part, which is the inverse transpose
+    /// up to a scale factor that gets normalized away).
+    Matrix4x4 ComputeNormalMatrix(const Matrix4x4& transform)
+    {
+        const float (*m)[4] = transform.m;
+        Matrix4x4 normalMatrix = Matrix4x4::Identity();
+        normalMatrix.m[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        normalMatrix.m[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        normalMatrix.m[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        normalMatrix.m[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+        normalMatrix.m[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+        normalMatrix.m[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+        normalMatrix.m[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+        normalMatrix.m[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+        normalMatrix.m[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+        return normalMatrix;
+    }
+
+    float ComputeDeterminant3x3(const Matrix4x4& transform)
+    {
+        const float (*m)[4] = transform.m;
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    /// Reads a node's local transform, either from its matrix or from its translation / rotation / scale properties.
+    Matrix4x4 ReadNodeTransform(const JsonValue& node, bool& outIsIdentity)
+    {
+        Matrix4x4 transform = Matrix4x4::Identity();
+        outIsIdentity = true;
+
+        const JsonValue* matrix = node.FindMember("matrix");
+        if (matrix != nullptr && matrix->GetElements().size() == 16)
+        {
+            // glTF matrices are stored in column-major order.
+            for (size_t element = 0; element < 16; element++)
+            {
+                transform.m[element % 4][element / 4] = static_cast<float>(matrix->GetElements()[element].GetNumber());
+            }
+        }
+        else
+        {
+            float translation[3] = { 0.0f, 0.0f, 0.0f };
+            float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            float scale[3] = { 1.0f, 1.0f, 1.0f };
+
+            const JsonValue* translationValue = node.FindMember("translation");
+            const JsonValue* rotationValue = node.FindMember("rotation");
+            const JsonValue* scaleValue = node.FindMember("scale");
+            for (size_t component = 0; component < 4; component++)
+            {
+                if (component < 3 && translationValue != nullptr && component < translationValue->GetElements().size())
+                {
+                    translation[component] = static_cast<float>(translationValue->GetElements()[component].GetNumber());
+                }
+                if (rotationValue != nullptr && component < rotationValue->GetElements().size())
+                {
+                    rotation[component] = static_cast<float>(rotationValue->GetElements()[component].GetNumber());
+                }
+                if (component < 3 && scaleValue != nullptr && component < scaleValue->GetElements().size())
+                {
+                    scale[component] = static_cast<float>(scaleValue->GetElements()[component].GetNumber(1.0));
+                }
+            }
+
+            // Rotation is a unit quaternion (x, y, z, w). Matrix is T * R * S.
+            const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+            const float rotationMatrix[3][3] = {
+                { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w) },
+                { 2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w) },
+                { 2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y) } };
+
+            for (int row = 0; row < 3; row++)
+            {
+                for (int column = 0; column < 3; column++)
+                {
+                    transform.m[row][column] = rotationMatrix[row][column] * scale[column];
+                }
+                transform.m[row][3] = translation[row];
+            }
+        }
+
+        const Matrix4x4 identity = Matrix4x4::Identity();
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                outIsIdentity &= transform.m[row][column] == identity.m[row][column];
+            }
+        }
+        return transform;
+    }
+
+    /// Lists every triangle primitive drawn by the default scene (or by every mesh if there are no scenes), with their world transforms.
+    void CollectPrimitiveDraws(const JsonValue& root, std::vector<PrimitiveDraw>& outDraws, size_t& outSkippedPrimitiveCount)
+    {
+        const JsonValue* meshes = root.FindMember("meshes");
+        const JsonValue* nodes = root.FindMember("nodes");
+        const JsonValue* scenes = root.FindMember("scenes");
+        if (meshes == nullptr)
+        {
+            return;
+        }
+
+        auto addMeshDraws = [&](const JsonValue& mesh, const Matrix4x4& worldMatrix, bool bIdentityTransform)
+        {
+            const JsonValue* primitives = mesh.FindMember("primitives");
+            if (primitives == nullptr)
+            {
+                return;
+            }
+
+            for (const JsonValue& primitive : primitives->GetElements())
+            {
+                const JsonValue* attributes = primitive.FindMember("attributes");
+                PrimitiveDraw draw;
+                draw.Mode = static_cast<uint32_t>(GetInteger(primitive, "mode", PRIMITIVE_MODE_TRIANGLES));
+                draw.PositionAccessor = attributes != nullptr ? GetInteger(*attributes, "POSITION", NO_ACCESSOR) : NO_ACCESSOR;
+                if (draw.PositionAccessor == NO_ACCESSOR || draw.Mode < PRIMITIVE_MODE_TRIANGLES || draw.Mode > PRIMITIVE_MODE_TRIANGLE_FAN)
+                {
+                    outSkippedPrimitiveCount++;
+                    continue;
+                }
+
+                draw.NormalAccessor = GetInteger(*attributes, "NORMAL", NO_ACCESSOR);
+                draw.TexCoordAccessor = GetInteger(*attributes, "TEXCOORD_0", NO_ACCESSOR);
+                draw.IndexAccessor = GetInteger(primitive, "indices", NO_ACCESSOR);
+                draw.WorldMatrix = worldMatrix;
+                draw.bIdentityTransform = bIdentityTransform;
+                outDraws.push_back(draw);
+            }
+        };
+
+        const int64_t sceneIndex = GetInteger(root, "scene", 0);
+        const JsonValue* scene = scenes != nullptr ? scenes->FindElement(static_cast<size_t>(sceneIndex)) : nullptr;
+        const JsonValue* rootNodes = scene != nullptr ? scene->FindMember("nodes") : nullptr;
+        if (rootNodes == nullptr || nodes == nullptr)
+        {
+            // No scene to follow: draw every mesh as is.
+            for (const JsonValue& mesh : meshes->GetElements())
+            {
+                addMeshDraws(mesh, Matrix4x4::Identity(), true);
+            }
+            return;
+        }
+
+        struct NodeVisit
+        {
+            size_t NodeIndex;
+            Matrix4x4 ParentMatrix;
+            bool bParentIdentity;
+            size_t Depth;
+        };
+
+        std::vector<NodeVisit> visitStack;
+        for (const JsonValue& rootNode : rootNodes->GetElements())
+        {
+            visitStack.push_back(NodeVisit{ static_cast<size_t>(rootNode.GetNumber(-1.0)), Matrix4x4::Identity(), true, 0 });
+        }
+
+        const size_t nodeCount = nodes->GetElements().size();
+        while (!visitStack.empty())
+        {
+            const NodeVisit visit = visitStack.back();
+            visitStack.pop_back();
+
+            // Node graphs must be trees, so a path longer than the node count means a cycle: ignore it rather than looping forever.
+            const JsonValue* node = nodes->FindElement(visit.NodeIndex);
+            if (node == nullptr || visit.Depth > nodeCount)
+            {
+                continue;
+            }
+
+            bool bLocalIdentity;
+            const Matrix4x4 localMatrix = ReadNodeTransform(*node, bLocalIdentity);
+            const Matrix4x4 worldMatrix = visit.ParentMatrix * localMatrix;
+            const bool bWorldIdentity = visit.bParentIdentity && bLocalIdentity;
+
+            const int64_t meshIndex = GetInteger(*node, "mesh", NO_ACCESSOR);
+            const JsonValue* mesh = meshIndex != NO_ACCESSOR ? meshes->FindElement(static_cast<size_t>(meshIndex)) : nullptr;
+            if (mesh != nullptr)
+            {
+                addMeshDraws(*mesh, worldMatrix, bWorldIdentity);
+            }
+
+            const JsonValue* children = node->FindMember("children");
+            if (children != nullptr)
+            {
+                for (const JsonValue& child : children->GetElements())
+                {
+                    visitStack.push_back(NodeVisit{ static_cast<size_t>(child.GetNumber(-1.0)), worldMatrix, bWorldIdentity, visit.Depth + 1 });
+                }
+            }
+        }
+    }
+
+    /// Converts vector elements of an accessor to floats in parallel, optionally transforming them as points or as normals.
+    template<typename VectorType>
+    void ConvertVectors(const AccessorView& view, VectorType* outVectors, const Matrix4x4* transform, bool bNormals, JobSystem& jobSystem)
+    {
+        const uint32_t componentCount = sizeof(VectorType) / sizeof(float);
+        const size_t batchCount = (view.Count + CONVERSION_BATCH_SIZE - 1) / CONVERSION_BATCH_SIZE;
+        jobSystem.ParallelFor(static_cast<uint32_t>(batchCount), [&](uint32_t batchIndex)
+        {
+            const size_t endElement = std::min(view.Count, (batchIndex + 1) * CONVERSION_BATCH_SIZE);
+            for (size_t elementIndex = batchIndex * CONVERSION_BATCH_SIZE; elementIndex < endElement; elementIndex++)
+            {
+                float components[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                ReadFloatElement(view, elementIndex, components, componentCount);
+
+                if (transform != nullptr)
+                {
+                    const Vector4 transformed = transform->TransformPoint(Vector3{ components[0], components[1], components[2] });
+                    Vector3 result = { transformed.x, transformed.y, transformed.z };
+                    if (bNormals)
+                    {
+                        // Normal matrices hold no translation, so the translation column being 0 makes TransformPoint a plain 3x3 product.
+                        const float length = Length(result);
+                        result = length > 0.0f ? result * (1.0f / length) : result;
+                    }
+                    components[0] = result.x;
+                    components[1] = result.y;
+                    components[2] = result.z;
+                }
+
+                memcpy(&outVectors[elementIndex], components, sizeof(VectorType));
+            }
+        });
+    }
+
+    /// Builds the triangle list indices of a primitive, offset by the index of its first vertex in the merged mesh.
+    /// @return The amount of indices that referenced a vertex outside of the primitive.
+    size_t AppendTriangleIndices(const AccessorView* indexView, size_t primitiveVertexCount, uint32_t mode, uint32_t baseVertex,
+        bool bFlipWinding, std::vector<uint32_t>& outIndices, JobSystem& jobSystem)
+    {
+        const size_t sourceCount = indexView != nullptr ? indexView->Count : primitiveVertexCount;
+        auto readSourceIndex = [&](size_t sourceIndex) -> uint32_t
+        {
+            if (indexView == nullptr)
+            {
+                return static_cast<uint32_t>(sourceIndex);
+            }
+            return indexView->Data != nullptr ? ReadIndex(indexView->Data + sourceIndex * indexView->Stride, indexView->ComponentType) : 0;
+        };
+
+        size_t triangleCount;
+        switch (mode)
+        {
+            case PRIMITIVE_MODE_TRIANGLES:
+                triangleCount = sourceCount / 3;
+                break;
+            default:
+                triangleCount = sourceCount >= 3 ? sourceCount - 2 : 0;
+                break;
+        }
+
+        const size_t firstIndex = outIndices.size();
+        outIndices.resize(firstIndex + triangleCount * 3);
+        uint32_t* triangleIndices = outIndices.data() + firstIndex;
+
+        std::atomic<size_t> invalidIndexCount(0);
+        const size_t batchCount = (triangleCount + CONVERSION_BATCH_SIZE - 1) / CONVERSION_BATCH_SIZE;
+        jobSystem.ParallelFor(static_cast<uint32_t>(batchCount), [&](uint32_t batchIndex)
+        {
+            size_t batchInvalidIndexCount = 0;
+            const size_t endTriangle = std::min(triangleCount, (batchIndex + 1) * CONVERSION_BATCH_SIZE);
+            for (size_t triangle = batchIndex * CONVERSION_BATCH_SIZE; triangle < endTriangle; triangle++)
+            {
+                uint32_t corners[3];
+                switch (mode)
+                {
+                    case PRIMITIVE_MODE_TRIANGLES:
+                        corners[0] = readSourceIndex(triangle * 3 + 0);
+                        corners[1] = readSourceIndex(triangle * 3 + 1);
+                        corners[2] = readSourceIndex(triangle * 3 + 2);
+                        break;
+                    case PRIMITIVE_MODE_TRIANGLE_STRIP:
+                        // Every other strip triangle has its first two corners swapped to keep a consistent winding.
+                        corners[0] = readSourceIndex(triangle);
+                        corners[1] = readSourceIndex(triangle + 1 + triangle % 2);
+                        corners[2] = readSourceIndex(triangle + 2 - triangle % 2);
+                        break;
+                    default:
+                        corners[0] = readSourceIndex(triangle + 1);
+                        corners[1] = readSourceIndex(triangle + 2);
+                        corners[2] = readSourceIndex(0);
+                        break;
+                }
+
+                if (bFlipWinding)
+                {
+                    std::swap(corners[1], corners[2]);
+                }
+
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    if (corners[corner] >= primitiveVertexCount)
+                    {
+                        batchInvalidIndexCount++;
+                        corners[corner] = 0;
+                    }
+                    triangleIndices[triangle * 3 + corner] = corners[corner] + baseVertex;
+                }
+            }
+            invalidIndexCount += batchInvalidIndexCount;
+        });
+
+        return invalidIndexCount.load();
+    }
+
+    /// Checks in parallel that every index of a triangle list references an existing vertex.
+    bool ValidateIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, JobSystem& jobSystem)
+    {
+        std::atomic<bool> bValid(true);
+        const size_t batchCount = (indexCount + CONVERSION_BATCH_SIZE - 1) / CONVERSION_BATCH_SIZE;
+        jobSystem.ParallelFor(static_cast<uint32_t>(batchCount), [&](uint32_t batchIndex)
+        {
+            uint32_t maxIndex = 0;
+            const size_t endIndex = std::min(indexCount, (batchIndex + 1) * CONVERSION_BATCH_SIZE);
+            for (size_t index = batchIndex * CONVERSION_BATCH_SIZE; index < endIndex; index++)
+            {
+                maxIndex = std::max(maxIndex, indices[index]);
+            }
+            if (endIndex > batchIndex * CONVERSION_BATCH_SIZE && maxIndex >= vertexCount)
+            {
+                bValid = false;
+            }
+        });
+        return bValid;
+    }
+
+    /// Reads an accessor's min / max properties as a bounding box.
+    bool ReadAccessorBounds(const AccessorView& view, BoundingBox& outBounds)
+    {
+        if (view.Min == nullptr || view.Max == nullptr || view.Min->GetElements().size() < 3 || view.Max->GetElements().size() < 3)
+        {
+            return false;
+        }
+
+        outBounds.Min = Vector3{ static_cast<float>(view.Min->GetElements()[0].GetNumber()), static_cast<float>(view.Min->GetElements()[1].GetNumber()),
+                                 static_cast<float>(view.Min->GetElements()[2].GetNumber()) };
+        outBounds.Max = Vector3{ static_cast<float>(view.Max->GetElements()[0].GetNumber()), static_cast<float>(view.Max->GetElements()[1].GetNumber()),
+                                 static_cast<float>(view.Max->GetElements()[2].GetNumber()) };
+        return !outBounds.IsEmpty();
+    }
+}
+
+bool GltfLoader::LoadMesh(const uint8_t* data, size_t size, std::shared_ptr<const void> dataOwner, JobSystem& jobSystem, Mesh& outMesh,
+    LoadStatistics& outStatistics, std::string& outError)
+{
+    outStatistics = LoadStatistics{};
+    outMesh = Mesh{};
+
+    // HEADER & CHUNKS: 12 byte header, then chunks made of an 8 byte header (length, type) followed by 4 byte aligned data.
+    if (size < 20 || ReadUint32(data) != GLB_MAGIC)
+    {
+        outError = "Not a binary glTF file.";
+        return false;
+    }
+
+    if (ReadUint32(data + 4) != GLB_VERSION)
+    {
+        outError = "Unsupported glTF version " + std::to_string(ReadUint32(data + 4)) + ", only version 2 is supported.";
+        return false;
+    }
+
+    const size_t fileLength = std::min<size_t>(ReadUint32(data + 8), size);
+    GltfDocument document;
+    const uint8_t* jsonData = nullptr;
+    size_t jsonSize = 0;
+
+    size_t chunkOffset = 12;
+    while (chunkOffset + 8 <= fileLength)
+    {
+        const size_t chunkLength = ReadUint32(data + chunkOffset);
+        const uint32_t chunkType = ReadUint32(data + chunkOffset + 4);
+        if (chunkLength > fileLength - chunkOffset - 8)
+        {
+            outError = "Truncated GLB chunk.";
+            return false;
+        }
+
+        const uint8_t* chunkData = data + chunkOffset + 8;
+        if (chunkType == GLB_CHUNK_TYPE_JSON && jsonData == nullptr)
+        {
+            jsonData = chunkData;
+            jsonSize = chunkLength;
+        }
+        else if (chunkType == GLB_CHUNK_TYPE_BIN && document.BinData == nullptr)
+        {
+            document.BinData = chunkData;
+            document.BinSize = chunkLength;
+        }
+
+        chunkOffset += 8 + ((chunkLength + 3) & ~static_cast<size_t>(3));
+    }
+
+    if (jsonData == nullptr)
+    {
+        outError = "GLB file has no JSON chunk.";
+        return false;
+    }
+
+    if (!JsonValue::Parse(reinterpret_cast<const char*>(jsonData), jsonSize, document.Root, outError))
+    {
+        return false;
+    }
+
+    // SCENE: list triangle primitives to draw.
+    std::vector<PrimitiveDraw> draws;
+    CollectPrimitiveDraws(document.Root, draws, outStatistics.SkippedPrimitiveCount);
+    if (draws.empty())
+    {
+        outError = "File contains no triangle geometry.";
+        return false;
+    }
+
+    // Vertex data can be used in place when every draw uses the same vertices untransformed, which is always true for a single primitive
+    // without node transform. Attributes that appear only on some primitives are left out.
+    bool bSharedVertices = true;
+    bool bHasNormals = true;
+    bool bHasTexCoords = true;
+    for (const PrimitiveDraw& draw : draws)
+    {
+        bSharedVertices &= draw.bIdentityTransform && draw.PositionAccessor == draws[0].PositionAccessor
+            && draw.NormalAccessor == draws[0].NormalAccessor && draw.TexCoordAccessor == draws[0].TexCoordAccessor;
+        bHasNormals &= draw.NormalAccessor != NO_ACCESSOR;
+        bHasTexCoords &= draw.TexCoordAccessor != NO_ACCESSOR;
+    }
+
+    std::vector<AccessorView> positionViews(draws.size()), normalViews(draws.size()), texCoordViews(draws.size()), indexViews(draws.size());
+    size_t totalVertexCount = 0;
+    for (size_t drawIndex = 0; drawIndex < draws.size(); drawIndex++)
+    {
+        const PrimitiveDraw& draw = draws[drawIndex];
+        if (!ResolveAccessor(document, draw.PositionAccessor, positionViews[drawIndex], outError)
+            || (bHasNormals && !ResolveAccessor(document, draw.NormalAccessor, normalViews[drawIndex], outError))
+            || (bHasTexCoords && !ResolveAccessor(document, draw.TexCoordAccessor, texCoordViews[drawIndex], outError))
+            || (draw.IndexAccessor != NO_ACCESSOR && !ResolveAccessor(document, draw.IndexAccessor, indexViews[drawIndex], outError)))
+        {
+            return false;
+        }
+
+        const size_t vertexCount = positionViews[drawIndex].Count;
+        if ((bHasNormals && normalViews[drawIndex].Count != vertexCount) || (bHasTexCoords && texCoordViews[drawIndex].Count != vertexCount))
+        {
+            outError = "Vertex attributes of a primitive have different element counts.";
+            return false;
+        }
+
+        if (draw.IndexAccessor != NO_ACCESSOR && (indexViews[drawIndex].ComponentCount != 1 || indexViews[drawIndex].ComponentType == COMPONENT_TYPE_FLOAT
+            || indexViews[drawIndex].ComponentType == COMPONENT_TYPE_BYTE || indexViews[drawIndex].ComponentType == COMPONENT_TYPE_SHORT))
+        {
+            outError = "Index accessor " + std::to_string(draw.IndexAccessor) + " is not made of unsigned integers.";
+            return false;
+        }
+
+        if (!bSharedVertices || drawIndex == 0)
+        {
+            totalVertexCount += vertexCount;
+        }
+    }
+
+    if (totalVertexCount > UINT32_MAX)
+    {
+        outError = "Scene has too many vertices to be indexed with 32 bit indices.";
+        return false;
+    }
+
+    // VERTICES: reference tightly packed float data in place, convert anything else.
+    if (bSharedVertices)
+    {
+        const AccessorView& positionView = positionViews[0];
+        if (positionView.IsTightFloatArray(3))
+        {
+            outMesh.Positions.Reference(reinterpret_cast<const Vector3*>(positionView.Data), positionView.Count, dataOwner);
+            outStatistics.ReferencedByteCount += outMesh.Positions.GetSizeInBytes();
+        }
+        else
+        {
+            ConvertVectors(positionView, outMesh.Positions.Allocate(positionView.Count), nullptr, false, jobSystem);
+            outStatistics.ConvertedByteCount += outMesh.Positions.GetSizeInBytes();
+        }
+
+        if (bHasNormals && normalViews[0].IsTightFloatArray(3))
+        {
+            outMesh.Normals.Reference(reinterpret_cast<const Vector3*>(normalViews[0].Data), normalViews[0].Count, dataOwner);
+            outStatistics.ReferencedByteCount += outMesh.Normals.GetSizeInBytes();
+        }
+        else if (bHasNormals)
+        {
+            ConvertVectors(normalViews[0], outMesh.Normals.Allocate(normalViews[0].Count), nullptr, true, jobSystem);
+            outStatistics.ConvertedByteCount += outMesh.Normals.GetSizeInBytes();
+        }
+
+        if (bHasTexCoords && texCoordViews[0].IsTightFloatArray(2))
+        {
+            outMesh.TexCoords.Reference(reinterpret_cast<const Vector2*>(texCoordViews[0].Data), texCoordViews[0].Count, dataOwner);
+            outStatistics.ReferencedByteCount += outMesh.TexCoords.GetSizeInBytes();
+        }
+        else if (bHasTexCoords)
+        {
+            ConvertVectors(texCoordViews[0], outMesh.TexCoords.Allocate(texCoordViews[0].Count), nullptr, false, jobSystem);
+            outStatistics.ConvertedByteCount += outMesh.TexCoords.GetSizeInBytes();
+        }
+
+        // Glide through the data once to get bounds, unless the file already gives them.
+        if (!ReadAccessorBounds(positionView, outMesh.Bounds))
+        {
+            outMesh.ComputeBounds();
+        }
+    }
+    else
+    {
+        Vector3* positions = outMesh.Positions.Allocate(totalVertexCount);
+        Vector3* normals = bHasNormals ? outMesh.Normals.Allocate(totalVertexCount) : nullptr;
+        Vector2* texCoords = bHasTexCoords ? outMesh.TexCoords.Allocate(totalVertexCount) : nullptr;
+
+        size_t baseVertex = 0;
+        for (size_t drawIndex = 0; drawIndex < draws.size(); drawIndex++)
+        {
+            const PrimitiveDraw& draw = draws[drawIndex];
+            const Matrix4x4* transform = draw.bIdentityTransform ? nullptr : &draw.WorldMatrix;
+            ConvertVectors(positionViews[drawIndex], positions + baseVertex, transform, false, jobSystem);
+            if (bHasNormals)
+            {
+                const Matrix4x4 normalMatrix = ComputeNormalMatrix(draw.WorldMatrix);
+                ConvertVectors(normalViews[drawIndex], normals + baseVertex, draw.bIdentityTransform ? nullptr : &normalMatrix, true, jobSystem);
+            }
+            if (bHasTexCoords)
+            {
+                ConvertVectors(texCoordViews[drawIndex], texCoords + baseVertex, nullptr, false, jobSystem);
+            }
+            baseVertex += positionViews[drawIndex].Count;
+        }
+
+        outStatistics.ConvertedByteCount += outMesh.Positions.GetSizeInBytes() + outMesh.Normals.GetSizeInBytes() + outMesh.TexCoords.GetSizeInBytes();
+        outMesh.ComputeBounds();
+    }
+
+    // INDICES: a single triangle list of 32 bit indices is referenced in place, anything else gets triangulated & merged.
+    const AccessorView& firstIndexView = indexViews[0];
+    if (bSharedVertices && draws.size() == 1 && draws[0].Mode == PRIMITIVE_MODE_TRIANGLES && draws[0].IndexAccessor != NO_ACCESSOR
+        && firstIndexView.Data != nullptr && firstIndexView.ComponentType == COMPONENT_TYPE_UNSIGNED_INT && firstIndexView.Stride == sizeof(uint32_t)
+        && reinterpret_cast<uintptr_t>(firstIndexView.Data) % alignof(uint32_t) == 0)
+    {
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(firstIndexView.Data);
+        const size_t indexCount = firstIndexView.Count - firstIndexView.Count % 3;
+        if (!ValidateIndices(indices, indexCount, outMesh.GetVertexCount(), jobSystem))
+        {
+            outError = "Indices reference vertices that don't exist.";
+            return false;
+        }
+
+        outMesh.Indices.Reference(indices, indexCount, dataOwner);
+        outStatistics.ReferencedByteCount += outMesh.Indices.GetSizeInBytes();
+    }
+    else
+    {
+        std::vector<uint32_t> indices;
+        size_t invalidIndexCount = 0;
+        size_t baseVertex = 0;
+        for (size_t drawIndex = 0; drawIndex < draws.size(); drawIndex++)
+        {
+            const PrimitiveDraw& draw = draws[drawIndex];
+            // Mirroring transforms turn counter-clockwise triangles clockwise.
+            const bool bFlipWinding = !draw.bIdentityTransform && ComputeDeterminant3x3(draw.WorldMatrix) < 0.0f;
+            invalidIndexCount += AppendTriangleIndices(draw.IndexAccessor != NO_ACCESSOR ? &indexViews[drawIndex] : nullptr,
+                positionViews[drawIndex].Count, draw.Mode, static_cast<uint32_t>(baseVertex), bFlipWinding, indices, jobSystem);
+
+            if (!bSharedVertices)
+            {
+                baseVertex += positionViews[drawIndex].Count;
+            }
+        }
+
+        if (invalidIndexCount > 0)
+        {
+            outError = std::to_string(invalidIndexCount) + " indices reference vertices that don't exist.";
+            return false;
+        }
+
+        outMesh.Indices = std::move(indices);
+        outStatistics.ConvertedByteCount += outMesh.Indices.GetSizeInBytes();
+    }
+
+    if (outMesh.GetTriangleCount() == 0)
+    {
+        outError = "File contains no triangle geometry.";
+        return false;
+    }
+
+    return true;
+}
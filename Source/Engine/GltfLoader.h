@@ -0,0 +1,43 @@
+/*
+    Binary glTF 2.0 (.glb) loader. Only the JSON chunk gets parsed: vertex & index data is referenced in place inside the BIN chunk
+    of the mapped file whenever its layout matches what the renderer consumes, and only converted into new arrays otherwise.
+*/
+
+#ifndef GLTF_LOADER_H
+#define GLTF_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Mesh.h"
+#include "JobSystem.h"
+
+namespace GltfLoader
+{
+    /// @brief How much of the loaded mesh data is referenced in place versus converted into new arrays.
+    struct LoadStatistics
+    {
+        size_t ReferencedByteCount = 0;
+        size_t ConvertedByteCount = 0;
+        // Primitives that are not made of triangles (points, lines) and were left out.
+        size_t SkippedPrimitiveCount = 0;
+    };
+
+    /// @brief Loads the triangle geometry of a .glb file's default scene into one indexed mesh (positions, normals & first texture coordinates).
+    /// Node transforms are applied. Vertex data can only be referenced in place when every drawn primitive shares the same vertex attributes
+    /// under an identity transform, which includes the common case of a single mesh; other scenes get merged into new arrays.
+    /// @param data GLB file contents. Must stay valid for as long as dataOwner lives.
+    /// @param size Size of the contents in bytes.
+    /// @param dataOwner Object keeping the contents alive. The mesh keeps a reference to it when it references data in place.
+    /// @param jobSystem Job system conversions & validation get spread across.
+    /// @param outMesh Mesh to fill.
+    /// @param outStatistics Filled with statistics about referenced & converted data.
+    /// @param outError Filled with a description of the problem when loading fails.
+    /// @return True if the mesh was loaded, false otherwise.
+    bool LoadMesh(const uint8_t* data, size_t size, std::shared_ptr<const void> dataOwner, JobSystem& jobSystem, Mesh& outMesh,
+        LoadStatistics& outStatistics, std::string& outError);
+}
+
+#endif // GLTF_LOADER_H
@@ -0,0 +1,112 @@
+#include "HierarchicalDepthBuffer.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Tests pick the finest level where a rectangle spans at most this many cells along each axis.
+    const int32_t MAX_TESTED_CELLS_PER_AXIS = 4;
+}
+
+void HierarchicalDepthBuffer::Resize(uint16_t width, uint16_t height)
+{
+    m_width = width;
+    m_height = height;
+    for (int32_t levelIndex = 0; levelIndex < LEVEL_COUNT; levelIndex++)
+    {
+        const int32_t cellSize = CELL_SIZE << levelIndex;
+        Level& level = m_levels[levelIndex];
+        level.Width = (width + cellSize - 1) / cellSize;
+        level.Height = (height + cellSize - 1) / cellSize;
+        level.MaxDepths.resize(static_cast<size_t>(level.Width) * level.Height);
+    }
+}
+
+void HierarchicalDepthBuffer::Update(const RenderTarget& target, const RasterRect& rect, const SimdPaths& simdPaths)
+{
+    const int32_t maxX = std::min(rect.MaxX, m_width);
+    const int32_t maxY = std::min(rect.MaxY, m_height);
+    if (rect.MinX >= maxX || rect.MinY >= maxY)
+    {
+        return;
+    }
+
+    // Finest level straight from the depth buffer.
+    Level& finestLevel = m_levels[0];
+    for (int32_t cellY = rect.MinY / CELL_SIZE; cellY * CELL_SIZE < maxY; cellY++)
+    {
+        for (int32_t cellX = rect.MinX / CELL_SIZE; cellX * CELL_SIZE < maxX; cellX++)
+        {
+            const RasterRect cellRect = { cellX * CELL_SIZE, cellY * CELL_SIZE, (cellX + 1) * CELL_SIZE, (cellY + 1) * CELL_SIZE };
+            finestLevel.MaxDepths[cellY * finestLevel.Width + cellX] = Rasterizer::ComputeMaxDepth(target, cellRect, simdPaths);
+        }
+    }
+
+    // Coarser levels from the up to 4 cells they cover in the previous level.
+    for (int32_t levelIndex = 1; levelIndex < LEVEL_COUNT; levelIndex++)
+    {
+        const Level& source = m_levels[levelIndex - 1];
+        Level& level = m_levels[levelIndex];
+        const int32_t cellSize = CELL_SIZE << levelIndex;
+        for (int32_t cellY = rect.MinY / cellSize; cellY * cellSize < maxY; cellY++)
+        {
+            const int32_t sourceY = cellY * 2;
+            const int32_t sourceEndY = std::min(sourceY + 2, source.Height);
+            for (int32_t cellX = rect.MinX / cellSize; cellX * cellSize < maxX; cellX++)
+            {
+                const int32_t sourceX = cellX * 2;
+                const int32_t sourceEndX = std::min(sourceX + 2, source.Width);
+
+                float maxDepth = 0.0f;
+                for (int32_t y = sourceY; y < sourceEndY; y++)
+                {
+                    for (int32_t x = sourceX; x < sourceEndX; x++)
+                    {
+                        maxDepth = std::max(maxDepth, source.MaxDepths[y * source.Width + x]);
+                    }
+                }
+                level.MaxDepths[cellY * level.Width + cellX] = maxDepth;
+            }
+        }
+    }
+}
+
+bool HierarchicalDepthBuffer::IsOccluded(const RasterRect& rect, float nearestDepth) const
+{
+    const int32_t minX = std::max(rect.MinX, 0);
+    const int32_t minY = std::max(rect.MinY, 0);
+    const int32_t maxX = std::min(rect.MaxX, m_width);
+    const int32_t maxY = std::min(rect.MaxY, m_height);
+    if (minX >= maxX || minY >= maxY)
+    {
+        // Nothing of the rectangle is on screen.
+        return true;
+    }
+
+    // Coarser levels test less cells, but are more conservative.
+    int32_t levelIndex = 0;
+    while (levelIndex < LEVEL_COUNT - 1)
+    {
+        const int32_t cellSize = CELL_SIZE << levelIndex;
+        if ((maxX - 1) / cellSize - minX / cellSize < MAX_TESTED_CELLS_PER_AXIS
+            && (maxY - 1) / cellSize - minY / cellSize < MAX_TESTED_CELLS_PER_AXIS)
+        {
+            break;
+        }
+        levelIndex++;
+    }
+
+    const Level& level = m_levels[levelIndex];
+    const int32_t cellSize = CELL_SIZE << levelIndex;
+    for (int32_t cellY = minY / cellSize; cellY <= (maxY - 1) / cellSize; cellY++)
+    {
+        for (int32_t cellX = minX / cellSize; cellX <= (maxX - 1) / cellSize; cellX++)
+        {
+            if (nearestDepth <= level.MaxDepths[cellY * level.Width + cellX])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
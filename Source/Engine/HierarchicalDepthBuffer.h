@@ -0,0 +1,55 @@
+/*
+    Coarse hierarchical depth buffer (Hi-Z) the renderer keeps alongside its full resolution depth buffer. Every level stores the farthest
+    depth over square cells of pixels, cells of each level being twice as wide as those of the previous one, up to a whole screen tile.
+    Screen space bounds of geometry get tested against it before any of their triangles are processed: geometry whose nearest depth lies
+    behind the farthest depth of every cell it covers is hidden, so it can be skipped.
+*/
+
+#ifndef HIERARCHICAL_DEPTH_BUFFER_H
+#define HIERARCHICAL_DEPTH_BUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rasterizer.h"
+
+class HierarchicalDepthBuffer
+{
+public:
+
+    // Size in pixels of the square cells of the finest level.
+    static constexpr int32_t CELL_SIZE = 8;
+    // Amount of levels. Cells of the coarsest level are CELL_SIZE << (LEVEL_COUNT - 1) pixels wide.
+    static constexpr int32_t LEVEL_COUNT = 4;
+    static constexpr int32_t COARSEST_CELL_SIZE = CELL_SIZE << (LEVEL_COUNT - 1);
+
+    /// @brief Resizes the levels to cover a depth buffer of the passed size. Cell contents are left unspecified until updated.
+    void Resize(uint16_t width, uint16_t height);
+
+    /// @brief Updates every level from a rectangle of the depth buffer. The rectangle must start on a coarsest cell boundary and either end on one
+    /// or at the edge of the target, so rectangles updated concurrently never share a cell.
+    /// @param simdPaths SIMD paths the CPU supports, see CpuFeatures::DetectSimdPaths.
+    void Update(const RenderTarget& target, const RasterRect& rect, const SimdPaths& simdPaths);
+
+    /// @brief Tests whether a rectangle of pixels is known to only hold depths closer than a given depth.
+    /// @param rect Rectangle to test, in pixels. Parts outside of the buffer are ignored.
+    /// @param nearestDepth Nearest depth of the geometry covering the rectangle.
+    /// @return True if the geometry is hidden by what the depth buffer held when last updated.
+    bool IsOccluded(const RasterRect& rect, float nearestDepth) const;
+
+private:
+
+    struct Level
+    {
+        // Farthest depth of every cell, row-major.
+        std::vector<float> MaxDepths;
+        int32_t Width = 0;
+        int32_t Height = 0;
+    };
+
+    Level m_levels[LEVEL_COUNT];
+    int32_t m_width = 0;
+    int32_t m_height = 0;
+};
+
+#endif // HIERARCHICAL_DEPTH_BUFFER_H
@@ -0,0 +1,92 @@
+#include "InputEventQueue.h"
+
+InputEvent InputEvent::MakeKey(InputEventType type, InputKey key)
+{
+    InputEvent event;
+    event.Type = type;
+    event.Key = key;
+    return event;
+}
+
+InputEvent InputEvent::MakeMouseButton(InputEventType type, InputMouseButton button, int32_t cursorX, int32_t cursorY)
+{
+    InputEvent event;
+    event.Type = type;
+    event.Button = button;
+    event.CursorX = cursorX;
+    event.CursorY = cursorY;
+    return event;
+}
+
+InputEvent InputEvent::MakeMouseMove(int32_t cursorX, int32_t cursorY, float deltaX, float deltaY)
+{
+    InputEvent event;
+    event.Type = InputEventType::MOUSE_MOVE;
+    event.CursorX = cursorX;
+    event.CursorY = cursorY;
+    event.DeltaX = deltaX;
+    event.DeltaY = deltaY;
+    return event;
+}
+
+InputEvent InputEvent::MakeMouseWheel(int32_t cursorX, int32_t cursorY, float notches)
+{
+    InputEvent event;
+    event.Type = InputEventType::MOUSE_WHEEL;
+    event.CursorX = cursorX;
+    event.CursorY = cursorY;
+    event.DeltaY = notches;
+    return event;
+}
+
+InputEvent InputEvent::MakeFocusLost()
+{
+    InputEvent event;
+    event.Type = InputEventType::FOCUS_LOST;
+    return event;
+}
+
+InputEventQueue::InputEventQueue() : m_droppedEventCount(0), m_pushPosition(0), m_bLastEventMergeable(false), m_popPosition(0)
+{
+    for (Slot& slot : m_slots)
+    {
+        slot.State.store(SLOT_FREE, std::memory_order_relaxed);
+    }
+}
+
+bool InputEventQueue::Push(const InputEvent& event)
+{
+    const bool bMotion = event.Type == InputEventType::MOUSE_MOVE || event.Type == InputEventType::MOUSE_WHEEL;
+
+    // Merge motion into the last event if it is motion of the same kind the consumer didn't take yet. Taking the slot back from the published
+    // state keeps the consumer off it while it gets modified, and fails if the consumer got to it first.
+    if (bMotion && m_bLastEventMergeable)
+    {
+        Slot& lastSlot = m_slots[(m_pushPosition - 1) % CAPACITY];
+        uint8_t slotState = SLOT_PUBLISHED;
+        if (lastSlot.Event.Type == event.Type && lastSlot.State.compare_exchange_strong(slotState, SLOT_MERGING, std::memory_order_acquire))
+        {
+            lastSlot.Event.CursorX = event.CursorX;
+            lastSlot.Event.CursorY = event.CursorY;
+            lastSlot.Event.DeltaX += event.DeltaX;
+            lastSlot.Event.DeltaY += event.DeltaY;
+            lastSlot.State.store(SLOT_PUBLISHED, std::memory_order_release);
+            return true;
+        }
+    }
+
+    // The consumer frees slots in order, so the next slot still being in use means the queue is full.
+    Slot& slot = m_slots[m_pushPosition % CAPACITY];
+    if (slot.State.load(std::memory_order_acquire) != SLOT_FREE)
+    {
+        m_droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+        m_bLastEventMergeable = false;
+        return false;
+    }
+
+    slot.Event = event;
+    slot.State.store(SLOT_PUBLISHED, std::memory_order_release);
+    m_pushPosition++;
+    m_bLastEventMergeable = bMotion;
+    return true;
+}
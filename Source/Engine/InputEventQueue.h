@@ -0,0 +1,142 @@
+/*
+    Input events platforms pass to the Engine, and the single-producer / single-consumer queue carrying them from the platform thread
+    receiving them to the thread running Engine updates, which drains it at the start of each update.
+    Events live in a fixed ring of slots, each carrying its own state, so neither side ever locks nor allocates: the producer publishes a
+    slot once written, the consumer frees it once read. A mouse move or wheel turn coming in while the previous event is a move or turn still
+    waiting in the queue gets merged into it, so however slow updates get, the Engine catches up with the cursor in a single event instead
+    of replaying every position it went through.
+*/
+
+#ifndef INPUT_EVENT_QUEUE_H
+#define INPUT_EVENT_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+
+enum class InputEventType : uint8_t
+{
+    KEY_DOWN,
+    KEY_UP,
+    MOUSE_BUTTON_DOWN,
+    MOUSE_BUTTON_UP,
+    MOUSE_MOVE,
+    MOUSE_WHEEL,
+    FOCUS_LOST // The platform stopped receiving input: keys & buttons held so far won't get released events.
+};
+
+/// @brief Keys the Engine reacts to. Platforms map their own key codes to these, leaving out every other key.
+enum class InputKey : uint8_t
+{
+    ORBIT_LEFT,
+    ORBIT_RIGHT,
+    ORBIT_UP,
+    ORBIT_DOWN,
+    ZOOM_IN,
+    ZOOM_OUT,
+    RESET_VIEW,
+
+    COUNT
+};
+
+enum class InputMouseButton : uint8_t
+{
+    LEFT,
+    RIGHT,
+    MIDDLE,
+
+    COUNT
+};
+
+/// @brief Input event, as pushed by the platform.
+struct InputEvent
+{
+    InputEventType Type = InputEventType::FOCUS_LOST;
+    // Key of KEY_ events, button of MOUSE_BUTTON_ events.
+    InputKey Key = InputKey::COUNT;
+    InputMouseButton Button = InputMouseButton::COUNT;
+    // Cursor position in display pixels from the top left corner when the event happened. Not set for key & focus events.
+    int32_t CursorX = 0;
+    int32_t CursorY = 0;
+    // Cursor motion in pixels of MOUSE_MOVE events, or wheel notches of MOUSE_WHEEL events (DeltaY positive when turned away from the user).
+    float DeltaX = 0.0f;
+    float DeltaY = 0.0f;
+
+    static InputEvent MakeKey(InputEventType type, InputKey key);
+    static InputEvent MakeMouseButton(InputEventType type, InputMouseButton button, int32_t cursorX, int32_t cursorY);
+    static InputEvent MakeMouseMove(int32_t cursorX, int32_t cursorY, float deltaX, float deltaY);
+    static InputEvent MakeMouseWheel(int32_t cursorX, int32_t cursorY, float notches);
+    static InputEvent MakeFocusLost();
+};
+
+class InputEventQueue
+{
+public:
+
+    // Amount of events the queue holds. Motion merging keeps it from filling up in practice, extra events get dropped if it does.
+    static constexpr uint32_t CAPACITY = 256;
+
+    InputEventQueue();
+
+    InputEventQueue(const InputEventQueue&) = delete;
+    InputEventQueue& operator=(const InputEventQueue&) = delete;
+
+    /// @brief Queues an event, or merges it into the last queued one if both are motion of the same kind (see top of file). Must only be
+    /// called from a single thread at a time.
+    /// @return Whether the event was queued or merged, false if the queue was full.
+    bool Push(const InputEvent& event);
+
+    /// @brief Pops every queued event in order, handing each of them to a consumer function. Must only be called from a single thread at a time.
+    /// An event the producer is merging motion into right then, and every event after it, get left for the next call.
+    /// @param consumer Function called as consumer(event) for every event.
+    /// @return Amount of popped events.
+    template<typename Consumer>
+    uint32_t Drain(Consumer&& consumer)
+    {
+        uint32_t eventCount = 0;
+        while (eventCount < CAPACITY)
+        {
+            Slot& slot = m_slots[m_popPosition % CAPACITY];
+            uint8_t slotState = SLOT_PUBLISHED;
+            if (!slot.State.compare_exchange_strong(slotState, SLOT_READING, std::memory_order_acquire))
+            {
+                break;
+            }
+
+            const InputEvent event = slot.Event;
+            slot.State.store(SLOT_FREE, std::memory_order_release);
+            m_popPosition++;
+            eventCount++;
+            consumer(event);
+        }
+        return eventCount;
+    }
+
+    /// @brief Returns the amount of events dropped since the previous call, and resets it.
+    uint64_t TakeDroppedEventCount() { return m_droppedEventCount.exchange(0, std::memory_order_relaxed); }
+
+private:
+
+    // Slot states. Only the producer moves slots from free to published and in & out of merging, only the consumer in & out of reading.
+    static constexpr uint8_t SLOT_FREE = 0;
+    static constexpr uint8_t SLOT_PUBLISHED = 1;
+    static constexpr uint8_t SLOT_MERGING = 2;
+    static constexpr uint8_t SLOT_READING = 3;
+
+    struct Slot
+    {
+        std::atomic<uint8_t> State;
+        InputEvent Event;
+    };
+
+    Slot m_slots[CAPACITY];
+    std::atomic<uint64_t> m_droppedEventCount;
+
+    // Producer-only state: position of the next event, and whether the last queued event is motion further motion can be merged into.
+    alignas(64) uint64_t m_pushPosition;
+    bool m_bLastEventMergeable;
+
+    // Consumer-only state.
+    alignas(64) uint64_t m_popPosition;
+};
+
+#endif // INPUT_EVENT_QUEUE_H
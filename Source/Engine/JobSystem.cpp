@@ -0,0 +1,193 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+void JobSystem::Initialize(uint32_t workerThreadCount)
+{
+    Shutdown();
+
+    m_bShuttingDown = false;
+    m_queuedJobCount = 0;
+
+    m_queues.clear();
+    for (uint32_t queueIndex = 0; queueIndex < workerThreadCount + 1; queueIndex++)
+    {
+        m_queues.emplace_back(std::make_unique<JobQueue>());
+        m_queues.back()->Ring.resize(256);
+    }
+
+    // Workers record profiling zones with the profiler of the thread spawning them, if any.
+    Profiler* profiler = Profiler::GetCurrentThreadProfiler();
+    for (uint32_t workerIndex = 0; workerIndex < workerThreadCount; workerIndex++)
+    {
+        m_workerThreads.emplace_back(&JobSystem::WorkerThreadMainFunc, this, workerIndex + 1, profiler);
+    }
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_WorkAvailable);
+        m_bShuttingDown = true;
+    }
+    m_workAvailableCondition.notify_all();
+
+    for (std::thread& workerThread : m_workerThreads)
+    {
+        workerThread.join();
+    }
+    m_workerThreads.clear();
+}
+
+void JobSystem::RunJobs(JobFunction function, void* context, uint32_t jobCount)
+{
+    if (jobCount == 0)
+    {
+        return;
+    }
+
+    // Without workers (or queues, if never initialized) there's no one to share with: run the batch inline.
+    if (m_workerThreads.empty() || jobCount == 1)
+    {
+        for (uint32_t jobIndex = 0; jobIndex < jobCount; jobIndex++)
+        {
+            function(context, jobIndex);
+        }
+        return;
+    }
+
+    std::atomic<uint32_t> remainingJobCount(jobCount);
+
+    // Deal jobs round-robin across every queue so workers start on their own queue rather than all stealing from the same one.
+    const size_t queueCount = m_queues.size();
+    const size_t firstQueueIndex = m_submitCursor.fetch_add(1, std::memory_order_relaxed) % queueCount;
+    for (uint32_t jobIndex = 0; jobIndex < jobCount; jobIndex++)
+    {
+        PushJob(*m_queues[(firstQueueIndex + jobIndex) % queueCount], Job{function, context, jobIndex, &remainingJobCount});
+    }
+
+    {
+        // Locking makes sure no worker is between checking the queued job count and starting to wait, which would miss the notification.
+        std::lock_guard<std::mutex> lock(m_mutex_WorkAvailable);
+    }
+    m_workAvailableCondition.notify_all();
+
+    // Help until the whole batch is done. Jobs from other batches may get executed here too, which is fine as they never block on us.
+    Job job;
+    while (remainingJobCount.load(std::memory_order_acquire) > 0)
+    {
+        if (TryAcquireJob(0, job))
+        {
+            ExecuteJob(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::PushJob(JobQueue& queue, const Job& job)
+{
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+
+    if (queue.Count == queue.Ring.size())
+    {
+        // Full: grow the ring, unrolling it so the front sits at index 0.
+        std::vector<Job> grownRing(queue.Ring.size() * 2);
+        for (size_t jobOffset = 0; jobOffset < queue.Count; jobOffset++)
+        {
+            grownRing[jobOffset] = queue.Ring[(queue.Head + jobOffset) % queue.Ring.size()];
+        }
+        queue.Ring.swap(grownRing);
+        queue.Head = 0;
+    }
+
+    queue.Ring[(queue.Head + queue.Count) % queue.Ring.size()] = job;
+    queue.Count++;
+    m_queuedJobCount.fetch_add(1, std::memory_order_release);
+}
+
+bool JobSystem::TryPopJob(JobQueue& queue, Job& outJob)
+{
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (queue.Count == 0)
+    {
+        return false;
+    }
+
+    queue.Count--;
+    outJob = queue.Ring[(queue.Head + queue.Count) % queue.Ring.size()];
+    m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::TryStealJob(JobQueue& queue, Job& outJob)
+{
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (queue.Count == 0)
+    {
+        return false;
+    }
+
+    outJob = queue.Ring[queue.Head];
+    queue.Head = (queue.Head + 1) % queue.Ring.size();
+    queue.Count--;
+    m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::TryAcquireJob(size_t preferredQueueIndex, Job& outJob)
+{
+    if (m_queuedJobCount.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    if (TryPopJob(*m_queues[preferredQueueIndex], outJob))
+    {
+        return true;
+    }
+
+    const size_t queueCount = m_queues.size();
+    for (size_t queueOffset = 1; queueOffset < queueCount; queueOffset++)
+    {
+        if (TryStealJob(*m_queues[(preferredQueueIndex + queueOffset) % queueCount], outJob))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::ExecuteJob(const Job& job)
+{
+    job.Function(job.Context, job.Index);
+    job.RemainingJobCount->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::WorkerThreadMainFunc(size_t queueIndex, Profiler* profiler)
+{
+    if (profiler != nullptr)
+    {
+        profiler->RegisterCurrentThread("Job Worker " + std::to_string(queueIndex));
+    }
+
+    Job job;
+    while (true)
+    {
+        if (TryAcquireJob(queueIndex, job))
+        {
+            ExecuteJob(job);
+            continue;
+        }
+
+        // Nothing to do: sleep until jobs get submitted or the pool shuts down.
+        std::unique_lock<std::mutex> lock(m_mutex_WorkAvailable);
+        m_workAvailableCondition.wait(lock, [this]() { return m_bShuttingDown || m_queuedJobCount.load(std::memory_order_acquire) > 0; });
+        if (m_bShuttingDown)
+        {
+            return;
+        }
+    }
+}
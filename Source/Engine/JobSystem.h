@@ -0,0 +1,107 @@
+/*
+    Engine-owned work-stealing thread pool, used to spread heavy work (rendering, loading...) across every core.
+*/
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Profiler;
+
+/// @brief Pool of worker threads executing jobs. Each worker owns a job queue it consumes from the back, and steals from the front of other
+/// queues once its own is empty, so work balances itself when jobs have uneven costs.
+/// Jobs are submitted in batches through RunJobs / ParallelFor, which only return once the whole batch is done. The submitting thread
+/// executes jobs too while it waits, so a pool without any worker thread simply runs everything on the calling thread.
+class JobSystem
+{
+public:
+
+    /// @brief Signature of job functions: context pointer passed at submission and index of the job within its batch.
+    typedef void (*JobFunction)(void* context, uint32_t jobIndex);
+
+    JobSystem() : m_queuedJobCount(0), m_bShuttingDown(false), m_submitCursor(0)
+    {}
+
+    ~JobSystem() { Shutdown(); }
+
+    /// @brief Spawns worker threads. Any previously running worker is shut down first.
+    /// @param workerThreadCount Amount of worker threads to spawn, on top of whichever threads submit jobs. Can be 0.
+    void Initialize(uint32_t workerThreadCount);
+
+    /// @brief Waits for worker threads to finish their current job and joins them. Must not be called while a batch is running.
+    void Shutdown();
+
+    uint32_t GetWorkerThreadCount() const { return static_cast<uint32_t>(m_workerThreads.size()); }
+
+    /// @brief Runs function(context, i) for every i in [0, jobCount) across worker threads & the calling thread, and returns once all
+    /// of them have completed. Can be called from within a job.
+    void RunJobs(JobFunction function, void* context, uint32_t jobCount);
+
+    /// @brief Convenience wrapper around RunJobs calling functor(jobIndex) for every job index.
+    template<typename Functor>
+    void ParallelFor(uint32_t jobCount, const Functor& functor)
+    {
+        RunJobs([](void* context, uint32_t jobIndex) { (*static_cast<const Functor*>(context))(jobIndex); },
+            const_cast<Functor*>(&functor), jobCount);
+    }
+
+private:
+
+    struct Job
+    {
+        JobFunction Function;
+        void* Context;
+        uint32_t Index;
+        // Counter of jobs left to complete in the batch this job belongs to.
+        std::atomic<uint32_t>* RemainingJobCount;
+    };
+
+    /// @brief Double-ended job queue stored as a growable ring buffer, so steady state use never allocates.
+    struct JobQueue
+    {
+        std::mutex Mutex;
+        std::vector<Job> Ring;
+        size_t Head = 0; // Index of the front (oldest) job.
+        size_t Count = 0;
+    };
+
+    void PushJob(JobQueue& queue, const Job& job);
+
+    /// @brief Pops the most recently pushed job of a queue (owner side).
+    bool TryPopJob(JobQueue& queue, Job& outJob);
+
+    /// @brief Pops the oldest job of a queue (thief side).
+    bool TryStealJob(JobQueue& queue, Job& outJob);
+
+    /// @brief Tries to get a job from the preferred queue, then from every other queue in turn.
+    bool TryAcquireJob(size_t preferredQueueIndex, Job& outJob);
+
+    void ExecuteJob(const Job& job);
+
+    /// @param profiler Profiler to register the worker thread to, or null.
+    void WorkerThreadMainFunc(size_t queueIndex, Profiler* profiler);
+
+    std::vector<std::thread> m_workerThreads;
+
+    // Queue 0 is filled by submitting threads, queue i + 1 is owned by worker thread i.
+    std::vector<std::unique_ptr<JobQueue>> m_queues;
+
+    // Total amount of jobs sitting in queues, used by idle workers to know when to wake up.
+    std::atomic<uint32_t> m_queuedJobCount;
+    std::atomic<bool> m_bShuttingDown;
+
+    // Queue index at which the next submitted batch starts being distributed, so batches of one job don't all land on the same worker.
+    std::atomic<uint32_t> m_submitCursor;
+
+    std::mutex m_mutex_WorkAvailable;
+    std::condition_variable m_workAvailableCondition;
+};
+
+#endif // JOB_SYSTEM_H
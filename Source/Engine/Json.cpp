@@ -0,0 +1,422 @@
+#include "Json.h"
+#include "TextParsing.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/// @brief Recursive descent parser filling JsonValue trees.
+class JsonParser
+{
+public:
+
+    JsonParser(const char* text, size_t length) : m_cursor(text), m_begin(text), m_end(text + length)
+    {}
+
+    bool ParseDocument(JsonValue& outValue, std::string& outError)
+    {
+        bool bParsed = ParseValue(outValue, 0);
+        if (bParsed)
+        {
+            SkipWhitespace();
+            if (m_cursor < m_end)
+            {
+                bParsed = Fail("unexpected characters after document end");
+            }
+        }
+
+        if (!bParsed)
+        {
+            outError = "JSON error at byte " + std::to_string(m_cursor - m_begin) + ": " + m_error + ".";
+        }
+        return bParsed;
+    }
+
+private:
+
+    // Deepest nesting of arrays & objects accepted, so malicious documents can't overflow the stack.
+    static constexpr uint32_t MAX_DEPTH = 256;
+
+    bool Fail(const char* error)
+    {
+        m_error = error;
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\n' || *m_cursor == '\r'))
+        {
+            m_cursor++;
+        }
+    }
+
+    bool ParseValue(JsonValue& outValue, uint32_t depth)
+    {
+        if (depth > MAX_DEPTH)
+        {
+            return Fail("document is nested too deeply");
+        }
+
+        SkipWhitespace();
+        if (m_cursor >= m_end)
+        {
+            return Fail("unexpected end of document");
+        }
+
+        switch (*m_cursor)
+        {
+            case '{':
+                return ParseObject(outValue, depth);
+            case '[':
+                return ParseArray(outValue, depth);
+            case '"':
+                outValue.m_type = JsonValue::Type::STRING;
+                return ParseString(outValue.m_string);
+            case 't':
+                outValue.m_type = JsonValue::Type::BOOLEAN;
+                outValue.m_bBoolean = true;
+                return ParseLiteral("true", 4);
+            case 'f':
+                outValue.m_type = JsonValue::Type::BOOLEAN;
+                outValue.m_bBoolean = false;
+                return ParseLiteral("false", 5);
+            case 'n':
+                outValue.m_type = JsonValue::Type::NULL_VALUE;
+                return ParseLiteral("null", 4);
+            default:
+                outValue.m_type = JsonValue::Type::NUMBER;
+                return ParseNumber(outValue.m_number);
+        }
+    }
+
+    bool ParseLiteral(const char* literal, size_t literalLength)
+    {
+        if (!TextParsing::MatchKeyword(m_cursor, m_end, literal, literalLength))
+        {
+            return Fail("invalid literal");
+        }
+        m_cursor += literalLength;
+        return true;
+    }
+
+    bool ParseNumber(double& outNumber)
+    {
+        // Validate the JSON number grammar while measuring its length.
+        const char* c = m_cursor;
+        bool bInteger = true;
+        if (c < m_end && *c == '-')
+        {
+            c++;
+        }
+        if (c >= m_end || !TextParsing::IsDigit(*c))
+        {
+            return Fail("invalid value");
+        }
+        while (c < m_end && TextParsing::IsDigit(*c))
+        {
+            c++;
+        }
+        if (c < m_end && *c == '.')
+        {
+            bInteger = false;
+            c++;
+            if (c >= m_end || !TextParsing::IsDigit(*c))
+            {
+                return Fail("invalid number");
+            }
+            while (c < m_end && TextParsing::IsDigit(*c))
+            {
+                c++;
+            }
+        }
+        if (c < m_end && (*c == 'e' || *c == 'E'))
+        {
+            bInteger = false;
+            c++;
+            if (c < m_end && (*c == '+' || *c == '-'))
+            {
+                c++;
+            }
+            if (c >= m_end || !TextParsing::IsDigit(*c))
+            {
+                return Fail("invalid number");
+            }
+            while (c < m_end && TextParsing::IsDigit(*c))
+            {
+                c++;
+            }
+        }
+
+        // Integers (offsets, counts...) are the bulk of numbers in asset descriptions and must be exact, so they get parsed directly.
+        // Anything else goes through the standard library, which needs a null terminated copy.
+        const size_t numberLength = static_cast<size_t>(c - m_cursor);
+        if (bInteger && numberLength <= 18)
+        {
+            int64_t integer = 0;
+            TextParsing::ParseInteger(m_cursor, c, integer);
+            outNumber = static_cast<double>(integer);
+        }
+        else
+        {
+            char buff[128];
+            if (numberLength >= sizeof(buff))
+            {
+                return Fail("number is too long");
+            }
+            memcpy(buff, m_cursor, numberLength);
+            buff[numberLength] = '\0';
+            outNumber = strtod(buff, nullptr);
+        }
+
+        m_cursor = c;
+        return true;
+    }
+
+    static bool ParseHexDigits(const char* digits, uint32_t& outCodeUnit)
+    {
+        outCodeUnit = 0;
+        for (int digitIndex = 0; digitIndex < 4; digitIndex++)
+        {
+            const char digit = digits[digitIndex];
+            uint32_t value;
+            if (digit >= '0' && digit <= '9')
+            {
+                value = digit - '0';
+            }
+            else if (digit >= 'a' && digit <= 'f')
+            {
+                value = digit - 'a' + 10;
+            }
+            else if (digit >= 'A' && digit <= 'F')
+            {
+                value = digit - 'A' + 10;
+            }
+            else
+            {
+                return false;
+            }
+            outCodeUnit = outCodeUnit * 16 + value;
+        }
+        return true;
+    }
+
+    static void AppendUtf8(std::string& str, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            str.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800)
+        {
+            str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    bool ParseString(std::string& outString)
+    {
+        m_cursor++; // Opening quote.
+        outString.clear();
+
+        while (true)
+        {
+            // Copy unescaped runs in one go.
+            const char* runStart = m_cursor;
+            while (m_cursor < m_end && *m_cursor != '"' && *m_cursor != '\\')
+            {
+                if (static_cast<unsigned char>(*m_cursor) < 0x20)
+                {
+                    return Fail("control character in string");
+                }
+                m_cursor++;
+            }
+            outString.append(runStart, m_cursor);
+
+            if (m_cursor >= m_end)
+            {
+                return Fail("unterminated string");
+            }
+
+            if (*m_cursor == '"')
+            {
+                m_cursor++;
+                return true;
+            }
+
+            // Escape sequence.
+            m_cursor++;
+            if (m_cursor >= m_end)
+            {
+                return Fail("unterminated string");
+            }
+
+            const char escaped = *m_cursor++;
+            switch (escaped)
+            {
+                case '"': outString.push_back('"'); break;
+                case '\\': outString.push_back('\\'); break;
+                case '/': outString.push_back('/'); break;
+                case 'b': outString.push_back('\b'); break;
+                case 'f': outString.push_back('\f'); break;
+                case 'n': outString.push_back('\n'); break;
+                case 'r': outString.push_back('\r'); break;
+                case 't': outString.push_back('\t'); break;
+                case 'u':
+                {
+                    uint32_t codePoint;
+                    if (m_end - m_cursor < 4 || !ParseHexDigits(m_cursor, codePoint))
+                    {
+                        return Fail("invalid unicode escape");
+                    }
+                    m_cursor += 4;
+
+                    // Characters outside of the basic multilingual plane are escaped as UTF-16 surrogate pairs.
+                    uint32_t lowSurrogate;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00 && m_end - m_cursor >= 6 && m_cursor[0] == '\\' && m_cursor[1] == 'u'
+                        && ParseHexDigits(m_cursor + 2, lowSurrogate) && lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                        m_cursor += 6;
+                    }
+                    AppendUtf8(outString, codePoint);
+                    break;
+                }
+                default:
+                    return Fail("invalid escape sequence");
+            }
+        }
+    }
+
+    bool ParseArray(JsonValue& outValue, uint32_t depth)
+    {
+        m_cursor++; // Opening bracket.
+        outValue.m_type = JsonValue::Type::ARRAY;
+
+        SkipWhitespace();
+        if (m_cursor < m_end && *m_cursor == ']')
+        {
+            m_cursor++;
+            return true;
+        }
+
+        while (true)
+        {
+            outValue.m_elements.emplace_back();
+            if (!ParseValue(outValue.m_elements.back(), depth + 1))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_cursor >= m_end)
+            {
+                return Fail("unterminated array");
+            }
+
+            const char separator = *m_cursor++;
+            if (separator == ']')
+            {
+                return true;
+            }
+            if (separator != ',')
+            {
+                return Fail("expected ',' or ']' in array");
+            }
+        }
+    }
+
+    bool ParseObject(JsonValue& outValue, uint32_t depth)
+    {
+        m_cursor++; // Opening brace.
+        outValue.m_type = JsonValue::Type::OBJECT;
+
+        SkipWhitespace();
+        if (m_cursor < m_end && *m_cursor == '}')
+        {
+            m_cursor++;
+            return true;
+        }
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (m_cursor >= m_end || *m_cursor != '"')
+            {
+                return Fail("expected member name in object");
+            }
+
+            outValue.m_members.emplace_back();
+            std::pair<std::string, JsonValue>& member = outValue.m_members.back();
+            if (!ParseString(member.first))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_cursor >= m_end || *m_cursor != ':')
+            {
+                return Fail("expected ':' after member name");
+            }
+            m_cursor++;
+
+            if (!ParseValue(member.second, depth + 1))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_cursor >= m_end)
+            {
+                return Fail("unterminated object");
+            }
+
+            const char separator = *m_cursor++;
+            if (separator == '}')
+            {
+                return true;
+            }
+            if (separator != ',')
+            {
+                return Fail("expected ',' or '}' in object");
+            }
+        }
+    }
+
+    const char* m_cursor;
+    const char* m_begin;
+    const char* m_end;
+
+    const char* m_error = "";
+};
+
+bool JsonValue::Parse(const char* text, size_t length, JsonValue& outValue, std::string& outError)
+{
+    outValue = JsonValue();
+    JsonParser parser(text, length);
+    return parser.ParseDocument(outValue, outError);
+}
+
+const JsonValue* JsonValue::FindMember(const char* name) const
+{
+    for (const std::pair<std::string, JsonValue>& member : m_members)
+    {
+        if (member.first == name)
+        {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
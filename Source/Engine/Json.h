@@ -0,0 +1,78 @@
+/*
+    Minimal JSON document parser, used to read the descriptive part of asset formats such as glTF.
+    Documents get parsed into a tree of values in one go; they are expected to be small compared to the binary data they describe.
+*/
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Value of a parsed JSON document, holding its children for arrays & objects.
+class JsonValue
+{
+public:
+
+    enum class Type
+    {
+        NULL_VALUE,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    JsonValue() : m_type(Type::NULL_VALUE), m_bBoolean(false), m_number(0.0)
+    {}
+
+    /// @brief Parses a complete JSON document.
+    /// @param text Document text, UTF-8 encoded. Does not need to be null terminated.
+    /// @param length Length of the text in bytes.
+    /// @param outValue Root value of the document.
+    /// @param outError Filled with a description of the problem when parsing fails.
+    /// @return True if the document was parsed, false otherwise.
+    static bool Parse(const char* text, size_t length, JsonValue& outValue, std::string& outError);
+
+    inline Type GetType() const { return m_type; }
+    inline bool IsNumber() const { return m_type == Type::NUMBER; }
+    inline bool IsString() const { return m_type == Type::STRING; }
+    inline bool IsArray() const { return m_type == Type::ARRAY; }
+    inline bool IsObject() const { return m_type == Type::OBJECT; }
+
+    inline bool GetBoolean(bool defaultValue = false) const { return m_type == Type::BOOLEAN ? m_bBoolean : defaultValue; }
+    inline double GetNumber(double defaultValue = 0.0) const { return m_type == Type::NUMBER ? m_number : defaultValue; }
+    /// @brief String contents, empty for values that aren't strings.
+    inline const std::string& GetString() const { return m_string; }
+
+    /// @brief Elements of an array, empty for values that aren't arrays.
+    inline const std::vector<JsonValue>& GetElements() const { return m_elements; }
+
+    /// @brief Members of an object in document order, empty for values that aren't objects.
+    inline const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_members; }
+
+    /// @brief Looks an object member up by name.
+    /// @return The member's value, or nullptr if this isn't an object or it has no such member.
+    const JsonValue* FindMember(const char* name) const;
+
+    /// @brief Looks an array element up by index.
+    /// @return The element, or nullptr if this isn't an array or the index is out of range.
+    inline const JsonValue* FindElement(size_t index) const { return index < m_elements.size() ? &m_elements[index] : nullptr; }
+
+private:
+
+    friend class JsonParser;
+
+    Type m_type;
+    bool m_bBoolean;
+    double m_number;
+    std::string m_string;
+    std::vector<JsonValue> m_elements;
+    std::vector<std::pair<std::string, JsonValue>> m_members;
+};
+
+#endif // JSON_H
@@ -0,0 +1,51 @@
+#include "MemoryArena.h"
+
+MemoryArena::MemoryArena(void* memory, size_t capacity)
+    : m_memory(static_cast<uint8_t*>(memory)), m_capacity(memory != nullptr ? capacity : 0), m_usedSize(0), m_peakUsedSize(0), m_overflowSize(0)
+{}
+
+MemoryArena::~MemoryArena()
+{
+    Reset();
+}
+
+void* MemoryArena::Allocate(size_t size, size_t alignment)
+{
+    // Bump the used size with a compare & swap, aligning the address the allocation starts at.
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_memory);
+    size_t offset = m_usedSize.load(std::memory_order_relaxed);
+    while (offset <= m_capacity)
+    {
+        const size_t alignedOffset = ((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+        const size_t endOffset = alignedOffset + size;
+        if (endOffset > m_capacity)
+        {
+            break;
+        }
+        if (m_usedSize.compare_exchange_weak(offset, endOffset, std::memory_order_relaxed))
+        {
+            return m_memory + alignedOffset;
+        }
+    }
+
+    // The block is full: fall back to the heap. Later allocations keep doing so until the next reset, even small ones that would still fit.
+    m_usedSize.store(m_capacity + 1, std::memory_order_relaxed);
+    void* memory = ::operator new(size > 0 ? size : 1, std::align_val_t(alignment));
+    std::lock_guard<std::mutex> lock(m_mutex_OverflowAllocations);
+    m_overflowAllocations.push_back(OverflowAllocation{ memory, alignment });
+    m_overflowSize += size;
+    return memory;
+}
+
+void MemoryArena::Reset()
+{
+    m_peakUsedSize = GetPeakUsedSize();
+
+    for (const OverflowAllocation& allocation : m_overflowAllocations)
+    {
+        ::operator delete(allocation.Memory, std::align_val_t(allocation.Alignment));
+    }
+    m_overflowAllocations.clear();
+    m_overflowSize = 0;
+    m_usedSize.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,148 @@
+/*
+    Linear memory arenas the Engine gets its memory from instead of the general-purpose heap, since it can't use static memory.
+    The platform reserves their memory and hands them to the Engine at initialization (see EngineMemory in Engine.h). Allocating bumps an
+    offset, and freeing only happens all at once by resetting the arena, so allocations are cheap enough for hot loops and can't fragment.
+    ArenaAllocator adapts arenas to STL containers.
+*/
+
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/// @brief Linear allocator over a block of memory. Allocating is thread safe, resetting isn't.
+/// Allocations that don't fit in the block fall back to the heap until the next reset, so an undersized arena is slower but never fails.
+class MemoryArena
+{
+public:
+
+    /// @param memory Block allocations are made from, owned by the caller. Should be aligned to at least a cache line.
+    /// @param capacity Size of the block in bytes.
+    MemoryArena(void* memory, size_t capacity);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    /// @brief Allocates memory valid until the next reset. Never returns null.
+    /// @param alignment Alignment of the allocation, a power of two.
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Allocates an uninitialized array valid until the next reset.
+    template<typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+    /// @brief Frees every allocation at once. Must not be called while other threads allocate.
+    void Reset();
+
+    size_t GetCapacity() const { return m_capacity; }
+    /// @brief Returns the amount of bytes used in the block since the last reset.
+    size_t GetUsedSize() const { return std::min(m_usedSize.load(std::memory_order_relaxed), m_capacity); }
+    /// @brief Returns the largest amount of bytes used between two resets, including bytes that fell back to the heap.
+    size_t GetPeakUsedSize() const { return std::max(m_peakUsedSize, GetUsedSize() + m_overflowSize); }
+
+private:
+
+    uint8_t* m_memory;
+    size_t m_capacity;
+    std::atomic<size_t> m_usedSize;
+    size_t m_peakUsedSize;
+
+    /// @brief Heap allocation made once the block was full.
+    struct OverflowAllocation
+    {
+        void* Memory;
+        size_t Alignment;
+    };
+
+    // Heap allocations made once the block was full, freed on reset.
+    std::mutex m_mutex_OverflowAllocations;
+    std::vector<OverflowAllocation> m_overflowAllocations;
+    size_t m_overflowSize;
+};
+
+/// @brief STL allocator allocating from a memory arena. Deallocating does nothing: memory only gets freed when the arena is reset, so
+/// containers using it must not outlive the arena's next reset. Without an arena, it falls back to the general-purpose heap.
+/// @tparam ALIGNMENT Alignment of allocations, a power of two at least that of T.
+template<typename T, size_t ALIGNMENT = alignof(T)>
+class ArenaAllocator
+{
+    static_assert(ALIGNMENT >= alignof(T) && (ALIGNMENT & (ALIGNMENT - 1)) == 0, "ArenaAllocator alignment must be a power of two at least that of T");
+
+public:
+
+    typedef T value_type;
+    // Containers take their allocator (and thus arena) along when assigned, so assigning a container a fresh one switches arenas.
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    // Rebound allocators keep the alignment, unless the new type requires more.
+    template<typename U>
+    struct rebind { typedef ArenaAllocator<U, (ALIGNMENT > alignof(U) ? ALIGNMENT : alignof(U))> other; };
+
+    ArenaAllocator(MemoryArena* arena = nullptr) noexcept : m_arena(arena)
+    {}
+
+    template<typename U, size_t OTHER_ALIGNMENT>
+    ArenaAllocator(const ArenaAllocator<U, OTHER_ALIGNMENT>& other) noexcept : m_arena(other.GetArena())
+    {}
+
+    T* allocate(size_t count)
+    {
+        if (m_arena == nullptr)
+        {
+            if constexpr (ALIGNMENT > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(ALIGNMENT)));
+            }
+            else
+            {
+                return static_cast<T*>(::operator new(count * sizeof(T)));
+            }
+        }
+        return static_cast<T*>(m_arena->Allocate(count * sizeof(T), ALIGNMENT));
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+        if (m_arena == nullptr)
+        {
+            if constexpr (ALIGNMENT > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                ::operator delete(pointer, std::align_val_t(ALIGNMENT));
+            }
+            else
+            {
+                ::operator delete(pointer);
+            }
+        }
+    }
+
+    MemoryArena* GetArena() const { return m_arena; }
+
+    template<typename U, size_t OTHER_ALIGNMENT>
+    bool operator==(const ArenaAllocator<U, OTHER_ALIGNMENT>& other) const { return m_arena == other.GetArena(); }
+    template<typename U, size_t OTHER_ALIGNMENT>
+    bool operator!=(const ArenaAllocator<U, OTHER_ALIGNMENT>& other) const { return m_arena != other.GetArena(); }
+
+private:
+
+    MemoryArena* m_arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/// @brief Arena vector whose elements start on a 32 byte boundary, the size of AVX registers, so SIMD kernels can use aligned loads & stores.
+template<typename T>
+using SimdArenaVector = std::vector<T, ArenaAllocator<T, 32>>;
+
+#endif // MEMORY_ARENA_H
@@ -0,0 +1,77 @@
+#include "Mesh.h"
+
+#include <algorithm>
+
+void Mesh::ComputeBounds()
+{
+    Bounds = BoundingBox{};
+    for (const Vector3& position : Positions)
+    {
+        Bounds.Extend(position);
+    }
+}
+
+Mesh Mesh::CreateUVSphere(uint32_t ringCount, uint32_t segmentCount)
+{
+    const float pi = 3.14159265358979f;
+
+    const size_t vertexCount = static_cast<size_t>(ringCount + 1) * (segmentCount + 1);
+    std::vector<Vector3> positions;
+    std::vector<Vector2> texCoords;
+    positions.reserve(vertexCount);
+    texCoords.reserve(vertexCount);
+
+    for (uint32_t ring = 0; ring <= ringCount; ring++)
+    {
+        const float v = static_cast<float>(ring) / ringCount;
+        const float polarAngle = v * pi;
+
+        for (uint32_t segment = 0; segment <= segmentCount; segment++)
+        {
+            const float u = static_cast<float>(segment) / segmentCount;
+            const float azimuthAngle = u * 2.0f * pi;
+
+            const Vector3 position = {  std::sin(polarAngle) * std::cos(azimuthAngle),
+                                        std::cos(polarAngle),
+                                        -std::sin(polarAngle) * std::sin(azimuthAngle)};
+            positions.push_back(position);
+            texCoords.push_back(Vector2{u, v});
+        }
+    }
+
+    // Quads get emitted tile by tile rather than ring by ring, so every run of 256 consecutive triangles (a bounding volume hierarchy chunk,
+    // see MeshBvh.h) covers a compact patch of the surface instead of a thin strip along a ring. Strips are all border, and chunk borders
+    // can't be simplified into levels of detail.
+    const uint32_t tileRingCount = 8;
+    const uint32_t tileSegmentCount = 16;
+
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(ringCount) * segmentCount * 6);
+    for (uint32_t tileRing = 0; tileRing < ringCount; tileRing += tileRingCount)
+    {
+        for (uint32_t tileSegment = 0; tileSegment < segmentCount; tileSegment += tileSegmentCount)
+        {
+            for (uint32_t ring = tileRing; ring < std::min(tileRing + tileRingCount, ringCount); ring++)
+            {
+                for (uint32_t segment = tileSegment; segment < std::min(tileSegment + tileSegmentCount, segmentCount); segment++)
+                {
+                    const uint32_t topLeft = ring * (segmentCount + 1) + segment;
+                    const uint32_t bottomLeft = topLeft + segmentCount + 1;
+
+                    // Counter-clockwise when seen from outside the sphere.
+                    indices.insert(indices.end(), { topLeft, bottomLeft, topLeft + 1 });
+                    indices.insert(indices.end(), { topLeft + 1, bottomLeft, bottomLeft + 1 });
+                }
+            }
+        }
+    }
+
+    Mesh sphere;
+    // Unit sphere centered on the origin: normals are positions.
+    sphere.Normals = std::vector<Vector3>(positions);
+    sphere.Positions = std::move(positions);
+    sphere.TexCoords = std::move(texCoords);
+    sphere.Indices = std::move(indices);
+    sphere.ComputeBounds();
+    return sphere;
+}
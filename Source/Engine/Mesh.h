@@ -0,0 +1,161 @@
+/*
+    Engine-side indexed triangle mesh representation, as produced by model loaders and consumed by the renderer.
+*/
+
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "VectorMath.h"
+
+/// @brief Axis aligned bounding box. An empty box has Min > Max on every axis.
+struct BoundingBox
+{
+    Vector3 Min = {  1e30f,  1e30f,  1e30f };
+    Vector3 Max = { -1e30f, -1e30f, -1e30f };
+
+    inline bool IsEmpty() const { return Min.x > Max.x; }
+    inline void Extend(const Vector3& point) { Min = ::Min(Min, point); Max = ::Max(Max, point); }
+    inline Vector3 GetCenter() const { return (Min + Max) * 0.5f; }
+    inline Vector3 GetExtent() const { return (Max - Min) * 0.5f; }
+};
+
+/// @brief Array of mesh data, either owned or referencing memory kept alive by some other object (such as a mapped model file), so
+/// loaders can hand out file contents without copying them. Reading is the same either way; writing converts referenced data to owned data.
+template<typename T>
+class MeshBuffer
+{
+public:
+
+    MeshBuffer() : m_data(nullptr), m_count(0)
+    {}
+
+    MeshBuffer(std::vector<T>&& values) : m_storage(std::move(values)) { PointToStorage(); }
+
+    MeshBuffer(const MeshBuffer& other) : m_storage(other.m_storage), m_externalOwner(other.m_externalOwner)
+    {
+        PointLike(other);
+    }
+
+    MeshBuffer(MeshBuffer&& other) : m_storage(std::move(other.m_storage)), m_externalOwner(std::move(other.m_externalOwner))
+    {
+        PointLike(other);
+        other.m_storage.clear();
+        other.PointToStorage();
+    }
+
+    MeshBuffer& operator=(MeshBuffer other)
+    {
+        m_storage = std::move(other.m_storage);
+        m_externalOwner = std::move(other.m_externalOwner);
+        PointLike(other);
+        return *this;
+    }
+
+    MeshBuffer& operator=(std::vector<T>&& values)
+    {
+        m_storage = std::move(values);
+        m_externalOwner.reset();
+        PointToStorage();
+        return *this;
+    }
+
+    inline size_t GetCount() const { return m_count; }
+    inline bool IsEmpty() const { return m_count == 0; }
+    inline size_t GetSizeInBytes() const { return m_count * sizeof(T); }
+    inline const T* GetData() const { return m_data; }
+    inline const T& operator[](size_t index) const { return m_data[index]; }
+
+    inline const T* begin() const { return m_data; }
+    inline const T* end() const { return m_data + m_count; }
+
+    /// @brief Whether data is referenced from memory owned by another object, rather than owned.
+    inline bool IsExternal() const { return m_externalOwner != nullptr; }
+
+    /// @brief Makes the buffer reference external memory. The owner object is kept alive for as long as the buffer references its memory.
+    /// @param data First element. Must be suitably aligned for T.
+    /// @param count Amount of elements.
+    /// @param owner Object owning the memory.
+    void Reference(const T* data, size_t count, std::shared_ptr<const void> owner)
+    {
+        m_storage = std::vector<T>();
+        m_externalOwner = std::move(owner);
+        m_data = data;
+        m_count = count;
+    }
+
+    /// @brief Replaces contents with count owned, value-initialized elements.
+    /// @return Pointer to the first element, for writing.
+    T* Allocate(size_t count)
+    {
+        m_storage.assign(count, T{});
+        m_externalOwner.reset();
+        PointToStorage();
+        return m_storage.data();
+    }
+
+    /// @brief Gives write access to the elements, copying referenced data to owned storage first if needed.
+    T* GetMutableData()
+    {
+        if (m_externalOwner != nullptr)
+        {
+            m_storage.assign(m_data, m_data + m_count);
+            m_externalOwner.reset();
+            PointToStorage();
+        }
+        return m_storage.data();
+    }
+
+private:
+
+    inline void PointToStorage() { m_data = m_storage.data(); m_count = m_storage.size(); }
+
+    /// Points at the same external memory as another buffer if this one references external memory, or at owned storage otherwise.
+    inline void PointLike(const MeshBuffer& other)
+    {
+        if (m_externalOwner != nullptr)
+        {
+            m_data = other.m_data;
+            m_count = other.m_count;
+        }
+        else
+        {
+            PointToStorage();
+        }
+    }
+
+    std::vector<T> m_storage;
+    std::shared_ptr<const void> m_externalOwner;
+
+    // Elements being read, pointing either into owned storage or into external memory.
+    const T* m_data;
+    size_t m_count;
+};
+
+/// @brief Indexed triangle mesh. Triangles are made of 3 consecutive indices into the vertex attribute arrays and
+/// are front facing when counter-clockwise. Normals and texture coordinates are optional, but when present there is one per position.
+struct Mesh
+{
+    MeshBuffer<Vector3> Positions;
+    MeshBuffer<Vector3> Normals;
+    MeshBuffer<Vector2> TexCoords;
+
+    MeshBuffer<uint32_t> Indices;
+
+    BoundingBox Bounds;
+
+    inline size_t GetVertexCount() const { return Positions.GetCount(); }
+    inline size_t GetTriangleCount() const { return Indices.GetCount() / 3; }
+
+    /// @brief Recomputes the bounding box from vertex positions.
+    void ComputeBounds();
+
+    /// @brief Generates a UV sphere of radius 1 centered on the origin, with normals and texture coordinates.
+    /// Triangle count is 2 * ringCount * segmentCount (minus the degenerate pole triangles, which are kept for simplicity).
+    static Mesh CreateUVSphere(uint32_t ringCount, uint32_t segmentCount);
+};
+
+#endif // MESH_H
@@ -0,0 +1,629 @@
+#include "MeshBvh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // Split candidates evaluated per axis by the surface area heuristic.
+    const uint32_t SAH_BIN_COUNT = 16;
+    // Cost of traversing a node relative to testing a chunk's triangles against it.
+    const float SAH_TRAVERSAL_COST = 0.25f;
+    // Leaves hold at most this many chunks, unless the maximum depth is reached.
+    const uint32_t MAX_LEAF_CHUNK_COUNT = 4;
+    // Traversal stacks are fixed-size arrays, so the tree depth is capped. Subtrees reaching it become leaves.
+    const uint32_t MAX_DEPTH = 64;
+
+    // Subtrees over more chunks than this build their two children in parallel.
+    const uint32_t PARALLEL_SUBTREE_CHUNK_COUNT = 1024;
+    // Chunks whose bounds are computed by a single job.
+    const uint32_t CHUNK_BATCH_SIZE = 256;
+
+    // Frustum planes culling tests run against: left, right, bottom, top, near, far.
+    const int FRUSTUM_PLANE_COUNT = 6;
+    const uint32_t ALL_PLANES_MASK = (1 << FRUSTUM_PLANE_COUNT) - 1;
+
+    inline float GetSurfaceArea(const BoundingBox& box)
+    {
+        const Vector3 size = box.Max - box.Min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline void ExtendBox(BoundingBox& box, const BoundingBox& other)
+    {
+        box.Min = Min(box.Min, other.Min);
+        box.Max = Max(box.Max, other.Max);
+    }
+
+    inline float GetAxis(const Vector3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    /// Tree node as built, before being flattened depth-first.
+    struct BuildNode
+    {
+        BoundingBox Bounds;
+        uint32_t Children[2];
+        // Range of the chunk order array covered by the node.
+        uint32_t FirstChunk;
+        uint32_t ChunkCount;
+        bool bLeaf;
+    };
+
+    struct BuildContext
+    {
+        JobSystem* Jobs;
+        const std::vector<BoundingBox>* ChunkBounds;
+        std::vector<Vector3> ChunkCentroids;
+        std::vector<uint32_t> ChunkOrder;
+
+        // Preallocated for the worst case, so subtrees can allocate nodes concurrently.
+        std::vector<BuildNode> Nodes;
+        std::atomic<uint32_t> NodeCount;
+    };
+
+    void BuildSubtree(BuildContext& context, uint32_t nodeIndex, uint32_t firstChunk, uint32_t chunkCount, uint32_t depth)
+    {
+        const std::vector<BoundingBox>& chunkBounds = *context.ChunkBounds;
+        uint32_t* chunkOrder = context.ChunkOrder.data();
+
+        BoundingBox bounds;
+        BoundingBox centroidBounds;
+        for (uint32_t orderIndex = firstChunk; orderIndex < firstChunk + chunkCount; orderIndex++)
+        {
+            ExtendBox(bounds, chunkBounds[chunkOrder[orderIndex]]);
+            centroidBounds.Extend(context.ChunkCentroids[chunkOrder[orderIndex]]);
+        }
+
+        BuildNode& node = context.Nodes[nodeIndex];
+        node.Bounds = bounds;
+        node.FirstChunk = firstChunk;
+        node.ChunkCount = chunkCount;
+        node.bLeaf = true;
+        if (chunkCount <= 1 || depth + 1 >= MAX_DEPTH)
+        {
+            return;
+        }
+
+        // Evaluate binned SAH splits along every axis the centroids spread over.
+        int bestAxis = -1;
+        uint32_t bestSplitBin = 0;
+        float bestCost = INFINITY;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float axisMin = GetAxis(centroidBounds.Min, axis);
+            const float axisExtent = GetAxis(centroidBounds.Max, axis) - axisMin;
+            if (!(axisExtent > 0.0f))
+            {
+                continue;
+            }
+
+            BoundingBox binBounds[SAH_BIN_COUNT];
+            uint32_t binCounts[SAH_BIN_COUNT] = {};
+            const float binScale = SAH_BIN_COUNT / axisExtent;
+            for (uint32_t orderIndex = firstChunk; orderIndex < firstChunk + chunkCount; orderIndex++)
+            {
+                const uint32_t chunk = chunkOrder[orderIndex];
+                const uint32_t bin = std::min(static_cast<uint32_t>((GetAxis(context.ChunkCentroids[chunk], axis) - axisMin) * binScale), SAH_BIN_COUNT - 1);
+                ExtendBox(binBounds[bin], chunkBounds[chunk]);
+                binCounts[bin]++;
+            }
+
+            // Sweep from the right to get the area & count right of every split, then from the left to evaluate them.
+            float rightAreas[SAH_BIN_COUNT];
+            uint32_t rightCounts[SAH_BIN_COUNT];
+            BoundingBox rightBounds;
+            uint32_t rightCount = 0;
+            for (uint32_t bin = SAH_BIN_COUNT - 1; bin > 0; bin--)
+            {
+                ExtendBox(rightBounds, binBounds[bin]);
+                rightCount += binCounts[bin];
+                rightAreas[bin] = rightCount > 0 ? GetSurfaceArea(rightBounds) : 0.0f;
+                rightCounts[bin] = rightCount;
+            }
+
+            BoundingBox leftBounds;
+            uint32_t leftCount = 0;
+            for (uint32_t splitBin = 1; splitBin < SAH_BIN_COUNT; splitBin++)
+            {
+                ExtendBox(leftBounds, binBounds[splitBin - 1]);
+                leftCount += binCounts[splitBin - 1];
+                if (leftCount == 0 || rightCounts[splitBin] == 0)
+                {
+                    continue;
+                }
+
+                const float cost = GetSurfaceArea(leftBounds) * leftCount + rightAreas[splitBin] * rightCounts[splitBin];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplitBin = splitBin;
+                }
+            }
+        }
+
+        const float parentArea = GetSurfaceArea(bounds);
+        const float splitCost = parentArea > 0.0f ? SAH_TRAVERSAL_COST + bestCost / parentArea : INFINITY;
+        if (chunkCount <= MAX_LEAF_CHUNK_COUNT && !(splitCost < static_cast<float>(chunkCount)))
+        {
+            return;
+        }
+
+        uint32_t splitPosition;
+        if (bestAxis >= 0)
+        {
+            const float axisMin = GetAxis(centroidBounds.Min, bestAxis);
+            const float binScale = SAH_BIN_COUNT / (GetAxis(centroidBounds.Max, bestAxis) - axisMin);
+            const uint32_t* splitIt = std::partition(chunkOrder + firstChunk, chunkOrder + firstChunk + chunkCount, [&](uint32_t chunk)
+            {
+                const float centroid = GetAxis(context.ChunkCentroids[chunk], bestAxis);
+                return std::min(static_cast<uint32_t>((centroid - axisMin) * binScale), SAH_BIN_COUNT - 1) < bestSplitBin;
+            });
+            splitPosition = static_cast<uint32_t>(splitIt - chunkOrder);
+        }
+        else
+        {
+            // Every centroid is at the same spot: any split is as good as another.
+            splitPosition = firstChunk + chunkCount / 2;
+        }
+        if (splitPosition == firstChunk || splitPosition == firstChunk + chunkCount)
+        {
+            splitPosition = firstChunk + chunkCount / 2;
+        }
+
+        const uint32_t firstChildIndex = context.NodeCount.fetch_add(2);
+        node.bLeaf = false;
+        node.Children[0] = firstChildIndex;
+        node.Children[1] = firstChildIndex + 1;
+
+        const uint32_t childFirstChunks[2] = { firstChunk, splitPosition };
+        const uint32_t childChunkCounts[2] = { splitPosition - firstChunk, firstChunk + chunkCount - splitPosition };
+        auto buildChild = [&](uint32_t childIndex)
+        {
+            BuildSubtree(context, firstChildIndex + childIndex, childFirstChunks[childIndex], childChunkCounts[childIndex], depth + 1);
+        };
+
+        if (chunkCount > PARALLEL_SUBTREE_CHUNK_COUNT)
+        {
+            context.Jobs->ParallelFor(2, buildChild);
+        }
+        else
+        {
+            buildChild(0);
+            buildChild(1);
+        }
+    }
+
+    /// Appends a built subtree to the flattened node array, depth-first.
+    /// @return Index of the subtree's root in the flattened array.
+    uint32_t FlattenSubtree(const BuildContext& context, uint32_t buildNodeIndex, uint32_t depth, std::vector<MeshBvh::Node>& outNodes,
+        MeshBvh::BuildStatistics& statistics)
+    {
+        const BuildNode& buildNode = context.Nodes[buildNodeIndex];
+        const uint32_t nodeIndex = static_cast<uint32_t>(outNodes.size());
+        outNodes.push_back(MeshBvh::Node{ buildNode.Bounds.Min, buildNode.FirstChunk, buildNode.Bounds.Max, buildNode.ChunkCount });
+        statistics.Depth = std::max(statistics.Depth, depth + 1);
+
+        if (buildNode.bLeaf)
+        {
+            statistics.LeafCount++;
+            return nodeIndex;
+        }
+
+        outNodes[nodeIndex].ChunkCount = 0;
+        FlattenSubtree(context, buildNode.Children[0], depth + 1, outNodes, statistics);
+        outNodes[nodeIndex].SecondChildOrFirstChunk = FlattenSubtree(context, buildNode.Children[1], depth + 1, outNodes, statistics);
+        return nodeIndex;
+    }
+
+    /// Extracts the frustum planes of a view projection matrix as (normal x, y, z, distance), the inside being positive.
+    void ExtractFrustumPlanes(const Matrix4x4& viewProjection, float (&outPlanes)[FRUSTUM_PLANE_COUNT][4])
+    {
+        const float (&m)[4][4] = viewProjection.m;
+        for (int column = 0; column < 4; column++)
+        {
+            outPlanes[0][column] = m[3][column] + m[0][column]; // -w <= x
+            outPlanes[1][column] = m[3][column] - m[0][column]; // x <= w
+            outPlanes[2][column] = m[3][column] + m[1][column]; // -w <= y
+            outPlanes[3][column] = m[3][column] - m[1][column]; // y <= w
+            outPlanes[4][column] = m[2][column];                // 0 <= z
+            outPlanes[5][column] = m[3][column] - m[2][column]; // z <= w
+        }
+    }
+
+    /// Tests a box against the frustum planes of a mask.
+    /// @return False if the box is fully outside a plane. Otherwise, planes the box is fully inside of are removed from the mask.
+    inline bool TestBoxAgainstPlanes(const Vector3& boxMin, const Vector3& boxMax, const float (&planes)[FRUSTUM_PLANE_COUNT][4], uint32_t& inOutPlaneMask)
+    {
+        for (int planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; planeIndex++)
+        {
+            if ((inOutPlaneMask & (1u << planeIndex)) == 0)
+            {
+                continue;
+            }
+
+            // Corners furthest along and against the plane normal.
+            const float* plane = planes[planeIndex];
+            const float farthestDistance = plane[0] * (plane[0] > 0.0f ? boxMax.x : boxMin.x) + plane[1] * (plane[1] > 0.0f ? boxMax.y : boxMin.y)
+                                         + plane[2] * (plane[2] > 0.0f ? boxMax.z : boxMin.z) + plane[3];
+            if (farthestDistance < 0.0f)
+            {
+                return false;
+            }
+
+            const float nearestDistance = plane[0] * (plane[0] > 0.0f ? boxMin.x : boxMax.x) + plane[1] * (plane[1] > 0.0f ? boxMin.y : boxMax.y)
+                                        + plane[2] * (plane[2] > 0.0f ? boxMin.z : boxMax.z) + plane[3];
+            if (nearestDistance >= 0.0f)
+            {
+                inOutPlaneMask &= ~(1u << planeIndex);
+            }
+        }
+        return true;
+    }
+
+    /// Slab test of a ray against a box.
+    /// @return Entry distance, or INFINITY if the box is missed or only hit further than maxDistance.
+    inline float IntersectRayBox(const Vector3& origin, const Vector3& inverseDirection, const Vector3& boxMin, const Vector3& boxMax, float maxDistance)
+    {
+        const float x0 = (boxMin.x - origin.x) * inverseDirection.x;
+        const float x1 = (boxMax.x - origin.x) * inverseDirection.x;
+        const float y0 = (boxMin.y - origin.y) * inverseDirection.y;
+        const float y1 = (boxMax.y - origin.y) * inverseDirection.y;
+        const float z0 = (boxMin.z - origin.z) * inverseDirection.z;
+        const float z1 = (boxMax.z - origin.z) * inverseDirection.z;
+
+        const float entry = std::fmax(std::fmax(std::fmin(x0, x1), std::fmin(y0, y1)), std::fmax(std::fmin(z0, z1), 0.0f));
+        const float exit = std::fmin(std::fmin(std::fmax(x0, x1), std::fmax(y0, y1)), std::fmin(std::fmax(z0, z1), maxDistance));
+        return entry <= exit ? entry : INFINITY;
+    }
+}
+
+MeshBvh::BuildStatistics MeshBvh::Build(const Mesh& mesh, JobSystem& jobSystem)
+{
+    BuildStatistics statistics;
+    Nodes = MeshBuffer<Node>();
+    Chunks = MeshBuffer<Chunk>();
+    ChunkOrder = MeshBuffer<uint32_t>();
+    Clusters = MeshBuffer<Cluster>();
+
+    const size_t triangleCount = mesh.GetTriangleCount();
+    if (triangleCount == 0)
+    {
+        return statistics;
+    }
+
+    // CHUNKS: bounds & vertex range of every run of triangles, and of the clusters they're made of.
+    const uint32_t chunkCount = static_cast<uint32_t>((triangleCount + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK);
+    const size_t clusterCount = (triangleCount + TRIANGLES_PER_CLUSTER - 1) / TRIANGLES_PER_CLUSTER;
+    std::vector<Chunk> chunks(chunkCount);
+    std::vector<Cluster> clusters(clusterCount);
+    std::vector<BoundingBox> chunkBounds(chunkCount);
+
+    BuildContext context;
+    context.Jobs = &jobSystem;
+    context.ChunkBounds = &chunkBounds;
+    context.ChunkCentroids.resize(chunkCount);
+    context.ChunkOrder.resize(chunkCount);
+
+    const uint32_t chunkBatchCount = (chunkCount + CHUNK_BATCH_SIZE - 1) / CHUNK_BATCH_SIZE;
+    jobSystem.ParallelFor(chunkBatchCount, [&](uint32_t batchIndex)
+    {
+        const uint32_t endChunk = std::min((batchIndex + 1) * CHUNK_BATCH_SIZE, chunkCount);
+        for (uint32_t chunkIndex = batchIndex * CHUNK_BATCH_SIZE; chunkIndex < endChunk; chunkIndex++)
+        {
+            const size_t firstIndex = static_cast<size_t>(chunkIndex) * TRIANGLES_PER_CHUNK * 3;
+            const size_t endIndex = std::min(firstIndex + TRIANGLES_PER_CHUNK * 3, triangleCount * 3);
+
+            BoundingBox bounds;
+            uint32_t firstVertex = UINT32_MAX;
+            uint32_t lastVertex = 0;
+            for (size_t index = firstIndex; index < endIndex; index++)
+            {
+                const uint32_t vertex = mesh.Indices[index];
+                bounds.Extend(mesh.Positions[vertex]);
+                firstVertex = std::min(firstVertex, vertex);
+                lastVertex = std::max(lastVertex, vertex);
+            }
+
+            chunks[chunkIndex] = Chunk{ bounds.Min, firstVertex, bounds.Max, lastVertex + 1 };
+            chunkBounds[chunkIndex] = bounds;
+            context.ChunkCentroids[chunkIndex] = bounds.GetCenter();
+            context.ChunkOrder[chunkIndex] = chunkIndex;
+
+            const size_t endCluster = std::min(static_cast<size_t>(chunkIndex + 1) * CLUSTERS_PER_CHUNK, clusterCount);
+            for (size_t clusterIndex = static_cast<size_t>(chunkIndex) * CLUSTERS_PER_CHUNK; clusterIndex < endCluster; clusterIndex++)
+            {
+                const size_t firstClusterTriangle = clusterIndex * TRIANGLES_PER_CLUSTER;
+                clusters[clusterIndex] = BuildCluster(mesh, mesh.Indices.GetData() + firstClusterTriangle * 3,
+                    std::min(firstClusterTriangle + TRIANGLES_PER_CLUSTER, static_cast<size_t>(triangleCount)) - firstClusterTriangle);
+            }
+        }
+    });
+
+    // TREE: built top-down, then flattened depth-first.
+    context.Nodes.resize(static_cast<size_t>(chunkCount) * 2 - 1);
+    context.NodeCount = 1;
+    BuildSubtree(context, 0, 0, chunkCount, 0);
+
+    std::vector<Node> nodes;
+    nodes.reserve(context.NodeCount);
+    FlattenSubtree(context, 0, 0, nodes, statistics);
+
+    statistics.ChunkCount = chunkCount;
+    statistics.NodeCount = static_cast<uint32_t>(nodes.size());
+
+    Nodes = std::move(nodes);
+    Chunks = std::move(chunks);
+    ChunkOrder = std::move(context.ChunkOrder);
+    Clusters = std::move(clusters);
+    return statistics;
+}
+
+size_t MeshBvh::CullChunks(const Matrix4x4& viewProjection, std::vector<uint8_t>& outVisibleChunks) const
+{
+    outVisibleChunks.assign(GetChunkCount(), 0);
+    if (IsEmpty())
+    {
+        return 0;
+    }
+
+    float planes[FRUSTUM_PLANE_COUNT][4];
+    ExtractFrustumPlanes(viewProjection, planes);
+
+    // Nodes fully inside a plane don't test their children against it again.
+    struct StackEntry
+    {
+        uint32_t NodeIndex;
+        uint32_t PlaneMask;
+    };
+    StackEntry stack[MAX_DEPTH + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = StackEntry{ 0, ALL_PLANES_MASK };
+
+    size_t visibleChunkCount = 0;
+    while (stackSize > 0)
+    {
+        StackEntry entry = stack[--stackSize];
+        const Node& node = Nodes[entry.NodeIndex];
+        if (entry.PlaneMask != 0 && !TestBoxAgainstPlanes(node.BoundsMin, node.BoundsMax, planes, entry.PlaneMask))
+        {
+            continue;
+        }
+
+        if (!node.IsLeaf())
+        {
+            stack[stackSize++] = StackEntry{ node.SecondChildOrFirstChunk, entry.PlaneMask };
+            stack[stackSize++] = StackEntry{ entry.NodeIndex + 1, entry.PlaneMask };
+            continue;
+        }
+
+        for (uint32_t orderIndex = node.SecondChildOrFirstChunk; orderIndex < node.SecondChildOrFirstChunk + node.ChunkCount; orderIndex++)
+        {
+            const uint32_t chunkIndex = ChunkOrder[orderIndex];
+            const Chunk& chunk = Chunks[chunkIndex];
+            uint32_t chunkPlaneMask = entry.PlaneMask;
+            if (chunkPlaneMask == 0 || TestBoxAgainstPlanes(chunk.BoundsMin, chunk.BoundsMax, planes, chunkPlaneMask))
+            {
+                outVisibleChunks[chunkIndex] = 1;
+                visibleChunkCount++;
+            }
+        }
+    }
+
+    return visibleChunkCount;
+}
+
+MeshBvh::Cluster MeshBvh::BuildCluster(const Mesh& mesh, const uint32_t* indices, size_t triangleCount)
+{
+    BoundingBox bounds;
+    uint32_t firstVertex = UINT32_MAX;
+    uint32_t lastVertex = 0;
+    Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        const Vector3& p0 = mesh.Positions[indices[triangle * 3 + 0]];
+        const Vector3& p1 = mesh.Positions[indices[triangle * 3 + 1]];
+        const Vector3& p2 = mesh.Positions[indices[triangle * 3 + 2]];
+        normalSum = normalSum + Normalize(Cross(p1 - p0, p2 - p0));
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const uint32_t vertex = indices[triangle * 3 + corner];
+            bounds.Extend(mesh.Positions[vertex]);
+            firstVertex = std::min(firstVertex, vertex);
+            lastVertex = std::max(lastVertex, vertex);
+        }
+    }
+
+    Cluster cluster;
+    cluster.Center = bounds.GetCenter();
+    cluster.Radius = 0.0f;
+    for (size_t index = 0; index < triangleCount * 3; index++)
+    {
+        cluster.Radius = std::max(cluster.Radius, Length(mesh.Positions[indices[index]] - cluster.Center));
+    }
+    cluster.FirstVertex = firstVertex;
+    cluster.EndVertex = lastVertex + 1;
+
+    // Degenerate triangles have no normal. They never get rasterized, so they don't widen the cone.
+    cluster.ConeAxis = Normalize(normalSum);
+    float minAxisDot = 1.0f;
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        const Vector3& p0 = mesh.Positions[indices[triangle * 3 + 0]];
+        const Vector3& p1 = mesh.Positions[indices[triangle * 3 + 1]];
+        const Vector3& p2 = mesh.Positions[indices[triangle * 3 + 2]];
+        const Vector3 normal = Cross(p1 - p0, p2 - p0);
+        if (Dot(normal, normal) > 0.0f)
+        {
+            minAxisDot = std::min(minAxisDot, Dot(Normalize(normal), cluster.ConeAxis));
+        }
+    }
+    cluster.ConeCutoff = minAxisDot > 0.0f && Dot(cluster.ConeAxis, cluster.ConeAxis) > 0.0f ? std::sqrt(1.0f - minAxisDot * minAxisDot) : 2.0f;
+    return cluster;
+}
+
+MeshBvh::ClusterCullingView MeshBvh::ComputeClusterCullingView(const Matrix4x4& viewProjection, const Vector3& cameraPosition)
+{
+    ClusterCullingView view;
+    ExtractFrustumPlanes(viewProjection, view.FrustumPlanes);
+    for (float (&plane)[4] : view.FrustumPlanes)
+    {
+        const float inverseLength = 1.0f / std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        for (float& coefficient : plane)
+        {
+            coefficient *= inverseLength;
+        }
+    }
+    view.CameraPosition = cameraPosition;
+    return view;
+}
+
+bool MeshBvh::IsClusterVisible(const Cluster& cluster, const ClusterCullingView& view, uint32_t& inOutBackfaceCulledCount,
+    uint32_t& inOutFrustumCulledCount)
+{
+    // Backfacing when the direction from the camera to every point of the sphere is within 90 degrees minus the cone's angle of its
+    // axis, as every normal then points away from the camera. Bounding dot(p - camera, axis) and |p - camera| over the sphere keeps
+    // the test conservative.
+    const Vector3 fromCamera = cluster.Center - view.CameraPosition;
+    if (Dot(fromCamera, cluster.ConeAxis) >= cluster.ConeCutoff * (Length(fromCamera) + cluster.Radius) + cluster.Radius)
+    {
+        inOutBackfaceCulledCount++;
+        return false;
+    }
+
+    for (const float (&plane)[4] : view.FrustumPlanes)
+    {
+        if (plane[0] * cluster.Center.x + plane[1] * cluster.Center.y + plane[2] * cluster.Center.z + plane[3] < -cluster.Radius)
+        {
+            inOutFrustumCulledCount++;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t MeshBvh::CullChunkClusters(size_t chunkIndex, const ClusterCullingView& view, uint32_t& inOutBackfaceCulledCount,
+    uint32_t& inOutFrustumCulledCount) const
+{
+    const size_t firstCluster = chunkIndex * CLUSTERS_PER_CHUNK;
+    const size_t clusterCount = std::min(firstCluster + CLUSTERS_PER_CHUNK, Clusters.GetCount()) - firstCluster;
+
+    uint32_t visibleClusterMask = 0;
+    for (size_t clusterOffset = 0; clusterOffset < clusterCount; clusterOffset++)
+    {
+        if (IsClusterVisible(Clusters[firstCluster + clusterOffset], view, inOutBackfaceCulledCount, inOutFrustumCulledCount))
+        {
+            visibleClusterMask |= 1u << clusterOffset;
+        }
+    }
+    return visibleClusterMask;
+}
+
+bool MeshBvh::Raycast(const Mesh& mesh, const Vector3& origin, const Vector3& direction, RaycastHit& outHit) const
+{
+    if (IsEmpty())
+    {
+        return false;
+    }
+
+    const Vector3 inverseDirection = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+    const size_t triangleCount = mesh.GetTriangleCount();
+
+    float closestDistance = INFINITY;
+    uint32_t closestTriangle = UINT32_MAX;
+
+    uint32_t stack[MAX_DEPTH + 1];
+    uint32_t stackSize = 0;
+    if (IntersectRayBox(origin, inverseDirection, Nodes[0].BoundsMin, Nodes[0].BoundsMax, closestDistance) != INFINITY)
+    {
+        stack[stackSize++] = 0;
+    }
+
+    while (stackSize > 0)
+    {
+        const Node& node = Nodes[stack[--stackSize]];
+        if (!node.IsLeaf())
+        {
+            // Visit the closest child first, so hits found there discard most of the other one.
+            const uint32_t children[2] = { static_cast<uint32_t>(&node - Nodes.GetData()) + 1, node.SecondChildOrFirstChunk };
+            float childDistances[2];
+            for (int childIndex = 0; childIndex < 2; childIndex++)
+            {
+                const Node& child = Nodes[children[childIndex]];
+                childDistances[childIndex] = IntersectRayBox(origin, inverseDirection, child.BoundsMin, child.BoundsMax, closestDistance);
+            }
+
+            const int closerChild = childDistances[1] < childDistances[0] ? 1 : 0;
+            if (childDistances[1 - closerChild] != INFINITY)
+            {
+                stack[stackSize++] = children[1 - closerChild];
+            }
+            if (childDistances[closerChild] != INFINITY)
+            {
+                stack[stackSize++] = children[closerChild];
+            }
+            continue;
+        }
+
+        for (uint32_t orderIndex = node.SecondChildOrFirstChunk; orderIndex < node.SecondChildOrFirstChunk + node.ChunkCount; orderIndex++)
+        {
+            const uint32_t chunkIndex = ChunkOrder[orderIndex];
+            const Chunk& chunk = Chunks[chunkIndex];
+            if (IntersectRayBox(origin, inverseDirection, chunk.BoundsMin, chunk.BoundsMax, closestDistance) == INFINITY)
+            {
+                continue;
+            }
+
+            // Moller-Trumbore intersection. The determinant is positive for counter-clockwise triangles seen from the ray's origin.
+            const size_t endTriangle = std::min(static_cast<size_t>(chunkIndex + 1) * TRIANGLES_PER_CHUNK, triangleCount);
+            for (size_t triangle = static_cast<size_t>(chunkIndex) * TRIANGLES_PER_CHUNK; triangle < endTriangle; triangle++)
+            {
+                const Vector3& p0 = mesh.Positions[mesh.Indices[triangle * 3 + 0]];
+                const Vector3& p1 = mesh.Positions[mesh.Indices[triangle * 3 + 1]];
+                const Vector3& p2 = mesh.Positions[mesh.Indices[triangle * 3 + 2]];
+
+                const Vector3 edge1 = p1 - p0;
+                const Vector3 edge2 = p2 - p0;
+                const Vector3 p = Cross(direction, edge2);
+                const float determinant = Dot(edge1, p);
+                if (!(determinant > 0.0f))
+                {
+                    continue;
+                }
+
+                const Vector3 toOrigin = origin - p0;
+                const float u = Dot(toOrigin, p);
+                if (u < 0.0f || u > determinant)
+                {
+                    continue;
+                }
+
+                const Vector3 q = Cross(toOrigin, edge1);
+                const float v = Dot(direction, q);
+                if (v < 0.0f || u + v > determinant)
+                {
+                    continue;
+                }
+
+                const float distance = Dot(edge2, q) / determinant;
+                if (distance >= 0.0f && distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    closestTriangle = static_cast<uint32_t>(triangle);
+                }
+            }
+        }
+    }
+
+    if (closestTriangle == UINT32_MAX)
+    {
+        return false;
+    }
+
+    outHit.TriangleIndex = closestTriangle;
+    outHit.Distance = closestDistance;
+    return true;
+}
@@ -0,0 +1,147 @@
+/*
+    Bounding volume hierarchy over chunks of mesh triangles, used to skip geometry outside of the view frustum every frame and to find
+    the triangle under the cursor with ray queries.
+    Chunks are runs of consecutive triangles of the index buffer, so culling keeps the triangle order the mesh optimizer produced, and
+    that order also makes their bounds tight. The tree is built top-down with a binned surface area heuristic then flattened depth-first
+    into an array of nodes, the first child of a node always directly following it.
+    Chunks are further split into clusters of triangles, each with a bounding sphere and a cone bounding its triangles' normals, so the
+    renderer can reject clusters facing away from the camera or outside of the view before transforming any of their vertices.
+*/
+
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+#include "JobSystem.h"
+
+/// @brief Result of a ray query against a mesh.
+struct RaycastHit
+{
+    // Index of the hit triangle within the mesh.
+    uint32_t TriangleIndex = UINT32_MAX;
+    // Distance along the ray, in multiples of the ray direction's length.
+    float Distance = 0.0f;
+};
+
+/// @brief Hierarchy of bounding boxes over a mesh's triangle chunks. Like meshes, its arrays can reference memory owned by
+/// another object such as a mapped cache file.
+struct MeshBvh
+{
+    // Amount of consecutive triangles grouped in a chunk. The last chunk of a mesh may hold less.
+    static constexpr uint32_t TRIANGLES_PER_CHUNK = 256;
+    // Amount of consecutive triangles grouped in a cluster. Divides TRIANGLES_PER_CHUNK, so chunks hold whole clusters.
+    static constexpr uint32_t TRIANGLES_PER_CLUSTER = 64;
+    static constexpr uint32_t CLUSTERS_PER_CHUNK = TRIANGLES_PER_CHUNK / TRIANGLES_PER_CLUSTER;
+
+    /// @brief Flattened tree node. 32 bytes, so two nodes share a cache line.
+    struct Node
+    {
+        Vector3 BoundsMin;
+        // Inner nodes: index of the second child (the first child is the next node). Leaves: index of their first entry in ChunkOrder.
+        uint32_t SecondChildOrFirstChunk;
+        Vector3 BoundsMax;
+        // Amount of chunks in a leaf, 0 for inner nodes.
+        uint32_t ChunkCount;
+
+        inline bool IsLeaf() const { return ChunkCount != 0; }
+    };
+
+    /// @brief Bounds of a chunk of triangles, and the range of vertices its triangles use.
+    struct Chunk
+    {
+        Vector3 BoundsMin;
+        uint32_t FirstVertex;
+        Vector3 BoundsMax;
+        // One past the highest vertex index the chunk uses.
+        uint32_t EndVertex;
+    };
+
+    /// @brief Bounding sphere and normal cone of a cluster of triangles, and the range of vertices its triangles use.
+    struct Cluster
+    {
+        Vector3 Center;
+        float Radius;
+        // Average normal of the cluster's triangles, and the sine of the largest angle between it and any of their normals. Clusters whose
+        // normals spread over a half space or more can never be backface culled, and get a cutoff above 1.
+        Vector3 ConeAxis;
+        float ConeCutoff;
+        uint32_t FirstVertex;
+        // One past the highest vertex index the cluster uses.
+        uint32_t EndVertex;
+    };
+
+    /// @brief Camera data clusters get culled against, computed once per frame.
+    struct ClusterCullingView
+    {
+        // Frustum planes as (normal x, y, z, distance), normals being of unit length and pointing inside.
+        float FrustumPlanes[6][4];
+        Vector3 CameraPosition;
+    };
+
+    /// @brief Figures about a built hierarchy.
+    struct BuildStatistics
+    {
+        uint32_t ChunkCount = 0;
+        uint32_t NodeCount = 0;
+        uint32_t LeafCount = 0;
+        uint32_t Depth = 0;
+    };
+
+    // Root first. Empty when the mesh has no triangles.
+    MeshBuffer<Node> Nodes;
+    // Chunks in mesh order: chunk i holds triangles [i * TRIANGLES_PER_CHUNK, (i + 1) * TRIANGLES_PER_CHUNK).
+    MeshBuffer<Chunk> Chunks;
+    // Chunk indices, grouped by leaf.
+    MeshBuffer<uint32_t> ChunkOrder;
+    // Clusters in mesh order: cluster i holds triangles [i * TRIANGLES_PER_CLUSTER, (i + 1) * TRIANGLES_PER_CLUSTER).
+    MeshBuffer<Cluster> Clusters;
+
+    inline bool IsEmpty() const { return Nodes.IsEmpty(); }
+    inline size_t GetChunkCount() const { return Chunks.GetCount(); }
+
+    /// @brief Builds the hierarchy over a mesh, replacing any previous one.
+    /// @param jobSystem Job system chunk bounds & subtrees are built across.
+    /// @return Figures about the built hierarchy.
+    BuildStatistics Build(const Mesh& mesh, JobSystem& jobSystem);
+
+    /// @brief Finds the chunks whose bounds intersect a view frustum.
+    /// @param viewProjection Matrix transforming mesh space to clip space, with clip space depth in [0, w].
+    /// @param outVisibleChunks Resized to the chunk count and filled with 1 for chunks in view, 0 for the others.
+    /// @return Amount of chunks in view.
+    size_t CullChunks(const Matrix4x4& viewProjection, std::vector<uint8_t>& outVisibleChunks) const;
+
+    /// @brief Computes the bounding sphere, normal cone and vertex range of a run of triangles, such as a cluster of the mesh or a simplified
+    /// level of one of its chunks.
+    /// @param indices Indices of the triangles, referencing the mesh's vertices.
+    static Cluster BuildCluster(const Mesh& mesh, const uint32_t* indices, size_t triangleCount);
+
+    /// @brief Prepares the data clusters get culled against for a camera.
+    /// @param viewProjection Matrix transforming mesh space to clip space, with clip space depth in [0, w].
+    /// @param cameraPosition Camera position in mesh space.
+    static ClusterCullingView ComputeClusterCullingView(const Matrix4x4& viewProjection, const Vector3& cameraPosition);
+
+    /// @brief Tells whether a cluster may be visible: false when all its triangles face away from the camera, or its bounds are outside of
+    /// the view frustum.
+    /// @param inOutBackfaceCulledCount Incremented if the cluster faces away from the camera.
+    /// @param inOutFrustumCulledCount Incremented if the cluster otherwise is outside of the view frustum.
+    static bool IsClusterVisible(const Cluster& cluster, const ClusterCullingView& view, uint32_t& inOutBackfaceCulledCount, uint32_t& inOutFrustumCulledCount);
+
+    /// @brief Culls the clusters of a chunk whose triangles all face away from the camera, or whose bounds are outside of the view frustum.
+    /// @param inOutBackfaceCulledCount Incremented for every cluster facing away from the camera.
+    /// @param inOutFrustumCulledCount Incremented for every other cluster outside of the view frustum.
+    /// @return Mask of the chunk's clusters that may be visible, bit i standing for the chunk's i-th cluster.
+    uint32_t CullChunkClusters(size_t chunkIndex, const ClusterCullingView& view, uint32_t& inOutBackfaceCulledCount, uint32_t& inOutFrustumCulledCount) const;
+
+    /// @brief Finds the closest front facing triangle hit by a ray. Back faces are ignored, as the renderer culls them.
+    /// @param mesh Mesh the hierarchy was built for.
+    /// @param origin Ray origin.
+    /// @param direction Ray direction. Does not need to be normalized.
+    /// @param outHit Filled with the closest hit, if any.
+    /// @return True if a triangle was hit.
+    bool Raycast(const Mesh& mesh, const Vector3& origin, const Vector3& direction, RaycastHit& outHit) const;
+};
+
+#endif // MESH_BVH_H
@@ -0,0 +1,306 @@
+#include "MeshCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+    const char CACHE_MAGIC[8] = "MVCACHE";
+    // Written in native byte order, so caches moved to a machine of the other byte order get rejected instead of misread.
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // Every section starts on a cache line boundary, which also satisfies the alignment of any element type.
+    const uint64_t SECTION_ALIGNMENT = 64;
+
+    const uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+    const uint64_t FNV_PRIME = 0x100000001B3ull;
+
+    enum class SectionType : uint32_t
+    {
+        POSITIONS = 1,
+        NORMALS = 2,
+        TEXCOORDS = 3,
+        INDICES = 4,
+        BVH_NODES = 5,
+        BVH_CHUNKS = 6,
+        BVH_CHUNK_ORDER = 7,
+        LOD_INDICES = 8,
+        LOD_LEVELS = 9,
+        BVH_CLUSTERS = 10
+    };
+
+    /// Location of one mesh buffer within the cache file.
+    struct CacheSection
+    {
+        uint32_t Type;
+        uint32_t ElementSize;
+        uint64_t Offset;
+        uint64_t Count;
+    };
+
+    const uint32_t MAX_SECTION_COUNT = 16;
+
+    /// Header at the start of every cache file. Sections follow it, in any order.
+    struct CacheHeader
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t ByteOrderMark;
+
+        uint64_t SourceHash;
+        uint64_t SourceSize;
+        uint64_t SourceModificationTime;
+
+        // Total size of the cache file, so truncated files get rejected.
+        uint64_t FileSize;
+
+        float BoundsMin[3];
+        float BoundsMax[3];
+
+        uint32_t SectionCount;
+        uint32_t ProcessingFlags;
+        CacheSection Sections[MAX_SECTION_COUNT];
+    };
+
+    static_assert(std::is_trivially_copyable<CacheHeader>::value, "Cache header is read & written as raw bytes.");
+
+    inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+        {
+            hash = (hash ^ bytes[byteIndex]) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    /// Lays out a non-empty mesh buffer as the next section of the file, remembering where its data comes from.
+    template<typename T>
+    void AddSection(CacheHeader& header, SectionType type, const MeshBuffer<T>& buffer, uint64_t& inOutFileSize, const void** outSectionData)
+    {
+        if (buffer.IsEmpty())
+        {
+            return;
+        }
+
+        outSectionData[header.SectionCount] = buffer.GetData();
+        CacheSection& section = header.Sections[header.SectionCount++];
+        section.Type = static_cast<uint32_t>(type);
+        section.ElementSize = sizeof(T);
+        section.Offset = AlignUp(inOutFileSize, SECTION_ALIGNMENT);
+        section.Count = buffer.GetCount();
+        inOutFileSize = section.Offset + section.Count * sizeof(T);
+    }
+
+    /// Makes a mesh buffer reference a section of the mapped cache, after checking the section fits within the file.
+    template<typename T>
+    bool ReferenceSection(const CacheSection& section, const std::shared_ptr<PlatformFileSystem::MappedFile>& file, MeshBuffer<T>& outBuffer)
+    {
+        const uint64_t fileSize = file->GetSize();
+        if (section.ElementSize != sizeof(T) || section.Offset % SECTION_ALIGNMENT != 0 || section.Offset < sizeof(CacheHeader)
+            || section.Offset > fileSize || section.Count > (fileSize - section.Offset) / sizeof(T))
+        {
+            return false;
+        }
+
+        outBuffer.Reference(reinterpret_cast<const T*>(file->GetData() + section.Offset), static_cast<size_t>(section.Count), file);
+        return true;
+    }
+}
+
+MeshCache::SourceKey MeshCache::ComputeSourceKey(const std::string& sourceFilePath, const PlatformFileSystem::FileInfo& sourceInfo,
+    uint32_t processingFlags)
+{
+    SourceKey key;
+    key.Size = sourceInfo.Size;
+    key.ModificationTime = sourceInfo.ModificationTime;
+    key.ProcessingFlags = processingFlags;
+
+    key.Hash = HashBytes(FNV_OFFSET_BASIS, sourceFilePath.data(), sourceFilePath.size());
+    key.Hash = HashBytes(key.Hash, &key.Size, sizeof(key.Size));
+    key.Hash = HashBytes(key.Hash, &key.ModificationTime, sizeof(key.ModificationTime));
+    key.Hash = HashBytes(key.Hash, &key.ProcessingFlags, sizeof(key.ProcessingFlags));
+    return key;
+}
+
+std::string MeshCache::GetCacheFilePath(const std::string& sourceFilePath, const std::string& cacheDirectoryPath)
+{
+    if (cacheDirectoryPath.empty())
+    {
+        return sourceFilePath + ".mvcache";
+    }
+
+    const size_t separatorPosition = sourceFilePath.find_last_of("/\\");
+    const std::string fileName = separatorPosition == std::string::npos ? sourceFilePath : sourceFilePath.substr(separatorPosition + 1);
+
+    char pathHash[24];
+    snprintf(pathHash, sizeof(pathHash), ".%016llx", static_cast<unsigned long long>(HashBytes(FNV_OFFSET_BASIS, sourceFilePath.data(), sourceFilePath.size())));
+
+    // Forward slashes are understood by every platform the Engine runs on.
+    const char lastCharacter = cacheDirectoryPath.back();
+    const bool bHasTrailingSeparator = lastCharacter == '/' || lastCharacter == '\\';
+    return cacheDirectoryPath + (bHasTrailingSeparator ? "" : "/") + fileName + pathHash + ".mvcache";
+}
+
+bool MeshCache::LoadMesh(const std::shared_ptr<PlatformFileSystem::MappedFile>& file, const SourceKey& expectedKey, Mesh& outMesh, MeshBvh& outBvh,
+    MeshLods& outLods, std::string& outError)
+{
+    CacheHeader header;
+    if (file->GetSize() < sizeof(header))
+    {
+        outError = "file is too small to be a model cache.";
+        return false;
+    }
+    memcpy(&header, file->GetData(), sizeof(header));
+
+    if (memcmp(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.ByteOrderMark != BYTE_ORDER_MARK)
+    {
+        outError = "file is not a model cache written by this platform.";
+        return false;
+    }
+    if (header.Version != FORMAT_VERSION)
+    {
+        outError = "cache was written by another version of the viewer.";
+        return false;
+    }
+    if (header.SourceHash != expectedKey.Hash || header.SourceSize != expectedKey.Size || header.SourceModificationTime != expectedKey.ModificationTime)
+    {
+        outError = header.ProcessingFlags != expectedKey.ProcessingFlags ? "cache was written with other load settings."
+            : "model file changed since the cache was written.";
+        return false;
+    }
+    if (header.FileSize != file->GetSize() || header.SectionCount > MAX_SECTION_COUNT)
+    {
+        outError = "cache file is truncated or corrupted.";
+        return false;
+    }
+
+    // #NOTE: Buffer contents, indices included, are trusted rather than validated. Checking them would mean touching every page of the
+    // file, which is exactly the cost this cache exists to avoid. The key and file size checks above already catch stale & truncated caches.
+    Mesh mesh;
+    MeshBvh bvh;
+    MeshLods lods;
+    bool bValid = true;
+    for (uint32_t sectionIndex = 0; sectionIndex < header.SectionCount && bValid; sectionIndex++)
+    {
+        const CacheSection& section = header.Sections[sectionIndex];
+        switch (static_cast<SectionType>(section.Type))
+        {
+            case SectionType::POSITIONS:
+                bValid = ReferenceSection(section, file, mesh.Positions);
+                break;
+            case SectionType::NORMALS:
+                bValid = ReferenceSection(section, file, mesh.Normals);
+                break;
+            case SectionType::TEXCOORDS:
+                bValid = ReferenceSection(section, file, mesh.TexCoords);
+                break;
+            case SectionType::INDICES:
+                bValid = ReferenceSection(section, file, mesh.Indices);
+                break;
+            case SectionType::BVH_NODES:
+                bValid = ReferenceSection(section, file, bvh.Nodes);
+                break;
+            case SectionType::BVH_CHUNKS:
+                bValid = ReferenceSection(section, file, bvh.Chunks);
+                break;
+            case SectionType::BVH_CHUNK_ORDER:
+                bValid = ReferenceSection(section, file, bvh.ChunkOrder);
+                break;
+            case SectionType::BVH_CLUSTERS:
+                bValid = ReferenceSection(section, file, bvh.Clusters);
+                break;
+            case SectionType::LOD_INDICES:
+                bValid = ReferenceSection(section, file, lods.Indices);
+                break;
+            case SectionType::LOD_LEVELS:
+                bValid = ReferenceSection(section, file, lods.Levels);
+                break;
+            default:
+                bValid = false;
+                break;
+        }
+    }
+
+    const size_t vertexCount = mesh.GetVertexCount();
+    const size_t chunkCount = (mesh.GetTriangleCount() + MeshBvh::TRIANGLES_PER_CHUNK - 1) / MeshBvh::TRIANGLES_PER_CHUNK;
+    const size_t clusterCount = (mesh.GetTriangleCount() + MeshBvh::TRIANGLES_PER_CLUSTER - 1) / MeshBvh::TRIANGLES_PER_CLUSTER;
+    if (!bValid || vertexCount > UINT32_MAX || mesh.Indices.GetCount() % 3 != 0
+        || (!mesh.Normals.IsEmpty() && mesh.Normals.GetCount() != vertexCount)
+        || (!mesh.TexCoords.IsEmpty() && mesh.TexCoords.GetCount() != vertexCount)
+        || (!bvh.IsEmpty() && (bvh.GetChunkCount() != chunkCount || bvh.ChunkOrder.GetCount() != chunkCount || bvh.Clusters.GetCount() != clusterCount))
+        || (!lods.IsEmpty() && (bvh.IsEmpty() || lods.Levels.GetCount() != chunkCount * MeshLods::LEVEL_COUNT)))
+    {
+        outError = "cache file is truncated or corrupted.";
+        return false;
+    }
+
+    mesh.Bounds.Min = Vector3{ header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2] };
+    mesh.Bounds.Max = Vector3{ header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2] };
+
+    outMesh = std::move(mesh);
+    outBvh = std::move(bvh);
+    outLods = std::move(lods);
+    return true;
+}
+
+bool MeshCache::WriteMesh(PlatformFileSystem::FileWriter& writer, const SourceKey& key, const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods)
+{
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.Version = FORMAT_VERSION;
+    header.ByteOrderMark = BYTE_ORDER_MARK;
+    header.SourceHash = key.Hash;
+    header.SourceSize = key.Size;
+    header.SourceModificationTime = key.ModificationTime;
+    header.ProcessingFlags = key.ProcessingFlags;
+
+    header.BoundsMin[0] = mesh.Bounds.Min.x;
+    header.BoundsMin[1] = mesh.Bounds.Min.y;
+    header.BoundsMin[2] = mesh.Bounds.Min.z;
+    header.BoundsMax[0] = mesh.Bounds.Max.x;
+    header.BoundsMax[1] = mesh.Bounds.Max.y;
+    header.BoundsMax[2] = mesh.Bounds.Max.z;
+
+    const void* sectionData[MAX_SECTION_COUNT];
+    uint64_t fileSize = sizeof(header);
+    AddSection(header, SectionType::POSITIONS, mesh.Positions, fileSize, sectionData);
+    AddSection(header, SectionType::NORMALS, mesh.Normals, fileSize, sectionData);
+    AddSection(header, SectionType::TEXCOORDS, mesh.TexCoords, fileSize, sectionData);
+    AddSection(header, SectionType::INDICES, mesh.Indices, fileSize, sectionData);
+    AddSection(header, SectionType::BVH_NODES, bvh.Nodes, fileSize, sectionData);
+    AddSection(header, SectionType::BVH_CHUNKS, bvh.Chunks, fileSize, sectionData);
+    AddSection(header, SectionType::BVH_CHUNK_ORDER, bvh.ChunkOrder, fileSize, sectionData);
+    AddSection(header, SectionType::BVH_CLUSTERS, bvh.Clusters, fileSize, sectionData);
+    AddSection(header, SectionType::LOD_INDICES, lods.Indices, fileSize, sectionData);
+    AddSection(header, SectionType::LOD_LEVELS, lods.Levels, fileSize, sectionData);
+    header.FileSize = fileSize;
+
+    if (!writer.Write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)))
+    {
+        return false;
+    }
+
+    // Sections were laid out in the order they get written, so only alignment padding sits between them.
+    const uint8_t padding[SECTION_ALIGNMENT] = {};
+    uint64_t writtenSize = sizeof(header);
+    for (uint32_t sectionIndex = 0; sectionIndex < header.SectionCount; sectionIndex++)
+    {
+        const CacheSection& section = header.Sections[sectionIndex];
+        if (!writer.Write(padding, static_cast<size_t>(section.Offset - writtenSize))
+            || !writer.Write(static_cast<const uint8_t*>(sectionData[sectionIndex]), static_cast<size_t>(section.Count * section.ElementSize)))
+        {
+            return false;
+        }
+        writtenSize = section.Offset + section.Count * section.ElementSize;
+    }
+
+    return true;
+}
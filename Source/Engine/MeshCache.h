@@ -0,0 +1,65 @@
+/*
+    Preprocessed binary mesh cache (.mvcache). Once a model has been loaded from its source format, its final mesh buffers, bounding volume
+    hierarchy and levels of detail get written to a cache file laid out so that a later launch can map it read-only and render straight from the mapping, without parsing anything.
+    Caches are keyed by the source file's path, size and modification time, so editing or replacing the source invalidates its cache.
+*/
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "MeshLod.h"
+#include "Platform.h"
+
+namespace MeshCache
+{
+    /// @brief Bumped whenever the cache layout or the output of any loader changes, so caches written by older builds get rebuilt.
+    constexpr uint32_t FORMAT_VERSION = 6;
+
+    /// @brief Identity of the source file a cache was built from.
+    struct SourceKey
+    {
+        // Hash of the source path, size & modification time.
+        uint64_t Hash = 0;
+        uint64_t Size = 0;
+        uint64_t ModificationTime = 0;
+        // Flags describing how the mesh was processed after loading (see ModelLoader.cpp), so changing load settings rebuilds caches.
+        uint32_t ProcessingFlags = 0;
+    };
+
+    /// @brief Builds the key of a source file from its path (as passed, not canonicalized), metadata and processing flags.
+    SourceKey ComputeSourceKey(const std::string& sourceFilePath, const PlatformFileSystem::FileInfo& sourceInfo, uint32_t processingFlags);
+
+    /// @brief Returns the path of the cache file of a source file.
+    /// @param sourceFilePath Path to the source model file.
+    /// @param cacheDirectoryPath Directory caches are kept in. When empty, the cache sits next to the source file.
+    /// Caches in a shared directory get the source path's hash in their name, so same-named models from different directories don't collide.
+    std::string GetCacheFilePath(const std::string& sourceFilePath, const std::string& cacheDirectoryPath);
+
+    /// @brief Makes a mesh, its hierarchy and its levels of detail reference the buffers of a mapped cache file in place. Only the header is read: buffer contents are trusted.
+    /// @param file Mapped cache file. The mesh, hierarchy & levels keep it alive for as long as they reference it.
+    /// @param expectedKey Key of the current source file. Caches built from another version of the source are rejected.
+    /// @param outMesh Mesh to fill.
+    /// @param outBvh Hierarchy to fill. Left empty if the cached mesh has none.
+    /// @param outLods Levels of detail to fill. Left empty if the cached mesh has none.
+    /// @param outError Filled with the reason the cache was rejected.
+    /// @return True if the mesh now references the cache, false if the cache is stale or invalid and should be rebuilt.
+    bool LoadMesh(const std::shared_ptr<PlatformFileSystem::MappedFile>& file, const SourceKey& expectedKey, Mesh& outMesh, MeshBvh& outBvh,
+        MeshLods& outLods, std::string& outError);
+
+    /// @brief Writes a mesh, its hierarchy and its levels of detail as a cache file.
+    /// @param writer Writer of the new cache file, positioned at its start. Not committed.
+    /// @param key Key of the source file the mesh was loaded from.
+    /// @param mesh Mesh to write.
+    /// @param bvh Hierarchy built over the mesh. May be empty.
+    /// @param lods Levels of detail of the hierarchy's chunks. May be empty.
+    /// @return True if every byte was written.
+    bool WriteMesh(PlatformFileSystem::FileWriter& writer, const SourceKey& key, const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods);
+}
+
+#endif // MESH_CACHE_H
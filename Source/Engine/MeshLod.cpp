@@ -0,0 +1,468 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <vector>
+
+namespace
+{
+    // Chunks simplified by a single job, reusing the same simplifier storage.
+    const uint32_t CHUNKS_PER_JOB = 16;
+
+    // Collapses are rejected when they would turn any remaining triangle by more than about 78 degrees, which catches fold-overs.
+    const float MIN_NORMAL_COSINE = 0.2f;
+
+    // Collapses are also rejected when they would turn any remaining triangle by more than about 25 degrees from its original orientation in
+    // total. Faces are flat shaded, so slivers left along locked borders, where successive collapses turn triangles a little at a time,
+    // otherwise show as dark or bright specks.
+    const float MAX_NORMAL_DEVIATION_COSINE = 0.9f;
+
+    // Share of the previous level's triangles a level must remove to be kept. Chunks stop at the first level that removes less, mostly chunks
+    // whose vertices are nearly all locked, as coarser levels would barely differ from the previous one.
+    const float MIN_LEVEL_REDUCTION = 0.2f;
+
+    /// Symmetric 4x4 matrix evaluating the sum of squared distances of a point to a set of planes: Q(p) = sum((n . p + d)^2).
+    /// Accumulated in double precision, as sums of many planes cancel out a lot.
+    struct Quadric
+    {
+        double A2 = 0.0, AB = 0.0, AC = 0.0, AD = 0.0;
+        double B2 = 0.0, BC = 0.0, BD = 0.0;
+        double C2 = 0.0, CD = 0.0;
+        double D2 = 0.0;
+
+        void AddPlane(double a, double b, double c, double d)
+        {
+            A2 += a * a; AB += a * b; AC += a * c; AD += a * d;
+            B2 += b * b; BC += b * c; BD += b * d;
+            C2 += c * c; CD += c * d;
+            D2 += d * d;
+        }
+
+        void Add(const Quadric& other)
+        {
+            A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+            B2 += other.B2; BC += other.BC; BD += other.BD;
+            C2 += other.C2; CD += other.CD;
+            D2 += other.D2;
+        }
+
+        double Evaluate(const Vector3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            return A2 * x * x + B2 * y * y + C2 * z * z + D2
+                + 2.0 * (AB * x * y + AC * x * z + BC * y * z + AD * x + BD * y + CD * z);
+        }
+    };
+
+    /// Candidate half-edge collapse: vertex From moves onto vertex To. Stale once either vertex changed since it was evaluated.
+    struct Collapse
+    {
+        double Cost;
+        uint32_t From;
+        uint32_t To;
+        uint32_t FromVersion;
+        uint32_t ToVersion;
+
+        bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+    };
+
+    /// Simplifies chunks one at a time, keeping its storage from one chunk to the next.
+    class ChunkSimplifier
+    {
+    public:
+
+        /// Simplifies the triangles of a chunk into successive levels, stopping at the first level that doesn't remove enough triangles.
+        /// @param outLevelIndices Filled with the triangles (as mesh vertex indices) of each simplified level.
+        /// @param outLevelErrors Filled with the error of each simplified level, in mesh units.
+        /// @return Amount of simplified levels filled, from 0 to LEVEL_COUNT.
+        uint32_t Simplify(const Mesh& mesh, const uint32_t* indices, uint32_t triangleCount, std::vector<uint32_t>* outLevelIndices, float* outLevelErrors)
+        {
+            LoadChunk(mesh, indices, triangleCount);
+
+            double maxCost = 0.0;
+            uint32_t previousTriangleCount = triangleCount;
+            for (uint32_t level = 1; level <= MeshLods::LEVEL_COUNT; level++)
+            {
+                const uint32_t targetTriangleCount = std::max<uint32_t>(triangleCount >> level, 1);
+                while (m_aliveTriangleCount > targetTriangleCount && !m_collapses.empty())
+                {
+                    const Collapse collapse = m_collapses.top();
+                    m_collapses.pop();
+                    if (!m_bVertexAlive[collapse.From] || !m_bVertexAlive[collapse.To] || m_vertexVersions[collapse.From] != collapse.FromVersion
+                        || m_vertexVersions[collapse.To] != collapse.ToVersion || !CanCollapse(collapse.From, collapse.To))
+                    {
+                        continue;
+                    }
+
+                    ApplyCollapse(collapse.From, collapse.To);
+                    maxCost = std::max(maxCost, collapse.Cost);
+                }
+
+                if (m_aliveTriangleCount > previousTriangleCount * (1.0f - MIN_LEVEL_REDUCTION))
+                {
+                    return level - 1;
+                }
+                previousTriangleCount = m_aliveTriangleCount;
+
+                std::vector<uint32_t>& levelIndices = outLevelIndices[level - 1];
+                levelIndices.clear();
+                for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+                {
+                    if (m_bTriangleAlive[triangle])
+                    {
+                        for (int corner = 0; corner < 3; corner++)
+                        {
+                            levelIndices.push_back(m_meshVertices[m_triangles[triangle * 3 + corner]]);
+                        }
+                    }
+                }
+                outLevelErrors[level - 1] = static_cast<float>(std::sqrt(std::max(maxCost, 0.0)));
+            }
+            return MeshLods::LEVEL_COUNT;
+        }
+
+    private:
+
+        /// Builds the chunk's local vertices, quadrics, adjacency and initial collapse candidates.
+        void LoadChunk(const Mesh& mesh, const uint32_t* indices, uint32_t triangleCount)
+        {
+            // Local vertices are the chunk's distinct mesh vertices, in ascending order.
+            m_meshVertices.assign(indices, indices + triangleCount * 3);
+            std::sort(m_meshVertices.begin(), m_meshVertices.end());
+            m_meshVertices.erase(std::unique(m_meshVertices.begin(), m_meshVertices.end()), m_meshVertices.end());
+            const uint32_t vertexCount = static_cast<uint32_t>(m_meshVertices.size());
+
+            m_triangles.resize(triangleCount * 3);
+            for (uint32_t index = 0; index < triangleCount * 3; index++)
+            {
+                m_triangles[index] = static_cast<uint32_t>(std::lower_bound(m_meshVertices.begin(), m_meshVertices.end(), indices[index]) - m_meshVertices.begin());
+            }
+            m_bTriangleAlive.assign(triangleCount, 1);
+            m_aliveTriangleCount = triangleCount;
+            m_triangleNormals.resize(triangleCount);
+
+            m_positions.resize(vertexCount);
+            for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+            {
+                m_positions[vertex] = mesh.Positions[m_meshVertices[vertex]];
+            }
+            m_quadrics.assign(vertexCount, Quadric());
+            m_bVertexAlive.assign(vertexCount, 1);
+            m_bVertexLocked.assign(vertexCount, 0);
+            m_vertexVersions.assign(vertexCount, 0);
+            if (m_vertexTriangles.size() < vertexCount)
+            {
+                m_vertexTriangles.resize(vertexCount);
+            }
+            for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+            {
+                m_vertexTriangles[vertex].clear();
+            }
+
+            m_edges.clear();
+            for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+            {
+                const uint32_t* corners = &m_triangles[triangle * 3];
+                const Vector3 normal = Cross(m_positions[corners[1]] - m_positions[corners[0]], m_positions[corners[2]] - m_positions[corners[0]]);
+                const float length = Length(normal);
+                const Vector3 unitNormal = length > 0.0f ? normal * (1.0f / length) : Vector3{ 0.0f, 0.0f, 0.0f };
+                m_triangleNormals[triangle] = unitNormal;
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    if (length > 0.0f)
+                    {
+                        m_quadrics[corners[corner]].AddPlane(unitNormal.x, unitNormal.y, unitNormal.z, -Dot(unitNormal, m_positions[corners[0]]));
+                    }
+                    m_vertexTriangles[corners[corner]].push_back(triangle);
+
+                    const uint32_t a = corners[corner];
+                    const uint32_t b = corners[(corner + 1) % 3];
+                    m_edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+                }
+            }
+
+            // Edges not shared by exactly two triangles of the chunk are borders: chunk borders, mesh borders or seams. Their vertices stay put.
+            std::sort(m_edges.begin(), m_edges.end());
+            for (size_t edgeIndex = 0; edgeIndex < m_edges.size();)
+            {
+                size_t edgeEnd = edgeIndex + 1;
+                while (edgeEnd < m_edges.size() && m_edges[edgeEnd] == m_edges[edgeIndex])
+                {
+                    edgeEnd++;
+                }
+                if (edgeEnd - edgeIndex != 2)
+                {
+                    m_bVertexLocked[m_edges[edgeIndex].first] = 1;
+                    m_bVertexLocked[m_edges[edgeIndex].second] = 1;
+                }
+                edgeIndex = edgeEnd;
+            }
+
+            m_collapses = std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>();
+            for (size_t edgeIndex = 0; edgeIndex < m_edges.size(); edgeIndex++)
+            {
+                if (edgeIndex > 0 && m_edges[edgeIndex] == m_edges[edgeIndex - 1])
+                {
+                    continue;
+                }
+                PushCollapse(m_edges[edgeIndex].first, m_edges[edgeIndex].second);
+                PushCollapse(m_edges[edgeIndex].second, m_edges[edgeIndex].first);
+            }
+        }
+
+        void PushCollapse(uint32_t from, uint32_t to)
+        {
+            if (m_bVertexLocked[from])
+            {
+                return;
+            }
+
+            Quadric quadric = m_quadrics[from];
+            quadric.Add(m_quadrics[to]);
+            m_collapses.push(Collapse{ quadric.Evaluate(m_positions[to]), from, to, m_vertexVersions[from], m_vertexVersions[to] });
+        }
+
+        inline bool TriangleHasVertex(uint32_t triangle, uint32_t vertex) const
+        {
+            return m_triangles[triangle * 3] == vertex || m_triangles[triangle * 3 + 1] == vertex || m_triangles[triangle * 3 + 2] == vertex;
+        }
+
+        /// Collects the vertices sharing a remaining triangle with a vertex, sorted.
+        void GatherNeighbors(uint32_t vertex, std::vector<uint32_t>& outNeighbors) const
+        {
+            outNeighbors.clear();
+            for (uint32_t triangle : m_vertexTriangles[vertex])
+            {
+                if (!m_bTriangleAlive[triangle])
+                {
+                    continue;
+                }
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    if (m_triangles[triangle * 3 + corner] != vertex)
+                    {
+                        outNeighbors.push_back(m_triangles[triangle * 3 + corner]);
+                    }
+                }
+            }
+            std::sort(outNeighbors.begin(), outNeighbors.end());
+            outNeighbors.erase(std::unique(outNeighbors.begin(), outNeighbors.end()), outNeighbors.end());
+        }
+
+        /// Checks a collapse keeps the surface a manifold (link condition), and doesn't fold any remaining triangle over or turn it too far from
+        /// its original orientation.
+        bool CanCollapse(uint32_t from, uint32_t to)
+        {
+            uint32_t sharedTriangleCount = 0;
+            for (uint32_t triangle : m_vertexTriangles[from])
+            {
+                if (m_bTriangleAlive[triangle] && TriangleHasVertex(triangle, to))
+                {
+                    sharedTriangleCount++;
+                }
+            }
+
+            // Vertices adjacent to both ends of the edge must be the opposite corners of its triangles, or the collapse pinches the surface.
+            GatherNeighbors(from, m_fromNeighbors);
+            GatherNeighbors(to, m_toNeighbors);
+            uint32_t commonNeighborCount = 0;
+            for (size_t fromIndex = 0, toIndex = 0; fromIndex < m_fromNeighbors.size() && toIndex < m_toNeighbors.size();)
+            {
+                if (m_fromNeighbors[fromIndex] < m_toNeighbors[toIndex])
+                {
+                    fromIndex++;
+                }
+                else if (m_fromNeighbors[fromIndex] > m_toNeighbors[toIndex])
+                {
+                    toIndex++;
+                }
+                else
+                {
+                    commonNeighborCount++;
+                    fromIndex++;
+                    toIndex++;
+                }
+            }
+            if (commonNeighborCount > sharedTriangleCount)
+            {
+                return false;
+            }
+
+            for (uint32_t triangle : m_vertexTriangles[from])
+            {
+                if (!m_bTriangleAlive[triangle] || TriangleHasVertex(triangle, to))
+                {
+                    continue;
+                }
+
+                Vector3 corners[3];
+                Vector3 movedCorners[3];
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex = m_triangles[triangle * 3 + corner];
+                    corners[corner] = m_positions[vertex];
+                    movedCorners[corner] = m_positions[vertex == from ? to : vertex];
+                }
+                const Vector3 normal = Cross(corners[1] - corners[0], corners[2] - corners[0]);
+                const Vector3 movedNormal = Cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+                const float movedLength = Length(movedNormal);
+                const Vector3& originalNormal = m_triangleNormals[triangle];
+                if (Dot(normal, movedNormal) < MIN_NORMAL_COSINE * Length(normal) * movedLength || movedLength == 0.0f
+                    || (Dot(originalNormal, originalNormal) > 0.0f && Dot(originalNormal, movedNormal) < MAX_NORMAL_DEVIATION_COSINE * movedLength))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void ApplyCollapse(uint32_t from, uint32_t to)
+        {
+            for (uint32_t triangle : m_vertexTriangles[from])
+            {
+                if (!m_bTriangleAlive[triangle])
+                {
+                    continue;
+                }
+
+                if (TriangleHasVertex(triangle, to))
+                {
+                    m_bTriangleAlive[triangle] = 0;
+                    m_aliveTriangleCount--;
+                }
+                else
+                {
+                    for (int corner = 0; corner < 3; corner++)
+                    {
+                        if (m_triangles[triangle * 3 + corner] == from)
+                        {
+                            m_triangles[triangle * 3 + corner] = to;
+                        }
+                    }
+                    m_vertexTriangles[to].push_back(triangle);
+                }
+            }
+
+            m_bVertexAlive[from] = 0;
+            m_quadrics[to].Add(m_quadrics[from]);
+            m_vertexVersions[to]++;
+
+            // Every collapse into or out of the moved onto vertex changed cost.
+            GatherNeighbors(to, m_toNeighbors);
+            for (uint32_t neighbor : m_toNeighbors)
+            {
+                PushCollapse(neighbor, to);
+                PushCollapse(to, neighbor);
+            }
+        }
+
+        // Chunk's distinct mesh vertices, indexed by local vertex.
+        std::vector<uint32_t> m_meshVertices;
+        std::vector<Vector3> m_positions;
+        std::vector<Quadric> m_quadrics;
+        std::vector<uint8_t> m_bVertexAlive;
+        std::vector<uint8_t> m_bVertexLocked;
+        std::vector<uint32_t> m_vertexVersions;
+        // Triangles using each local vertex. May hold dead triangles, and triangles that moved to another vertex.
+        std::vector<std::vector<uint32_t>> m_vertexTriangles;
+
+        // Chunk triangles, as local vertices.
+        std::vector<uint32_t> m_triangles;
+        std::vector<uint8_t> m_bTriangleAlive;
+        // Unit normal of every triangle before simplification, zero for degenerate ones.
+        std::vector<Vector3> m_triangleNormals;
+        uint32_t m_aliveTriangleCount = 0;
+
+        std::vector<std::pair<uint32_t, uint32_t>> m_edges;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_collapses;
+
+        // Scratch neighbor lists.
+        std::vector<uint32_t> m_fromNeighbors;
+        std::vector<uint32_t> m_toNeighbors;
+    };
+}
+
+MeshLods::BuildStatistics MeshLods::Build(const Mesh& mesh, const MeshBvh& bvh, JobSystem& jobSystem)
+{
+    BuildStatistics statistics;
+    Indices = MeshBuffer<uint32_t>();
+    Levels = MeshBuffer<ChunkLevel>();
+
+    const uint32_t triangleCount = static_cast<uint32_t>(mesh.GetTriangleCount());
+    const uint32_t chunkCount = static_cast<uint32_t>(bvh.GetChunkCount());
+    statistics.LevelTriangleCounts[0] = triangleCount;
+    if (chunkCount == 0)
+    {
+        return statistics;
+    }
+
+    std::vector<std::vector<uint32_t>> chunkLevelIndices(static_cast<size_t>(chunkCount) * LEVEL_COUNT);
+    std::vector<float> chunkLevelErrors(static_cast<size_t>(chunkCount) * LEVEL_COUNT);
+    std::vector<MeshBvh::Cluster> chunkLevelBounds(static_cast<size_t>(chunkCount) * LEVEL_COUNT);
+    std::vector<uint32_t> chunkSimplifiedLevelCounts(chunkCount);
+    jobSystem.ParallelFor((chunkCount + CHUNKS_PER_JOB - 1) / CHUNKS_PER_JOB, [&](uint32_t jobIndex)
+    {
+        ChunkSimplifier simplifier;
+        const uint32_t endChunk = std::min((jobIndex + 1) * CHUNKS_PER_JOB, chunkCount);
+        for (uint32_t chunkIndex = jobIndex * CHUNKS_PER_JOB; chunkIndex < endChunk; chunkIndex++)
+        {
+            const uint32_t firstTriangle = chunkIndex * MeshBvh::TRIANGLES_PER_CHUNK;
+            const uint32_t chunkTriangleCount = std::min(firstTriangle + MeshBvh::TRIANGLES_PER_CHUNK, triangleCount) - firstTriangle;
+            chunkSimplifiedLevelCounts[chunkIndex] = simplifier.Simplify(mesh, mesh.Indices.GetData() + firstTriangle * size_t(3), chunkTriangleCount,
+                &chunkLevelIndices[static_cast<size_t>(chunkIndex) * LEVEL_COUNT], &chunkLevelErrors[static_cast<size_t>(chunkIndex) * LEVEL_COUNT]);
+            for (uint32_t level = 1; level <= chunkSimplifiedLevelCounts[chunkIndex]; level++)
+            {
+                const std::vector<uint32_t>& levelIndices = chunkLevelIndices[static_cast<size_t>(chunkIndex) * LEVEL_COUNT + level - 1];
+                chunkLevelBounds[static_cast<size_t>(chunkIndex) * LEVEL_COUNT + level - 1] = MeshBvh::BuildCluster(mesh, levelIndices.data(), levelIndices.size() / 3);
+            }
+        }
+    });
+
+    // Lay levels out level-major, so chunks drawn at the same level next to each other read contiguous triangles. Levels a chunk stopped
+    // before repeat its last level rather than storing a copy of it: right after level 0 they keep the chunk's own triangle count, which the
+    // renderer draws at full detail, otherwise they share the previous level's triangles.
+    std::vector<uint32_t> indices;
+    std::vector<ChunkLevel> levels(static_cast<size_t>(chunkCount) * LEVEL_COUNT);
+    for (uint32_t level = 1; level <= LEVEL_COUNT; level++)
+    {
+        for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+        {
+            const size_t levelIndex = static_cast<size_t>(chunkIndex) * LEVEL_COUNT + level - 1;
+            ChunkLevel& chunkLevel = levels[levelIndex];
+            if (level > chunkSimplifiedLevelCounts[chunkIndex])
+            {
+                if (level > 1)
+                {
+                    chunkLevel = levels[levelIndex - 1];
+                }
+                else
+                {
+                    const uint32_t firstTriangle = chunkIndex * MeshBvh::TRIANGLES_PER_CHUNK;
+                    const uint32_t chunkTriangleCount = std::min(firstTriangle + MeshBvh::TRIANGLES_PER_CHUNK, triangleCount) - firstTriangle;
+                    chunkLevel = ChunkLevel{ 0, chunkTriangleCount, 0.0f,
+                        MeshBvh::BuildCluster(mesh, mesh.Indices.GetData() + firstTriangle * size_t(3), chunkTriangleCount) };
+                }
+            }
+            else
+            {
+                const std::vector<uint32_t>& levelIndices = chunkLevelIndices[levelIndex];
+                chunkLevel.FirstTriangle = static_cast<uint32_t>(indices.size() / 3);
+                chunkLevel.TriangleCount = static_cast<uint32_t>(levelIndices.size() / 3);
+                chunkLevel.Error = chunkLevelErrors[levelIndex];
+                chunkLevel.Bounds = chunkLevelBounds[levelIndex];
+                indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+                statistics.BuiltLevelCount = std::max(statistics.BuiltLevelCount, level);
+            }
+            statistics.LevelTriangleCounts[level] += chunkLevel.TriangleCount;
+        }
+    }
+    for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        statistics.StoppedChunkCount += chunkSimplifiedLevelCounts[chunkIndex] < LEVEL_COUNT ? 1 : 0;
+    }
+
+    Indices = std::move(indices);
+    Levels = std::move(levels);
+    return statistics;
+}
@@ -0,0 +1,67 @@
+/*
+    Levels of detail of a mesh, built per chunk of its bounding volume hierarchy (see MeshBvh.h) by quadric error metric edge collapse
+    (Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997).
+    Each chunk gets simplified on its own, its border edges locked so neighboring chunks drawn at different levels never crack apart. Open edges
+    (mesh borders, UV & normal seams where vertices get split) are locked the same way. Simplified triangles only reference existing vertices,
+    so levels share the mesh's vertex buffers. Every level comes with the geometric error it introduced, which the renderer projects to the
+    screen each frame to pick the coarsest level of every chunk that still looks like the full detail one.
+*/
+
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <cstdint>
+
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "JobSystem.h"
+
+/// @brief Simplified levels of every chunk of a mesh. Like meshes, its arrays can reference memory owned by another object such as a mapped
+/// cache file.
+struct MeshLods
+{
+    // Simplified levels per chunk, on top of the full detail one (level 0). Each level aims for half the triangles of the previous one, and
+    // chunks stop at the first level that removes too few of them.
+    static constexpr uint32_t LEVEL_COUNT = 4;
+
+    /// @brief Triangles of a chunk at a simplified level.
+    struct ChunkLevel
+    {
+        // Range of Indices holding the level's triangles, as triangle offsets.
+        uint32_t FirstTriangle;
+        uint32_t TriangleCount;
+        // Largest distance from the full detail surface introduced by simplification, in mesh units.
+        float Error;
+        // Bounding sphere, normal cone and vertex range of the level's triangles, so the renderer culls simplified chunks like clusters.
+        MeshBvh::Cluster Bounds;
+    };
+
+    /// @brief Figures about built levels.
+    struct BuildStatistics
+    {
+        // Triangles of all chunks at every level, level 0 being the full detail mesh.
+        uint64_t LevelTriangleCounts[LEVEL_COUNT + 1] = {};
+        // Coarsest level any chunk got simplified into.
+        uint32_t BuiltLevelCount = 0;
+        // Chunks which stopped short of LEVEL_COUNT levels, their next level not removing enough triangles. Their remaining levels repeat
+        // their last one.
+        uint32_t StoppedChunkCount = 0;
+    };
+
+    // Simplified triangles of every level, level-major: all chunks' level 1 triangles in chunk order, then level 2's, and so on.
+    MeshBuffer<uint32_t> Indices;
+    // Simplified levels of chunk c: Levels[c * LEVEL_COUNT + level - 1].
+    MeshBuffer<ChunkLevel> Levels;
+
+    inline bool IsEmpty() const { return Levels.IsEmpty(); }
+
+    inline const ChunkLevel& GetChunkLevel(size_t chunkIndex, uint32_t level) const { return Levels[chunkIndex * LEVEL_COUNT + level - 1]; }
+
+    /// @brief Builds the levels of every chunk of a mesh, replacing any previous ones.
+    /// @param bvh Hierarchy built over the mesh, defining its chunks.
+    /// @param jobSystem Job system chunks get simplified across.
+    /// @return Figures about the built levels.
+    BuildStatistics Build(const Mesh& mesh, const MeshBvh& bvh, JobSystem& jobSystem);
+};
+
+#endif // MESH_LOD_H
@@ -0,0 +1,544 @@
+#include "MeshOptimizer.h"
+#include "MeshBvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Overdraw is measured from orthographic views along both directions of each axis, at this resolution.
+    const uint32_t OVERDRAW_VIEW_COUNT = 6;
+    const int32_t OVERDRAW_VIEW_RESOLUTION = 256;
+
+    // Clusters split for overdraw keep at least this many triangles, so sorting doesn't scatter triangles sharing vertices.
+    const uint32_t MIN_SOFT_CLUSTER_TRIANGLE_COUNT = 64;
+
+    /// Simulated FIFO vertex cache. Vertices hold the time they entered the cache at, time only moves forward on misses, so a vertex
+    /// is cached as long as less than VERTEX_CACHE_SIZE other vertices entered after it.
+    class FifoCacheSimulator
+    {
+    public:
+
+        FifoCacheSimulator(size_t vertexCount) : m_entryTimes(vertexCount, 0), m_time(MeshOptimizer::VERTEX_CACHE_SIZE + 1)
+        {}
+
+        /// Accesses a vertex. Returns true on a cache miss, meaning the vertex had to be transformed.
+        inline bool Access(uint32_t vertex)
+        {
+            if (m_time - m_entryTimes[vertex] > MeshOptimizer::VERTEX_CACHE_SIZE)
+            {
+                m_entryTimes[vertex] = m_time++;
+                return true;
+            }
+            return false;
+        }
+
+        inline void Flush() { m_time += MeshOptimizer::VERTEX_CACHE_SIZE + 1; }
+
+    private:
+
+        std::vector<uint32_t> m_entryTimes;
+        uint32_t m_time;
+    };
+
+    /// Orders triangles with Tipsify: triangles are emitted as fans around vertices, the next fan vertex being a vertex of the current fan
+    /// that is still in cache and has triangles left, or otherwise the most recently used vertex having triangles left.
+    /// @param outClusterStarts Filled with the output positions at which the cache had to be considered flushed because no cached vertex had
+    /// triangles left. Starts with 0.
+    /// @return Mesh triangle indices in emission order.
+    std::vector<uint32_t> TipsifyTriangleOrder(const uint32_t* indices, size_t triangleCount, size_t vertexCount, std::vector<uint32_t>& outClusterStarts)
+    {
+        const uint32_t cacheSize = MeshOptimizer::VERTEX_CACHE_SIZE;
+        const size_t indexCount = triangleCount * 3;
+
+        // Vertex to triangle adjacency, in compressed rows. Live triangle counts start as every vertex's amount of adjacent triangles.
+        std::vector<uint32_t> liveTriangleCounts(vertexCount, 0);
+        for (size_t index = 0; index < indexCount; index++)
+        {
+            liveTriangleCounts[indices[index]]++;
+        }
+
+        std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangleCounts[vertex];
+        }
+
+        std::vector<uint32_t> adjacentTriangles(indexCount);
+        {
+            std::vector<size_t> insertPositions(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t index = 0; index < indexCount; index++)
+            {
+                adjacentTriangles[insertPositions[indices[index]]++] = static_cast<uint32_t>(index / 3);
+            }
+        }
+
+        std::vector<uint32_t> cacheEntryTimes(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+
+        std::vector<uint8_t> emittedTriangles(triangleCount, 0);
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+
+        std::vector<uint32_t> triangleOrder;
+        triangleOrder.reserve(triangleCount);
+        outClusterStarts.clear();
+
+        // Cursor of the linear scan for vertices with triangles left, used once the dead end stack is exhausted.
+        size_t scanCursor = 0;
+
+        auto skipDeadEnd = [&]() -> int64_t
+        {
+            while (!deadEndStack.empty())
+            {
+                const uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangleCounts[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+            while (scanCursor < vertexCount)
+            {
+                if (liveTriangleCounts[scanCursor] > 0)
+                {
+                    return static_cast<int64_t>(scanCursor);
+                }
+                scanCursor++;
+            }
+            return -1;
+        };
+
+        int64_t fanVertex = skipDeadEnd();
+        if (fanVertex >= 0)
+        {
+            outClusterStarts.push_back(0);
+        }
+
+        while (fanVertex >= 0)
+        {
+            candidates.clear();
+            for (size_t adjacencyIndex = adjacencyOffsets[fanVertex]; adjacencyIndex < adjacencyOffsets[fanVertex + 1]; adjacencyIndex++)
+            {
+                const uint32_t triangle = adjacentTriangles[adjacencyIndex];
+                if (emittedTriangles[triangle])
+                {
+                    continue;
+                }
+
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex = indices[static_cast<size_t>(triangle) * 3 + corner];
+                    deadEndStack.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangleCounts[vertex]--;
+                    if (time - cacheEntryTimes[vertex] > cacheSize)
+                    {
+                        cacheEntryTimes[vertex] = time++;
+                    }
+                }
+                emittedTriangles[triangle] = 1;
+                triangleOrder.push_back(triangle);
+            }
+
+            // Pick the candidate that will still be in cache once its remaining triangles are emitted, and that entered the cache earliest
+            // among those so it gets used before being evicted.
+            int64_t nextVertex = -1;
+            uint32_t bestPriority = 0;
+            bool bHasPriority = false;
+            for (uint32_t vertex : candidates)
+            {
+                if (liveTriangleCounts[vertex] == 0)
+                {
+                    continue;
+                }
+
+                const uint32_t age = time - cacheEntryTimes[vertex];
+                const uint32_t priority = age + 2 * liveTriangleCounts[vertex] <= cacheSize ? age : 0;
+                if (!bHasPriority || priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                    bHasPriority = true;
+                }
+            }
+
+            if (nextVertex < 0)
+            {
+                nextVertex = skipDeadEnd();
+                if (nextVertex >= 0)
+                {
+                    outClusterStarts.push_back(static_cast<uint32_t>(triangleOrder.size()));
+                }
+            }
+            fanVertex = nextVertex;
+        }
+
+        return triangleOrder;
+    }
+
+    /// Splits clusters further wherever the cache efficiency reached so far within a cluster is already close to that of the whole cluster,
+    /// which gives overdraw sorting more freedom at little cache cost.
+    std::vector<uint32_t> SplitClusters(const std::vector<uint32_t>& indices, size_t vertexCount, const std::vector<uint32_t>& clusterStarts,
+        float overdrawThreshold)
+    {
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        FifoCacheSimulator cache(vertexCount);
+
+        std::vector<uint32_t> splitClusterStarts;
+        splitClusterStarts.reserve(clusterStarts.size());
+        for (size_t clusterIndex = 0; clusterIndex < clusterStarts.size(); clusterIndex++)
+        {
+            const uint32_t clusterStart = clusterStarts[clusterIndex];
+            const uint32_t clusterEnd = clusterIndex + 1 < clusterStarts.size() ? clusterStarts[clusterIndex + 1] : triangleCount;
+            splitClusterStarts.push_back(clusterStart);
+
+            cache.Flush();
+            uint32_t clusterMissCount = 0;
+            for (size_t index = clusterStart * size_t(3); index < clusterEnd * size_t(3); index++)
+            {
+                clusterMissCount += cache.Access(indices[index]);
+            }
+            const float thresholdAcmr = overdrawThreshold * clusterMissCount / (clusterEnd - clusterStart);
+
+            cache.Flush();
+            uint32_t missCount = 0;
+            uint32_t splitStart = clusterStart;
+            for (uint32_t triangle = clusterStart; triangle < clusterEnd; triangle++)
+            {
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    missCount += cache.Access(indices[static_cast<size_t>(triangle) * 3 + corner]);
+                }
+
+                const uint32_t splitTriangleCount = triangle + 1 - splitStart;
+                if (splitTriangleCount >= MIN_SOFT_CLUSTER_TRIANGLE_COUNT && clusterEnd - (triangle + 1) >= MIN_SOFT_CLUSTER_TRIANGLE_COUNT
+                    && static_cast<float>(missCount) / splitTriangleCount <= thresholdAcmr)
+                {
+                    splitStart = triangle + 1;
+                    splitClusterStarts.push_back(splitStart);
+                    cache.Flush();
+                    missCount = 0;
+                }
+            }
+        }
+
+        return splitClusterStarts;
+    }
+
+    /// Reorders clusters so those facing away from the mesh's center come first: they are the most likely to hide other clusters.
+    /// Sorting is done per block of consecutive triangles the size of a hierarchy chunk, then per cluster within blocks. Tipsify walks
+    /// connected triangles so blocks are spatially compact, and moving whole blocks keeps the chunks cut from the final order just as
+    /// compact, hence their bounds tight. The last block, if partial, stays last so every other block still lines up with a chunk.
+    std::vector<uint32_t> SortClustersForOverdraw(const Mesh& mesh, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts)
+    {
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        const uint32_t blockSize = MeshBvh::TRIANGLES_PER_CHUNK;
+        const uint32_t blockCount = (triangleCount + blockSize - 1) / blockSize;
+
+        // Clusters also get cut at block boundaries.
+        std::vector<uint32_t> pieceStarts;
+        pieceStarts.reserve(clusterStarts.size() + blockCount);
+        size_t nextClusterIndex = 0;
+        for (uint32_t blockStart = 0; blockStart < triangleCount; blockStart += blockSize)
+        {
+            const uint32_t blockEnd = std::min(blockStart + blockSize, triangleCount);
+            pieceStarts.push_back(blockStart);
+            while (nextClusterIndex < clusterStarts.size() && clusterStarts[nextClusterIndex] < blockEnd)
+            {
+                if (clusterStarts[nextClusterIndex] > blockStart)
+                {
+                    pieceStarts.push_back(clusterStarts[nextClusterIndex]);
+                }
+                nextClusterIndex++;
+            }
+        }
+        const size_t pieceCount = pieceStarts.size();
+
+        // Area weighted centroid & normal sums of pieces. Cross product lengths are twice the triangle areas, which cancels out.
+        std::vector<Vector3> pieceCentroidSums(pieceCount);
+        std::vector<Vector3> pieceNormalSums(pieceCount);
+        std::vector<float> pieceAreas(pieceCount);
+        Vector3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+        float meshArea = 0.0f;
+        for (size_t pieceIndex = 0; pieceIndex < pieceCount; pieceIndex++)
+        {
+            const uint32_t pieceEnd = pieceIndex + 1 < pieceCount ? pieceStarts[pieceIndex + 1] : triangleCount;
+
+            Vector3 centroidSum = { 0.0f, 0.0f, 0.0f };
+            Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+            float areaSum = 0.0f;
+            for (uint32_t triangle = pieceStarts[pieceIndex]; triangle < pieceEnd; triangle++)
+            {
+                const Vector3& p0 = mesh.Positions[indices[static_cast<size_t>(triangle) * 3 + 0]];
+                const Vector3& p1 = mesh.Positions[indices[static_cast<size_t>(triangle) * 3 + 1]];
+                const Vector3& p2 = mesh.Positions[indices[static_cast<size_t>(triangle) * 3 + 2]];
+
+                const Vector3 normal = Cross(p1 - p0, p2 - p0);
+                const float area = Length(normal);
+                centroidSum = centroidSum + (p0 + p1 + p2) * (area / 3.0f);
+                normalSum = normalSum + normal;
+                areaSum += area;
+            }
+
+            pieceCentroidSums[pieceIndex] = centroidSum;
+            pieceNormalSums[pieceIndex] = normalSum;
+            pieceAreas[pieceIndex] = areaSum;
+            meshCentroid = meshCentroid + centroidSum;
+            meshArea += areaSum;
+        }
+        meshCentroid = meshArea > 0.0f ? meshCentroid * (1.0f / meshArea) : mesh.Bounds.GetCenter();
+
+        const auto computeSortKey = [&](const Vector3& centroidSum, const Vector3& normalSum, float area, uint32_t firstTriangle)
+        {
+            const Vector3 centroid = area > 0.0f ? centroidSum * (1.0f / area) : mesh.Positions[indices[firstTriangle * size_t(3)]];
+            return Dot(centroid - meshCentroid, Normalize(normalSum));
+        };
+
+        std::vector<float> pieceSortKeys(pieceCount);
+        std::vector<uint32_t> blockFirstPieces(blockCount + 1, static_cast<uint32_t>(pieceCount));
+        std::vector<float> blockSortKeys(blockCount);
+        for (uint32_t blockIndex = 0, pieceIndex = 0; blockIndex < blockCount; blockIndex++)
+        {
+            const uint32_t blockEnd = std::min((blockIndex + 1) * blockSize, triangleCount);
+            blockFirstPieces[blockIndex] = pieceIndex;
+
+            Vector3 centroidSum = { 0.0f, 0.0f, 0.0f };
+            Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+            float areaSum = 0.0f;
+            for (; pieceIndex < pieceCount && pieceStarts[pieceIndex] < blockEnd; pieceIndex++)
+            {
+                pieceSortKeys[pieceIndex] = computeSortKey(pieceCentroidSums[pieceIndex], pieceNormalSums[pieceIndex], pieceAreas[pieceIndex],
+                    pieceStarts[pieceIndex]);
+                centroidSum = centroidSum + pieceCentroidSums[pieceIndex];
+                normalSum = normalSum + pieceNormalSums[pieceIndex];
+                areaSum += pieceAreas[pieceIndex];
+            }
+            blockSortKeys[blockIndex] = computeSortKey(centroidSum, normalSum, areaSum, blockIndex * blockSize);
+        }
+
+        std::vector<uint32_t> blockOrder(blockCount);
+        for (uint32_t blockIndex = 0; blockIndex < blockCount; blockIndex++)
+        {
+            blockOrder[blockIndex] = blockIndex;
+        }
+        const uint32_t fullBlockCount = triangleCount / blockSize;
+        std::stable_sort(blockOrder.begin(), blockOrder.begin() + fullBlockCount, [&](uint32_t a, uint32_t b) { return blockSortKeys[a] > blockSortKeys[b]; });
+
+        std::vector<uint32_t> sortedIndices;
+        sortedIndices.reserve(indices.size());
+        std::vector<uint32_t> pieceOrder;
+        for (uint32_t blockIndex : blockOrder)
+        {
+            pieceOrder.clear();
+            for (uint32_t pieceIndex = blockFirstPieces[blockIndex]; pieceIndex < blockFirstPieces[blockIndex + 1]; pieceIndex++)
+            {
+                pieceOrder.push_back(pieceIndex);
+            }
+            std::stable_sort(pieceOrder.begin(), pieceOrder.end(), [&](uint32_t a, uint32_t b) { return pieceSortKeys[a] > pieceSortKeys[b]; });
+
+            for (uint32_t pieceIndex : pieceOrder)
+            {
+                const uint32_t pieceEnd = pieceIndex + 1 < pieceCount ? pieceStarts[pieceIndex + 1] : triangleCount;
+                sortedIndices.insert(sortedIndices.end(), indices.begin() + pieceStarts[pieceIndex] * size_t(3), indices.begin() + pieceEnd * size_t(3));
+            }
+        }
+        return sortedIndices;
+    }
+
+    /// Rebuilds a vertex attribute buffer so that new vertex i holds old vertex oldVertices[i].
+    template<typename T>
+    void RemapVertexBuffer(MeshBuffer<T>& buffer, const std::vector<uint32_t>& oldVertices)
+    {
+        if (buffer.IsEmpty())
+        {
+            return;
+        }
+
+        std::vector<T> remapped(oldVertices.size());
+        for (size_t newVertex = 0; newVertex < oldVertices.size(); newVertex++)
+        {
+            remapped[newVertex] = buffer[oldVertices[newVertex]];
+        }
+        buffer = std::move(remapped);
+    }
+
+    /// Counts drawn & covered pixels of a mesh rasterized from one orthographic view along a mesh axis.
+    void MeasureViewOverdraw(const Mesh& mesh, uint32_t viewIndex, uint64_t& outDrawnPixelCount, uint64_t& outCoveredPixelCount)
+    {
+        // Views look along -axis from the positive side, or along +axis from the negative side. Screen axes are picked so that screen space
+        // is right-handed with the axis pointing at the viewer, keeping front faces counter-clockwise. Depth is lower closer to the viewer.
+        const int axis = static_cast<int>(viewIndex / 2);
+        const float side = viewIndex % 2 == 0 ? 1.0f : -1.0f;
+        auto project = [axis, side](const Vector3& p) -> Vector3
+        {
+            const float coordinates[3] = { p.x, p.y, p.z };
+            return Vector3{ coordinates[(axis + 1) % 3] * side, coordinates[(axis + 2) % 3], -coordinates[axis] * side };
+        };
+
+        const Vector3 boundsA = project(mesh.Bounds.Min);
+        const Vector3 boundsB = project(mesh.Bounds.Max);
+        const float minU = std::min(boundsA.x, boundsB.x);
+        const float minV = std::min(boundsA.y, boundsB.y);
+        const float extent = std::max(std::max(boundsA.x, boundsB.x) - minU, std::max(boundsA.y, boundsB.y) - minV);
+        const float scale = extent > 0.0f ? OVERDRAW_VIEW_RESOLUTION / extent : 0.0f;
+
+        std::vector<float> depthBuffer(static_cast<size_t>(OVERDRAW_VIEW_RESOLUTION) * OVERDRAW_VIEW_RESOLUTION, INFINITY);
+        uint64_t drawnPixelCount = 0;
+
+        const size_t triangleCount = mesh.GetTriangleCount();
+        for (size_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            Vector3 corners[3];
+            for (int corner = 0; corner < 3; corner++)
+            {
+                const Vector3 projected = project(mesh.Positions[mesh.Indices[triangle * 3 + corner]]);
+                corners[corner] = Vector3{ (projected.x - minU) * scale, (projected.y - minV) * scale, projected.z };
+            }
+
+            const Vector3& a = corners[0];
+            const Vector3& b = corners[1];
+            const Vector3& c = corners[2];
+            const float doubleArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (!(doubleArea > 0.0f))
+            {
+                continue; // Back facing or degenerate.
+            }
+
+            // Pixel centers sit at half coordinates.
+            const int32_t minX = std::max(static_cast<int32_t>(std::ceil(std::min(std::min(a.x, b.x), c.x) - 0.5f)), 0);
+            const int32_t minY = std::max(static_cast<int32_t>(std::ceil(std::min(std::min(a.y, b.y), c.y) - 0.5f)), 0);
+            const int32_t maxX = std::min(static_cast<int32_t>(std::floor(std::max(std::max(a.x, b.x), c.x) - 0.5f)), OVERDRAW_VIEW_RESOLUTION - 1);
+            const int32_t maxY = std::min(static_cast<int32_t>(std::floor(std::max(std::max(a.y, b.y), c.y) - 0.5f)), OVERDRAW_VIEW_RESOLUTION - 1);
+
+            const float inverseDoubleArea = 1.0f / doubleArea;
+            for (int32_t y = minY; y <= maxY; y++)
+            {
+                const float pixelY = y + 0.5f;
+                for (int32_t x = minX; x <= maxX; x++)
+                {
+                    const float pixelX = x + 0.5f;
+                    const float weightA = (c.x - b.x) * (pixelY - b.y) - (c.y - b.y) * (pixelX - b.x);
+                    const float weightB = (a.x - c.x) * (pixelY - c.y) - (a.y - c.y) * (pixelX - c.x);
+                    const float weightC = (b.x - a.x) * (pixelY - a.y) - (b.y - a.y) * (pixelX - a.x);
+                    if (weightA < 0.0f || weightB < 0.0f || weightC < 0.0f)
+                    {
+                        continue;
+                    }
+
+                    const float depth = (weightA * a.z + weightB * b.z + weightC * c.z) * inverseDoubleArea;
+                    float& bufferDepth = depthBuffer[static_cast<size_t>(y) * OVERDRAW_VIEW_RESOLUTION + x];
+                    if (depth < bufferDepth)
+                    {
+                        bufferDepth = depth;
+                        drawnPixelCount++;
+                    }
+                }
+            }
+        }
+
+        uint64_t coveredPixelCount = 0;
+        for (float depth : depthBuffer)
+        {
+            coveredPixelCount += depth != INFINITY;
+        }
+
+        outDrawnPixelCount = drawnPixelCount;
+        outCoveredPixelCount = coveredPixelCount;
+    }
+}
+
+MeshOptimizer::MeshStatistics MeshOptimizer::AnalyzeMesh(const Mesh& mesh, JobSystem& jobSystem)
+{
+    MeshStatistics statistics;
+    const size_t triangleCount = mesh.GetTriangleCount();
+    if (triangleCount == 0)
+    {
+        return statistics;
+    }
+
+    // One job per overdraw view, plus one simulating the vertex cache.
+    uint64_t drawnPixelCounts[OVERDRAW_VIEW_COUNT] = {};
+    uint64_t coveredPixelCounts[OVERDRAW_VIEW_COUNT] = {};
+    uint64_t missCount = 0;
+    jobSystem.ParallelFor(OVERDRAW_VIEW_COUNT + 1, [&](uint32_t jobIndex)
+    {
+        if (jobIndex < OVERDRAW_VIEW_COUNT)
+        {
+            MeasureViewOverdraw(mesh, jobIndex, drawnPixelCounts[jobIndex], coveredPixelCounts[jobIndex]);
+            return;
+        }
+
+        FifoCacheSimulator cache(mesh.GetVertexCount());
+        for (uint32_t vertex : mesh.Indices)
+        {
+            missCount += cache.Access(vertex);
+        }
+    });
+
+    uint64_t drawnPixelCount = 0;
+    uint64_t coveredPixelCount = 0;
+    for (uint32_t viewIndex = 0; viewIndex < OVERDRAW_VIEW_COUNT; viewIndex++)
+    {
+        drawnPixelCount += drawnPixelCounts[viewIndex];
+        coveredPixelCount += coveredPixelCounts[viewIndex];
+    }
+
+    statistics.Acmr = static_cast<float>(static_cast<double>(missCount) / triangleCount);
+    statistics.Atvr = static_cast<float>(static_cast<double>(missCount) / std::max<size_t>(mesh.GetVertexCount(), 1));
+    statistics.Overdraw = coveredPixelCount > 0 ? static_cast<float>(static_cast<double>(drawnPixelCount) / coveredPixelCount) : 0.0f;
+    return statistics;
+}
+
+void MeshOptimizer::OptimizeMesh(Mesh& mesh, float overdrawThreshold)
+{
+    const size_t triangleCount = mesh.GetTriangleCount();
+    const size_t vertexCount = mesh.GetVertexCount();
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // VERTEX CACHE: order triangles with Tipsify.
+    std::vector<uint32_t> clusterStarts;
+    const std::vector<uint32_t> triangleOrder = TipsifyTriangleOrder(mesh.Indices.GetData(), triangleCount, vertexCount, clusterStarts);
+
+    std::vector<uint32_t> indices(triangleCount * 3);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            indices[triangle * 3 + corner] = mesh.Indices[static_cast<size_t>(triangleOrder[triangle]) * 3 + corner];
+        }
+    }
+
+    // OVERDRAW: sort clusters of triangles, split finer than Tipsify's when it costs little cache efficiency.
+    clusterStarts = SplitClusters(indices, vertexCount, clusterStarts, overdrawThreshold);
+    indices = SortClustersForOverdraw(mesh, indices, clusterStarts);
+
+    // VERTEX FETCH: lay vertices out in first use order.
+    std::vector<uint32_t> newVertexIndices(vertexCount, UINT32_MAX);
+    std::vector<uint32_t> oldVertices;
+    oldVertices.reserve(vertexCount);
+    for (uint32_t& index : indices)
+    {
+        uint32_t& newVertex = newVertexIndices[index];
+        if (newVertex == UINT32_MAX)
+        {
+            newVertex = static_cast<uint32_t>(oldVertices.size());
+            oldVertices.push_back(index);
+        }
+        index = newVertex;
+    }
+
+    RemapVertexBuffer(mesh.Positions, oldVertices);
+    RemapVertexBuffer(mesh.Normals, oldVertices);
+    RemapVertexBuffer(mesh.TexCoords, oldVertices);
+    mesh.Indices = std::move(indices);
+
+    if (oldVertices.size() != vertexCount)
+    {
+        mesh.ComputeBounds();
+    }
+}
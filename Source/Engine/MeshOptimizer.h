@@ -0,0 +1,45 @@
+/*
+    Post-load mesh optimization: reorders the triangles and vertices of indexed meshes, which come in whatever order their exporter produced,
+    so the renderer walks memory more linearly and draws less hidden pixels. The mesh itself (its surface) is left unchanged.
+    Triangles get reordered for vertex locality with Tipsify (Sander, Nehab & Barczak, "Fast Triangle Reordering for Vertex Locality and
+    Reduced Overdraw", 2007), the resulting clusters get sorted so outward facing ones come first (by blocks matching the chunks of the mesh's
+    bounding volume hierarchy, so chunks stay spatially compact), then vertices are laid out in first use order.
+*/
+
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstdint>
+
+#include "Mesh.h"
+#include "JobSystem.h"
+
+namespace MeshOptimizer
+{
+    /// @brief Size of the FIFO vertex cache triangle orders are optimized for & measured with.
+    constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+    /// @brief Measures of how efficiently a mesh's triangle order renders.
+    struct MeshStatistics
+    {
+        // Average cache miss ratio: vertices transformed per triangle with a FIFO cache of VERTEX_CACHE_SIZE vertices. 0.5 at best, 3 at worst.
+        float Acmr = 0.0f;
+        // Average transform to vertex ratio: vertices transformed per mesh vertex with the same cache. 1 at best.
+        float Atvr = 0.0f;
+        // Pixels drawn per visible pixel (front faces only, depth tested), averaged over orthographic views along both directions of each axis.
+        // 1 at best.
+        float Overdraw = 0.0f;
+    };
+
+    /// @brief Measures the vertex cache efficiency & overdraw of a mesh. Overdraw is measured by rasterizing the mesh at a low resolution.
+    /// @param jobSystem Job system measures get spread across.
+    MeshStatistics AnalyzeMesh(const Mesh& mesh, JobSystem& jobSystem);
+
+    /// @brief Reorders triangles for vertex cache locality & overdraw, then vertices for memory locality. Vertices not used by any triangle
+    /// get removed. Referenced mesh buffers are replaced by owned ones.
+    /// @param overdrawThreshold How much worse than the best possible cache efficiency (as an ACMR ratio) clusters can get when split
+    /// to sort them finer for overdraw. 1 only sorts clusters Tipsify produced.
+    void OptimizeMesh(Mesh& mesh, float overdrawThreshold = 1.05f);
+}
+
+#endif // MESH_OPTIMIZER_H
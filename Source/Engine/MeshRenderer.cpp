@@ -0,0 +1,669 @@
+#include "MeshRenderer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Planes against which triangles get clipped, matching VertexTransform::CLIP_REQUIRED_MASK bits.
+    const int CLIP_PLANE_COUNT = 5;
+
+    // A triangle clipped against 5 planes is a convex polygon of at most 8 vertices.
+    const int MAX_CLIPPED_POLYGON_VERTICES = 8;
+
+    // Vertices transformed by a single job of the vertex stage.
+    const uint32_t VERTEX_BATCH_SIZE = 16384;
+    // Granularity at which vertices used by clusters in view get marked for transformation. Divides VERTEX_BATCH_SIZE.
+    const uint32_t VERTEX_BLOCK_SIZE = 64;
+
+    // Triangle setup chunks: at most this many per thread, each holding at least a minimum amount of triangles so tiny meshes don't
+    // pay for binning overhead.
+    const size_t CHUNKS_PER_THREAD = 4;
+    const size_t MIN_TRIANGLES_PER_CHUNK = 4096;
+    // Set up triangles each block of a binning chunk holds.
+    const uint32_t TRIANGLE_BLOCK_SIZE = 256;
+
+    // Base color of rendered meshes (0xAARRGGBB) and color of the background.
+    const uint32_t MESH_BASE_COLOR = 0xFFD0D4DC;
+    const uint32_t BACKGROUND_COLOR = 0xFF202428;
+
+    // Signed distance of a clip space position to one of the clipping planes, positive inside.
+    inline float ClipPlaneDistance(const Vector4& p, int planeIndex, float guardBandScale)
+    {
+        switch (planeIndex)
+        {
+            case 0: return p.z;
+            case 1: return p.x + p.w * guardBandScale;
+            case 2: return p.w * guardBandScale - p.x;
+            case 3: return p.y + p.w * guardBandScale;
+            default: return p.w * guardBandScale - p.y;
+        }
+    }
+
+    inline Vector4 Lerp(const Vector4& a, const Vector4& b, float t)
+    {
+        return Vector4{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t};
+    }
+
+    /// Flat shading with a light placed at the camera: faces looking at the viewer are brightest.
+    inline uint32_t ShadeFace(const Vector3& p0, const Vector3& p1, const Vector3& p2, const Vector3& towardsLight)
+    {
+        const Vector3 normal = Normalize(Cross(p1 - p0, p2 - p0));
+        const float intensity = 0.15f + 0.85f * std::max(Dot(normal, towardsLight), 0.0f);
+
+        const uint32_t r = static_cast<uint32_t>(((MESH_BASE_COLOR >> 16) & 0xFF) * intensity);
+        const uint32_t g = static_cast<uint32_t>(((MESH_BASE_COLOR >> 8) & 0xFF) * intensity);
+        const uint32_t b = static_cast<uint32_t>((MESH_BASE_COLOR & 0xFF) * intensity);
+        return 0xFF000000 | (r << 16) | (g << 8) | b;
+    }
+}
+
+void MeshRenderer::Render(const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods, const Camera& camera, Pixel_RGBA* colorBuffer, uint16_t width, uint16_t height,
+    MemoryArena& frameArena, JobSystem& jobSystem)
+{
+    PROFILE_ZONE("MeshRenderer::Render");
+    m_statistics = RenderStatistics{};
+    m_frameArena = &frameArena;
+
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (m_depthBuffer.size() != pixelCount)
+    {
+        m_depthBuffer.resize(pixelCount);
+    }
+    m_hierarchicalDepth.Resize(width, height);
+
+    const RenderTarget target = { colorBuffer, m_depthBuffer.data(), width, height };
+
+    const bool bSameSizeAsLastFrame = m_viewport.Width == width && m_viewport.Height == height;
+    m_viewport.Width = width;
+    m_viewport.Height = height;
+    m_viewport.GuardBandScale = 2.0f * Rasterizer::GUARD_BAND_PIXELS / std::max<uint16_t>(std::max(width, height), 1) - 1.0f;
+
+    m_tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t tileCount = static_cast<uint32_t>(m_tileCountX * m_tileCountY);
+    m_bFullFrameDamage = !bSameSizeAsLastFrame || m_tilesDrawn.size() != tileCount;
+    m_tilesDrawn.swap(m_tilesDrawnLastFrame);
+    m_tilesDrawn.assign(tileCount, 0);
+    if (tileCount == 0)
+    {
+        return;
+    }
+
+    const Matrix4x4 viewProjection = camera.GetProjectionMatrix(m_viewport.Width / m_viewport.Height) * camera.GetViewMatrix();
+    const Vector3 towardsLight = -camera.GetForward();
+
+    // An error of e mesh units seen from a distance d spans e * height / (2 * tan(fovY / 2) * d) pixels.
+    m_cameraPosition = camera.GetPosition();
+    m_lodDistancePerError = 0.0f;
+    if (!lods.IsEmpty() && lods.Levels.GetCount() == bvh.GetChunkCount() * MeshLods::LEVEL_COUNT && m_lodErrorThreshold > 0.0f)
+    {
+        m_lodDistancePerError = m_viewport.Height / (2.0f * std::tan(camera.GetFovY() * 0.5f) * m_lodErrorThreshold);
+    }
+
+    // Clusters get culled against the camera position (backfaces) and the frustum planes.
+    m_bCullClusters = bvh.Clusters.GetCount() == (mesh.GetTriangleCount() + MeshBvh::TRIANGLES_PER_CLUSTER - 1) / MeshBvh::TRIANGLES_PER_CLUSTER;
+    m_clusterCullingView = MeshBvh::ComputeClusterCullingView(viewProjection, m_cameraPosition);
+
+    if (bvh.IsEmpty())
+    {
+        PrepareWholeMeshPass(mesh);
+        RenderPass(mesh, viewProjection, towardsLight, target, true, jobSystem);
+        return;
+    }
+
+    // FRUSTUM CULLING: find the chunks in view.
+    const size_t chunkCount = bvh.GetChunkCount();
+    size_t chunksInFrustum;
+    {
+        PROFILE_ZONE("Frustum culling");
+        chunksInFrustum = bvh.CullChunks(viewProjection, m_chunksInFrustum);
+    }
+    m_statistics.ChunksFrustumCulled = static_cast<uint32_t>(chunkCount - chunksInFrustum);
+
+    // OCCLUDER PASS: chunks that were visible last frame are likely still visible, so they get drawn first. Their depth then makes up the
+    // hierarchical depth buffer the other chunks get tested against.
+    // #NOTE: Visibility is kept per chunk index, so switching to another mesh with as many chunks starts from the previous mesh's
+    // visibility. This only costs a frame of less efficient culling.
+    if (m_chunksVisibleLastFrame.size() != chunkCount)
+    {
+        m_chunksVisibleLastFrame.assign(chunkCount, 1);
+    }
+    std::vector<uint8_t>& occluderChunks = m_chunksVisibleLastFrame;
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        occluderChunks[chunkIndex] &= m_chunksInFrustum[chunkIndex];
+    }
+    PrepareChunkPass(mesh, bvh, lods, occluderChunks);
+    RenderPass(mesh, viewProjection, towardsLight, target, true, jobSystem);
+
+    // OCCLUSION CULLING: other chunks in view only get drawn if their bounds aren't hidden behind occluders.
+    m_passChunks.assign(chunkCount, 0);
+    bool bAnyChunkLeft = false;
+    {
+        PROFILE_ZONE("Occlusion culling");
+        for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+        {
+            if (m_chunksInFrustum[chunkIndex] && !occluderChunks[chunkIndex])
+            {
+                if (IsChunkOccluded(bvh.Chunks[chunkIndex], viewProjection))
+                {
+                    m_statistics.ChunksOcclusionCulled++;
+                }
+                else
+                {
+                    m_passChunks[chunkIndex] = 1;
+                    bAnyChunkLeft = true;
+                }
+            }
+        }
+    }
+    if (bAnyChunkLeft)
+    {
+        PrepareChunkPass(mesh, bvh, lods, m_passChunks);
+        RenderPass(mesh, viewProjection, towardsLight, target, false, jobSystem);
+    }
+
+    // Visibility for next frame: occluders are tested again now that every chunk in view has been drawn, so chunks which got hidden
+    // stop being drawn first.
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        if (occluderChunks[chunkIndex])
+        {
+            occluderChunks[chunkIndex] = !IsChunkOccluded(bvh.Chunks[chunkIndex], viewProjection);
+        }
+        else
+        {
+            occluderChunks[chunkIndex] = m_passChunks[chunkIndex];
+        }
+    }
+
+    m_statistics.ChunksRendered = static_cast<uint32_t>(chunksInFrustum - m_statistics.ChunksOcclusionCulled);
+    m_statistics.TrianglesCulled = static_cast<uint32_t>(mesh.GetTriangleCount() - m_statistics.TrianglesSubmitted - m_statistics.TrianglesSimplified);
+}
+
+void MeshRenderer::RenderPass(const Mesh& mesh, const Matrix4x4& viewProjection, const Vector3& towardsLight, const RenderTarget& target,
+    bool bClearTiles, JobSystem& jobSystem)
+{
+    PROFILE_ZONE("MeshRenderer::RenderPass");
+
+    // VERTEX STAGE: transform vertices to clip space & compute their clip code. Vertices which won't need clipping are projected to
+    // screen space right away, as they are usually shared by several triangles.
+    m_vertices.Resize(mesh.GetVertexCount());
+    jobSystem.ParallelFor(static_cast<uint32_t>(m_vertexBatches.size()), [&](uint32_t batchIndex)
+    {
+        PROFILE_ZONE("Vertex stage batch");
+        const ElementRange& batch = m_vertexBatches[batchIndex];
+        VertexTransform::TransformVertices(mesh.Positions.GetData(), batch.First, batch.End, viewProjection, m_viewport, m_vertices, m_simdPaths);
+    });
+
+    // SETUP STAGE: cull, clip, set up and bin the pass's triangles, in chunks of consecutive pass triangles.
+    // A few chunks per thread keep every thread busy even when chunks have uneven costs.
+    size_t triangleCount = 0;
+    for (const TriangleRange& range : m_passTriangleRanges)
+    {
+        triangleCount += range.TriangleCount;
+    }
+    m_statistics.TrianglesSubmitted += static_cast<uint32_t>(triangleCount);
+
+    const uint32_t tileCount = static_cast<uint32_t>(m_tileCountX * m_tileCountY);
+    const size_t maxChunkCount = (jobSystem.GetWorkerThreadCount() + 1) * CHUNKS_PER_THREAD;
+    m_activeChunkCount = static_cast<uint32_t>(std::max<size_t>(std::min(triangleCount / MIN_TRIANGLES_PER_CHUNK, maxChunkCount), 1));
+    if (m_chunks.size() < m_activeChunkCount)
+    {
+        m_chunks.resize(m_activeChunkCount);
+    }
+
+    jobSystem.ParallelFor(m_activeChunkCount, [&](uint32_t chunkIndex)
+    {
+        PROFILE_ZONE("Setup stage chunk");
+        BinningChunk& chunk = m_chunks[chunkIndex];
+        chunk.TriangleBlock = nullptr;
+        chunk.TriangleBlockCount = TRIANGLE_BLOCK_SIZE;
+        chunk.TileBins = m_frameArena->AllocateArray<TileBin>(tileCount);
+        std::fill(chunk.TileBins, chunk.TileBins + tileCount, TileBin{ nullptr, nullptr });
+        chunk.Statistics = RenderStatistics{};
+
+        // Walk the pass's triangle ranges up to this chunk's share of its triangles.
+        const size_t firstPassTriangle = triangleCount * chunkIndex / m_activeChunkCount;
+        const size_t endPassTriangle = triangleCount * (chunkIndex + 1) / m_activeChunkCount;
+        size_t rangeStartPassTriangle = 0;
+        for (const TriangleRange& range : m_passTriangleRanges)
+        {
+            const size_t rangeEndPassTriangle = rangeStartPassTriangle + range.TriangleCount;
+            if (rangeEndPassTriangle > firstPassTriangle)
+            {
+                const size_t firstTriangle = std::max(firstPassTriangle, rangeStartPassTriangle) - rangeStartPassTriangle;
+                const size_t endTriangle = std::min(endPassTriangle, rangeEndPassTriangle) - rangeStartPassTriangle;
+                SetupAndBinTriangles(mesh, range.Indices + firstTriangle * 3, endTriangle - firstTriangle, towardsLight, chunk);
+            }
+            if (rangeEndPassTriangle >= endPassTriangle)
+            {
+                break;
+            }
+            rangeStartPassTriangle = rangeEndPassTriangle;
+        }
+    });
+
+    // RASTER STAGE: every tile gets rasterized by a single job, which also updates the tile's hierarchical depth.
+    // #NOTE: Tiles are too many & too short for a profiling zone each, so the stage is profiled as a whole.
+    {
+        PROFILE_ZONE("Raster stage");
+        jobSystem.ParallelFor(tileCount, [&](uint32_t tileIndex)
+        {
+            RasterizeTile(tileIndex, target, bClearTiles);
+        });
+    }
+
+    for (uint32_t chunkIndex = 0; chunkIndex < m_activeChunkCount; chunkIndex++)
+    {
+        const RenderStatistics& chunkStatistics = m_chunks[chunkIndex].Statistics;
+        m_statistics.TrianglesClipped += chunkStatistics.TrianglesClipped;
+        m_statistics.TrianglesRasterized += chunkStatistics.TrianglesRasterized;
+        m_statistics.TileBinEntries += chunkStatistics.TileBinEntries;
+    }
+}
+
+void MeshRenderer::PrepareWholeMeshPass(const Mesh& mesh)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    const uint32_t triangleCount = static_cast<uint32_t>(mesh.GetTriangleCount());
+    m_passTriangleRanges = ArenaVector<TriangleRange>(m_frameArena);
+    m_passTriangleRanges.reserve(1);
+    m_vertexBatches = ArenaVector<ElementRange>(m_frameArena);
+    m_vertexBatches.reserve((vertexCount + VERTEX_BATCH_SIZE - 1) / VERTEX_BATCH_SIZE);
+    if (triangleCount > 0)
+    {
+        m_passTriangleRanges.push_back(TriangleRange{ mesh.Indices.GetData(), triangleCount });
+    }
+    for (uint32_t firstVertex = 0; firstVertex < vertexCount; firstVertex += VERTEX_BATCH_SIZE)
+    {
+        m_vertexBatches.push_back(ElementRange{ firstVertex, std::min(firstVertex + VERTEX_BATCH_SIZE, vertexCount) });
+    }
+    m_statistics.VerticesTransformed += vertexCount;
+}
+
+void MeshRenderer::PrepareChunkPass(const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods, const std::vector<uint8_t>& passChunks)
+{
+    PROFILE_ZONE("MeshRenderer::PrepareChunkPass");
+    // Merge chunks of the pass whose triangles follow each other (consecutive chunks at full detail, or at the same simplified level) into
+    // triangle ranges, and mark the vertex blocks they use. Full detail chunks only submit their clusters that survive backface & frustum
+    // culling, and only mark the vertices of those. Simplified chunks are culled the same way as a single cluster, with the bounds of their
+    // level, and only mark the vertices their level uses.
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+    const uint32_t triangleCount = static_cast<uint32_t>(mesh.GetTriangleCount());
+    const uint32_t blockCount = (vertexCount + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE;
+    m_passVertexBlocks.assign(blockCount, 0);
+
+    // Every chunk adds at most one range per cluster, and every vertex block at most one batch.
+    const size_t passChunkCount = static_cast<size_t>(std::count(passChunks.begin(), passChunks.end(), 1));
+    m_passTriangleRanges = ArenaVector<TriangleRange>(m_frameArena);
+    m_passTriangleRanges.reserve(passChunkCount * MeshBvh::CLUSTERS_PER_CHUNK);
+    m_vertexBatches = ArenaVector<ElementRange>(m_frameArena);
+    m_vertexBatches.reserve(blockCount);
+    for (uint32_t chunkIndex = 0; chunkIndex < passChunks.size(); chunkIndex++)
+    {
+        if (!passChunks[chunkIndex])
+        {
+            continue;
+        }
+
+        const MeshBvh::Chunk& chunk = bvh.Chunks[chunkIndex];
+        const uint32_t firstTriangle = chunkIndex * MeshBvh::TRIANGLES_PER_CHUNK;
+        TriangleRange chunkRange = { mesh.Indices.GetData() + firstTriangle * size_t(3), std::min(firstTriangle + MeshBvh::TRIANGLES_PER_CHUNK, triangleCount) - firstTriangle };
+        const uint32_t level = SelectChunkLevel(chunk, lods, chunkIndex);
+        if (level > 0 && lods.GetChunkLevel(chunkIndex, level).TriangleCount < chunkRange.TriangleCount)
+        {
+            const MeshLods::ChunkLevel& chunkLevel = lods.GetChunkLevel(chunkIndex, level);
+            m_statistics.ChunksSimplified++;
+            m_statistics.TrianglesSimplified += chunkRange.TriangleCount - chunkLevel.TriangleCount;
+            if (m_bCullClusters)
+            {
+                m_statistics.ClustersTested++;
+                if (!MeshBvh::IsClusterVisible(chunkLevel.Bounds, m_clusterCullingView, m_statistics.ClustersBackfaceCulled, m_statistics.ClustersFrustumCulled))
+                {
+                    continue;
+                }
+            }
+            AddPassTriangles(TriangleRange{ lods.Indices.GetData() + chunkLevel.FirstTriangle * size_t(3), chunkLevel.TriangleCount });
+            if (chunkLevel.TriangleCount > 0)
+            {
+                MarkPassVertices(chunkLevel.Bounds.FirstVertex, chunkLevel.Bounds.EndVertex);
+            }
+            continue;
+        }
+
+        if (!m_bCullClusters)
+        {
+            AddPassTriangles(chunkRange);
+            MarkPassVertices(chunk.FirstVertex, chunk.EndVertex);
+            continue;
+        }
+
+        const uint32_t firstCluster = chunkIndex * MeshBvh::CLUSTERS_PER_CHUNK;
+        const uint32_t clusterCount = (chunkRange.TriangleCount + MeshBvh::TRIANGLES_PER_CLUSTER - 1) / MeshBvh::TRIANGLES_PER_CLUSTER;
+        const uint32_t visibleClusterMask = bvh.CullChunkClusters(chunkIndex, m_clusterCullingView, m_statistics.ClustersBackfaceCulled,
+            m_statistics.ClustersFrustumCulled);
+        m_statistics.ClustersTested += clusterCount;
+        for (uint32_t clusterOffset = 0; clusterOffset < clusterCount; clusterOffset++)
+        {
+            if ((visibleClusterMask & (1u << clusterOffset)) == 0)
+            {
+                continue;
+            }
+
+            const uint32_t firstClusterTriangle = clusterOffset * MeshBvh::TRIANGLES_PER_CLUSTER;
+            AddPassTriangles(TriangleRange{ chunkRange.Indices + firstClusterTriangle * size_t(3),
+                std::min(firstClusterTriangle + MeshBvh::TRIANGLES_PER_CLUSTER, chunkRange.TriangleCount) - firstClusterTriangle });
+            const MeshBvh::Cluster& cluster = bvh.Clusters[firstCluster + clusterOffset];
+            MarkPassVertices(cluster.FirstVertex, cluster.EndVertex);
+        }
+    }
+
+    // Merge marked vertex blocks into batches, cut at batch boundaries so no batch gets too large.
+    for (uint32_t block = 0; block < blockCount; block++)
+    {
+        if (!m_passVertexBlocks[block])
+        {
+            continue;
+        }
+
+        const uint32_t firstVertex = block * VERTEX_BLOCK_SIZE;
+        const uint32_t endVertex = std::min(firstVertex + VERTEX_BLOCK_SIZE, vertexCount);
+        if (!m_vertexBatches.empty() && m_vertexBatches.back().End == firstVertex && firstVertex % VERTEX_BATCH_SIZE != 0)
+        {
+            m_vertexBatches.back().End = endVertex;
+        }
+        else
+        {
+            m_vertexBatches.push_back(ElementRange{ firstVertex, endVertex });
+        }
+        m_statistics.VerticesTransformed += endVertex - firstVertex;
+    }
+}
+
+uint32_t MeshRenderer::SelectChunkLevel(const MeshBvh::Chunk& chunk, const MeshLods& lods, size_t chunkIndex) const
+{
+    if (m_lodDistancePerError == 0.0f)
+    {
+        return 0;
+    }
+
+    // Distance from the camera to the closest point of the chunk's bounds, 0 inside of them.
+    const Vector3 closestPoint = Min(Max(m_cameraPosition, chunk.BoundsMin), chunk.BoundsMax);
+    const float distance = Length(closestPoint - m_cameraPosition);
+
+    // Errors grow with levels, so stop at the first level that would be noticeable.
+    uint32_t level = 0;
+    while (level < MeshLods::LEVEL_COUNT && lods.GetChunkLevel(chunkIndex, level + 1).Error * m_lodDistancePerError <= distance)
+    {
+        level++;
+    }
+    return level;
+}
+
+void MeshRenderer::AddPassTriangles(const TriangleRange& range)
+{
+    if (!m_passTriangleRanges.empty() && m_passTriangleRanges.back().Indices + m_passTriangleRanges.back().TriangleCount * size_t(3) == range.Indices)
+    {
+        m_passTriangleRanges.back().TriangleCount += range.TriangleCount;
+    }
+    else if (range.TriangleCount > 0)
+    {
+        m_passTriangleRanges.push_back(range);
+    }
+}
+
+void MeshRenderer::MarkPassVertices(uint32_t firstVertex, uint32_t endVertex)
+{
+    for (uint32_t block = firstVertex / VERTEX_BLOCK_SIZE; block <= (endVertex - 1) / VERTEX_BLOCK_SIZE; block++)
+    {
+        m_passVertexBlocks[block] = 1;
+    }
+}
+
+bool MeshRenderer::IsChunkOccluded(const MeshBvh::Chunk& chunk, const Matrix4x4& viewProjection) const
+{
+    // Screen space bounds & nearest depth of the chunk's bounding box, from its 8 projected corners. Depth only grows with distance to the
+    // camera, so the nearest corner bounds the depth of anything in the box.
+    float minX = m_viewport.Width;
+    float minY = m_viewport.Height;
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    float nearestDepth = 1.0f;
+    for (int cornerIndex = 0; cornerIndex < 8; cornerIndex++)
+    {
+        const Vector3 corner = {    (cornerIndex & 1) ? chunk.BoundsMax.x : chunk.BoundsMin.x,
+                                    (cornerIndex & 2) ? chunk.BoundsMax.y : chunk.BoundsMin.y,
+                                    (cornerIndex & 4) ? chunk.BoundsMax.z : chunk.BoundsMin.z };
+        const Vector4 clipPosition = viewProjection.TransformPoint(corner);
+        if (clipPosition.z < 0.0f)
+        {
+            // Boxes crossing the near plane cover an unbounded part of the screen: keep them.
+            return false;
+        }
+
+        const float inverseW = 1.0f / clipPosition.w;
+        const float screenX = (clipPosition.x * inverseW * 0.5f + 0.5f) * m_viewport.Width;
+        const float screenY = (0.5f - clipPosition.y * inverseW * 0.5f) * m_viewport.Height;
+        minX = std::min(minX, screenX);
+        minY = std::min(minY, screenY);
+        maxX = std::max(maxX, screenX);
+        maxY = std::max(maxY, screenY);
+        nearestDepth = std::min(nearestDepth, clipPosition.z * inverseW);
+    }
+
+    // Pixels whose center the box may cover. Rounding outwards keeps the test conservative.
+    const RasterRect rect = {   static_cast<int32_t>(std::floor(minX)), static_cast<int32_t>(std::floor(minY)),
+                                static_cast<int32_t>(std::ceil(maxX)) + 1, static_cast<int32_t>(std::ceil(maxY)) + 1 };
+    return m_hierarchicalDepth.IsOccluded(rect, nearestDepth);
+}
+
+void MeshRenderer::SetupAndBinTriangles(const Mesh& mesh, const uint32_t* indices, size_t triangleCount, const Vector3& towardsLight, BinningChunk& chunk)
+{
+    for (size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+    {
+        const uint32_t i0 = indices[triangleIndex * 3 + 0];
+        const uint32_t i1 = indices[triangleIndex * 3 + 1];
+        const uint32_t i2 = indices[triangleIndex * 3 + 2];
+
+        const uint16_t code0 = m_vertices.ClipCodes[i0];
+        const uint16_t code1 = m_vertices.ClipCodes[i1];
+        const uint16_t code2 = m_vertices.ClipCodes[i2];
+
+        // Trivial rejection: all three vertices outside of the same view plane.
+        if ((code0 & code1 & code2 & VertexTransform::CLIP_VIEW_MASK) != 0)
+        {
+            continue;
+        }
+
+        if (((code0 | code1 | code2) & VertexTransform::CLIP_REQUIRED_MASK) != 0)
+        {
+            chunk.Statistics.TrianglesClipped++;
+            const uint32_t color = ShadeFace(mesh.Positions[i0], mesh.Positions[i1], mesh.Positions[i2], towardsLight);
+            ClipAndSetupTriangle(m_vertices.GetClipPosition(i0), m_vertices.GetClipPosition(i1), m_vertices.GetClipPosition(i2), color, chunk);
+            continue;
+        }
+
+        // Shading is only computed once the triangle is known to be front facing & covering pixels, so set it up with a placeholder color.
+        RasterTriangle triangle;
+        if (Rasterizer::SetupTriangle(m_vertices.GetScreenVertex(i0), m_vertices.GetScreenVertex(i1), m_vertices.GetScreenVertex(i2), 0, triangle))
+        {
+            triangle.Color = ShadeFace(mesh.Positions[i0], mesh.Positions[i1], mesh.Positions[i2], towardsLight);
+            BinTriangle(triangle, chunk);
+        }
+    }
+}
+
+void MeshRenderer::BinTriangle(const RasterTriangle& triangle, BinningChunk& chunk)
+{
+    const int32_t minX = std::max(triangle.Bounds.MinX, 0);
+    const int32_t minY = std::max(triangle.Bounds.MinY, 0);
+    const int32_t maxX = std::min(triangle.Bounds.MaxX, static_cast<int32_t>(m_viewport.Width));
+    const int32_t maxY = std::min(triangle.Bounds.MaxY, static_cast<int32_t>(m_viewport.Height));
+    if (minX >= maxX || minY >= maxY)
+    {
+        return;
+    }
+
+    if (chunk.TriangleBlockCount == TRIANGLE_BLOCK_SIZE)
+    {
+        chunk.TriangleBlock = m_frameArena->AllocateArray<RasterTriangle>(TRIANGLE_BLOCK_SIZE);
+        chunk.TriangleBlockCount = 0;
+    }
+    RasterTriangle* storedTriangle = &chunk.TriangleBlock[chunk.TriangleBlockCount++];
+    *storedTriangle = triangle;
+    chunk.Statistics.TrianglesRasterized++;
+
+    const int32_t lastTileX = (maxX - 1) / TILE_SIZE;
+    const int32_t lastTileY = (maxY - 1) / TILE_SIZE;
+    for (int32_t tileY = minY / TILE_SIZE; tileY <= lastTileY; tileY++)
+    {
+        for (int32_t tileX = minX / TILE_SIZE; tileX <= lastTileX; tileX++)
+        {
+            TileBin& bin = chunk.TileBins[tileY * m_tileCountX + tileX];
+            if (bin.LastBlock == nullptr || bin.LastBlock->TriangleCount == TILE_BIN_BLOCK_SIZE)
+            {
+                TileBinBlock* block = m_frameArena->AllocateArray<TileBinBlock>(1);
+                block->Next = nullptr;
+                block->TriangleCount = 0;
+                (bin.LastBlock != nullptr ? bin.LastBlock->Next : bin.FirstBlock) = block;
+                bin.LastBlock = block;
+            }
+            bin.LastBlock->Triangles[bin.LastBlock->TriangleCount++] = storedTriangle;
+            chunk.Statistics.TileBinEntries++;
+        }
+    }
+}
+
+void MeshRenderer::RasterizeTile(uint32_t tileIndex, const RenderTarget& target, bool bClear)
+{
+    const int32_t tileX = static_cast<int32_t>(tileIndex) % m_tileCountX;
+    const int32_t tileY = static_cast<int32_t>(tileIndex) / m_tileCountX;
+    const RasterRect tileRect = {   tileX * TILE_SIZE, tileY * TILE_SIZE,
+                                    std::min((tileX + 1) * TILE_SIZE, static_cast<int32_t>(target.Width)),
+                                    std::min((tileY + 1) * TILE_SIZE, static_cast<int32_t>(target.Height)) };
+
+    bool bDrewAnything = false;
+    if (bClear)
+    {
+        Rasterizer::ClearRenderTarget(target, tileRect, BACKGROUND_COLOR, 1.0f);
+        bDrewAnything = true;
+    }
+
+    for (uint32_t chunkIndex = 0; chunkIndex < m_activeChunkCount; chunkIndex++)
+    {
+        for (const TileBinBlock* block = m_chunks[chunkIndex].TileBins[tileIndex].FirstBlock; block != nullptr; block = block->Next)
+        {
+            for (uint32_t triangleOffset = 0; triangleOffset < block->TriangleCount; triangleOffset++)
+            {
+                Rasterizer::RasterizeTriangle(*block->Triangles[triangleOffset], target, tileRect, m_simdPaths);
+            }
+            bDrewAnything = true;
+            m_tilesDrawn[tileIndex] = 1;
+        }
+    }
+
+    if (bDrewAnything)
+    {
+        m_hierarchicalDepth.Update(target, tileRect, m_simdPaths);
+    }
+}
+
+void MeshRenderer::GetLastFrameDamage(DisplayDamage& outDamage) const
+{
+    outDamage.Clear();
+
+    const uint16_t width = static_cast<uint16_t>(m_viewport.Width);
+    const uint16_t height = static_cast<uint16_t>(m_viewport.Height);
+    if (m_bFullFrameDamage)
+    {
+        outDamage.AddRect(DisplayRect{ 0, 0, width, height });
+        return;
+    }
+
+    // Add runs of damaged tiles along each row. Runs spanning the same columns on consecutive rows get merged by the damage region.
+    for (int32_t tileY = 0; tileY < m_tileCountY; tileY++)
+    {
+        const uint32_t rowTileIndex = static_cast<uint32_t>(tileY * m_tileCountX);
+        int32_t tileX = 0;
+        while (tileX < m_tileCountX)
+        {
+            const int32_t runStartTileX = tileX;
+            while (tileX < m_tileCountX && (m_tilesDrawn[rowTileIndex + tileX] | m_tilesDrawnLastFrame[rowTileIndex + tileX]) != 0)
+            {
+                tileX++;
+            }
+
+            if (tileX == runStartTileX)
+            {
+                tileX++;
+                continue;
+            }
+
+            const int32_t minX = runStartTileX * TILE_SIZE;
+            const int32_t minY = tileY * TILE_SIZE;
+            const int32_t maxX = std::min(tileX * TILE_SIZE, static_cast<int32_t>(width));
+            const int32_t maxY = std::min((tileY + 1) * TILE_SIZE, static_cast<int32_t>(height));
+            outDamage.AddRect(DisplayRect{ static_cast<uint16_t>(minX), static_cast<uint16_t>(minY), static_cast<uint16_t>(maxX - minX),
+                static_cast<uint16_t>(maxY - minY) });
+        }
+    }
+}
+
+void MeshRenderer::ClipAndSetupTriangle(const Vector4& c0, const Vector4& c1, const Vector4& c2, uint32_t color, BinningChunk& chunk)
+{
+    // Sutherland-Hodgman clipping against each plane in turn, ping-ponging between two polygon buffers.
+    Vector4 polygons[2][MAX_CLIPPED_POLYGON_VERTICES + 1] = { { c0, c1, c2 } };
+    int vertexCount = 3;
+    int currentPolygon = 0;
+
+    for (int planeIndex = 0; planeIndex < CLIP_PLANE_COUNT && vertexCount >= 3; planeIndex++)
+    {
+        const Vector4* input = polygons[currentPolygon];
+        Vector4* output = polygons[1 - currentPolygon];
+        int outputCount = 0;
+
+        for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+        {
+            const Vector4& current = input[vertexIndex];
+            const Vector4& next = input[(vertexIndex + 1) % vertexCount];
+            const float currentDistance = ClipPlaneDistance(current, planeIndex, m_viewport.GuardBandScale);
+            const float nextDistance = ClipPlaneDistance(next, planeIndex, m_viewport.GuardBandScale);
+
+            if (currentDistance >= 0.0f)
+            {
+                output[outputCount++] = current;
+            }
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                output[outputCount++] = Lerp(current, next, currentDistance / (currentDistance - nextDistance));
+            }
+        }
+
+        vertexCount = std::min(outputCount, MAX_CLIPPED_POLYGON_VERTICES);
+        currentPolygon = 1 - currentPolygon;
+    }
+
+    if (vertexCount < 3)
+    {
+        return;
+    }
+
+    // Set up the resulting convex polygon as a fan around its first vertex.
+    const Vector4* polygon = polygons[currentPolygon];
+    const RasterVertex fanOrigin = VertexTransform::ProjectToScreen(polygon[0], m_viewport);
+    RasterVertex previous = VertexTransform::ProjectToScreen(polygon[1], m_viewport);
+    for (int vertexIndex = 2; vertexIndex < vertexCount; vertexIndex++)
+    {
+        const RasterVertex current = VertexTransform::ProjectToScreen(polygon[vertexIndex], m_viewport);
+
+        RasterTriangle triangle;
+        if (Rasterizer::SetupTriangle(fanOrigin, previous, current, color, triangle))
+        {
+            BinTriangle(triangle, chunk);
+        }
+        previous = current;
+    }
+}
@@ -0,0 +1,234 @@
+/*
+    Geometry pipeline turning an indexed mesh seen through a camera into rasterized triangles: frustum culling, vertex transform, clipping,
+    projection to fixed-point screen space, flat shading and rasterization.
+    When the mesh has a bounding volume hierarchy, only triangle chunks intersecting the view frustum go through the pipeline, and of those
+    only the clusters neither facing away from the camera nor outside of the view, with the vertices they use. Chunks are drawn in two
+    passes: chunks visible last frame get drawn first as occluders, then the others get tested against a hierarchical depth buffer of the
+    occluders and only drawn if they may be visible. Chunks far enough from the camera are drawn at the coarsest of their
+    simplified levels (see MeshLod.h) whose error projects to less than a threshold amount of pixels.
+    The screen is split in square tiles. Set up triangles get binned into every tile they overlap, then tiles are rasterized in parallel,
+    each of them by a single job so no two threads ever touch the same pixel. Tiles no triangle got drawn in only hold the background, so
+    the damage of a frame is the tiles drawn in by either it or the frame before it.
+*/
+
+#ifndef MESH_RENDERER_H
+#define MESH_RENDERER_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "MeshLod.h"
+#include "Camera.h"
+#include "Rasterizer.h"
+#include "VertexTransform.h"
+#include "HierarchicalDepthBuffer.h"
+#include "JobSystem.h"
+#include "MemoryArena.h"
+#include "DisplayDamage.h"
+
+/// @brief Counters describing the work done by the last rendered frame.
+struct RenderStatistics
+{
+    uint32_t ChunksFrustumCulled = 0; // Chunks of the mesh outside of the view frustum.
+    uint32_t ChunksOcclusionCulled = 0; // Chunks of the mesh in view, but hidden behind chunks drawn as occluders.
+    uint32_t ChunksRendered = 0; // Chunks of the mesh drawn, as occluders or after passing the occlusion test.
+    uint32_t ChunksSimplified = 0; // Chunks of the mesh drawn at one of their simplified levels.
+    uint32_t ClustersTested = 0; // Clusters of full detail chunks drawn, and simplified chunks drawn as one, tested for backface & frustum culling.
+    uint32_t ClustersBackfaceCulled = 0; // Tested clusters skipped because all their triangles face away from the camera.
+    uint32_t ClustersFrustumCulled = 0; // Tested clusters skipped because their bounds are outside of the view frustum.
+    uint32_t TrianglesCulled = 0; // Triangles of the mesh skipped because their chunk or cluster was culled.
+    uint32_t TrianglesSimplified = 0; // Triangles of drawn chunks removed by the simplified levels they were drawn at.
+    uint32_t TrianglesSubmitted = 0; // Triangles of the mesh fed to the pipeline.
+    uint32_t VerticesTransformed = 0; // Vertices of the mesh transformed to clip space.
+    uint32_t TrianglesClipped = 0; // Triangles crossing the near plane or guard band, which had to be clipped into polygons.
+    uint32_t TrianglesRasterized = 0; // Triangles (including clipping products) that survived culling and were rasterized.
+    uint32_t TileBinEntries = 0; // Sum over rasterized triangles of the amount of tiles they were binned into.
+};
+
+class MeshRenderer
+{
+public:
+
+    // Size in pixels of the square screen tiles triangles get binned into.
+    static constexpr int32_t TILE_SIZE = 64;
+
+    /// @brief Renders a mesh into the passed color buffer. Depth is handled internally, using a depth buffer matching the color buffer's size.
+    /// The color buffer is cleared first.
+    /// @param mesh Mesh to render, in world space.
+    /// @param bvh Hierarchy built over the mesh, used for frustum & occlusion culling. When empty, the whole mesh gets processed.
+    /// @param lods Simplified levels of the mesh's chunks. When empty, chunks are always drawn at full detail.
+    /// @param camera Camera to render the mesh from.
+    /// @param colorBuffer Pixel buffer to draw into, usually from a Memory Map Drawer.
+    /// @param width Width in pixels of the color buffer.
+    /// @param height Height in pixels of the color buffer.
+    /// @param frameArena Arena scratch data of the frame (triangle lists, set up triangles, tile bins) gets allocated from. It must not be reset
+    /// before this returns.
+    /// @param jobSystem Job system every stage of the pipeline gets spread across.
+    void Render(const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods, const Camera& camera, Pixel_RGBA* colorBuffer, uint16_t width, uint16_t height,
+        MemoryArena& frameArena, JobSystem& jobSystem);
+
+    /// @brief Sets the arena buffers sized after the rendered mesh (such as transformed vertices) get allocated from, releasing current ones.
+    /// Buffers only get reallocated when a larger mesh gets rendered, so the arena only grows with the largest mesh.
+    void SetPersistentArena(MemoryArena& arena) { m_vertices = VertexTransform::TransformedVertices(&arena); }
+
+    const RenderStatistics& GetLastFrameStatistics() const { return m_statistics; }
+
+    /// @brief Computes the regions of the last rendered frame that differ from the frame rendered before it, in color buffer pixels.
+    /// The whole frame is damaged when it doesn't have the same size as the frame before it.
+    void GetLastFrameDamage(DisplayDamage& outDamage) const;
+
+    /// @brief Sets how far, in pixels, a simplified level of a chunk may deviate on screen from its full detail level to be drawn instead.
+    /// 0 always draws chunks at full detail.
+    void SetLodErrorThreshold(float pixels) { m_lodErrorThreshold = pixels; }
+
+    /// @brief Sets the SIMD paths the pipeline's kernels take, see CpuFeatures::DetectSimdPaths. Kernels stick to the compilation target until
+    /// then.
+    void SetSimdPaths(const SimdPaths& simdPaths) { m_simdPaths = simdPaths; }
+    const SimdPaths& GetSimdPaths() const { return m_simdPaths; }
+
+private:
+
+    /// @brief Run of consecutive mesh vertices going through the pipeline.
+    struct ElementRange
+    {
+        uint32_t First;
+        uint32_t End;
+    };
+
+    /// @brief Run of consecutive triangles going through the pipeline, read from the mesh's indices or from one of its simplified levels.
+    struct TriangleRange
+    {
+        const uint32_t* Indices;
+        uint32_t TriangleCount;
+    };
+
+    // Triangles held by each block of a tile bin, sized so blocks take 256 bytes.
+    static constexpr uint32_t TILE_BIN_BLOCK_SIZE = 30;
+
+    /// @brief Block of a tile bin, allocated from the frame arena. Bins are chains of blocks in binning order.
+    struct TileBinBlock
+    {
+        TileBinBlock* Next;
+        uint32_t TriangleCount;
+        const RasterTriangle* Triangles[TILE_BIN_BLOCK_SIZE];
+    };
+
+    /// @brief Triangles of a binning chunk overlapping a tile.
+    struct TileBin
+    {
+        TileBinBlock* FirstBlock;
+        TileBinBlock* LastBlock;
+    };
+
+    /// @brief Set up triangles of a contiguous range of mesh triangles, binned per screen tile. Each chunk is filled by a single job,
+    /// and tiles read chunks in order so triangles get rasterized in submission order.
+    /// Set up triangles & bins are allocated from the frame arena, in blocks so they never need to be moved.
+    struct BinningChunk
+    {
+        // Block set up triangles get stored into, and the amount of triangles it holds.
+        RasterTriangle* TriangleBlock = nullptr;
+        uint32_t TriangleBlockCount = 0;
+        // Bin of every tile.
+        TileBin* TileBins = nullptr;
+
+        RenderStatistics Statistics;
+    };
+
+    /// @brief Runs the pipeline over the triangle ranges & vertex batches of the current pass.
+    /// @param bClearTiles Whether tiles get cleared before rasterization. Later passes draw over the previous ones.
+    void RenderPass(const Mesh& mesh, const Matrix4x4& viewProjection, const Vector3& towardsLight, const RenderTarget& target, bool bClearTiles,
+        JobSystem& jobSystem);
+
+    /// @brief Fills the triangle ranges & vertex batches of the current pass with the whole mesh.
+    void PrepareWholeMeshPass(const Mesh& mesh);
+
+    /// @brief Fills the triangle ranges & vertex batches of the current pass with the chunks flagged in passChunks, each at the level of
+    /// detail selected for it this frame.
+    void PrepareChunkPass(const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods, const std::vector<uint8_t>& passChunks);
+
+    /// @brief Appends a run of triangles to the current pass, merging it with the previous run if it directly follows it.
+    void AddPassTriangles(const TriangleRange& range);
+
+    /// @brief Marks the vertex blocks overlapping a range of vertices for transformation by the current pass.
+    void MarkPassVertices(uint32_t firstVertex, uint32_t endVertex);
+
+    /// @brief Picks the coarsest level of a chunk whose error projects to at most the error threshold on screen.
+    /// @return The selected level, 0 being full detail.
+    uint32_t SelectChunkLevel(const MeshBvh::Chunk& chunk, const MeshLods& lods, size_t chunkIndex) const;
+
+    /// @brief Tests the bounds of a chunk against the hierarchical depth buffer. Conservative: visible chunks are never reported as occluded.
+    bool IsChunkOccluded(const MeshBvh::Chunk& chunk, const Matrix4x4& viewProjection) const;
+
+    /// @brief Culls, clips, sets up and bins a run of triangles into a chunk.
+    /// @param indices Vertex indices of the triangles, 3 per triangle.
+    void SetupAndBinTriangles(const Mesh& mesh, const uint32_t* indices, size_t triangleCount, const Vector3& towardsLight, BinningChunk& chunk);
+
+    /// @brief Adds a set up triangle to the chunk, binning it into every tile its bounds overlap.
+    void BinTriangle(const RasterTriangle& triangle, BinningChunk& chunk);
+
+    /// @brief Rasterizes every triangle binned into a tile, clearing it first if asked to, then updates its hierarchical depth.
+    void RasterizeTile(uint32_t tileIndex, const RenderTarget& target, bool bClear);
+
+    /// @brief Clips a triangle crossing the near plane or guard band in clip space, then sets up & bins the resulting polygon as a triangle fan.
+    void ClipAndSetupTriangle(const Vector4& c0, const Vector4& c1, const Vector4& c2, uint32_t color, BinningChunk& chunk);
+
+    // Chunk visibility: chunks in view this frame, chunks drawn (and not hidden by the end of the frame) last frame, and chunks drawn by the
+    // current pass.
+    std::vector<uint8_t> m_chunksInFrustum;
+    std::vector<uint8_t> m_chunksVisibleLastFrame;
+    std::vector<uint8_t> m_passChunks;
+
+    // Arena scratch data of the current frame gets allocated from.
+    MemoryArena* m_frameArena = nullptr;
+
+    // Work of the current pass: runs of triangles to set up (in chunk order) and batches of vertices to transform. Vertices outside of batches
+    // hold stale data from previous passes, which no triangle of the pass reads. Allocated from the frame arena, with room for the worst case.
+    ArenaVector<TriangleRange> m_passTriangleRanges;
+    ArenaVector<ElementRange> m_vertexBatches;
+    // Blocks of vertices used by chunks of the current pass.
+    std::vector<uint8_t> m_passVertexBlocks;
+
+    // Every mesh vertex transformed for the current frame, as structure of arrays streams.
+    VertexTransform::TransformedVertices m_vertices;
+
+    std::vector<float> m_depthBuffer;
+    // Farthest depths of the depth buffer over coarse cells, updated as tiles get rasterized.
+    HierarchicalDepthBuffer m_hierarchicalDepth;
+
+    // SIMD paths the vertex transform & rasterizer kernels take.
+    SimdPaths m_simdPaths;
+
+    // Viewport for the current frame.
+    VertexTransform::Viewport m_viewport = { 0.0f, 0.0f, 1.0f };
+
+    // Level of detail selection: camera position for the current frame, and the distance at which an error of one mesh unit projects to
+    // the error threshold (0 when simplified levels are disabled).
+    Vector3 m_cameraPosition = {0.0f, 0.0f, 0.0f};
+    float m_lodDistancePerError = 0.0f;
+    float m_lodErrorThreshold = 1.0f;
+
+    // Cluster culling data for the current frame. Clusters only get culled when the hierarchy has them.
+    MeshBvh::ClusterCullingView m_clusterCullingView;
+    bool m_bCullClusters = false;
+
+    // Tile grid for the current frame.
+    int32_t m_tileCountX = 0;
+    int32_t m_tileCountY = 0;
+
+    // Whether triangles got drawn in each tile by the current frame and the frame before it, for damage tracking. One byte per tile, so
+    // tile jobs never share a flag.
+    std::vector<uint8_t> m_tilesDrawn;
+    std::vector<uint8_t> m_tilesDrawnLastFrame;
+    // Whether the current frame has another size than the frame before it (or is the first one), damaging all of it.
+    bool m_bFullFrameDamage = true;
+
+    // Binning chunks of the current pass, kept from frame to frame. Their triangles & bins live in the frame arena.
+    std::vector<BinningChunk> m_chunks;
+    uint32_t m_activeChunkCount = 0;
+
+    RenderStatistics m_statistics;
+};
+
+#endif // MESH_RENDERER_H
@@ -0,0 +1,238 @@
+#include "ModelLoader.h"
+#include "Platform.h"
+#include "ObjLoader.h"
+#include "GltfLoader.h"
+#include "StlLoader.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    // Processing flags cache keys get built with (see MeshCache::SourceKey).
+    const uint32_t PROCESSING_FLAG_OPTIMIZED = 1 << 0;
+    const uint32_t PROCESSING_FLAG_LODS = 1 << 1;
+
+    /// Returns the lower case extension of a file path without its dot, or an empty string if it has none.
+    std::string GetLowerCaseExtension(const std::string& filePath)
+    {
+        const size_t dotPosition = filePath.find_last_of('.');
+        const size_t separatorPosition = filePath.find_last_of("/\\");
+        if (dotPosition == std::string::npos || (separatorPosition != std::string::npos && dotPosition < separatorPosition))
+        {
+            return std::string();
+        }
+
+        std::string extension = filePath.substr(dotPosition + 1);
+        for (char& c : extension)
+        {
+            if (c >= 'A' && c <= 'Z')
+            {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return extension;
+    }
+
+    /// Loads a model from its source format. Format-specific load reports are displayed along the way.
+    /// @return True if the model was loaded, false otherwise (in which case the failure has been reported).
+    bool LoadModelFromSource(const std::string& filePath, const std::string& extension, PlatformFileSystem& fileSystem, PlatformDebugger& debugger,
+        JobSystem& jobSystem, Mesh& outMesh)
+    {
+        PROFILE_ZONE("ModelLoader::LoadModelFromSource");
+
+        std::string loadMessage;
+        bool bLoaded;
+        if (extension == "stl")
+        {
+            // STL files are streamed rather than mapped, so their size never shows up in memory use.
+            std::shared_ptr<PlatformFileSystem::FileReader> reader = fileSystem.OpenFileForReading(filePath);
+            if (reader == nullptr)
+            {
+                debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot load model '%s': file could not be opened.", filePath);
+                return false;
+            }
+
+            StlLoader::LoadStatistics statistics;
+            bLoaded = StlLoader::LoadMesh(*reader, outMesh, statistics, loadMessage);
+            if (bLoaded)
+            {
+                debugger.Log<DebugLogMessage::Category::LOG>("STL data (%s): %llu triangles welded into %zu vertices, %llu degenerate triangles dropped.",
+                    statistics.bBinary ? "binary" : "ASCII", statistics.FileTriangleCount, outMesh.GetVertexCount(), statistics.DegenerateTriangleCount);
+            }
+        }
+        else
+        {
+            std::shared_ptr<PlatformFileSystem::MappedFile> file = fileSystem.MapFileReadOnly(filePath);
+            if (file == nullptr)
+            {
+                debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot load model '%s': file could not be opened.", filePath);
+                return false;
+            }
+
+            if (extension == "glb")
+            {
+                // The mesh may keep referencing the mapped file, which then stays mapped for as long as the mesh lives.
+                GltfLoader::LoadStatistics statistics;
+                bLoaded = GltfLoader::LoadMesh(file->GetData(), file->GetSize(), file, jobSystem, outMesh, statistics, loadMessage);
+                if (bLoaded)
+                {
+                    debugger.Log<DebugLogMessage::Category::LOG>("glTF data: %.1f MB referenced in place, %.1f MB converted, %zu non-triangle primitives skipped.",
+                        statistics.ReferencedByteCount / (1024.0 * 1024.0), statistics.ConvertedByteCount / (1024.0 * 1024.0),
+                        statistics.SkippedPrimitiveCount);
+                }
+            }
+            else
+            {
+                bLoaded = ObjLoader::LoadMesh(file->GetData(), file->GetSize(), jobSystem, outMesh, loadMessage);
+            }
+        }
+
+        if (!bLoaded)
+        {
+            debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot load model '%s': %s", filePath, loadMessage);
+            return false;
+        }
+
+        // Loaders may succeed with a message describing parts of the file they had to skip.
+        if (!loadMessage.empty())
+        {
+            debugger.Log<DebugLogMessage::Category::WARNING>("While loading model '%s': %s", filePath, loadMessage);
+        }
+
+        return true;
+    }
+
+    /// Optimizes a freshly loaded mesh, reporting how much rendering efficiency it gained.
+    void OptimizeLoadedMesh(Mesh& mesh, JobSystem& jobSystem, PlatformDebugger& debugger)
+    {
+        PROFILE_ZONE("ModelLoader::OptimizeLoadedMesh");
+        const std::chrono::steady_clock::time_point optimizeStartTime = std::chrono::steady_clock::now();
+
+        const MeshOptimizer::MeshStatistics before = MeshOptimizer::AnalyzeMesh(mesh, jobSystem);
+        MeshOptimizer::OptimizeMesh(mesh);
+        const MeshOptimizer::MeshStatistics after = MeshOptimizer::AnalyzeMesh(mesh, jobSystem);
+
+        debugger.Log<DebugLogMessage::Category::LOG>("Mesh optimized in %.3f s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overdraw %.3f -> %.3f.",
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - optimizeStartTime).count(),
+            before.Acmr, after.Acmr, before.Atvr, after.Atvr, before.Overdraw, after.Overdraw);
+    }
+}
+
+bool ModelLoader::LoadModel(const std::string& filePath, const LoadSettings& settings, PlatformFileSystem& fileSystem, PlatformDebugger& debugger,
+    JobSystem& jobSystem, Mesh& outMesh, MeshBvh& outBvh, MeshLods& outLods)
+{
+    PROFILE_ZONE("ModelLoader::LoadModel");
+    const std::chrono::steady_clock::time_point loadStartTime = std::chrono::steady_clock::now();
+
+    const std::string extension = GetLowerCaseExtension(filePath);
+    if (extension != "obj" && extension != "glb" && extension != "stl")
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot load model '%s': unsupported file format '%s'.", filePath, extension);
+        return false;
+    }
+
+    PlatformFileSystem::FileInfo fileInfo;
+    if (!fileSystem.GetFileInfo(filePath, fileInfo))
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot load model '%s': file could not be opened.", filePath);
+        return false;
+    }
+
+    const uint32_t processingFlags = (settings.bOptimizeMesh ? PROCESSING_FLAG_OPTIMIZED : 0) | (settings.bGenerateLods ? PROCESSING_FLAG_LODS : 0);
+    const MeshCache::SourceKey cacheKey = MeshCache::ComputeSourceKey(filePath, fileInfo, processingFlags);
+    const std::string cacheFilePath = settings.bUseCache ? MeshCache::GetCacheFilePath(filePath, settings.CacheDirectoryPath) : std::string();
+
+    bool bLoadedFromCache = false;
+    if (!cacheFilePath.empty())
+    {
+        // A missing cache simply means this model was never loaded before. The mapping is released right away if the cache gets rejected,
+        // so it can be overwritten.
+        std::shared_ptr<PlatformFileSystem::MappedFile> cacheFile = fileSystem.MapFileReadOnly(cacheFilePath);
+        if (cacheFile != nullptr)
+        {
+            PROFILE_ZONE("MeshCache::LoadMesh");
+            std::string cacheError;
+            bLoadedFromCache = MeshCache::LoadMesh(cacheFile, cacheKey, outMesh, outBvh, outLods, cacheError);
+            if (!bLoadedFromCache)
+            {
+                debugger.Log<DebugLogMessage::Category::LOG>("Rebuilding model cache '%s': %s", cacheFilePath, cacheError);
+            }
+        }
+    }
+
+    if (!bLoadedFromCache)
+    {
+        if (!LoadModelFromSource(filePath, extension, fileSystem, debugger, jobSystem, outMesh))
+        {
+            return false;
+        }
+
+        // Cached meshes were optimized before being written, so this only ever runs once per model.
+        if (settings.bOptimizeMesh)
+        {
+            OptimizeLoadedMesh(outMesh, jobSystem, debugger);
+        }
+
+        // Chunks are cut from the final triangle order, so the hierarchy gets built last, and levels of detail over its chunks after it.
+        BuildMeshBvh(outMesh, jobSystem, debugger, outBvh);
+        if (settings.bGenerateLods)
+        {
+            BuildMeshLods(outMesh, outBvh, jobSystem, debugger, outLods);
+        }
+    }
+
+    const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStartTime).count();
+    const double megabytes = fileInfo.Size / (1024.0 * 1024.0);
+
+    debugger.Log<DebugLogMessage::Category::SUCCESS>("Loaded model '%s'%s: %.1f MB in %.3f s (%.1f MB/s), %zu vertices & %zu triangles.",
+        filePath, bLoadedFromCache ? " from cache" : "", megabytes, loadSeconds, loadSeconds > 0.0 ? megabytes / loadSeconds : 0.0,
+        outMesh.GetVertexCount(), outMesh.GetTriangleCount());
+
+    if (!bLoadedFromCache && !cacheFilePath.empty())
+    {
+        // Failing to write the cache only costs the next launch some time, so it isn't an error.
+        PROFILE_ZONE("MeshCache::WriteMesh");
+        const std::chrono::steady_clock::time_point writeStartTime = std::chrono::steady_clock::now();
+        std::shared_ptr<PlatformFileSystem::FileWriter> cacheWriter = fileSystem.CreateFileForWriting(cacheFilePath);
+        if (cacheWriter != nullptr && MeshCache::WriteMesh(*cacheWriter, cacheKey, outMesh, outBvh, outLods) && cacheWriter->Commit())
+        {
+            debugger.Log<DebugLogMessage::Category::LOG>("Wrote model cache '%s' in %.3f s.", cacheFilePath,
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStartTime).count());
+        }
+        else
+        {
+            debugger.Log<DebugLogMessage::Category::WARNING>("Could not write model cache '%s'.", cacheFilePath);
+        }
+    }
+
+    return true;
+}
+
+void ModelLoader::BuildMeshBvh(const Mesh& mesh, JobSystem& jobSystem, PlatformDebugger& debugger, MeshBvh& outBvh)
+{
+    PROFILE_ZONE("ModelLoader::BuildMeshBvh");
+    const std::chrono::steady_clock::time_point buildStartTime = std::chrono::steady_clock::now();
+    const MeshBvh::BuildStatistics statistics = outBvh.Build(mesh, jobSystem);
+
+    debugger.Log<DebugLogMessage::Category::LOG>("Built BVH over %u chunks of %u triangles in %.2f ms: %u nodes, %u leaves, depth %u.",
+        statistics.ChunkCount, MeshBvh::TRIANGLES_PER_CHUNK, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStartTime).count(),
+        statistics.NodeCount, statistics.LeafCount, statistics.Depth);
+}
+
+void ModelLoader::BuildMeshLods(const Mesh& mesh, const MeshBvh& bvh, JobSystem& jobSystem, PlatformDebugger& debugger, MeshLods& outLods)
+{
+    PROFILE_ZONE("ModelLoader::BuildMeshLods");
+    const std::chrono::steady_clock::time_point buildStartTime = std::chrono::steady_clock::now();
+    const MeshLods::BuildStatistics statistics = outLods.Build(mesh, bvh, jobSystem);
+
+    static_assert(MeshLods::LEVEL_COUNT == 4, "Log every level's triangle count below.");
+    debugger.Log<DebugLogMessage::Category::LOG>("Built %u of %u levels of detail in %.2f ms, triangles per level: %llu %llu %llu %llu %llu. %u of %u chunks stopped early, "
+        "their next level removing too few triangles.", statistics.BuiltLevelCount, MeshLods::LEVEL_COUNT,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStartTime).count(), statistics.LevelTriangleCounts[0],
+        statistics.LevelTriangleCounts[1], statistics.LevelTriangleCounts[2], statistics.LevelTriangleCounts[3], statistics.LevelTriangleCounts[4],
+        statistics.StoppedChunkCount, static_cast<uint32_t>(bvh.GetChunkCount()));
+}
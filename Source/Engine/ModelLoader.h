@@ -0,0 +1,58 @@
+/*
+    Single entry point the Engine uses to load 3D model files, whatever their format. Files are accessed through the platform's
+    memory mapping service, dispatched to the right format loader by extension, and load statistics are reported to the platform debugger.
+    Loaded meshes get optimized for rendering and get a bounding volume hierarchy and simplified levels of detail built over them, then all are written to a binary cache (see MeshCache.h), which later loads of the same unchanged file map instead of parsing the file.
+*/
+
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <string>
+
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "MeshLod.h"
+#include "JobSystem.h"
+
+class PlatformDebugger;
+class PlatformFileSystem;
+
+namespace ModelLoader
+{
+    /// @brief Processing applied to loaded models.
+    struct LoadSettings
+    {
+        // Whether meshes loaded from model files get reordered for rendering efficiency (see MeshOptimizer.h).
+        bool bOptimizeMesh = true;
+
+        // Whether simplified levels of detail get generated for the chunks of loaded meshes (see MeshLod.h).
+        bool bGenerateLods = true;
+
+        // Whether loaded models get cached.
+        bool bUseCache = true;
+        // Directory cache files are kept in, which must exist. When empty, caches sit next to their model file.
+        std::string CacheDirectoryPath;
+    };
+
+    /// @brief Loads a model file into a mesh. Supported formats: Wavefront OBJ (.obj), binary glTF (.glb), STL (.stl).
+    /// Success (with load throughput), warnings and errors get reported through the platform debugger.
+    /// @param filePath Path to the model file, UTF-8 encoded.
+    /// @param settings Load settings. When caching, an up to date cache is loaded instead of the file, any other gets (re)written after loading the file.
+    /// @param fileSystem Platform file system the file gets mapped with.
+    /// @param debugger Platform debugger load reports are displayed with.
+    /// @param jobSystem Job system format loaders spread their work across.
+    /// @param outMesh Mesh to fill. Left in an unspecified state if loading fails.
+    /// @param outBvh Hierarchy to build over the mesh, or load from the cache. Left in an unspecified state if loading fails.
+    /// @param outLods Levels of detail to build over the hierarchy's chunks, or load from the cache. Left empty when not generating levels.
+    /// @return True if the model was loaded, false otherwise.
+    bool LoadModel(const std::string& filePath, const LoadSettings& settings, PlatformFileSystem& fileSystem, PlatformDebugger& debugger, JobSystem& jobSystem,
+        Mesh& outMesh, MeshBvh& outBvh, MeshLods& outLods);
+
+    /// @brief Builds the bounding volume hierarchy of a mesh and reports its build cost through the platform debugger.
+    void BuildMeshBvh(const Mesh& mesh, JobSystem& jobSystem, PlatformDebugger& debugger, MeshBvh& outBvh);
+
+    /// @brief Builds the levels of detail of a mesh's chunks and reports their build cost & triangle counts through the platform debugger.
+    void BuildMeshLods(const Mesh& mesh, const MeshBvh& bvh, JobSystem& jobSystem, PlatformDebugger& debugger, MeshLods& outLods);
+}
+
+#endif // MODEL_LOADER_H
@@ -0,0 +1,501 @@
+#include "ObjLoader.h"
+#include "TextParsing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+namespace
+{
+    // Chunks hold at least this many bytes of OBJ text, so small files don't get split for nothing.
+    const size_t MIN_CHUNK_SIZE = 1 << 20;
+    // Chunks per job system thread. More chunks than threads balances uneven chunk parsing costs.
+    const size_t CHUNKS_PER_THREAD = 8;
+    // Hash buckets per job system thread for index triple de-duplication.
+    const size_t DEDUPLICATION_BUCKETS_PER_THREAD = 4;
+
+    const int32_t NO_INDEX = -1;
+
+    /// Position / texture coordinate / normal index triple of a face corner. Absent attributes are NO_INDEX.
+    struct CornerKey
+    {
+        int32_t Position, TexCoord, Normal;
+
+        inline bool operator==(const CornerKey& other) const
+        {
+            return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal;
+        }
+    };
+
+    inline uint64_t HashCornerKey(const CornerKey& key)
+    {
+        uint64_t hash = static_cast<uint32_t>(key.Position) * 0x9E3779B97F4A7C15ull;
+        hash ^= (static_cast<uint32_t>(key.TexCoord) + 0x632BE59BD9B4E019ull + (hash << 6) + (hash >> 2)) * 0xC2B2AE3D27D4EB4Full;
+        hash ^= (static_cast<uint32_t>(key.Normal) + 0x165667B19E3779F9ull + (hash << 6) + (hash >> 2)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    /// Parsing results of one line-aligned chunk of the file.
+    struct ObjChunk
+    {
+        const char* Begin;
+        const char* End;
+
+        std::vector<Vector3> Positions;
+        std::vector<Vector2> TexCoords;
+        std::vector<Vector3> Normals;
+
+        // Triangle corners, 3 per triangle, in file order.
+        std::vector<CornerKey> Corners;
+
+        // Negative OBJ indices are relative to the attributes declared so far, which parallel parsing only knows within the chunk.
+        // Those get stored as chunk-local indices (possibly negative when reaching into previous chunks) and fixed up after merging.
+        // Each entry is a corner index times 3 plus the attribute index (0: position, 1: texture coordinate, 2: normal).
+        std::vector<size_t> RelativeIndexSlots;
+
+        // Index of the first attribute of each kind of this chunk in the merged arrays, and of its first corner.
+        size_t PositionBase = 0, TexCoordBase = 0, NormalBase = 0, CornerBase = 0;
+
+        size_t MalformedLineCount = 0;
+    };
+
+    /// Parses a face corner index ("12", "-3"...), converting it from OBJ's 1-based convention.
+    /// Relative (negative) indices are converted to chunk-local indices and flagged in outRelativeMask with the given attribute bit.
+    inline bool ParseCornerIndex(const char*& cursor, const char* end, size_t localAttributeCount, uint32_t attributeBit,
+        int32_t& outIndex, uint32_t& outRelativeMask)
+    {
+        int64_t objIndex;
+        if (!TextParsing::ParseInteger(cursor, end, objIndex) || objIndex == 0 || objIndex > INT32_MAX || objIndex < -INT32_MAX)
+        {
+            return false;
+        }
+
+        if (objIndex > 0)
+        {
+            outIndex = static_cast<int32_t>(objIndex - 1);
+        }
+        else
+        {
+            outIndex = static_cast<int32_t>(static_cast<int64_t>(localAttributeCount) + objIndex);
+            outRelativeMask |= attributeBit;
+        }
+        return true;
+    }
+
+    /// Appends a triangle corner, recording slots of its relative indices.
+    inline void PushCorner(ObjChunk& chunk, const CornerKey& corner, uint32_t relativeMask)
+    {
+        const size_t cornerIndex = chunk.Corners.size();
+        for (uint32_t attribute = 0; attribute < 3; attribute++)
+        {
+            if (relativeMask & (1u << attribute))
+            {
+                chunk.RelativeIndexSlots.push_back(cornerIndex * 3 + attribute);
+            }
+        }
+        chunk.Corners.push_back(corner);
+    }
+
+    /// Parses the corners of a face statement ("f 1/2/3 4/5/6 ...") and triangulates it as a fan.
+    bool ParseFace(const char*& cursor, const char* end, ObjChunk& chunk)
+    {
+        CornerKey firstCorner = {}, previousCorner = {};
+        uint32_t firstRelativeMask = 0, previousRelativeMask = 0;
+        uint32_t cornerCount = 0;
+
+        // Triangles emitted by this face get appended; roll them back if the face turns out to be malformed.
+        const size_t cornersBefore = chunk.Corners.size();
+        const size_t relativeSlotsBefore = chunk.RelativeIndexSlots.size();
+
+        bool bValid = true;
+        while (bValid)
+        {
+            TextParsing::SkipBlanks(cursor, end);
+            if (cursor >= end || *cursor == '\n' || *cursor == '#')
+            {
+                break;
+            }
+
+            CornerKey corner = { NO_INDEX, NO_INDEX, NO_INDEX };
+            uint32_t relativeMask = 0;
+
+            bValid = ParseCornerIndex(cursor, end, chunk.Positions.size(), 1u << 0, corner.Position, relativeMask);
+            if (bValid && cursor < end && *cursor == '/')
+            {
+                cursor++;
+                if (cursor < end && *cursor != '/')
+                {
+                    bValid = ParseCornerIndex(cursor, end, chunk.TexCoords.size(), 1u << 1, corner.TexCoord, relativeMask);
+                }
+                if (bValid && cursor < end && *cursor == '/')
+                {
+                    cursor++;
+                    bValid = ParseCornerIndex(cursor, end, chunk.Normals.size(), 1u << 2, corner.Normal, relativeMask);
+                }
+            }
+            bValid = bValid && (cursor >= end || TextParsing::IsBlank(*cursor) || *cursor == '\n');
+
+            if (!bValid)
+            {
+                break;
+            }
+
+            if (cornerCount == 0)
+            {
+                firstCorner = corner;
+                firstRelativeMask = relativeMask;
+            }
+            else if (cornerCount >= 2)
+            {
+                PushCorner(chunk, firstCorner, firstRelativeMask);
+                PushCorner(chunk, previousCorner, previousRelativeMask);
+                PushCorner(chunk, corner, relativeMask);
+            }
+
+            previousCorner = corner;
+            previousRelativeMask = relativeMask;
+            cornerCount++;
+        }
+
+        if (!bValid || cornerCount < 3)
+        {
+            chunk.Corners.resize(cornersBefore);
+            chunk.RelativeIndexSlots.resize(relativeSlotsBefore);
+            return false;
+        }
+        return true;
+    }
+
+    /// Parses a float preceded by any amount of blanks.
+    inline bool ParseNextFloat(const char*& cursor, const char* end, float& outValue)
+    {
+        TextParsing::SkipBlanks(cursor, end);
+        return TextParsing::ParseFloat(cursor, end, outValue);
+    }
+
+    /// Parses every line of a chunk.
+    void ParseChunk(ObjChunk& chunk)
+    {
+        const char* cursor = chunk.Begin;
+        const char* end = chunk.End;
+
+        while (cursor < end)
+        {
+            TextParsing::SkipBlanks(cursor, end);
+            if (cursor + 1 >= end)
+            {
+                break;
+            }
+
+            bool bValid = true;
+            if (cursor[0] == 'v' && TextParsing::IsBlank(cursor[1]))
+            {
+                cursor += 2;
+                Vector3 position;
+                bValid = ParseNextFloat(cursor, end, position.x)
+                    && ParseNextFloat(cursor, end, position.y)
+                    && ParseNextFloat(cursor, end, position.z);
+                if (bValid)
+                {
+                    chunk.Positions.push_back(position);
+                }
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 't' && cursor + 2 < end && TextParsing::IsBlank(cursor[2]))
+            {
+                cursor += 3;
+                Vector2 texCoord;
+                bValid = ParseNextFloat(cursor, end, texCoord.x);
+                // The V coordinate is optional in OBJ files.
+                if (!ParseNextFloat(cursor, end, texCoord.y))
+                {
+                    texCoord.y = 0.0f;
+                }
+                if (bValid)
+                {
+                    chunk.TexCoords.push_back(texCoord);
+                }
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 'n' && cursor + 2 < end && TextParsing::IsBlank(cursor[2]))
+            {
+                cursor += 3;
+                Vector3 normal;
+                bValid = ParseNextFloat(cursor, end, normal.x)
+                    && ParseNextFloat(cursor, end, normal.y)
+                    && ParseNextFloat(cursor, end, normal.z);
+                if (bValid)
+                {
+                    chunk.Normals.push_back(normal);
+                }
+            }
+            else if (cursor[0] == 'f' && TextParsing::IsBlank(cursor[1]))
+            {
+                cursor += 2;
+                bValid = ParseFace(cursor, end, chunk);
+            }
+
+            if (!bValid)
+            {
+                chunk.MalformedLineCount++;
+            }
+
+            // Anything else (comments, groups, materials...) is ignored, as is whatever follows the parsed values.
+            TextParsing::SkipLine(cursor, end);
+        }
+    }
+}
+
+bool ObjLoader::LoadMesh(const uint8_t* data, size_t size, JobSystem& jobSystem, Mesh& outMesh, std::string& outError)
+{
+    const char* text = reinterpret_cast<const char*>(data);
+    const char* textEnd = text + size;
+    const size_t threadCount = jobSystem.GetWorkerThreadCount() + 1;
+
+    // SPLIT: cut the file in chunks of roughly equal size, moving each boundary to the start of the next line.
+    const size_t chunkCount = std::max<size_t>(std::min(size / MIN_CHUNK_SIZE, threadCount * CHUNKS_PER_THREAD), 1);
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* chunkBegin = text;
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+    {
+        const char* chunkEnd = chunkIndex + 1 == chunkCount ? textEnd : std::max(chunkBegin, text + size * (chunkIndex + 1) / chunkCount);
+        if (chunkEnd < textEnd)
+        {
+            TextParsing::SkipLine(chunkEnd, textEnd);
+        }
+
+        chunks[chunkIndex].Begin = chunkBegin;
+        chunks[chunkIndex].End = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    // PARSE: every chunk independently.
+    jobSystem.ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex)
+    {
+        ParseChunk(chunks[chunkIndex]);
+    });
+
+    // MERGE: compute where each chunk's data goes, then copy it over.
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0, malformedLineCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        chunk.PositionBase = positionCount;
+        chunk.TexCoordBase = texCoordCount;
+        chunk.NormalBase = normalCount;
+        chunk.CornerBase = cornerCount;
+
+        positionCount += chunk.Positions.size();
+        texCoordCount += chunk.TexCoords.size();
+        normalCount += chunk.Normals.size();
+        cornerCount += chunk.Corners.size();
+        malformedLineCount += chunk.MalformedLineCount;
+    }
+
+    if (cornerCount == 0)
+    {
+        outError = "File contains no valid face.";
+        return false;
+    }
+
+    if (positionCount > static_cast<size_t>(INT32_MAX) || cornerCount > static_cast<size_t>(UINT32_MAX))
+    {
+        outError = "File is too large to be indexed with 32 bit indices.";
+        return false;
+    }
+
+    std::vector<Vector3> positions(positionCount);
+    std::vector<Vector2> texCoords(texCoordCount);
+    std::vector<Vector3> normals(normalCount);
+    std::vector<CornerKey> corners(cornerCount);
+    std::atomic<size_t> invalidIndexCount(0);
+
+    jobSystem.ParallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t chunkIndex)
+    {
+        ObjChunk& chunk = chunks[chunkIndex];
+
+        // Relative indices become absolute now that the amount of attributes declared before this chunk is known.
+        for (size_t slot : chunk.RelativeIndexSlots)
+        {
+            CornerKey& corner = chunk.Corners[slot / 3];
+            switch (slot % 3)
+            {
+                case 0: corner.Position += static_cast<int32_t>(chunk.PositionBase); break;
+                case 1: corner.TexCoord += static_cast<int32_t>(chunk.TexCoordBase); break;
+                default: corner.Normal += static_cast<int32_t>(chunk.NormalBase); break;
+            }
+        }
+
+        size_t chunkInvalidIndexCount = 0;
+        for (const CornerKey& corner : chunk.Corners)
+        {
+            chunkInvalidIndexCount += (corner.Position < 0 || static_cast<size_t>(corner.Position) >= positionCount)
+                || corner.TexCoord < NO_INDEX || (corner.TexCoord != NO_INDEX && static_cast<size_t>(corner.TexCoord) >= texCoordCount)
+                || corner.Normal < NO_INDEX || (corner.Normal != NO_INDEX && static_cast<size_t>(corner.Normal) >= normalCount) ? 1 : 0;
+        }
+        invalidIndexCount += chunkInvalidIndexCount;
+
+        std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + chunk.PositionBase);
+        std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), texCoords.begin() + chunk.TexCoordBase);
+        std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + chunk.NormalBase);
+        std::copy(chunk.Corners.begin(), chunk.Corners.end(), corners.begin() + chunk.CornerBase);
+
+        // Release chunk memory as soon as possible, since large files make this step the peak of memory usage.
+        chunk = ObjChunk{};
+    });
+
+    if (invalidIndexCount > 0)
+    {
+        outError = "File contains " + std::to_string(invalidIndexCount.load()) + " face corners referencing undeclared vertex attributes.";
+        return false;
+    }
+
+    outMesh = Mesh{};
+
+    bool bUsesTexCoords = false, bUsesNormals = false;
+    for (const CornerKey& corner : corners)
+    {
+        bUsesTexCoords |= corner.TexCoord != NO_INDEX;
+        bUsesNormals |= corner.Normal != NO_INDEX;
+        if (bUsesTexCoords && bUsesNormals)
+        {
+            break;
+        }
+    }
+
+    if (!bUsesTexCoords && !bUsesNormals)
+    {
+        // Positions only: OBJ indices already are mesh indices, no de-duplication needed.
+        outMesh.Positions = std::move(positions);
+        uint32_t* indices = outMesh.Indices.Allocate(cornerCount);
+        for (size_t cornerIndex = 0; cornerIndex < cornerCount; cornerIndex++)
+        {
+            indices[cornerIndex] = static_cast<uint32_t>(corners[cornerIndex].Position);
+        }
+    }
+    else
+    {
+        // DE-DUPLICATE: every distinct index triple becomes one mesh vertex. Triples are distributed among buckets by hash, each bucket
+        // gets de-duplicated by a single job with its own hash table, then buckets are laid out one after the other.
+        const size_t bucketCount = threadCount * DEDUPLICATION_BUCKETS_PER_THREAD;
+        const size_t cornerBatchCount = chunkCount;
+
+        // Count corners per batch & bucket, so corners can be scattered into per-bucket lists in parallel while keeping file order.
+        std::vector<uint32_t> batchBucketCounts(cornerBatchCount * bucketCount, 0);
+        std::vector<uint8_t> cornerBuckets(cornerCount);
+        jobSystem.ParallelFor(static_cast<uint32_t>(cornerBatchCount), [&](uint32_t batchIndex)
+        {
+            const size_t firstCorner = cornerCount * batchIndex / cornerBatchCount;
+            const size_t endCorner = cornerCount * (batchIndex + 1) / cornerBatchCount;
+            uint32_t* bucketCounts = &batchBucketCounts[batchIndex * bucketCount];
+            for (size_t cornerIndex = firstCorner; cornerIndex < endCorner; cornerIndex++)
+            {
+                const uint8_t bucket = static_cast<uint8_t>((HashCornerKey(corners[cornerIndex]) >> 40) % bucketCount);
+                cornerBuckets[cornerIndex] = bucket;
+                bucketCounts[bucket]++;
+            }
+        });
+
+        std::vector<size_t> bucketCornerBases(bucketCount + 1, 0);
+        std::vector<size_t> batchBucketOffsets(cornerBatchCount * bucketCount);
+        for (size_t bucket = 0; bucket < bucketCount; bucket++)
+        {
+            size_t offset = bucketCornerBases[bucket];
+            for (size_t batchIndex = 0; batchIndex < cornerBatchCount; batchIndex++)
+            {
+                batchBucketOffsets[batchIndex * bucketCount + bucket] = offset;
+                offset += batchBucketCounts[batchIndex * bucketCount + bucket];
+            }
+            bucketCornerBases[bucket + 1] = offset;
+        }
+
+        std::vector<uint32_t> bucketSortedCorners(cornerCount);
+        jobSystem.ParallelFor(static_cast<uint32_t>(cornerBatchCount), [&](uint32_t batchIndex)
+        {
+            const size_t firstCorner = cornerCount * batchIndex / cornerBatchCount;
+            const size_t endCorner = cornerCount * (batchIndex + 1) / cornerBatchCount;
+            size_t* bucketOffsets = &batchBucketOffsets[batchIndex * bucketCount];
+            for (size_t cornerIndex = firstCorner; cornerIndex < endCorner; cornerIndex++)
+            {
+                bucketSortedCorners[bucketOffsets[cornerBuckets[cornerIndex]]++] = static_cast<uint32_t>(cornerIndex);
+            }
+        });
+        cornerBuckets = std::vector<uint8_t>();
+
+        // Each bucket job assigns bucket-local vertex indices, stored in the mesh index buffer until bucket bases are known.
+        uint32_t* indices = outMesh.Indices.Allocate(cornerCount);
+        std::vector<std::vector<CornerKey>> bucketUniqueKeys(bucketCount);
+        jobSystem.ParallelFor(static_cast<uint32_t>(bucketCount), [&](uint32_t bucket)
+        {
+            const size_t bucketCornerCount = bucketCornerBases[bucket + 1] - bucketCornerBases[bucket];
+            size_t tableSize = 16;
+            while (tableSize < bucketCornerCount * 2)
+            {
+                tableSize *= 2;
+            }
+
+            std::vector<uint32_t> table(tableSize, UINT32_MAX);
+            std::vector<CornerKey>& uniqueKeys = bucketUniqueKeys[bucket];
+
+            for (size_t sortedIndex = bucketCornerBases[bucket]; sortedIndex < bucketCornerBases[bucket + 1]; sortedIndex++)
+            {
+                const uint32_t cornerIndex = bucketSortedCorners[sortedIndex];
+                const CornerKey& key = corners[cornerIndex];
+
+                size_t tableIndex = HashCornerKey(key) & (tableSize - 1);
+                while (table[tableIndex] != UINT32_MAX && !(uniqueKeys[table[tableIndex]] == key))
+                {
+                    tableIndex = (tableIndex + 1) & (tableSize - 1);
+                }
+
+                if (table[tableIndex] == UINT32_MAX)
+                {
+                    table[tableIndex] = static_cast<uint32_t>(uniqueKeys.size());
+                    uniqueKeys.push_back(key);
+                }
+                indices[cornerIndex] = table[tableIndex];
+            }
+        });
+
+        std::vector<size_t> bucketVertexBases(bucketCount + 1, 0);
+        for (size_t bucket = 0; bucket < bucketCount; bucket++)
+        {
+            bucketVertexBases[bucket + 1] = bucketVertexBases[bucket] + bucketUniqueKeys[bucket].size();
+        }
+
+        const size_t vertexCount = bucketVertexBases[bucketCount];
+        Vector3* meshPositions = outMesh.Positions.Allocate(vertexCount);
+        Vector2* meshTexCoords = bUsesTexCoords ? outMesh.TexCoords.Allocate(vertexCount) : nullptr;
+        Vector3* meshNormals = bUsesNormals ? outMesh.Normals.Allocate(vertexCount) : nullptr;
+
+        // Build vertices & offset indices by their bucket's base.
+        jobSystem.ParallelFor(static_cast<uint32_t>(bucketCount), [&](uint32_t bucket)
+        {
+            const size_t vertexBase = bucketVertexBases[bucket];
+            const std::vector<CornerKey>& uniqueKeys = bucketUniqueKeys[bucket];
+            for (size_t localIndex = 0; localIndex < uniqueKeys.size(); localIndex++)
+            {
+                const CornerKey& key = uniqueKeys[localIndex];
+                meshPositions[vertexBase + localIndex] = positions[key.Position];
+                if (bUsesTexCoords)
+                {
+                    meshTexCoords[vertexBase + localIndex] = key.TexCoord != NO_INDEX ? texCoords[key.TexCoord] : Vector2{0.0f, 0.0f};
+                }
+                if (bUsesNormals)
+                {
+                    meshNormals[vertexBase + localIndex] = key.Normal != NO_INDEX ? normals[key.Normal] : Vector3{0.0f, 0.0f, 0.0f};
+                }
+            }
+
+            for (size_t sortedIndex = bucketCornerBases[bucket]; sortedIndex < bucketCornerBases[bucket + 1]; sortedIndex++)
+            {
+                indices[bucketSortedCorners[sortedIndex]] += static_cast<uint32_t>(vertexBase);
+            }
+        });
+    }
+
+    outMesh.ComputeBounds();
+
+    if (malformedLineCount > 0)
+    {
+        outError = std::to_string(malformedLineCount) + " malformed lines were skipped.";
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+/*
+    Wavefront OBJ parser, built for multi-gigabyte scans: the file is split in line-aligned chunks parsed in parallel, then
+    position / texture coordinate / normal index triples are merged & de-duplicated into an indexed mesh, in parallel as well.
+*/
+
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Mesh.h"
+#include "JobSystem.h"
+
+namespace ObjLoader
+{
+    /// @brief Parses OBJ text into an indexed mesh. Only geometry is read (v, vt, vn & f statements), polygons are triangulated as fans.
+    /// Everything else (groups, materials, smoothing...) is ignored.
+    /// @param data OBJ file contents. Does not need to be null terminated.
+    /// @param size Size of the contents in bytes.
+    /// @param jobSystem Job system parsing & merging gets spread across.
+    /// @param outMesh Mesh to fill.
+    /// @param outError Filled with a description of the problem when loading fails.
+    /// @return True if the mesh was loaded, false otherwise.
+    bool LoadMesh(const uint8_t* data, size_t size, JobSystem& jobSystem, Mesh& outMesh, std::string& outError);
+}
+
+#endif // OBJ_LOADER_H
@@ -9,10 +9,31 @@
 #include <memory>
 #include <atomic>
 #include "Engine.h"
+#include "DisplayDamage.h"
 
 /// Abstract platform implementation classes, to be implemented in Platform code and passed to the Engine on initialization.
 /// Their role is to give the Engine access to platform resources in a manner it can understand.
 
+/// @brief Wait / notify primitive built on the platform's native facilities, letting a thread sleep until another one has work for it
+/// instead of actively waiting. Notifications latch: one sent while no thread waits wakes the next wait right away, and several sent
+/// before a wait only wake it once.
+class PlatformSignal
+{
+public:
+
+    static constexpr uint32_t INFINITE_TIMEOUT = UINT32_MAX;
+
+    virtual ~PlatformSignal() = default;
+
+    /// @brief Wakes the thread waiting on the signal, or the next one to wait if none currently is. Can be called from any thread.
+    virtual void Notify() = 0;
+
+    /// @brief Sleeps until the signal gets notified, consuming the notification.
+    /// @param timeoutMilliseconds Time after which to stop waiting, INFINITE_TIMEOUT to wait for as long as it takes.
+    /// @return True if the signal got notified, false if the wait timed out.
+    virtual bool Wait(uint32_t timeoutMilliseconds = INFINITE_TIMEOUT) = 0;
+};
+
 /// @brief Platform Debugger is used by the Engine to have the Platform output debug information through some platform-specific channel that can "outlive"
 /// the engine itself in case of fatal failure, usually a console.
 class PlatformDebugger
@@ -29,6 +50,26 @@ public:
     /// usually a console. Note: this may block the calling thread, but the platform should keep the potential blocking time very low.
     /// @param msg DebugLogMessage structure to display.
     virtual void DisplayDebugMessage(DebugLogMessage&& msg) = 0;
+
+    /// @brief Asks the platform to display a printf-style formatted message, formatted later on by whichever thread displays it. Never allocates,
+    /// and compiles out when the category is below DEBUG_LOG_MIN_CATEGORY. Arguments still get evaluated by the caller then: call sites
+    /// whose arguments cost more than reading a few values should be guarded by if constexpr (DebugLog::IsCategoryCompiledIn(...)).
+    /// @param format Format string, which must outlive the message (usually a string literal). See DebugLog::FormatMessage for supported
+    /// conversions.
+    /// @param arguments Format arguments, packed in binary form right away.
+    template<DebugLogMessage::Category CATEGORY, typename... Arguments>
+    void Log(const char* format, const Arguments&... arguments)
+    {
+        if constexpr (DebugLog::IsCategoryCompiledIn(CATEGORY))
+        {
+            DebugLog::PackedArguments packedArguments;
+            (packedArguments.Pack(arguments), ...);
+            DisplayFormattedDebugMessage(CATEGORY, format, packedArguments);
+        }
+    }
+
+    /// @brief Asks the platform to display a message formatted from a format string and packed arguments. See Log.
+    virtual void DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments) = 0;
 };
 
 /// @brief Common RGBA bitmap format we expect the platform to be able to use.
@@ -48,9 +89,9 @@ class PlatformRenderer
 {
 public:
 
-    /// @brief Thread safe memory-mapped pixel data allowing the Engine to draw pixels directly to Platform display.
-    /// When allocated by the platform, some unique pixel buffer should be allocated with it and locked for Engine use. Once the Engine releases the drawer,
-    /// The platform should display it.
+    /// @brief Memory-mapped pixel data allowing the Engine to draw pixels directly to Platform display.
+    /// Display drawers are persistent: the platform keeps a swapchain of them (see DisplaySwapchain.h), recreated only when the display
+    /// gets resized, and the Engine acquires and presents them in rotation.
     class MemoryMapDrawer
     {
     public:
@@ -58,27 +99,13 @@ public:
         MemoryMapDrawer() = delete;
         MemoryMapDrawer(uint16_t w, uint16_t h, uint16_t offsetX, uint16_t offsetY, Pixel_RGBA* buff)
             : m_width(w), m_height(h), m_offsetX(offsetX), m_offsetY(offsetY), m_pixelBuffer(buff)
-            {
-                m_bReadyToDraw = false;
-                m_bShouldBeDiscarded = false;
-            }
+            {}
 
         inline uint16_t GetWidth() const { return m_width; }
         inline uint16_t GetHeight() const { return m_height; }
         inline uint16_t GetOffsetX() const { return m_offsetX; }
         inline uint16_t GetOffsetY() const { return m_offsetY; }
         inline Pixel_RGBA* GetPixelBufferPtr() const { return m_pixelBuffer; }
-        
-        /// @brief Marks this Drawer as ready to be drawn by the Platform.
-        inline void SetReadyToDraw() { m_bReadyToDraw = true; } // #TODO(Marc): Add an assertion system so we can assert that flag wasn't already set.
-        inline bool IsReadyToDraw() { return m_bReadyToDraw; }
-        
-        /// @brief Sets the Drawer's state as "Drawn", giving back control to the Engine in case it needs to make changes to the pixels buffer.
-        inline void SetDrawn() { m_bReadyToDraw = false; }
-
-        /// @brief Marks this Drawer as "to be discarded" by the Platform, usually after the next Render call.
-        inline void Discard() { m_bShouldBeDiscarded = true; }
-        inline bool ShouldDiscard() { return m_bShouldBeDiscarded; }
 
     private:
         // Pixel Width & Height of drawer. Total pixel count should be Width * Height.
@@ -86,32 +113,145 @@ public:
         // Pixel offset of the drawer from, conventionally, the top-left corner of the display.
         uint16_t m_offsetX, m_offsetY;
 
-        // Specifies whether this Drawer is ready to be drawn. Effectively acts as a lock (and may be implemented with locks under the hood depending on platform).
-        // When false, the Engine is still modifying it and the platform should leave it alone.
-        // When true, the Engine is done modifying it and the platform should draw it on next Render call.
-        std::atomic<bool> m_bReadyToDraw;
-
-        /// Specifies whether this Drawer should be discarded by the Platform after the next Render call, whether it is ready to be drawn or not (in the former case,
-        /// it WILL be drawn before being discarded).
-        std::atomic<bool> m_bShouldBeDiscarded;
-
-        // Internal pointer to allocated pixel buffer memory.
+        // Internal pointer to pixel buffer memory, owned by the platform.
         Pixel_RGBA* m_pixelBuffer;
     };
 
-    /// @brief Allocates and returns a new Memory Map Drawer for drawing over the entirety of the available display space.
-    /// @return Newly allocated Memory Map Drawer. Since it is supposed to cover the entire display space, its width and height are set by the platform.
-    /// The drawer should be fully ready for modification by the Engine code, and once "released" (bReadyToDraw is set) should be drawn on the next call to the
-    /// Platform Render function.
+    /// @brief Acquires the next drawer of the display swapchain for the Engine to draw over the entirety of the display. Never blocks, and
+    /// doesn't allocate unless the display got resized since the drawer was last used.
+    /// @return Acquired drawer, sized after the display by the platform, or null if none is available. Its pixels hold whatever was last
+    /// drawn on it. It stays owned by the platform and must be handed back through PresentDisplayDrawer.
     /// #TODO(Marc): Support non-full displays so specific screen elements may be drawn separately, moved around...
-    virtual std::shared_ptr<MemoryMapDrawer> AllocateFullDisplayDrawer() = 0;
+    virtual MemoryMapDrawer* AcquireDisplayDrawer() = 0;
+
+    /// @brief Hands an acquired drawer back to the platform, to be presented on the next render update. A drawer presented earlier that wasn't
+    /// displayed yet gets dropped in favor of this one.
+    /// @param damage Regions of the drawer, relative to its offset, that differ from the drawer presented before it. Only those get presented.
+    virtual void PresentDisplayDrawer(MemoryMapDrawer* drawer, const DisplayDamage& damage) = 0;
 
-    /// @brief Triggers a rendering update on the platform, whererin it will go through every drawing resource / request that are ready to draw and do so,
-    /// discarding them as appropriate.
+    /// @brief Triggers a rendering update on the platform, wherein it will display the latest presented drawer if it didn't already.
     /// @note  Depending on the platform, it might actually execute the work synchronously or just signal some other thread to do it.
-    /// In the latter case, it will probably lock all further rendering resource allocation and the command buffer until done, but in the meantime the Engine should
-    /// have plenty of non-rendering work to do in the meantime.
+    /// In the latter case, the Engine can go on drawing the next frame on another drawer of the swapchain in the meantime.
     virtual void RenderUpdate() = 0;
+
+    /// @brief Returns the signal the platform notifies every time it finished displaying a presented drawer, which the Engine waits on to
+    /// pace its updates after presentation.
+    virtual PlatformSignal& GetPresentSignal() = 0;
+
+    /// @brief Returns a counter the platform increments every time the display needs the Engine to draw it again, such as after a resize.
+    /// Engines rendering on demand compare it against the one of their last frame, so a display left as it was lets them skip rendering.
+    /// Can be called from any thread.
+    virtual uint64_t GetDisplayVersion() const = 0;
+};
+
+/// @brief Platform Clock gives the Engine a monotonic high-resolution time source, which it measures the passage of time with.
+class PlatformClock
+{
+public:
+
+    /// @brief Returns the current time, in ticks counted from an arbitrary origin. Never goes backwards. Can be called from any thread.
+    virtual uint64_t GetTicks() const = 0;
+
+    /// @brief Returns the amount of ticks per second, which never changes.
+    virtual uint64_t GetTicksPerSecond() const = 0;
+};
+
+/// @brief Platform File System gives the Engine access to files on whatever storage the platform has, in a manner suited to large assets.
+class PlatformFileSystem
+{
+public:
+
+    /// @brief Read-only memory mapping of an entire file. The mapping stays valid for as long as the object lives, and gets released
+    /// by the platform when it is destroyed.
+    class MappedFile
+    {
+    public:
+
+        virtual ~MappedFile() = default;
+
+        inline const uint8_t* GetData() const { return m_data; }
+        inline size_t GetSize() const { return m_size; }
+
+    protected:
+
+        MappedFile(const uint8_t* data, size_t size) : m_data(data), m_size(size)
+        {}
+
+        // Pointer to the first byte of the mapped file. May be null for empty files.
+        const uint8_t* m_data;
+        size_t m_size;
+    };
+
+    /// @brief Sequential reader of a file, for loaders streaming through files in blocks rather than mapping them whole.
+    class FileReader
+    {
+    public:
+
+        virtual ~FileReader() = default;
+
+        /// @brief Reads bytes at the current position of the file and moves past them.
+        /// @param buffer Buffer receiving the bytes.
+        /// @param size Amount of bytes to read.
+        /// @return Amount of bytes read. Only less than size once the end of the file is reached, or on read error.
+        virtual size_t Read(uint8_t* buffer, size_t size) = 0;
+
+        inline uint64_t GetSize() const { return m_size; }
+
+    protected:
+
+        FileReader(uint64_t size) : m_size(size)
+        {}
+
+        // Size of the file when it was opened.
+        uint64_t m_size;
+    };
+
+    /// @brief Sequential writer of a new file. Bytes go to a temporary file which only replaces the destination once committed, so readers
+    /// never see a partially written file. Dropping the writer without committing it deletes the temporary file.
+    class FileWriter
+    {
+    public:
+
+        virtual ~FileWriter() = default;
+
+        /// @brief Appends bytes to the file.
+        /// @return True if every byte was written.
+        virtual bool Write(const uint8_t* data, size_t size) = 0;
+
+        /// @brief Finishes writing and moves the file to its destination, replacing any file already there. The writer can't be used afterwards.
+        /// @return True if the file is now at its destination.
+        virtual bool Commit() = 0;
+    };
+
+    /// @brief Metadata of a file, used to tell whether it changed since it was last seen.
+    struct FileInfo
+    {
+        uint64_t Size = 0;
+        // Last modification time, in platform-specific units. Only meaningful when compared with other times from the same platform.
+        uint64_t ModificationTime = 0;
+    };
+
+    /// @brief Maps a whole file to memory for reading. Pages are loaded lazily by the platform as they get accessed, so this is cheap
+    /// even for very large files.
+    /// @param filePath Path to the file, UTF-8 encoded.
+    /// @return Mapped file, or nullptr if the file could not be opened or mapped.
+    virtual std::shared_ptr<MappedFile> MapFileReadOnly(const std::string& filePath) = 0;
+
+    /// @brief Opens a file for sequential reading from its start.
+    /// @param filePath Path to the file, UTF-8 encoded.
+    /// @return File reader, or nullptr if the file could not be opened.
+    virtual std::shared_ptr<FileReader> OpenFileForReading(const std::string& filePath) = 0;
+
+    /// @brief Creates a file for sequential writing. Directories along the path are not created.
+    /// @param filePath Path the file ends up at once committed, UTF-8 encoded.
+    /// @return File writer, or nullptr if the file could not be created.
+    virtual std::shared_ptr<FileWriter> CreateFileForWriting(const std::string& filePath) = 0;
+
+    /// @brief Reads the metadata of a file without opening it.
+    /// @param filePath Path to the file, UTF-8 encoded.
+    /// @param outInfo Filled with the file's metadata.
+    /// @return True if the file exists and is a regular file.
+    virtual bool GetFileInfo(const std::string& filePath, FileInfo& outInfo) = 0;
 };
 
 #endif // PLATFORM_H
\ No newline at end of file
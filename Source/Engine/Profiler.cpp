@@ -0,0 +1,247 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+
+#if ENGINE_PROFILING
+
+namespace
+{
+    // #NOTE: The only static memory of the Engine, and only in profiling builds: threading a profiler through every function that may
+    // open a zone would cost more than the zones themselves.
+    thread_local Profiler::ThreadBuffer* t_threadBuffer = nullptr;
+
+    /// Returns the current steady clock time in nanoseconds.
+    uint64_t GetTimestamp()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// Appends a string to JSON output as a string literal.
+    void AppendJsonString(const std::string& str, std::string& outJson)
+    {
+        outJson += '"';
+        for (char character : str)
+        {
+            if (character == '"' || character == '\\')
+            {
+                outJson += '\\';
+            }
+            outJson += static_cast<unsigned char>(character) < 0x20 ? ' ' : character;
+        }
+        outJson += '"';
+    }
+
+    /// Zones of every thread merged by call path.
+    struct SummaryNode
+    {
+        std::string Name;
+        uint32_t Depth;
+        std::vector<uint64_t> Durations;
+        uint64_t TotalDuration;
+        std::vector<uint32_t> Children;
+    };
+
+    /// Appends the summary line of a node, then those of its children, longest first.
+    void WriteSummaryNode(std::vector<SummaryNode>& nodes, uint32_t nodeIndex, std::string& outSummary)
+    {
+        SummaryNode& node = nodes[nodeIndex];
+        std::sort(node.Durations.begin(), node.Durations.end());
+        const size_t callCount = node.Durations.size();
+        const size_t p99Rank = std::min(std::max<size_t>(static_cast<size_t>(0.99 * callCount + 0.5), 1), callCount);
+
+        const std::string indentedName = std::string(node.Depth * 2, ' ') + node.Name;
+        char line[256];
+        snprintf(line, sizeof(line), "  %-48s %9zu calls | mean %9.3f ms | p99 %9.3f ms | total %10.3f ms\n", indentedName.c_str(), callCount,
+            node.TotalDuration / 1e6 / callCount, node.Durations[p99Rank - 1] / 1e6, node.TotalDuration / 1e6);
+        outSummary += line;
+
+        std::vector<uint32_t> children = node.Children;
+        std::sort(children.begin(), children.end(), [&nodes](uint32_t a, uint32_t b) { return nodes[a].TotalDuration > nodes[b].TotalDuration; });
+        for (uint32_t childIndex : children)
+        {
+            WriteSummaryNode(nodes, childIndex, outSummary);
+        }
+    }
+}
+
+ProfileZone::ProfileZone(const char* name) : m_name(name), m_threadBuffer(t_threadBuffer), m_startTime(0), m_depth(0)
+{
+    if (m_threadBuffer != nullptr)
+    {
+        m_depth = m_threadBuffer->OpenZoneCount++;
+        m_startTime = GetTimestamp();
+    }
+}
+
+ProfileZone::~ProfileZone()
+{
+    if (m_threadBuffer == nullptr)
+    {
+        return;
+    }
+
+    const uint64_t endTime = GetTimestamp();
+    m_threadBuffer->OpenZoneCount--;
+
+    const uint32_t zoneIndex = m_threadBuffer->ZoneCount.load(std::memory_order_relaxed);
+    if (zoneIndex == m_threadBuffer->ZoneCapacity)
+    {
+        m_threadBuffer->DroppedZoneCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_threadBuffer->Zones[zoneIndex] = Profiler::ZoneRecord{ m_name, m_startTime, endTime, m_depth };
+    m_threadBuffer->ZoneCount.store(zoneIndex + 1, std::memory_order_release);
+}
+
+#endif // ENGINE_PROFILING
+
+Profiler::Profiler(uint32_t zoneCapacityPerThread) : m_zoneCapacityPerThread(zoneCapacityPerThread), m_originTime(0)
+{
+#if ENGINE_PROFILING
+    m_originTime = GetTimestamp();
+#endif
+}
+
+void Profiler::RegisterCurrentThread(const std::string& threadName)
+{
+#if ENGINE_PROFILING
+    std::unique_ptr<ThreadBuffer> threadBuffer = std::make_unique<ThreadBuffer>();
+    threadBuffer->ThreadName = threadName;
+    threadBuffer->Owner = this;
+    threadBuffer->Zones = std::make_unique<ZoneRecord[]>(m_zoneCapacityPerThread);
+    threadBuffer->ZoneCapacity = m_zoneCapacityPerThread;
+    threadBuffer->ZoneCount = 0;
+    threadBuffer->DroppedZoneCount = 0;
+    threadBuffer->OpenZoneCount = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex_ThreadBuffers);
+    threadBuffer->ThreadIndex = static_cast<uint32_t>(m_threadBuffers.size());
+    t_threadBuffer = threadBuffer.get();
+    m_threadBuffers.emplace_back(std::move(threadBuffer));
+#else
+    (void)threadName;
+#endif
+}
+
+Profiler* Profiler::GetCurrentThreadProfiler()
+{
+#if ENGINE_PROFILING
+    return t_threadBuffer != nullptr ? t_threadBuffer->Owner : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+void Profiler::WriteChromeTrace(std::string& outJson) const
+{
+    outJson = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+#if ENGINE_PROFILING
+    std::lock_guard<std::mutex> lock(m_mutex_ThreadBuffers);
+    bool bFirstEvent = true;
+    char number[64];
+    for (const std::unique_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+    {
+        // Thread name metadata, then a complete event per zone, timed in microseconds.
+        outJson += bFirstEvent ? "\n" : ",\n";
+        bFirstEvent = false;
+        snprintf(number, sizeof(number), "%u", threadBuffer->ThreadIndex);
+        outJson += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        outJson += number;
+        outJson += ",\"args\":{\"name\":";
+        AppendJsonString(threadBuffer->ThreadName, outJson);
+        outJson += "}}";
+
+        const uint32_t zoneCount = threadBuffer->ZoneCount.load(std::memory_order_acquire);
+        for (uint32_t zoneIndex = 0; zoneIndex < zoneCount; zoneIndex++)
+        {
+            const ZoneRecord& zone = threadBuffer->Zones[zoneIndex];
+            outJson += ",\n{\"name\":";
+            AppendJsonString(zone.Name, outJson);
+            snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u", threadBuffer->ThreadIndex);
+            outJson += number;
+            snprintf(number, sizeof(number), ",\"ts\":%.3f", (zone.StartTime - m_originTime) / 1e3);
+            outJson += number;
+            snprintf(number, sizeof(number), ",\"dur\":%.3f}", (zone.EndTime - zone.StartTime) / 1e3);
+            outJson += number;
+        }
+    }
+#endif
+    outJson += "\n]}\n";
+}
+
+void Profiler::WriteSummary(std::string& outSummary) const
+{
+    outSummary.clear();
+#if ENGINE_PROFILING
+    std::vector<SummaryNode> nodes;
+    std::vector<uint32_t> rootNodes;
+    std::map<std::pair<int64_t, std::string>, uint32_t> nodeIndices;
+
+    std::lock_guard<std::mutex> lock(m_mutex_ThreadBuffers);
+    std::vector<ZoneRecord> zones;
+    for (const std::unique_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+    {
+        // Zones get recorded as they close, children before their parent: order them as they opened to walk down call paths.
+        const uint32_t zoneCount = threadBuffer->ZoneCount.load(std::memory_order_acquire);
+        zones.assign(threadBuffer->Zones.get(), threadBuffer->Zones.get() + zoneCount);
+        std::sort(zones.begin(), zones.end(), [](const ZoneRecord& a, const ZoneRecord& b)
+        {
+            return a.StartTime != b.StartTime ? a.StartTime < b.StartTime : a.Depth < b.Depth;
+        });
+
+        // Node & zone currently open at each depth of the call path.
+        std::vector<uint32_t> pathNodes;
+        std::vector<const ZoneRecord*> pathZones;
+        for (const ZoneRecord& zone : zones)
+        {
+            // Zones whose parent didn't get recorded (dropped, or still open) count as roots.
+            int64_t parentNodeIndex = -1;
+            if (zone.Depth > 0 && zone.Depth <= pathZones.size() && pathZones[zone.Depth - 1] != nullptr && pathZones[zone.Depth - 1]->EndTime >= zone.EndTime)
+            {
+                parentNodeIndex = pathNodes[zone.Depth - 1];
+            }
+
+            const auto nodeKey = std::make_pair(parentNodeIndex, std::string(zone.Name));
+            auto nodeIterator = nodeIndices.find(nodeKey);
+            if (nodeIterator == nodeIndices.end())
+            {
+                const uint32_t newNodeIndex = static_cast<uint32_t>(nodes.size());
+                nodes.push_back(SummaryNode{ zone.Name, parentNodeIndex >= 0 ? nodes[parentNodeIndex].Depth + 1 : 0, {}, 0, {} });
+                (parentNodeIndex >= 0 ? nodes[parentNodeIndex].Children : rootNodes).push_back(newNodeIndex);
+                nodeIterator = nodeIndices.emplace(nodeKey, newNodeIndex).first;
+            }
+
+            SummaryNode& node = nodes[nodeIterator->second];
+            node.Durations.push_back(zone.EndTime - zone.StartTime);
+            node.TotalDuration += zone.EndTime - zone.StartTime;
+
+            pathNodes.resize(zone.Depth + 1);
+            pathZones.resize(zone.Depth + 1, nullptr);
+            pathNodes[zone.Depth] = nodeIterator->second;
+            pathZones[zone.Depth] = &zone;
+        }
+    }
+
+    std::sort(rootNodes.begin(), rootNodes.end(), [&nodes](uint32_t a, uint32_t b) { return nodes[a].TotalDuration > nodes[b].TotalDuration; });
+    for (uint32_t rootNodeIndex : rootNodes)
+    {
+        WriteSummaryNode(nodes, rootNodeIndex, outSummary);
+    }
+#endif
+}
+
+uint64_t Profiler::GetDroppedZoneCount() const
+{
+    uint64_t droppedZoneCount = 0;
+#if ENGINE_PROFILING
+    std::lock_guard<std::mutex> lock(m_mutex_ThreadBuffers);
+    for (const std::unique_ptr<ThreadBuffer>& threadBuffer : m_threadBuffers)
+    {
+        droppedZoneCount += threadBuffer->DroppedZoneCount.load(std::memory_order_relaxed);
+    }
+#endif
+    return droppedZoneCount;
+}
@@ -0,0 +1,121 @@
+/*
+    Scoped profiling zones, recorded per thread and exported as a Chrome trace (chrome://tracing, Perfetto) or summarized per call path.
+    Zones are opened with PROFILE_ZONE("Name") and close at the end of the enclosing scope. Only threads registered to a Profiler record
+    them: each one appends to its own preallocated buffer, so recording never locks nor allocates.
+    Profiling compiles out entirely unless building with -DENGINE_PROFILING=1: zones then expand to nothing, and Profilers record nothing
+    and keep no static memory.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef ENGINE_PROFILING
+#define ENGINE_PROFILING 0
+#endif
+
+class Profiler
+{
+public:
+
+    // Amount of zones each registered thread can record. Zones closing once a thread's buffer is full are dropped.
+    static constexpr uint32_t DEFAULT_ZONE_CAPACITY_PER_THREAD = 1 << 18;
+
+    static constexpr bool IsCompiledIn() { return ENGINE_PROFILING != 0; }
+
+    Profiler(uint32_t zoneCapacityPerThread = DEFAULT_ZONE_CAPACITY_PER_THREAD);
+
+    /// @brief Makes zones opened by the calling thread get recorded by this profiler, under the passed thread name. Allocates the thread's
+    /// buffer. The profiler must outlive any zone the thread opens afterwards.
+    void RegisterCurrentThread(const std::string& threadName);
+
+    /// @brief Returns the profiler the calling thread is registered to, or null. Lets threads spawned by the Engine join their parent's.
+    static Profiler* GetCurrentThreadProfiler();
+
+    /// @brief Writes every recorded zone as Chrome trace event JSON. Zones still being recorded by other threads may or may not be included.
+    void WriteChromeTrace(std::string& outJson) const;
+
+    /// @brief Writes a table of recorded zones merged by call path, with their call count, mean, 99th percentile & total durations.
+    void WriteSummary(std::string& outSummary) const;
+
+    /// @brief Returns the amount of zones dropped by full thread buffers.
+    uint64_t GetDroppedZoneCount() const;
+
+    /// @brief Zone that closed, as recorded by its thread.
+    struct ZoneRecord
+    {
+        const char* Name;
+        // Steady clock nanoseconds.
+        uint64_t StartTime;
+        uint64_t EndTime;
+        // Amount of zones of the thread that were open when this one opened.
+        uint32_t Depth;
+    };
+
+    /// @brief Zones recorded by a registered thread. Only that thread writes to it: closed zones get published through the zone count.
+    struct ThreadBuffer
+    {
+        std::string ThreadName;
+        uint32_t ThreadIndex;
+        Profiler* Owner;
+
+        std::unique_ptr<ZoneRecord[]> Zones;
+        uint32_t ZoneCapacity;
+        std::atomic<uint32_t> ZoneCount;
+        std::atomic<uint64_t> DroppedZoneCount;
+
+        // Amount of zones currently open on the thread.
+        uint32_t OpenZoneCount;
+    };
+
+private:
+
+    uint32_t m_zoneCapacityPerThread;
+    // Steady clock time traces start from.
+    uint64_t m_originTime;
+
+    mutable std::mutex m_mutex_ThreadBuffers;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+};
+
+#if ENGINE_PROFILING
+
+/// @brief Profiling zone lasting from its construction to its destruction, recorded if the constructing thread is registered to a Profiler.
+class ProfileZone
+{
+public:
+
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+
+    const char* m_name;
+    // Null if the thread isn't registered.
+    Profiler::ThreadBuffer* m_threadBuffer;
+    uint64_t m_startTime;
+    uint32_t m_depth;
+};
+
+#define PROFILE_ZONE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCATENATE(a, b) PROFILE_ZONE_CONCATENATE_INNER(a, b)
+
+// Opens a profiling zone lasting until the end of the enclosing scope. The name must be a string literal, or outlive the Profiler.
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCATENATE(profileZone_, __LINE__)(name)
+
+#else
+
+#define PROFILE_ZONE(name) do {} while (false)
+
+#endif // ENGINE_PROFILING
+
+#endif // PROFILER_H
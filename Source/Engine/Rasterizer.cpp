@@ -0,0 +1,242 @@
+#include "Rasterizer.h"
+#include "RasterizerKernels.h"
+#include "CpuFeatures.h"
+#include "Platform.h"
+
+#include <algorithm>
+
+// SIMD paths, see CpuFeatures.h. Defining RASTERIZER_FORCE_SCALAR disables them, which is mostly useful to compare results.
+#if !defined(RASTERIZER_FORCE_SCALAR)
+    #if defined(ENGINE_AVX2_KERNELS)
+        #define RASTERIZER_SIMD_AVX2
+    #endif
+    #if defined(ENGINE_SSE2_KERNELS)
+        #define RASTERIZER_SIMD_SSE2
+        #include <emmintrin.h>
+    #endif
+#endif
+
+bool Rasterizer::SetupTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, uint32_t color, RasterTriangle& outTriangle)
+{
+    const RasterVertex* vertices[3] = { &v0, &v1, &v2 };
+
+    // Edge i goes from vertex (i + 1) to vertex (i + 2), opposite of vertex i.
+    int64_t unbiasedC[3];
+    for (int edgeIndex = 0; edgeIndex < 3; edgeIndex++)
+    {
+        const RasterVertex& a = *vertices[(edgeIndex + 1) % 3];
+        const RasterVertex& b = *vertices[(edgeIndex + 2) % 3];
+
+        const int32_t edgeA = b.Y - a.Y;
+        const int32_t edgeB = a.X - b.X;
+        unbiasedC[edgeIndex] = -(static_cast<int64_t>(edgeA) * a.X + static_cast<int64_t>(edgeB) * a.Y);
+
+        // Top-left fill rule: pixel centers exactly on an edge belong to the triangle only if that edge is a top edge (horizontal,
+        // interior below) or a left edge (going down the screen for our winding). Other edges require a strictly positive edge value.
+        const bool bTopLeftEdge = edgeA > 0 || (edgeA == 0 && edgeB > 0);
+
+        outTriangle.EdgeA[edgeIndex] = edgeA;
+        outTriangle.EdgeB[edgeIndex] = edgeB;
+        outTriangle.EdgeC[edgeIndex] = unbiasedC[edgeIndex] - (bTopLeftEdge ? 0 : 1);
+    }
+
+    // Twice the signed area, in squared sub-pixel units. Back facing & degenerate triangles are rejected here.
+    const int64_t doubleArea = static_cast<int64_t>(outTriangle.EdgeA[2]) * v2.X + static_cast<int64_t>(outTriangle.EdgeB[2]) * v2.Y + unbiasedC[2];
+    if (doubleArea <= 0)
+    {
+        return false;
+    }
+
+    // Pixel bounds: pixels whose center lies within the sub-pixel bounding box.
+    const int32_t minX = std::min(std::min(v0.X, v1.X), v2.X);
+    const int32_t minY = std::min(std::min(v0.Y, v1.Y), v2.Y);
+    const int32_t maxX = std::max(std::max(v0.X, v1.X), v2.X);
+    const int32_t maxY = std::max(std::max(v0.Y, v1.Y), v2.Y);
+    const int32_t halfPixel = SUBPIXEL_SCALE / 2;
+
+    outTriangle.Bounds.MinX = (minX - halfPixel + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    outTriangle.Bounds.MinY = (minY - halfPixel + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    outTriangle.Bounds.MaxX = ((maxX - halfPixel) >> SUBPIXEL_BITS) + 1;
+    outTriangle.Bounds.MaxY = ((maxY - halfPixel) >> SUBPIXEL_BITS) + 1;
+    if (outTriangle.Bounds.IsEmpty())
+    {
+        return false;
+    }
+
+    // Depth is interpolated linearly in screen space, which is correct for post-projection depth.
+    const float inverseArea = 1.0f / static_cast<float>(doubleArea);
+    const float depthPerSubPixelX = (outTriangle.EdgeA[0] * v0.Z + outTriangle.EdgeA[1] * v1.Z + outTriangle.EdgeA[2] * v2.Z) * inverseArea;
+    const float depthPerSubPixelY = (outTriangle.EdgeB[0] * v0.Z + outTriangle.EdgeB[1] * v1.Z + outTriangle.EdgeB[2] * v2.Z) * inverseArea;
+
+    outTriangle.OriginX = v0.X;
+    outTriangle.OriginY = v0.Y;
+    outTriangle.OriginDepth = v0.Z;
+    outTriangle.DepthStepX = depthPerSubPixelX * SUBPIXEL_SCALE;
+    outTriangle.DepthStepY = depthPerSubPixelY * SUBPIXEL_SCALE;
+
+    outTriangle.Color = color;
+    return true;
+}
+
+void Rasterizer::RasterizeTriangle(const RasterTriangle& triangle, const RenderTarget& target, const RasterRect& clipRect, const SimdPaths& simdPaths)
+{
+#if defined(RASTERIZER_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        Avx2::RasterizeTriangle(triangle, target, clipRect);
+        return;
+    }
+#endif
+
+    const RasterRect bounds = ClipTriangleBounds(triangle, target, clipRect);
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    const int32_t startSubPixelX = PixelCenterToSubPixel(bounds.MinX);
+
+#if defined(RASTERIZER_SIMD_SSE2)
+    const int32_t laneCount = 4;
+    // SSE2 has no 32 bit multiply, so lane steps are built by hand.
+    const __m128i laneEdgeSteps0 = _mm_setr_epi32(0, triangle.EdgeA[0] * SUBPIXEL_SCALE, 2 * triangle.EdgeA[0] * SUBPIXEL_SCALE, 3 * triangle.EdgeA[0] * SUBPIXEL_SCALE);
+    const __m128i laneEdgeSteps1 = _mm_setr_epi32(0, triangle.EdgeA[1] * SUBPIXEL_SCALE, 2 * triangle.EdgeA[1] * SUBPIXEL_SCALE, 3 * triangle.EdgeA[1] * SUBPIXEL_SCALE);
+    const __m128i laneEdgeSteps2 = _mm_setr_epi32(0, triangle.EdgeA[2] * SUBPIXEL_SCALE, 2 * triangle.EdgeA[2] * SUBPIXEL_SCALE, 3 * triangle.EdgeA[2] * SUBPIXEL_SCALE);
+    const __m128 laneDepthSteps = _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(triangle.DepthStepX));
+    const __m128i triangleColor = _mm_set1_epi32(static_cast<int32_t>(triangle.Color));
+    const __m128i minusOne = _mm_set1_epi32(-1);
+
+    const int64_t blockEdgeStep0 = static_cast<int64_t>(triangle.EdgeA[0]) * SUBPIXEL_SCALE * laneCount;
+    const int64_t blockEdgeStep1 = static_cast<int64_t>(triangle.EdgeA[1]) * SUBPIXEL_SCALE * laneCount;
+    const int64_t blockEdgeStep2 = static_cast<int64_t>(triangle.EdgeA[2]) * SUBPIXEL_SCALE * laneCount;
+    const float blockDepthStep = triangle.DepthStepX * laneCount;
+#endif
+
+    for (int32_t y = bounds.MinY; y < bounds.MaxY; y++)
+    {
+        const int32_t subPixelY = PixelCenterToSubPixel(y);
+        int64_t edge0 = EvaluateEdge(triangle, 0, startSubPixelX, subPixelY);
+        int64_t edge1 = EvaluateEdge(triangle, 1, startSubPixelX, subPixelY);
+        int64_t edge2 = EvaluateEdge(triangle, 2, startSubPixelX, subPixelY);
+        float depth = EvaluateDepth(triangle, startSubPixelX, subPixelY);
+
+        Pixel_RGBA* colorRow = target.ColorBuffer + static_cast<size_t>(y) * target.Width;
+        float* depthRow = target.DepthBuffer + static_cast<size_t>(y) * target.Width;
+
+#if defined(RASTERIZER_SIMD_SSE2)
+        // Triangles are convex: once a row has been entered and left, the rest of it can be skipped.
+        bool bEnteredRow = false;
+        for (int32_t x = bounds.MinX; x < bounds.MaxX; x += laneCount)
+        {
+            if (x + laneCount > bounds.MaxX)
+            {
+                // Partial block at the end of the span: SSE2 has no masked store, so finish the span one pixel at a time.
+                RasterizeSpanScalar(triangle, colorRow, depthRow, x, bounds.MaxX, edge0, edge1, edge2, depth);
+                break;
+            }
+
+            const __m128i edges0 = _mm_add_epi32(_mm_set1_epi32(SaturateEdge(edge0)), laneEdgeSteps0);
+            const __m128i edges1 = _mm_add_epi32(_mm_set1_epi32(SaturateEdge(edge1)), laneEdgeSteps1);
+            const __m128i edges2 = _mm_add_epi32(_mm_set1_epi32(SaturateEdge(edge2)), laneEdgeSteps2);
+
+            // A pixel is covered when all three edge values are positive, i.e. when the sign bit of their bitwise OR is clear.
+            const __m128i coverage = _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(edges0, edges1), edges2), minusOne);
+
+            if (_mm_movemask_epi8(coverage) == 0)
+            {
+                if (bEnteredRow)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                bEnteredRow = true;
+
+                const __m128 depths = _mm_add_ps(_mm_set1_ps(depth), laneDepthSteps);
+                const __m128 storedDepths = _mm_loadu_ps(depthRow + x);
+                const __m128i writeMask = _mm_and_si128(coverage, _mm_castps_si128(_mm_cmplt_ps(depths, storedDepths)));
+                const __m128 writeMaskFloat = _mm_castsi128_ps(writeMask);
+
+                const __m128i storedColors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colorRow + x));
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(writeMaskFloat, depths), _mm_andnot_ps(writeMaskFloat, storedDepths)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(colorRow + x),
+                    _mm_or_si128(_mm_and_si128(writeMask, triangleColor), _mm_andnot_si128(writeMask, storedColors)));
+            }
+
+            edge0 += blockEdgeStep0;
+            edge1 += blockEdgeStep1;
+            edge2 += blockEdgeStep2;
+            depth += blockDepthStep;
+        }
+#else
+        RasterizeSpanScalar(triangle, colorRow, depthRow, bounds.MinX, bounds.MaxX, edge0, edge1, edge2, depth);
+#endif
+    }
+}
+
+void Rasterizer::ClearRenderTarget(const RenderTarget& target, const RasterRect& rect, uint32_t color, float depth)
+{
+    const int32_t minX = std::max(rect.MinX, 0);
+    const int32_t minY = std::max(rect.MinY, 0);
+    const int32_t maxX = std::min(rect.MaxX, static_cast<int32_t>(target.Width));
+    const int32_t maxY = std::min(rect.MaxY, static_cast<int32_t>(target.Height));
+
+    for (int32_t y = minY; y < maxY; y++)
+    {
+        Pixel_RGBA* colorRow = target.ColorBuffer + static_cast<size_t>(y) * target.Width;
+        float* depthRow = target.DepthBuffer + static_cast<size_t>(y) * target.Width;
+        for (int32_t x = minX; x < maxX; x++)
+        {
+            colorRow[x].pixel = color;
+            depthRow[x] = depth;
+        }
+    }
+}
+
+float Rasterizer::ComputeMaxDepth(const RenderTarget& target, const RasterRect& rect, const SimdPaths& simdPaths)
+{
+#if defined(RASTERIZER_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        return Avx2::ComputeMaxDepth(target, rect);
+    }
+#endif
+
+    const RasterRect bounds = ClipToTarget(rect, target);
+    float maxDepth = 0.0f;
+    for (int32_t y = bounds.MinY; y < bounds.MaxY; y++)
+    {
+        const float* depthRow = target.DepthBuffer + static_cast<size_t>(y) * target.Width;
+        int32_t x = bounds.MinX;
+#if defined(RASTERIZER_SIMD_SSE2)
+        __m128 maxDepths = _mm_setzero_ps();
+        for (; x + 4 <= bounds.MaxX; x += 4)
+        {
+            maxDepths = _mm_max_ps(maxDepths, _mm_loadu_ps(depthRow + x));
+        }
+        const __m128 maxDepths2 = _mm_max_ps(maxDepths, _mm_movehl_ps(maxDepths, maxDepths));
+        maxDepth = std::max(maxDepth, _mm_cvtss_f32(_mm_max_ss(maxDepths2, _mm_shuffle_ps(maxDepths2, maxDepths2, 1))));
+#endif
+        for (; x < bounds.MaxX; x++)
+        {
+            maxDepth = std::max(maxDepth, depthRow[x]);
+        }
+    }
+    return maxDepth;
+}
+
+const char* Rasterizer::GetSimdPathName(const SimdPaths& simdPaths)
+{
+#if defined(RASTERIZER_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        return "AVX2";
+    }
+#endif
+#if defined(RASTERIZER_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
@@ -0,0 +1,103 @@
+/*
+    Software triangle rasterizer drawing flat colored, depth tested triangles into memory-mapped pixel buffers.
+    Vertices are snapped to a fixed-point sub-pixel grid and coverage follows the top-left fill rule, so triangles sharing an edge
+    never draw a pixel twice nor leave a gap between them.
+    Edge functions are evaluated for several pixels at a time using SIMD (AVX2 or SSE2, depending on what the CPU supports), with a
+    scalar fallback.
+*/
+
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include <cstdint>
+
+#include "CpuFeatures.h"
+
+// Pixel format forward declaration (see Platform.h).
+union Pixel_RGBA;
+
+/// @brief Color & depth buffers the rasterizer draws into. Both buffers hold Width * Height elements, row-major with no padding.
+struct RenderTarget
+{
+    Pixel_RGBA* ColorBuffer;
+    float* DepthBuffer;
+    uint16_t Width, Height;
+};
+
+/// @brief Rectangle of pixels, with exclusive maximum coordinates.
+struct RasterRect
+{
+    int32_t MinX, MinY, MaxX, MaxY;
+
+    inline bool IsEmpty() const { return MinX >= MaxX || MinY >= MaxY; }
+};
+
+/// @brief Screen space vertex as fed to the rasterizer.
+struct RasterVertex
+{
+    // Pixel coordinates in fixed-point with Rasterizer::SUBPIXEL_BITS fractional bits, origin at the top-left corner of the target.
+    int32_t X, Y;
+    // Depth in [0, 1], lower is closer.
+    float Z;
+};
+
+/// @brief Triangle prepared for rasterization: edge functions, depth plane and pixel bounds. Set up once, it can be rasterized
+/// into any amount of clip rectangles.
+struct RasterTriangle
+{
+    // Edge function coefficients in sub-pixel units: E(x, y) = A * x + B * y + C, positive inside the triangle.
+    // Edge i is the edge opposite of vertex i. C includes the fill rule bias.
+    int32_t EdgeA[3];
+    int32_t EdgeB[3];
+    int64_t EdgeC[3];
+
+    // Depth plane: depth at first vertex and its variation per pixel along X & Y.
+    int32_t OriginX, OriginY;
+    float OriginDepth;
+    float DepthStepX, DepthStepY;
+
+    // Pixels possibly covered by the triangle.
+    RasterRect Bounds;
+
+    uint32_t Color;
+};
+
+namespace Rasterizer
+{
+    constexpr int32_t SUBPIXEL_BITS = 4;
+    constexpr int32_t SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+
+    // Vertex pixel coordinates must stay within [-GUARD_BAND_PIXELS, GUARD_BAND_PIXELS] for edge functions not to overflow.
+    // Triangles going further must be clipped beforehand.
+    constexpr float GUARD_BAND_PIXELS = 8192.0f;
+
+    /// @brief Prepares a triangle for rasterization. Triangles are front facing when counter-clockwise as seen on screen, like in clip space.
+    /// @return False if the triangle is back facing, degenerate or covers no pixel center, in which case it should not be rasterized.
+    bool SetupTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, uint32_t color, RasterTriangle& outTriangle);
+
+    /// @brief Draws the pixels of a prepared triangle that lie within the clip rectangle and pass the depth test.
+    /// Pixels outside of the clip rectangle are never read nor written, so separate clip rectangles may be rasterized concurrently.
+    /// @param simdPaths SIMD paths the CPU supports, see CpuFeatures::DetectSimdPaths.
+    void RasterizeTriangle(const RasterTriangle& triangle, const RenderTarget& target, const RasterRect& clipRect, const SimdPaths& simdPaths);
+
+    /// @brief Fills a rectangle of the target with a color and a depth value.
+    void ClearRenderTarget(const RenderTarget& target, const RasterRect& rect, uint32_t color, float depth);
+
+    /// @brief Returns the farthest depth stored within a rectangle of the target, or 0 if the rectangle is empty.
+    float ComputeMaxDepth(const RenderTarget& target, const RasterRect& rect, const SimdPaths& simdPaths);
+
+    /// @brief Returns the name of the SIMD instruction set the rasterizer runs with the passed paths, for debugging purposes.
+    const char* GetSimdPathName(const SimdPaths& simdPaths);
+
+#if defined(ENGINE_AVX2_KERNELS)
+    namespace Avx2
+    {
+        // RasterizeTriangle & ComputeMaxDepth compiled for AVX2 (see RasterizerAvx2.cpp). Those call them when SimdPaths allow AVX2, nothing
+        // else should.
+        ENGINE_AVX2_TARGET void RasterizeTriangle(const RasterTriangle& triangle, const RenderTarget& target, const RasterRect& clipRect);
+        ENGINE_AVX2_TARGET float ComputeMaxDepth(const RenderTarget& target, const RasterRect& rect);
+    }
+#endif
+}
+
+#endif // RASTERIZER_H
@@ -0,0 +1,118 @@
+#include "Rasterizer.h"
+#include "Platform.h"
+
+#include <algorithm>
+
+// AVX2 rasterization, compiled for AVX2 whatever the target so Rasterizer.cpp can pick it at startup.
+#if defined(ENGINE_AVX2_KERNELS) && !defined(RASTERIZER_FORCE_SCALAR)
+
+#include <immintrin.h>
+
+ENGINE_AVX2_BEGIN
+
+#include "RasterizerKernels.h"
+
+ENGINE_AVX2_END
+
+ENGINE_AVX2_TARGET void Rasterizer::Avx2::RasterizeTriangle(const RasterTriangle& triangle, const RenderTarget& target, const RasterRect& clipRect)
+{
+    const RasterRect bounds = ClipTriangleBounds(triangle, target, clipRect);
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    const int32_t startSubPixelX = PixelCenterToSubPixel(bounds.MinX);
+
+    const int32_t laneCount = 8;
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i laneEdgeSteps0 = _mm256_mullo_epi32(laneOffsets, _mm256_set1_epi32(triangle.EdgeA[0] * SUBPIXEL_SCALE));
+    const __m256i laneEdgeSteps1 = _mm256_mullo_epi32(laneOffsets, _mm256_set1_epi32(triangle.EdgeA[1] * SUBPIXEL_SCALE));
+    const __m256i laneEdgeSteps2 = _mm256_mullo_epi32(laneOffsets, _mm256_set1_epi32(triangle.EdgeA[2] * SUBPIXEL_SCALE));
+    const __m256 laneDepthSteps = _mm256_mul_ps(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), _mm256_set1_ps(triangle.DepthStepX));
+    const __m256i triangleColor = _mm256_set1_epi32(static_cast<int32_t>(triangle.Color));
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    const __m256i spanEnd = _mm256_set1_epi32(bounds.MaxX);
+
+    const int64_t blockEdgeStep0 = static_cast<int64_t>(triangle.EdgeA[0]) * SUBPIXEL_SCALE * laneCount;
+    const int64_t blockEdgeStep1 = static_cast<int64_t>(triangle.EdgeA[1]) * SUBPIXEL_SCALE * laneCount;
+    const int64_t blockEdgeStep2 = static_cast<int64_t>(triangle.EdgeA[2]) * SUBPIXEL_SCALE * laneCount;
+    const float blockDepthStep = triangle.DepthStepX * laneCount;
+
+    for (int32_t y = bounds.MinY; y < bounds.MaxY; y++)
+    {
+        const int32_t subPixelY = PixelCenterToSubPixel(y);
+        int64_t edge0 = EvaluateEdge(triangle, 0, startSubPixelX, subPixelY);
+        int64_t edge1 = EvaluateEdge(triangle, 1, startSubPixelX, subPixelY);
+        int64_t edge2 = EvaluateEdge(triangle, 2, startSubPixelX, subPixelY);
+        float depth = EvaluateDepth(triangle, startSubPixelX, subPixelY);
+
+        Pixel_RGBA* colorRow = target.ColorBuffer + static_cast<size_t>(y) * target.Width;
+        float* depthRow = target.DepthBuffer + static_cast<size_t>(y) * target.Width;
+
+        // Triangles are convex: once a row has been entered and left, the rest of it can be skipped.
+        bool bEnteredRow = false;
+        for (int32_t x = bounds.MinX; x < bounds.MaxX; x += laneCount)
+        {
+            const __m256i edges0 = _mm256_add_epi32(_mm256_set1_epi32(SaturateEdge(edge0)), laneEdgeSteps0);
+            const __m256i edges1 = _mm256_add_epi32(_mm256_set1_epi32(SaturateEdge(edge1)), laneEdgeSteps1);
+            const __m256i edges2 = _mm256_add_epi32(_mm256_set1_epi32(SaturateEdge(edge2)), laneEdgeSteps2);
+
+            // A pixel is covered when all three edge values are positive, i.e. when the sign bit of their bitwise OR is clear.
+            const __m256i coverage = _mm256_and_si256(
+                _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(edges0, edges1), edges2), minusOne),
+                _mm256_cmpgt_epi32(spanEnd, _mm256_add_epi32(_mm256_set1_epi32(x), laneOffsets)));
+
+            if (_mm256_testz_si256(coverage, coverage))
+            {
+                if (bEnteredRow)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                bEnteredRow = true;
+
+                // Masked loads & stores never touch pixels outside the span.
+                const __m256 depths = _mm256_add_ps(_mm256_set1_ps(depth), laneDepthSteps);
+                const __m256 storedDepths = _mm256_maskload_ps(depthRow + x, coverage);
+                const __m256i writeMask = _mm256_and_si256(coverage, _mm256_castps_si256(_mm256_cmp_ps(depths, storedDepths, _CMP_LT_OQ)));
+
+                _mm256_maskstore_ps(depthRow + x, writeMask, depths);
+                _mm256_maskstore_epi32(reinterpret_cast<int*>(colorRow + x), writeMask, triangleColor);
+            }
+
+            edge0 += blockEdgeStep0;
+            edge1 += blockEdgeStep1;
+            edge2 += blockEdgeStep2;
+            depth += blockDepthStep;
+        }
+    }
+}
+
+ENGINE_AVX2_TARGET float Rasterizer::Avx2::ComputeMaxDepth(const RenderTarget& target, const RasterRect& rect)
+{
+    const RasterRect bounds = ClipToTarget(rect, target);
+    float maxDepth = 0.0f;
+    for (int32_t y = bounds.MinY; y < bounds.MaxY; y++)
+    {
+        const float* depthRow = target.DepthBuffer + static_cast<size_t>(y) * target.Width;
+        int32_t x = bounds.MinX;
+        __m256 maxDepths = _mm256_setzero_ps();
+        for (; x + 8 <= bounds.MaxX; x += 8)
+        {
+            maxDepths = _mm256_max_ps(maxDepths, _mm256_loadu_ps(depthRow + x));
+        }
+        const __m128 maxDepths4 = _mm_max_ps(_mm256_castps256_ps128(maxDepths), _mm256_extractf128_ps(maxDepths, 1));
+        const __m128 maxDepths2 = _mm_max_ps(maxDepths4, _mm_movehl_ps(maxDepths4, maxDepths4));
+        maxDepth = std::max(maxDepth, _mm_cvtss_f32(_mm_max_ss(maxDepths2, _mm_shuffle_ps(maxDepths2, maxDepths2, 1))));
+        for (; x < bounds.MaxX; x++)
+        {
+            maxDepth = std::max(maxDepth, depthRow[x]);
+        }
+    }
+    return maxDepth;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+    Rasterizer helpers shared by Rasterizer.cpp & RasterizerAvx2.cpp, each file compiling them for its own instruction set. Everything has
+    internal linkage, so each file keeps its own copy whatever it got compiled for.
+*/
+
+#ifndef RASTERIZER_KERNELS_H
+#define RASTERIZER_KERNELS_H
+
+#include "Rasterizer.h"
+#include "Platform.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Edge function values get clamped to this magnitude before being stepped across a block of pixels in 32 bits.
+    // Stepping across a block never changes a value by more than 2^26 within the guard band, so clamped values keep the right sign.
+    constexpr int64_t EDGE_SATURATION = int64_t(1) << 30;
+
+    inline int32_t SaturateEdge(int64_t value)
+    {
+        return static_cast<int32_t>(std::min(std::max(value, -EDGE_SATURATION), EDGE_SATURATION));
+    }
+
+    inline int64_t EvaluateEdge(const RasterTriangle& triangle, int edgeIndex, int32_t subPixelX, int32_t subPixelY)
+    {
+        return static_cast<int64_t>(triangle.EdgeA[edgeIndex]) * subPixelX + static_cast<int64_t>(triangle.EdgeB[edgeIndex]) * subPixelY
+            + triangle.EdgeC[edgeIndex];
+    }
+
+    // Pixel centers sit half a pixel away from pixel corners.
+    inline int32_t PixelCenterToSubPixel(int32_t pixel) { return (pixel << Rasterizer::SUBPIXEL_BITS) + Rasterizer::SUBPIXEL_SCALE / 2; }
+
+    /// Pixels of a rectangle within the target.
+    inline RasterRect ClipToTarget(const RasterRect& rect, const RenderTarget& target)
+    {
+        return RasterRect{  std::max(rect.MinX, 0), std::max(rect.MinY, 0),
+                            std::min(rect.MaxX, static_cast<int32_t>(target.Width)), std::min(rect.MaxY, static_cast<int32_t>(target.Height)) };
+    }
+
+    /// Pixels of a triangle within both the clip rectangle and the target.
+    inline RasterRect ClipTriangleBounds(const RasterTriangle& triangle, const RenderTarget& target, const RasterRect& clipRect)
+    {
+        return ClipToTarget(RasterRect{ std::max(triangle.Bounds.MinX, clipRect.MinX), std::max(triangle.Bounds.MinY, clipRect.MinY),
+                                        std::min(triangle.Bounds.MaxX, clipRect.MaxX), std::min(triangle.Bounds.MaxY, clipRect.MaxY) }, target);
+    }
+
+    /// Depth at a sub-pixel position, from the triangle's depth plane.
+    inline float EvaluateDepth(const RasterTriangle& triangle, int32_t subPixelX, int32_t subPixelY)
+    {
+        return triangle.OriginDepth
+            + triangle.DepthStepX * static_cast<float>(subPixelX - triangle.OriginX) / Rasterizer::SUBPIXEL_SCALE
+            + triangle.DepthStepY * static_cast<float>(subPixelY - triangle.OriginY) / Rasterizer::SUBPIXEL_SCALE;
+    }
+
+    /// Rasterizes a horizontal span of pixels one at a time. Used as the scalar path and for partial SIMD blocks.
+    /// Edge values are those of the first pixel of the span.
+    inline void RasterizeSpanScalar(const RasterTriangle& triangle, Pixel_RGBA* colorRow, float* depthRow, int32_t startX, int32_t endX,
+        int64_t edge0, int64_t edge1, int64_t edge2, float depth)
+    {
+        const int64_t step0 = static_cast<int64_t>(triangle.EdgeA[0]) * Rasterizer::SUBPIXEL_SCALE;
+        const int64_t step1 = static_cast<int64_t>(triangle.EdgeA[1]) * Rasterizer::SUBPIXEL_SCALE;
+        const int64_t step2 = static_cast<int64_t>(triangle.EdgeA[2]) * Rasterizer::SUBPIXEL_SCALE;
+
+        for (int32_t x = startX; x < endX; x++)
+        {
+            if ((edge0 | edge1 | edge2) >= 0 && depth < depthRow[x])
+            {
+                depthRow[x] = depth;
+                colorRow[x].pixel = triangle.Color;
+            }
+
+            edge0 += step0;
+            edge1 += step1;
+            edge2 += step2;
+            depth += triangle.DepthStepX;
+        }
+    }
+}
+
+#endif // RASTERIZER_KERNELS_H
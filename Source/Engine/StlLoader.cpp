@@ -0,0 +1,427 @@
+#include "StlLoader.h"
+#include "TextParsing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Size of the blocks the file is streamed in.
+    const size_t BLOCK_SIZE = 1 << 20;
+
+    const size_t BINARY_HEADER_SIZE = 84;
+    // Normal (3 floats), 3 corners (3 floats each) & a 16 bit attribute word.
+    const size_t BINARY_TRIANGLE_SIZE = 50;
+
+    /// Welds positions closer than a tolerance into unique vertices. Vertices are put in a uniform grid of cells a few times larger than
+    /// the tolerance, hashed into buckets chained through the vertices themselves, so the only memory used is a few bytes per unique vertex.
+    class VertexWelder
+    {
+    public:
+
+        VertexWelder(float tolerance) : m_tolerance(tolerance), m_cellSize(tolerance * 4.0f), m_inverseCellSize(1.0f / (tolerance * 4.0f))
+        {
+            m_bucketHeads.assign(1 << 16, UINT32_MAX);
+        }
+
+        void Reserve(size_t vertexCount)
+        {
+            m_positions.reserve(vertexCount);
+            m_nextInBucket.reserve(vertexCount);
+        }
+
+        /// Returns the index of the vertex at (or within tolerance of) a position, creating it if needed.
+        uint32_t Weld(const Vector3& position)
+        {
+            const int64_t cellX = GetCellCoordinate(position.x);
+            const int64_t cellY = GetCellCoordinate(position.y);
+            const int64_t cellZ = GetCellCoordinate(position.z);
+
+            // Exact duplicates are the vast majority of welds and always sit in the position's own cell, so look there first.
+            uint32_t vertex = FindInCell(position, cellX, cellY, cellZ);
+            if (vertex != UINT32_MAX)
+            {
+                return vertex;
+            }
+
+            // Neighbor cells only need checking along axes where the position is within tolerance of a cell face.
+            const int64_t rangeX[2] = { NeighborOffset(position.x, cellX, -1), NeighborOffset(position.x, cellX, 1) };
+            const int64_t rangeY[2] = { NeighborOffset(position.y, cellY, -1), NeighborOffset(position.y, cellY, 1) };
+            const int64_t rangeZ[2] = { NeighborOffset(position.z, cellZ, -1), NeighborOffset(position.z, cellZ, 1) };
+            for (int64_t offsetX = rangeX[0]; offsetX <= rangeX[1] && vertex == UINT32_MAX; offsetX++)
+            {
+                for (int64_t offsetY = rangeY[0]; offsetY <= rangeY[1] && vertex == UINT32_MAX; offsetY++)
+                {
+                    for (int64_t offsetZ = rangeZ[0]; offsetZ <= rangeZ[1] && vertex == UINT32_MAX; offsetZ++)
+                    {
+                        if (offsetX != 0 || offsetY != 0 || offsetZ != 0)
+                        {
+                            vertex = FindInCell(position, cellX + offsetX, cellY + offsetY, cellZ + offsetZ);
+                        }
+                    }
+                }
+            }
+
+            if (vertex != UINT32_MAX)
+            {
+                return vertex;
+            }
+
+            vertex = static_cast<uint32_t>(m_positions.size());
+            m_positions.push_back(position);
+            m_nextInBucket.push_back(UINT32_MAX);
+            InsertInBucket(vertex, cellX, cellY, cellZ);
+
+            // Keep chains short by growing the bucket table along with vertices.
+            if (m_positions.size() > m_bucketHeads.size())
+            {
+                Rehash(m_bucketHeads.size() * 2);
+            }
+            return vertex;
+        }
+
+        inline size_t GetVertexCount() const { return m_positions.size(); }
+
+        /// Hands welded positions over, leaving the welder empty.
+        std::vector<Vector3> TakePositions()
+        {
+            m_nextInBucket = std::vector<uint32_t>();
+            m_bucketHeads = std::vector<uint32_t>();
+            return std::move(m_positions);
+        }
+
+    private:
+
+        inline int64_t GetCellCoordinate(float coordinate) const
+        {
+            // Clamped so huge coordinates can't overflow; they all end up in far away cells, which only costs some extra comparisons.
+            const float cell = std::floor(coordinate * m_inverseCellSize);
+            return static_cast<int64_t>(std::max(std::min(cell, 4.0e18f), -4.0e18f));
+        }
+
+        inline int64_t NeighborOffset(float coordinate, int64_t cell, int64_t direction) const
+        {
+            const float offsetInCell = coordinate - static_cast<float>(cell) * m_cellSize;
+            if (direction < 0)
+            {
+                return offsetInCell <= m_tolerance ? -1 : 0;
+            }
+            return offsetInCell >= m_cellSize - m_tolerance ? 1 : 0;
+        }
+
+        inline size_t GetBucket(int64_t cellX, int64_t cellY, int64_t cellZ) const
+        {
+            uint64_t hash = static_cast<uint64_t>(cellX) * 0x9E3779B97F4A7C15ull;
+            hash ^= static_cast<uint64_t>(cellY) * 0xC2B2AE3D27D4EB4Full + (hash >> 29);
+            hash ^= static_cast<uint64_t>(cellZ) * 0x165667B19E3779F9ull + (hash >> 32);
+            return static_cast<size_t>(hash ^ (hash >> 31)) & (m_bucketHeads.size() - 1);
+        }
+
+        inline uint32_t FindInCell(const Vector3& position, int64_t cellX, int64_t cellY, int64_t cellZ) const
+        {
+            // Buckets hold vertices of every cell hashing to them, but checking the distance directly makes checking the cell unnecessary.
+            for (uint32_t vertex = m_bucketHeads[GetBucket(cellX, cellY, cellZ)]; vertex != UINT32_MAX; vertex = m_nextInBucket[vertex])
+            {
+                const Vector3& candidate = m_positions[vertex];
+                if (std::fabs(candidate.x - position.x) <= m_tolerance && std::fabs(candidate.y - position.y) <= m_tolerance
+                    && std::fabs(candidate.z - position.z) <= m_tolerance)
+                {
+                    return vertex;
+                }
+            }
+            return UINT32_MAX;
+        }
+
+        inline void InsertInBucket(uint32_t vertex, int64_t cellX, int64_t cellY, int64_t cellZ)
+        {
+            const size_t bucket = GetBucket(cellX, cellY, cellZ);
+            m_nextInBucket[vertex] = m_bucketHeads[bucket];
+            m_bucketHeads[bucket] = vertex;
+        }
+
+        void Rehash(size_t bucketCount)
+        {
+            m_bucketHeads.assign(bucketCount, UINT32_MAX);
+            for (uint32_t vertex = 0; vertex < m_positions.size(); vertex++)
+            {
+                const Vector3& position = m_positions[vertex];
+                InsertInBucket(vertex, GetCellCoordinate(position.x), GetCellCoordinate(position.y), GetCellCoordinate(position.z));
+            }
+        }
+
+        float m_tolerance;
+        float m_cellSize;
+        float m_inverseCellSize;
+
+        std::vector<Vector3> m_positions;
+        // Next vertex in the same bucket, or UINT32_MAX at the end of the chain.
+        std::vector<uint32_t> m_nextInBucket;
+        // First vertex of every bucket, or UINT32_MAX for empty buckets. Always a power of two in size.
+        std::vector<uint32_t> m_bucketHeads;
+    };
+
+    /// Accumulates welded triangles into mesh indices.
+    struct TriangleSink
+    {
+        VertexWelder Welder;
+        std::vector<uint32_t> Indices;
+        StlLoader::LoadStatistics& Statistics;
+
+        TriangleSink(float weldTolerance, StlLoader::LoadStatistics& statistics) : Welder(weldTolerance), Statistics(statistics)
+        {}
+
+        void AddTriangle(const Vector3& a, const Vector3& b, const Vector3& c)
+        {
+            Statistics.FileTriangleCount++;
+
+            const bool bFinite = std::isfinite(a.x) && std::isfinite(a.y) && std::isfinite(a.z) && std::isfinite(b.x) && std::isfinite(b.y)
+                && std::isfinite(b.z) && std::isfinite(c.x) && std::isfinite(c.y) && std::isfinite(c.z);
+            if (!bFinite)
+            {
+                Statistics.DegenerateTriangleCount++;
+                return;
+            }
+
+            const uint32_t i0 = Welder.Weld(a);
+            const uint32_t i1 = Welder.Weld(b);
+            const uint32_t i2 = Welder.Weld(c);
+            if (i0 == i1 || i1 == i2 || i2 == i0)
+            {
+                Statistics.DegenerateTriangleCount++;
+                return;
+            }
+
+            Indices.push_back(i0);
+            Indices.push_back(i1);
+            Indices.push_back(i2);
+        }
+    };
+
+    inline Vector3 ReadBinaryVector3(const uint8_t* bytes)
+    {
+        Vector3 vector;
+        memcpy(&vector, bytes, sizeof(vector));
+        return vector;
+    }
+
+    /// Streams binary triangles, starting with whatever the first block holds after the header.
+    bool StreamBinary(PlatformFileSystem::FileReader& reader, std::vector<uint8_t>& block, size_t blockFill, uint64_t triangleCount,
+        TriangleSink& sink, std::string& outError)
+    {
+        size_t blockOffset = BINARY_HEADER_SIZE;
+        uint64_t triangleIndex = 0;
+        while (triangleIndex < triangleCount)
+        {
+            while (triangleIndex < triangleCount && blockFill - blockOffset >= BINARY_TRIANGLE_SIZE)
+            {
+                const uint8_t* record = block.data() + blockOffset;
+                sink.AddTriangle(ReadBinaryVector3(record + 12), ReadBinaryVector3(record + 24), ReadBinaryVector3(record + 36));
+                blockOffset += BINARY_TRIANGLE_SIZE;
+                triangleIndex++;
+            }
+
+            if (triangleIndex == triangleCount)
+            {
+                break;
+            }
+
+            // Move the partial record left at the end of the block to its front, and fill the rest.
+            const size_t leftover = blockFill - blockOffset;
+            memmove(block.data(), block.data() + blockOffset, leftover);
+            blockOffset = 0;
+            const size_t readSize = reader.Read(block.data() + leftover, block.size() - leftover);
+            blockFill = leftover + readSize;
+            if (readSize == 0)
+            {
+                outError = "File ended after " + std::to_string(triangleIndex) + " of " + std::to_string(triangleCount) + " triangles.";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// ASCII parsing state carried from line to line.
+    struct AsciiState
+    {
+        // Corners of the current facet loop. Usually 3, but polygons get triangulated as fans.
+        std::vector<Vector3> LoopCorners;
+    };
+
+    void ParseAsciiLine(const char* cursor, const char* end, AsciiState& state, TriangleSink& sink)
+    {
+        TextParsing::SkipBlanks(cursor, end);
+        if (TextParsing::MatchKeyword(cursor, end, "vertex", 6))
+        {
+            cursor += 6;
+            Vector3 corner;
+            TextParsing::SkipBlanks(cursor, end);
+            bool bValid = TextParsing::ParseFloat(cursor, end, corner.x);
+            TextParsing::SkipBlanks(cursor, end);
+            bValid = bValid && TextParsing::ParseFloat(cursor, end, corner.y);
+            TextParsing::SkipBlanks(cursor, end);
+            bValid = bValid && TextParsing::ParseFloat(cursor, end, corner.z);
+            if (!bValid)
+            {
+                // Make the facet count as degenerate rather than silently shifting corners.
+                corner = Vector3{ NAN, NAN, NAN };
+            }
+            state.LoopCorners.push_back(corner);
+        }
+        else if (TextParsing::MatchKeyword(cursor, end, "endloop", 7))
+        {
+            for (size_t corner = 2; corner < state.LoopCorners.size(); corner++)
+            {
+                sink.AddTriangle(state.LoopCorners[0], state.LoopCorners[corner - 1], state.LoopCorners[corner]);
+            }
+            state.LoopCorners.clear();
+        }
+        else if (TextParsing::MatchKeyword(cursor, end, "facet", 5) || TextParsing::MatchKeyword(cursor, end, "outer", 5))
+        {
+            state.LoopCorners.clear();
+        }
+    }
+
+    /// Streams ASCII text line by line, starting with the contents of the first block.
+    bool StreamAscii(PlatformFileSystem::FileReader& reader, std::vector<uint8_t>& block, size_t blockFill, TriangleSink& sink, std::string& outError)
+    {
+        AsciiState state;
+        while (true)
+        {
+            const char* text = reinterpret_cast<const char*>(block.data());
+            const char* cursor = text;
+            const char* end = text + blockFill;
+
+            // Parse every complete line of the block.
+            while (true)
+            {
+                const char* lineFeed = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+                if (lineFeed == nullptr)
+                {
+                    break;
+                }
+                ParseAsciiLine(cursor, lineFeed, state, sink);
+                cursor = lineFeed + 1;
+            }
+
+            // Move the partial line left at the end of the block to its front, and fill the rest.
+            const size_t leftover = static_cast<size_t>(end - cursor);
+            if (leftover == block.size())
+            {
+                outError = "Line longer than " + std::to_string(block.size()) + " bytes.";
+                return false;
+            }
+            memmove(block.data(), cursor, leftover);
+            const size_t readSize = reader.Read(block.data() + leftover, block.size() - leftover);
+            blockFill = leftover + readSize;
+
+            if (readSize == 0)
+            {
+                // Last line without line feed.
+                ParseAsciiLine(reinterpret_cast<const char*>(block.data()), reinterpret_cast<const char*>(block.data()) + blockFill, state, sink);
+                return true;
+            }
+        }
+    }
+}
+
+bool StlLoader::LoadMesh(PlatformFileSystem::FileReader& reader, Mesh& outMesh, LoadStatistics& outStatistics, std::string& outError,
+    float weldTolerance)
+{
+    outStatistics = LoadStatistics{};
+    outMesh = Mesh{};
+
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    const size_t blockFill = reader.Read(block.data(), block.size());
+
+    // Binary files are exactly as large as their triangle count says, which is more reliable than the header: some binary exporters
+    // start it with "solid" just like ASCII files do.
+    const uint64_t fileSize = reader.GetSize();
+    uint64_t binaryTriangleCount = 0;
+    if (blockFill >= BINARY_HEADER_SIZE)
+    {
+        uint32_t headerTriangleCount;
+        memcpy(&headerTriangleCount, block.data() + 80, sizeof(headerTriangleCount));
+        binaryTriangleCount = headerTriangleCount;
+    }
+
+    const char* text = reinterpret_cast<const char*>(block.data());
+    const char* textCursor = text;
+    TextParsing::SkipBlanks(textCursor, text + blockFill);
+    while (textCursor < text + blockFill && *textCursor == '\n')
+    {
+        textCursor++;
+        TextParsing::SkipBlanks(textCursor, text + blockFill);
+    }
+
+    const bool bSizeMatchesBinary = blockFill >= BINARY_HEADER_SIZE && fileSize == BINARY_HEADER_SIZE + binaryTriangleCount * BINARY_TRIANGLE_SIZE;
+    const bool bLooksAscii = TextParsing::MatchKeyword(textCursor, text + blockFill, "solid", 5);
+    outStatistics.bBinary = bSizeMatchesBinary || (!bLooksAscii && blockFill >= BINARY_HEADER_SIZE);
+
+    TriangleSink sink(std::max(weldTolerance, 1e-20f), outStatistics);
+    bool bStreamed;
+    if (outStatistics.bBinary)
+    {
+        if (!bSizeMatchesBinary)
+        {
+            // Trust the file size over a header count that doesn't match it.
+            binaryTriangleCount = (fileSize - BINARY_HEADER_SIZE) / BINARY_TRIANGLE_SIZE;
+        }
+
+        // Closed CAD meshes have about half as many vertices as triangles.
+        sink.Indices.reserve(static_cast<size_t>(binaryTriangleCount) * 3);
+        sink.Welder.Reserve(static_cast<size_t>(binaryTriangleCount / 2 + 16));
+        bStreamed = StreamBinary(reader, block, blockFill, binaryTriangleCount, sink, outError);
+    }
+    else if (bLooksAscii)
+    {
+        bStreamed = StreamAscii(reader, block, blockFill, sink, outError);
+    }
+    else
+    {
+        outError = "Not an STL file.";
+        return false;
+    }
+
+    block = std::vector<uint8_t>();
+    if (!bStreamed)
+    {
+        return false;
+    }
+
+    if (sink.Indices.empty())
+    {
+        outError = "File contains no valid triangle.";
+        return false;
+    }
+
+    if (sink.Welder.GetVertexCount() > UINT32_MAX)
+    {
+        outError = "File has too many vertices to be indexed with 32 bit indices.";
+        return false;
+    }
+
+    // NORMALS: sum of adjacent face normals weighted by face area (which is the length of the cross product), normalized.
+    std::vector<Vector3> positions = sink.Welder.TakePositions();
+    std::vector<Vector3> normals(positions.size(), Vector3{ 0.0f, 0.0f, 0.0f });
+    for (size_t index = 0; index < sink.Indices.size(); index += 3)
+    {
+        const uint32_t i0 = sink.Indices[index], i1 = sink.Indices[index + 1], i2 = sink.Indices[index + 2];
+        const Vector3 faceNormal = Cross(positions[i1] - positions[i0], positions[i2] - positions[i0]);
+        normals[i0] = normals[i0] + faceNormal;
+        normals[i1] = normals[i1] + faceNormal;
+        normals[i2] = normals[i2] + faceNormal;
+    }
+    for (Vector3& normal : normals)
+    {
+        const float length = Length(normal);
+        normal = length > 0.0f ? normal * (1.0f / length) : Vector3{ 0.0f, 0.0f, 1.0f };
+    }
+
+    outMesh.Positions = std::move(positions);
+    outMesh.Normals = std::move(normals);
+    outMesh.Indices = std::move(sink.Indices);
+    outMesh.ComputeBounds();
+    return true;
+}
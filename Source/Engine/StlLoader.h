@@ -0,0 +1,44 @@
+/*
+    STL (binary & ASCII) loader for CAD exports with tens of millions of triangles. The file is streamed in fixed-size blocks and
+    duplicate corners are welded on the fly through a hash grid, so memory use follows unique vertices instead of the file size.
+*/
+
+#ifndef STL_LOADER_H
+#define STL_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Mesh.h"
+#include "Platform.h"
+
+namespace StlLoader
+{
+    /// @brief Default distance under which corners get welded into a single vertex, in model units. Meant to absorb float noise of
+    /// exporters without merging actual details, for models in millimeters as well as in meters.
+    constexpr float DEFAULT_WELD_TOLERANCE = 1e-5f;
+
+    /// @brief Statistics about a loaded STL file.
+    struct LoadStatistics
+    {
+        bool bBinary = false;
+        // Triangles read from the file.
+        uint64_t FileTriangleCount = 0;
+        // Triangles left out because welding collapsed them (or their coordinates weren't finite numbers).
+        uint64_t DegenerateTriangleCount = 0;
+    };
+
+    /// @brief Streams an STL file into an indexed mesh with welded vertices & recomputed smooth normals. Normals stored in the file are ignored.
+    /// Binary and ASCII files are told apart from their size & contents, whatever their header says.
+    /// @param reader Reader positioned at the start of the file.
+    /// @param outMesh Mesh to fill.
+    /// @param outStatistics Filled with statistics about the file.
+    /// @param outError Filled with a description of the problem when loading fails.
+    /// @param weldTolerance Distance (per axis) under which corners get welded together. Must be strictly positive.
+    /// @return True if the mesh was loaded, false otherwise.
+    bool LoadMesh(PlatformFileSystem::FileReader& reader, Mesh& outMesh, LoadStatistics& outStatistics, std::string& outError,
+        float weldTolerance = DEFAULT_WELD_TOLERANCE);
+}
+
+#endif // STL_LOADER_H
@@ -0,0 +1,162 @@
+/*
+    Fast, allocation-free parsing helpers for text asset formats. Every function works on a [cursor, end) character range that
+    does not need to be null terminated, and advances the cursor past what it consumed.
+*/
+
+#ifndef TEXT_PARSING_H
+#define TEXT_PARSING_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+namespace TextParsing
+{
+    inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+    inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    /// @brief Skips spaces, tabs and carriage returns (but not line feeds).
+    inline void SkipBlanks(const char*& cursor, const char* end)
+    {
+        while (cursor < end && IsBlank(*cursor))
+        {
+            cursor++;
+        }
+    }
+
+    /// @brief Moves the cursor to the first character of the next line, or to the end.
+    inline void SkipLine(const char*& cursor, const char* end)
+    {
+        const char* lineFeed = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        cursor = lineFeed != nullptr ? lineFeed + 1 : end;
+    }
+
+    /// @brief Parses an optionally signed decimal integer. Magnitudes too large for 64 bits saturate to a value above 10^17, all of their
+    /// digits still being consumed, so callers range-checking values reject them.
+    /// @return False if there were no digits at the cursor, in which case the cursor is left untouched.
+    inline bool ParseInteger(const char*& cursor, const char* end, int64_t& outValue)
+    {
+        const char* c = cursor;
+        bool bNegative = false;
+        if (c < end && (*c == '-' || *c == '+'))
+        {
+            bNegative = *c == '-';
+            c++;
+        }
+
+        if (c >= end || !IsDigit(*c))
+        {
+            return false;
+        }
+
+        // Accumulating stops before the next digit could overflow.
+        const int64_t MAX_ACCUMULATED_VALUE = (INT64_MAX - 9) / 10;
+        int64_t value = 0;
+        while (c < end && IsDigit(*c))
+        {
+            if (value <= MAX_ACCUMULATED_VALUE)
+            {
+                value = value * 10 + (*c - '0');
+            }
+            c++;
+        }
+
+        outValue = bNegative ? -value : value;
+        cursor = c;
+        return true;
+    }
+
+    /// @brief Parses a decimal floating point number with optional sign, fraction and exponent (e.g. "-1.5e-3").
+    /// Precision is that of a double computation rounded to float, which is plenty for geometry, but not always correctly rounded.
+    /// @return False if there was no number at the cursor, in which case the cursor is left untouched.
+    inline bool ParseFloat(const char*& cursor, const char* end, float& outValue)
+    {
+        // Exact powers of ten representable in a double.
+        static constexpr double exactPowersOfTen[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        const char* c = cursor;
+        bool bNegative = false;
+        if (c < end && (*c == '-' || *c == '+'))
+        {
+            bNegative = *c == '-';
+            c++;
+        }
+
+        // Accumulate up to 19 significant digits in an integer mantissa, further digits only shift the exponent.
+        uint64_t mantissa = 0;
+        int32_t significantDigitCount = 0;
+        int32_t exponent = 0;
+        bool bHasDigits = false;
+
+        while (c < end && IsDigit(*c))
+        {
+            bHasDigits = true;
+            if (significantDigitCount < 19)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                significantDigitCount += mantissa != 0 ? 1 : 0;
+            }
+            else
+            {
+                exponent++;
+            }
+            c++;
+        }
+
+        if (c < end && *c == '.')
+        {
+            c++;
+            while (c < end && IsDigit(*c))
+            {
+                bHasDigits = true;
+                if (significantDigitCount < 19)
+                {
+                    mantissa = mantissa * 10 + (*c - '0');
+                    significantDigitCount += mantissa != 0 ? 1 : 0;
+                    exponent--;
+                }
+                c++;
+            }
+        }
+
+        if (!bHasDigits)
+        {
+            return false;
+        }
+
+        if (c < end && (*c == 'e' || *c == 'E'))
+        {
+            const char* exponentCursor = c + 1;
+            int64_t explicitExponent;
+            if (ParseInteger(exponentCursor, end, explicitExponent))
+            {
+                exponent += static_cast<int32_t>(explicitExponent < -1000 ? -1000 : (explicitExponent > 1000 ? 1000 : explicitExponent));
+                c = exponentCursor;
+            }
+        }
+
+        double value = static_cast<double>(mantissa);
+        if (exponent < 0)
+        {
+            value = exponent >= -22 ? value / exactPowersOfTen[-exponent] : value * std::pow(10.0, exponent);
+        }
+        else if (exponent > 0)
+        {
+            value = exponent <= 22 ? value * exactPowersOfTen[exponent] : value * std::pow(10.0, exponent);
+        }
+
+        outValue = static_cast<float>(bNegative ? -value : value);
+        cursor = c;
+        return true;
+    }
+
+    /// @brief Checks whether the characters at the cursor match a keyword, without moving the cursor.
+    inline bool MatchKeyword(const char* cursor, const char* end, const char* keyword, size_t keywordLength)
+    {
+        return static_cast<size_t>(end - cursor) >= keywordLength && memcmp(cursor, keyword, keywordLength) == 0;
+    }
+}
+
+#endif // TEXT_PARSING_H
@@ -0,0 +1,203 @@
+#include "Texture.h"
+#include "CpuFeatures.h"
+#include "Platform.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// SIMD paths, see CpuFeatures.h. Defining TEXTURE_FORCE_SCALAR disables them, which is mostly useful to compare results.
+#if !defined(TEXTURE_FORCE_SCALAR)
+    #if defined(ENGINE_AVX2_KERNELS)
+        #define TEXTURE_SIMD_AVX2
+    #endif
+    #if defined(ENGINE_SSE2_KERNELS)
+        #define TEXTURE_SIMD_SSE2
+        #include <emmintrin.h>
+    #endif
+#endif
+
+namespace
+{
+#if defined(TEXTURE_SIMD_SSE2)
+    // Thin SSE2 wrappers over the intrinsics the block kernel of TextureKernels.h is written with. Each lane samples a pixel, blocks holding
+    // a single quad.
+    typedef __m128 FloatLanes;
+    typedef __m128i IntLanes;
+    const uint32_t LANE_COUNT = 4;
+
+    inline FloatLanes Splat(float value) { return _mm_set1_ps(value); }
+    inline IntLanes SplatInt(int32_t value) { return _mm_set1_epi32(value); }
+    inline FloatLanes Load(const float* source) { return _mm_loadu_ps(source); }
+    inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm_add_ps(a, b); }
+    inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm_sub_ps(a, b); }
+    inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm_mul_ps(a, b); }
+    inline FloatLanes Min(FloatLanes a, FloatLanes b) { return _mm_min_ps(a, b); }
+    inline FloatLanes Max(FloatLanes a, FloatLanes b) { return _mm_max_ps(a, b); }
+    inline FloatLanes IfGreaterOrEqual(FloatLanes a, FloatLanes b, FloatLanes value) { return _mm_and_ps(_mm_cmpge_ps(a, b), value); }
+    inline IntLanes TruncateToInt(FloatLanes a) { return _mm_cvttps_epi32(a); }
+    inline IntLanes RoundToInt(FloatLanes a) { return _mm_cvtps_epi32(a); }
+    inline FloatLanes ToFloat(IntLanes a) { return _mm_cvtepi32_ps(a); }
+    inline IntLanes AddInt(IntLanes a, IntLanes b) { return _mm_add_epi32(a, b); }
+    inline IntLanes AndInt(IntLanes a, IntLanes b) { return _mm_and_si128(a, b); }
+    inline IntLanes OrInt(IntLanes a, IntLanes b) { return _mm_or_si128(a, b); }
+    template<int SHIFT> inline IntLanes ShiftLeft(IntLanes a) { return _mm_slli_epi32(a, SHIFT); }
+    template<int SHIFT> inline IntLanes ShiftRight(IntLanes a) { return _mm_srli_epi32(a, SHIFT); }
+    inline void StoreInt(Pixel_RGBA* destination, IntLanes a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), a); }
+
+    /// SSE2 has no floor: truncate, then step down the lanes truncation rounded up. Lanes stay well within int32 range, UVs being clamped.
+    inline FloatLanes Floor(FloatLanes a)
+    {
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+    }
+
+    /// SSE2 has no gather either: texels get fetched one at a time.
+    inline IntLanes Gather(const uint32_t* texels, IntLanes indices)
+    {
+        alignas(16) int32_t indexValues[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(indexValues), indices);
+        return _mm_setr_epi32(static_cast<int32_t>(texels[indexValues[0]]), static_cast<int32_t>(texels[indexValues[1]]),
+            static_cast<int32_t>(texels[indexValues[2]]), static_cast<int32_t>(texels[indexValues[3]]));
+    }
+
+    inline FloatLanes SplatPerQuad(const float* values) { return _mm_set1_ps(values[0]); }
+    inline IntLanes SplatIntPerQuad(const int32_t* values) { return _mm_set1_epi32(values[0]); }
+
+    #define TEXTURE_SIMD_LANES
+#endif
+}
+
+#include "TextureKernels.h"
+
+namespace
+{
+    inline uint32_t GetTileRowCount(const Texture::Level& level) { return (level.Height + Texture::TILE_SIZE - 1) >> Texture::TILE_SIZE_BITS; }
+
+    /// Averages four RGBA8 texels channel by channel, rounding to nearest.
+    inline uint32_t AverageTexels(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+    {
+        uint32_t result = 0;
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            const uint32_t sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) + ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+            result |= ((sum + 2) >> 2) << shift;
+        }
+        return result;
+    }
+
+}
+
+bool Texture::Create(const Pixel_RGBA* texels, uint32_t width, uint32_t height, JobSystem& jobSystem, bool bGenerateMips)
+{
+    PROFILE_ZONE("Texture::Create");
+    m_levels.clear();
+    m_tiles.clear();
+    if (width == 0 || height == 0 || width > MAX_SIZE || height > MAX_SIZE)
+    {
+        return false;
+    }
+
+    // Lay every level out first, so texel storage gets allocated at once.
+    uint32_t texelCount = 0;
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+    while (true)
+    {
+        Level level;
+        level.Width = levelWidth;
+        level.Height = levelHeight;
+        level.TileColumnCount = (levelWidth + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+        level.FirstTexel = texelCount;
+        m_levels.push_back(level);
+        texelCount += level.TileColumnCount * GetTileRowCount(level) * TILE_TEXEL_COUNT;
+
+        if (!bGenerateMips || (levelWidth == 1 && levelHeight == 1))
+        {
+            break;
+        }
+        levelWidth = std::max<uint32_t>(levelWidth / 2, 1);
+        levelHeight = std::max<uint32_t>(levelHeight / 2, 1);
+    }
+    m_tiles.resize(texelCount / TILE_TEXEL_COUNT);
+    uint32_t* storage = m_tiles.data()->Texels;
+
+    // Level 0: reorder row-major texels into tiles, a row of tiles per job.
+    const Level& baseLevel = m_levels[0];
+    jobSystem.ParallelFor(GetTileRowCount(baseLevel), [&](uint32_t tileRow)
+    {
+        const uint32_t endY = std::min((tileRow + 1) * TILE_SIZE, height);
+        for (uint32_t y = tileRow * TILE_SIZE; y < endY; y++)
+        {
+            const Pixel_RGBA* sourceRow = texels + static_cast<size_t>(y) * width;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                storage[GetTexelIndex(baseLevel, x, y)] = sourceRow[x].pixel;
+            }
+        }
+    });
+
+    // Every other level averages 2x2 texels of the previous one, so levels get built in order, each one spread across jobs. The last texel
+    // row or column of odd sized levels gets averaged with itself.
+    for (size_t levelIndex = 1; levelIndex < m_levels.size(); levelIndex++)
+    {
+        const Level& sourceLevel = m_levels[levelIndex - 1];
+        const Level& level = m_levels[levelIndex];
+        jobSystem.ParallelFor(GetTileRowCount(level), [&](uint32_t tileRow)
+        {
+            const uint32_t endY = std::min((tileRow + 1) * TILE_SIZE, level.Height);
+            for (uint32_t y = tileRow * TILE_SIZE; y < endY; y++)
+            {
+                const uint32_t sourceY0 = std::min(2 * y, sourceLevel.Height - 1);
+                const uint32_t sourceY1 = std::min(2 * y + 1, sourceLevel.Height - 1);
+                for (uint32_t x = 0; x < level.Width; x++)
+                {
+                    const uint32_t sourceX0 = std::min(2 * x, sourceLevel.Width - 1);
+                    const uint32_t sourceX1 = std::min(2 * x + 1, sourceLevel.Width - 1);
+                    storage[GetTexelIndex(level, x, y)] = AverageTexels(storage[GetTexelIndex(sourceLevel, sourceX0, sourceY0)],
+                        storage[GetTexelIndex(sourceLevel, sourceX1, sourceY0)], storage[GetTexelIndex(sourceLevel, sourceX0, sourceY1)],
+                        storage[GetTexelIndex(sourceLevel, sourceX1, sourceY1)]);
+                }
+            }
+        });
+    }
+    return true;
+}
+
+uint32_t Texture::GetTexel(uint32_t level, uint32_t x, uint32_t y) const
+{
+    return m_tiles.data()->Texels[GetTexelIndex(m_levels[level], x, y)];
+}
+
+uint32_t Texture::ComputeQuadLevel(const float* u, const float* v) const
+{
+    return SelectQuadLevel(m_levels[0], GetLevelCount(), u, v);
+}
+
+void Texture::SampleQuads(const float* u, const float* v, uint32_t quadCount, Pixel_RGBA* outPixels, const SimdPaths& simdPaths) const
+{
+#if defined(TEXTURE_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        SampleQuadsAvx2(u, v, quadCount, outPixels);
+        return;
+    }
+#endif
+    SampleQuadRange(m_levels, m_tiles.data()->Texels, u, v, quadCount, outPixels);
+}
+
+const char* Texture::GetSimdPathName(const SimdPaths& simdPaths)
+{
+#if defined(TEXTURE_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        return "AVX2";
+    }
+#endif
+#if defined(TEXTURE_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
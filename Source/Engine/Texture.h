@@ -0,0 +1,100 @@
+/*
+    Engine-side RGBA8 texture with its full mip chain, stored for a software sampler walking it at any angle.
+    Texels are grouped in 8x8 tiles, each tile holding its texels in Morton (Z) order, so the 2x2 texels a bilinear fetch reads always sit
+    close together, and a pixel quad's fetches land in a handful of cache lines whichever direction the texture gets walked in. Row-major
+    storage only gives that going along rows: walking down columns, every fetch misses cache.
+    Samples are taken per 2x2 pixel quad, the way a rasterizer shades pixels: UV differences within the quad pick the mip level, then each
+    pixel gets filtered bilinearly within it, using SIMD (AVX2 gathering two quads at once or SSE2 one quad at once, depending on what the
+    CPU supports) with a scalar fallback.
+*/
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+// Pixel format forward declaration (see Platform.h).
+union Pixel_RGBA;
+
+class Texture
+{
+public:
+
+    // Tiles are TILE_SIZE texels wide & high. Partial tiles at the right & bottom edges of levels get padded.
+    static constexpr uint32_t TILE_SIZE_BITS = 3;
+    static constexpr uint32_t TILE_SIZE = 1 << TILE_SIZE_BITS;
+    static constexpr uint32_t TILE_TEXEL_COUNT = TILE_SIZE * TILE_SIZE;
+
+    // Largest width & height of a texture. Keeps texel indices, and texel coordinates of wrapped UVs, within 32 bits.
+    static constexpr uint32_t MAX_SIZE = 16384;
+
+    // UVs get clamped to [-MAX_UV, MAX_UV] before wrapping, which keeps sampling within the texture whatever the UVs, NaN included.
+    static constexpr float MAX_UV = 4096.0f;
+
+    /// @brief Mip level: its size and where its tiles start, tiles being stored row-major within a level.
+    struct Level
+    {
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t TileColumnCount;
+        // Index of the level's first texel in the texel storage, a multiple of TILE_TEXEL_COUNT.
+        uint32_t FirstTexel;
+    };
+
+    /// @brief Builds the texture from row-major texels, replacing any previous contents, then its mip chain down to 1x1. Each level gets box
+    /// filtered from the previous one.
+    /// @param texels Row-major texels, width * height of them with no padding.
+    /// @param jobSystem Job system conversion & filtering of each level get spread across, tile rows at a time.
+    /// @param bGenerateMips Whether to build the mip chain, or only level 0.
+    /// @return False if either size is 0 or above MAX_SIZE, leaving the texture empty.
+    bool Create(const Pixel_RGBA* texels, uint32_t width, uint32_t height, JobSystem& jobSystem, bool bGenerateMips = true);
+
+    inline bool IsEmpty() const { return m_levels.empty(); }
+    inline uint32_t GetWidth() const { return IsEmpty() ? 0 : m_levels[0].Width; }
+    inline uint32_t GetHeight() const { return IsEmpty() ? 0 : m_levels[0].Height; }
+    inline uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+    inline const Level& GetLevel(uint32_t level) const { return m_levels[level]; }
+
+    /// @brief Size of the texel storage in bytes, padding included.
+    inline size_t GetSizeInBytes() const { return m_tiles.size() * sizeof(Tile); }
+
+    /// @brief Returns a texel of a level, as Pixel_RGBA::pixel. Coordinates must be within the level.
+    uint32_t GetTexel(uint32_t level, uint32_t x, uint32_t y) const;
+
+    /// @brief Samples pixel quads with bilinear filtering, UVs repeating. Each quad picks the mip level closest to its texel to pixel ratio.
+    /// @param u Horizontal texture coordinates, 4 per quad: top left, top right, bottom left & bottom right pixels. 0 is the left edge of
+    /// the texture, 1 its right edge.
+    /// @param v Vertical texture coordinates, ordered the same. 0 is the top edge of the texture, 1 its bottom edge.
+    /// @param quadCount Amount of quads.
+    /// @param outPixels Sampled colors, 4 per quad ordered like UVs. Texture must not be empty.
+    /// @param simdPaths SIMD paths the CPU supports, see CpuFeatures::DetectSimdPaths.
+    void SampleQuads(const float* u, const float* v, uint32_t quadCount, Pixel_RGBA* outPixels, const SimdPaths& simdPaths) const;
+
+    /// @brief Returns the mip level a quad samples, see SampleQuads.
+    uint32_t ComputeQuadLevel(const float* u, const float* v) const;
+
+    /// @brief Returns the name of the SIMD instruction set the sampler runs with the passed paths, for debugging purposes.
+    static const char* GetSimdPathName(const SimdPaths& simdPaths);
+
+private:
+
+    /// @brief Texels of a tile, in Morton order. Aligned so a tile spans exactly 4 cache lines, each holding a 4x4 block of texels.
+    struct alignas(64) Tile
+    {
+        uint32_t Texels[TILE_TEXEL_COUNT];
+    };
+
+#if defined(ENGINE_AVX2_KERNELS)
+    /// @brief SampleQuads compiled for AVX2 (see TextureAvx2.cpp), which SampleQuads calls instead when SimdPaths allow AVX2.
+    ENGINE_AVX2_TARGET void SampleQuadsAvx2(const float* u, const float* v, uint32_t quadCount, Pixel_RGBA* outPixels) const;
+#endif
+
+    std::vector<Tile> m_tiles;
+    std::vector<Level> m_levels;
+};
+
+#endif // TEXTURE_H
@@ -0,0 +1,65 @@
+#include "Texture.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// AVX2 texture sampling, compiled for AVX2 whatever the target so Texture.cpp can pick it at startup.
+#if defined(ENGINE_AVX2_KERNELS) && !defined(TEXTURE_FORCE_SCALAR)
+
+#include <immintrin.h>
+
+ENGINE_AVX2_BEGIN
+
+namespace
+{
+    // Thin AVX2 wrappers over the intrinsics the block kernel of TextureKernels.h is written with. Each lane samples a pixel, blocks holding
+    // two quads, each with its own mip level.
+    typedef __m256 FloatLanes;
+    typedef __m256i IntLanes;
+    const uint32_t LANE_COUNT = 8;
+
+    inline FloatLanes Splat(float value) { return _mm256_set1_ps(value); }
+    inline IntLanes SplatInt(int32_t value) { return _mm256_set1_epi32(value); }
+    inline FloatLanes Load(const float* source) { return _mm256_loadu_ps(source); }
+    inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm256_add_ps(a, b); }
+    inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm256_sub_ps(a, b); }
+    inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm256_mul_ps(a, b); }
+    inline FloatLanes Min(FloatLanes a, FloatLanes b) { return _mm256_min_ps(a, b); }
+    inline FloatLanes Max(FloatLanes a, FloatLanes b) { return _mm256_max_ps(a, b); }
+    inline FloatLanes Floor(FloatLanes a) { return _mm256_floor_ps(a); }
+    inline FloatLanes IfGreaterOrEqual(FloatLanes a, FloatLanes b, FloatLanes value) { return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ), value); }
+    inline IntLanes TruncateToInt(FloatLanes a) { return _mm256_cvttps_epi32(a); }
+    inline IntLanes RoundToInt(FloatLanes a) { return _mm256_cvtps_epi32(a); }
+    inline FloatLanes ToFloat(IntLanes a) { return _mm256_cvtepi32_ps(a); }
+    inline IntLanes AddInt(IntLanes a, IntLanes b) { return _mm256_add_epi32(a, b); }
+    inline IntLanes AndInt(IntLanes a, IntLanes b) { return _mm256_and_si256(a, b); }
+    inline IntLanes OrInt(IntLanes a, IntLanes b) { return _mm256_or_si256(a, b); }
+    template<int SHIFT> inline IntLanes ShiftLeft(IntLanes a) { return _mm256_slli_epi32(a, SHIFT); }
+    template<int SHIFT> inline IntLanes ShiftRight(IntLanes a) { return _mm256_srli_epi32(a, SHIFT); }
+    inline IntLanes Gather(const uint32_t* texels, IntLanes indices) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(texels), indices, 4); }
+    inline void StoreInt(Pixel_RGBA* destination, IntLanes a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), a); }
+
+    /// Broadcasts a value per quad to the lanes of that quad.
+    inline FloatLanes SplatPerQuad(const float* values)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(values[0])), _mm_set1_ps(values[1]), 1);
+    }
+    inline IntLanes SplatIntPerQuad(const int32_t* values)
+    {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(values[0])), _mm_set1_epi32(values[1]), 1);
+    }
+}
+
+#define TEXTURE_SIMD_LANES
+#include "TextureKernels.h"
+
+ENGINE_AVX2_END
+
+ENGINE_AVX2_TARGET void Texture::SampleQuadsAvx2(const float* u, const float* v, uint32_t quadCount, Pixel_RGBA* outPixels) const
+{
+    SampleQuadRange(m_levels, m_tiles.data()->Texels, u, v, quadCount, outPixels);
+}
+
+#endif
@@ -0,0 +1,263 @@
+/*
+    Texture sampling kernels shared by Texture.cpp & TextureAvx2.cpp, each file compiling them for its own instruction set.
+    SIMD kernels are written once over thin wrappers of the intrinsics: files define the wrappers, along with TEXTURE_SIMD_LANES, before
+    including this one. Everything has internal linkage, so each file keeps its own copy whatever it got compiled for.
+*/
+
+#ifndef TEXTURE_KERNELS_H
+#define TEXTURE_KERNELS_H
+
+#include "Texture.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Mip levels of a MAX_SIZE texture, down to 1x1.
+    constexpr uint32_t MAX_LEVEL_COUNT = 15;
+    static_assert((1u << (MAX_LEVEL_COUNT - 1)) == Texture::MAX_SIZE, "Mip chains of the largest textures must fit MAX_LEVEL_COUNT levels.");
+
+    /// Level constants the sampler works with, computed once per SampleQuads call by ComputeLevelSampling.
+    struct LevelSampling
+    {
+        float Width;
+        float Height;
+        float InverseWidth;
+        float InverseHeight;
+        float TileColumnCount;
+        int32_t FirstTexel;
+    };
+
+    /// Spreads the low TILE_SIZE_BITS bits of a coordinate to every other bit, for interleaving with the other coordinate's in Morton order.
+    inline uint32_t SpreadTileBits(uint32_t value)
+    {
+        return (value & 1) | ((value & 2) << 1) | ((value & 4) << 2);
+    }
+
+    inline uint32_t GetTexelIndex(const Texture::Level& level, uint32_t x, uint32_t y)
+    {
+        const uint32_t tileIndex = (y >> Texture::TILE_SIZE_BITS) * level.TileColumnCount + (x >> Texture::TILE_SIZE_BITS);
+        const uint32_t tileMask = Texture::TILE_SIZE - 1;
+        return level.FirstTexel + tileIndex * Texture::TILE_TEXEL_COUNT + SpreadTileBits(x & tileMask) + (SpreadTileBits(y & tileMask) << 1);
+    }
+
+    /// Brings an integral texel coordinate back within [0, size), repeating the texture. The last clamp only catches rounding of huge
+    /// coordinates, so memory outside the level is never read.
+    inline float WrapCoordinate(float coordinate, float size, float inverseSize)
+    {
+        coordinate -= size * std::floor(coordinate * inverseSize);
+        coordinate = coordinate >= size ? coordinate - size : coordinate;
+        return std::min(std::max(coordinate, 0.0f), size - 1.0f);
+    }
+
+    /// Bilinearly filters a single pixel. Used as the scalar path and for quads left over by SIMD blocks. Every operation matches the SIMD
+    /// paths', in the same order, so all paths give the same results.
+    inline uint32_t SampleBilinearScalar(const uint32_t* texels, const LevelSampling& level, float u, float v)
+    {
+        // Written so NaN compares false and gets replaced, like SIMD min & max do.
+        u = u > -Texture::MAX_UV ? u : -Texture::MAX_UV;
+        u = u < Texture::MAX_UV ? u : Texture::MAX_UV;
+        v = v > -Texture::MAX_UV ? v : -Texture::MAX_UV;
+        v = v < Texture::MAX_UV ? v : Texture::MAX_UV;
+
+        // Texel centers sit half a texel away from texel corners.
+        const float x = u * level.Width - 0.5f;
+        const float y = v * level.Height - 0.5f;
+        const float floorX = std::floor(x);
+        const float floorY = std::floor(y);
+        const float fractionX = x - floorX;
+        const float fractionY = y - floorY;
+
+        const float x0 = WrapCoordinate(floorX, level.Width, level.InverseWidth);
+        const float y0 = WrapCoordinate(floorY, level.Height, level.InverseHeight);
+        const float x1 = x0 + 1.0f >= level.Width ? x0 + 1.0f - level.Width : x0 + 1.0f;
+        const float y1 = y0 + 1.0f >= level.Height ? y0 + 1.0f - level.Height : y0 + 1.0f;
+
+        Texture::Level indexLevel;
+        indexLevel.TileColumnCount = static_cast<uint32_t>(level.TileColumnCount);
+        indexLevel.FirstTexel = static_cast<uint32_t>(level.FirstTexel);
+        const uint32_t t00 = texels[GetTexelIndex(indexLevel, static_cast<uint32_t>(x0), static_cast<uint32_t>(y0))];
+        const uint32_t t10 = texels[GetTexelIndex(indexLevel, static_cast<uint32_t>(x1), static_cast<uint32_t>(y0))];
+        const uint32_t t01 = texels[GetTexelIndex(indexLevel, static_cast<uint32_t>(x0), static_cast<uint32_t>(y1))];
+        const uint32_t t11 = texels[GetTexelIndex(indexLevel, static_cast<uint32_t>(x1), static_cast<uint32_t>(y1))];
+
+        uint32_t result = 0;
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            const float c00 = static_cast<float>((t00 >> shift) & 0xFF);
+            const float c10 = static_cast<float>((t10 >> shift) & 0xFF);
+            const float c01 = static_cast<float>((t01 >> shift) & 0xFF);
+            const float c11 = static_cast<float>((t11 >> shift) & 0xFF);
+            const float top = c00 + (c10 - c00) * fractionX;
+            const float bottom = c01 + (c11 - c01) * fractionX;
+            result |= static_cast<uint32_t>(std::lrint(top + (bottom - top) * fractionY)) << shift;
+        }
+        return result;
+    }
+
+#if defined(TEXTURE_SIMD_LANES)
+    const uint32_t QUADS_PER_BLOCK = LANE_COUNT / 4;
+
+    /// See WrapCoordinate.
+    inline FloatLanes WrapCoordinates(FloatLanes coordinates, FloatLanes size, FloatLanes inverseSize)
+    {
+        coordinates = Sub(coordinates, Mul(size, Floor(Mul(coordinates, inverseSize))));
+        coordinates = Sub(coordinates, IfGreaterOrEqual(coordinates, size, size));
+        return Min(Max(coordinates, Splat(0.0f)), Sub(size, Splat(1.0f)));
+    }
+
+    /// Position of texels within their level's tiles: tile column, or tile row times tile count per row, and Morton bits, both for a
+    /// coordinate. Tile math stays in floats, as SSE2 can't multiply 32-bit integers.
+    inline void GetTilePosition(FloatLanes coordinates, FloatLanes tileScale, IntLanes& outTileOffset, IntLanes& outMortonBits)
+    {
+        outTileOffset = TruncateToInt(Mul(Floor(Mul(coordinates, Splat(1.0f / Texture::TILE_SIZE))), tileScale));
+        const IntLanes tileCoordinates = AndInt(TruncateToInt(coordinates), SplatInt(Texture::TILE_SIZE - 1));
+        outMortonBits = OrInt(OrInt(AndInt(tileCoordinates, SplatInt(1)), ShiftLeft<1>(AndInt(tileCoordinates, SplatInt(2)))),
+            ShiftLeft<2>(AndInt(tileCoordinates, SplatInt(4))));
+    }
+
+    inline IntLanes GetTexelIndices(IntLanes firstTexel, IntLanes tileColumn, IntLanes mortonX, IntLanes tileRow, IntLanes mortonY)
+    {
+        constexpr int TILE_TEXEL_BITS = 2 * Texture::TILE_SIZE_BITS;
+        return AddInt(AddInt(firstTexel, ShiftLeft<TILE_TEXEL_BITS>(AddInt(tileRow, tileColumn))), OrInt(mortonX, ShiftLeft<1>(mortonY)));
+    }
+
+    /// Filters a channel of the lanes' texels, as SampleBilinearScalar does.
+    template<int SHIFT>
+    inline IntLanes FilterChannel(IntLanes t00, IntLanes t10, IntLanes t01, IntLanes t11, FloatLanes fractionX, FloatLanes fractionY)
+    {
+        const IntLanes channelMask = SplatInt(0xFF);
+        const FloatLanes c00 = ToFloat(AndInt(ShiftRight<SHIFT>(t00), channelMask));
+        const FloatLanes c10 = ToFloat(AndInt(ShiftRight<SHIFT>(t10), channelMask));
+        const FloatLanes c01 = ToFloat(AndInt(ShiftRight<SHIFT>(t01), channelMask));
+        const FloatLanes c11 = ToFloat(AndInt(ShiftRight<SHIFT>(t11), channelMask));
+        const FloatLanes top = Add(c00, Mul(Sub(c10, c00), fractionX));
+        const FloatLanes bottom = Add(c01, Mul(Sub(c11, c01), fractionX));
+        return ShiftLeft<SHIFT>(RoundToInt(Add(top, Mul(Sub(bottom, top), fractionY))));
+    }
+
+    /// Samples QUADS_PER_BLOCK quads, each one at its own level.
+    inline void SampleQuadBlock(const uint32_t* texels, const LevelSampling* const* quadLevels, const float* u, const float* v, Pixel_RGBA* outPixels)
+    {
+        float widths[QUADS_PER_BLOCK], heights[QUADS_PER_BLOCK], inverseWidths[QUADS_PER_BLOCK], inverseHeights[QUADS_PER_BLOCK];
+        float tileColumnCounts[QUADS_PER_BLOCK];
+        int32_t firstTexels[QUADS_PER_BLOCK];
+        for (uint32_t quad = 0; quad < QUADS_PER_BLOCK; quad++)
+        {
+            widths[quad] = quadLevels[quad]->Width;
+            heights[quad] = quadLevels[quad]->Height;
+            inverseWidths[quad] = quadLevels[quad]->InverseWidth;
+            inverseHeights[quad] = quadLevels[quad]->InverseHeight;
+            tileColumnCounts[quad] = quadLevels[quad]->TileColumnCount;
+            firstTexels[quad] = quadLevels[quad]->FirstTexel;
+        }
+        const FloatLanes width = SplatPerQuad(widths);
+        const FloatLanes height = SplatPerQuad(heights);
+        const FloatLanes one = Splat(1.0f);
+
+        const FloatLanes maxUv = Splat(Texture::MAX_UV);
+        const FloatLanes minUv = Splat(-Texture::MAX_UV);
+        const FloatLanes x = Sub(Mul(Min(Max(Load(u), minUv), maxUv), width), Splat(0.5f));
+        const FloatLanes y = Sub(Mul(Min(Max(Load(v), minUv), maxUv), height), Splat(0.5f));
+        const FloatLanes floorX = Floor(x);
+        const FloatLanes floorY = Floor(y);
+        const FloatLanes fractionX = Sub(x, floorX);
+        const FloatLanes fractionY = Sub(y, floorY);
+
+        const FloatLanes x0 = WrapCoordinates(floorX, width, SplatPerQuad(inverseWidths));
+        const FloatLanes y0 = WrapCoordinates(floorY, height, SplatPerQuad(inverseHeights));
+        FloatLanes x1 = Add(x0, one);
+        x1 = Sub(x1, IfGreaterOrEqual(x1, width, width));
+        FloatLanes y1 = Add(y0, one);
+        y1 = Sub(y1, IfGreaterOrEqual(y1, height, height));
+
+        IntLanes tileColumn0, mortonX0, tileColumn1, mortonX1, tileRow0, mortonY0, tileRow1, mortonY1;
+        GetTilePosition(x0, one, tileColumn0, mortonX0);
+        GetTilePosition(x1, one, tileColumn1, mortonX1);
+        const FloatLanes tileColumnCount = SplatPerQuad(tileColumnCounts);
+        GetTilePosition(y0, tileColumnCount, tileRow0, mortonY0);
+        GetTilePosition(y1, tileColumnCount, tileRow1, mortonY1);
+
+        const IntLanes firstTexel = SplatIntPerQuad(firstTexels);
+        const IntLanes t00 = Gather(texels, GetTexelIndices(firstTexel, tileColumn0, mortonX0, tileRow0, mortonY0));
+        const IntLanes t10 = Gather(texels, GetTexelIndices(firstTexel, tileColumn1, mortonX1, tileRow0, mortonY0));
+        const IntLanes t01 = Gather(texels, GetTexelIndices(firstTexel, tileColumn0, mortonX0, tileRow1, mortonY1));
+        const IntLanes t11 = Gather(texels, GetTexelIndices(firstTexel, tileColumn1, mortonX1, tileRow1, mortonY1));
+
+        StoreInt(outPixels, OrInt(OrInt(FilterChannel<0>(t00, t10, t01, t11, fractionX, fractionY), FilterChannel<8>(t00, t10, t01, t11, fractionX, fractionY)),
+            OrInt(FilterChannel<16>(t00, t10, t01, t11, fractionX, fractionY), FilterChannel<24>(t00, t10, t01, t11, fractionX, fractionY))));
+    }
+#endif
+
+    inline void ComputeLevelSampling(const std::vector<Texture::Level>& levels, LevelSampling* outLevels)
+    {
+        for (size_t levelIndex = 0; levelIndex < levels.size(); levelIndex++)
+        {
+            const Texture::Level& level = levels[levelIndex];
+            outLevels[levelIndex].Width = static_cast<float>(level.Width);
+            outLevels[levelIndex].Height = static_cast<float>(level.Height);
+            outLevels[levelIndex].InverseWidth = 1.0f / level.Width;
+            outLevels[levelIndex].InverseHeight = 1.0f / level.Height;
+            outLevels[levelIndex].TileColumnCount = static_cast<float>(level.TileColumnCount);
+            outLevels[levelIndex].FirstTexel = static_cast<int32_t>(level.FirstTexel);
+        }
+    }
+
+    /// See Texture::ComputeQuadLevel.
+    inline uint32_t SelectQuadLevel(const Texture::Level& baseLevel, uint32_t levelCount, const float* u, const float* v)
+    {
+        // Texels of level 0 the quad steps over per pixel, horizontally & vertically. The longest step is the texel to pixel ratio.
+        const float width = static_cast<float>(baseLevel.Width);
+        const float height = static_cast<float>(baseLevel.Height);
+        const float stepXu = (u[1] - u[0]) * width;
+        const float stepXv = (v[1] - v[0]) * height;
+        const float stepYu = (u[2] - u[0]) * width;
+        const float stepYv = (v[2] - v[0]) * height;
+        const float ratioSquared = std::max(stepXu * stepXu + stepXv * stepXv, stepYu * stepYu + stepYv * stepYv);
+
+        // The closest level is round(log2(ratio)) = floor(log2(2 * ratio^2) / 2), and floor(log2(x)) is the exponent of float x. Ratios under
+        // half a texel per pixel get a negative exponent, NaN & infinite ones the largest: both end up clamped.
+        const float scaledRatio = 2.0f * ratioSquared;
+        uint32_t ratioBits;
+        memcpy(&ratioBits, &scaledRatio, sizeof(ratioBits));
+        const int32_t exponent = static_cast<int32_t>((ratioBits >> 23) & 0xFF) - 127;
+        return exponent > 0 ? std::min(static_cast<uint32_t>(exponent) / 2, levelCount - 1) : 0;
+    }
+
+    /// Samples quads as Texture::SampleQuads describes, QUADS_PER_BLOCK at a time when SIMD lanes are available, then those left over one
+    /// pixel at a time.
+    inline void SampleQuadRange(const std::vector<Texture::Level>& textureLevels, const uint32_t* texels, const float* u, const float* v,
+        uint32_t quadCount, Pixel_RGBA* outPixels)
+    {
+        LevelSampling levels[MAX_LEVEL_COUNT];
+        ComputeLevelSampling(textureLevels, levels);
+        const Texture::Level& baseLevel = textureLevels[0];
+        const uint32_t levelCount = static_cast<uint32_t>(textureLevels.size());
+
+        uint32_t quad = 0;
+#if defined(TEXTURE_SIMD_LANES)
+        for (; quad + QUADS_PER_BLOCK <= quadCount; quad += QUADS_PER_BLOCK)
+        {
+            const LevelSampling* quadLevels[QUADS_PER_BLOCK];
+            for (uint32_t blockQuad = 0; blockQuad < QUADS_PER_BLOCK; blockQuad++)
+            {
+                quadLevels[blockQuad] = &levels[SelectQuadLevel(baseLevel, levelCount, u + (quad + blockQuad) * 4, v + (quad + blockQuad) * 4)];
+            }
+            SampleQuadBlock(texels, quadLevels, u + quad * 4, v + quad * 4, outPixels + quad * 4);
+        }
+#endif
+        for (; quad < quadCount; quad++)
+        {
+            const LevelSampling& level = levels[SelectQuadLevel(baseLevel, levelCount, u + quad * 4, v + quad * 4)];
+            for (uint32_t pixel = quad * 4; pixel < quad * 4 + 4; pixel++)
+            {
+                outPixels[pixel].pixel = SampleBilinearScalar(texels, level, u[pixel], v[pixel]);
+            }
+        }
+    }
+}
+
+#endif // TEXTURE_KERNELS_H
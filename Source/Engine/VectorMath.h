@@ -0,0 +1,109 @@
+/*
+    Basic linear algebra types used throughout the Engine: 2D / 3D / 4D float vectors and 4x4 matrices.
+    Matrices are stored row-major and transform column vectors (v' = M * v).
+*/
+
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <cmath>
+
+struct Vector2
+{
+    float x, y;
+};
+
+struct Vector3
+{
+    float x, y, z;
+
+    inline Vector3 operator+(const Vector3& other) const { return Vector3{x + other.x, y + other.y, z + other.z}; }
+    inline Vector3 operator-(const Vector3& other) const { return Vector3{x - other.x, y - other.y, z - other.z}; }
+    inline Vector3 operator*(float scalar) const { return Vector3{x * scalar, y * scalar, z * scalar}; }
+    inline Vector3 operator-() const { return Vector3{-x, -y, -z}; }
+};
+
+inline float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vector3 Cross(const Vector3& a, const Vector3& b) { return Vector3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+inline float Length(const Vector3& v) { return std::sqrt(Dot(v, v)); }
+inline Vector3 Min(const Vector3& a, const Vector3& b) { return Vector3{std::fmin(a.x, b.x), std::fmin(a.y, b.y), std::fmin(a.z, b.z)}; }
+inline Vector3 Max(const Vector3& a, const Vector3& b) { return Vector3{std::fmax(a.x, b.x), std::fmax(a.y, b.y), std::fmax(a.z, b.z)}; }
+
+/// @brief Returns the passed vector scaled to unit length, or the zero vector if it has no length.
+inline Vector3 Normalize(const Vector3& v)
+{
+    float length = Length(v);
+    return length > 0.0f ? v * (1.0f / length) : Vector3{0.0f, 0.0f, 0.0f};
+}
+
+struct Vector4
+{
+    float x, y, z, w;
+};
+
+struct Matrix4x4
+{
+    // Row-major elements: m[row][column].
+    float m[4][4];
+
+    static Matrix4x4 Identity()
+    {
+        return Matrix4x4{{  {1.0f, 0.0f, 0.0f, 0.0f},
+                            {0.0f, 1.0f, 0.0f, 0.0f},
+                            {0.0f, 0.0f, 1.0f, 0.0f},
+                            {0.0f, 0.0f, 0.0f, 1.0f}}};
+    }
+
+    /// @brief Builds a right-handed perspective projection matrix mapping view space depth [near, far] to clip space depth [0, w].
+    /// @param fovY Vertical field of view in radians.
+    /// @param aspect Width over height ratio of the viewport.
+    static Matrix4x4 Perspective(float fovY, float aspect, float nearPlane, float farPlane)
+    {
+        const float yScale = 1.0f / std::tan(fovY * 0.5f);
+        const float xScale = yScale / aspect;
+        const float depthRange = farPlane / (nearPlane - farPlane);
+
+        return Matrix4x4{{  {xScale, 0.0f, 0.0f, 0.0f},
+                            {0.0f, yScale, 0.0f, 0.0f},
+                            {0.0f, 0.0f, depthRange, depthRange * nearPlane},
+                            {0.0f, 0.0f, -1.0f, 0.0f}}};
+    }
+
+    /// @brief Builds a right-handed view matrix for an eye at the passed position looking towards target.
+    static Matrix4x4 LookAt(const Vector3& eye, const Vector3& target, const Vector3& up)
+    {
+        const Vector3 forward = Normalize(target - eye);
+        const Vector3 right = Normalize(Cross(forward, up));
+        const Vector3 trueUp = Cross(right, forward);
+
+        return Matrix4x4{{  {right.x, right.y, right.z, -Dot(right, eye)},
+                            {trueUp.x, trueUp.y, trueUp.z, -Dot(trueUp, eye)},
+                            {-forward.x, -forward.y, -forward.z, Dot(forward, eye)},
+                            {0.0f, 0.0f, 0.0f, 1.0f}}};
+    }
+
+    inline Matrix4x4 operator*(const Matrix4x4& other) const
+    {
+        Matrix4x4 result;
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                result.m[row][column] = m[row][0] * other.m[0][column] + m[row][1] * other.m[1][column]
+                                      + m[row][2] * other.m[2][column] + m[row][3] * other.m[3][column];
+            }
+        }
+        return result;
+    }
+
+    /// @brief Transforms a point (implicit w = 1).
+    inline Vector4 TransformPoint(const Vector3& p) const
+    {
+        return Vector4{ m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                        m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                        m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3],
+                        m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3]};
+    }
+};
+
+#endif // VECTOR_MATH_H
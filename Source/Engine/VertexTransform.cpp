@@ -0,0 +1,113 @@
+#include "VertexTransform.h"
+#include "CpuFeatures.h"
+
+#include <cmath>
+
+// SIMD paths, see CpuFeatures.h. Defining VERTEX_TRANSFORM_FORCE_SCALAR disables them, which is mostly useful to compare results.
+#if !defined(VERTEX_TRANSFORM_FORCE_SCALAR)
+    #if defined(ENGINE_AVX2_KERNELS)
+        #define VERTEX_TRANSFORM_SIMD_AVX2
+    #endif
+    #if defined(ENGINE_SSE2_KERNELS)
+        #define VERTEX_TRANSFORM_SIMD_SSE2
+        #include <emmintrin.h>
+    #endif
+#endif
+
+namespace
+{
+#if defined(VERTEX_TRANSFORM_SIMD_SSE2)
+    // Thin SSE2 wrappers over the intrinsics the block kernel of VertexTransformKernels.h is written with.
+    typedef __m128 FloatLanes;
+    typedef __m128i IntLanes;
+    const uint32_t LANE_COUNT = 4;
+
+    inline FloatLanes Splat(float value) { return _mm_set1_ps(value); }
+    inline IntLanes SplatInt(int32_t value) { return _mm_set1_epi32(value); }
+    inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm_add_ps(a, b); }
+    inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm_sub_ps(a, b); }
+    inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm_mul_ps(a, b); }
+    inline FloatLanes Div(FloatLanes a, FloatLanes b) { return _mm_div_ps(a, b); }
+    inline IntLanes BitIfLess(FloatLanes a, FloatLanes b, IntLanes bit) { return _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(a, b)), bit); }
+    inline IntLanes Or(IntLanes a, IntLanes b) { return _mm_or_si128(a, b); }
+    inline IntLanes RoundToInt(FloatLanes a) { return _mm_cvtps_epi32(a); }
+    inline void Store(float* destination, FloatLanes a) { _mm_store_ps(destination, a); }
+    inline void StoreInt(int32_t* destination, IntLanes a) { _mm_store_si128(reinterpret_cast<__m128i*>(destination), a); }
+
+    inline void StoreClipCodes(uint16_t* destination, IntLanes codes)
+    {
+        // Codes fit in 10 bits, so signed saturation packs them losslessly.
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), _mm_packs_epi32(codes, codes));
+    }
+
+    /// Loads 4 interleaved positions and deinterleaves them.
+    inline void LoadPositions(const Vector3* positions, FloatLanes& outX, FloatLanes& outY, FloatLanes& outZ)
+    {
+        const float* p = &positions[0].x;
+        const __m128 a = _mm_loadu_ps(p + 0); // x0 y0 z0 x1
+        const __m128 b = _mm_loadu_ps(p + 4); // y1 z1 x2 y2
+        const __m128 c = _mm_loadu_ps(p + 8); // z2 x3 y3 z3
+
+        outX = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        outY = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        outZ = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    }
+
+    #define VERTEX_TRANSFORM_SIMD_LANES
+#endif
+}
+
+#include "VertexTransformKernels.h"
+
+void VertexTransform::TransformedVertices::Resize(size_t vertexCount)
+{
+    const size_t paddedCount = (vertexCount + STREAM_PADDING - 1) / STREAM_PADDING * STREAM_PADDING;
+    ClipX.resize(paddedCount);
+    ClipY.resize(paddedCount);
+    ClipZ.resize(paddedCount);
+    ClipW.resize(paddedCount);
+    ClipCodes.resize(paddedCount);
+    ScreenX.resize(paddedCount);
+    ScreenY.resize(paddedCount);
+    ScreenZ.resize(paddedCount);
+    VertexCount = static_cast<uint32_t>(vertexCount);
+}
+
+void VertexTransform::TransformVertices(const Vector3* positions, uint32_t firstVertex, uint32_t endVertex, const Matrix4x4& viewProjection,
+    const Viewport& viewport, TransformedVertices& outVertices, const SimdPaths& simdPaths)
+{
+#if defined(VERTEX_TRANSFORM_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        Avx2::TransformVertices(positions, firstVertex, endVertex, viewProjection, viewport, outVertices);
+        return;
+    }
+#endif
+    TransformVertexRange(positions, firstVertex, endVertex, viewProjection, viewport, outVertices);
+}
+
+RasterVertex VertexTransform::ProjectToScreen(const Vector4& clipPosition, const Viewport& viewport)
+{
+    const float inverseW = 1.0f / clipPosition.w;
+    const float screenX = (clipPosition.x * inverseW * 0.5f + 0.5f) * viewport.Width;
+    const float screenY = (0.5f - clipPosition.y * inverseW * 0.5f) * viewport.Height;
+
+    return RasterVertex{    static_cast<int32_t>(std::lrint(screenX * Rasterizer::SUBPIXEL_SCALE)),
+                            static_cast<int32_t>(std::lrint(screenY * Rasterizer::SUBPIXEL_SCALE)),
+                            clipPosition.z * inverseW };
+}
+
+const char* VertexTransform::GetSimdPathName(const SimdPaths& simdPaths)
+{
+#if defined(VERTEX_TRANSFORM_SIMD_AVX2)
+    if (simdPaths.bUseAvx2)
+    {
+        return "AVX2";
+    }
+#endif
+#if defined(VERTEX_TRANSFORM_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
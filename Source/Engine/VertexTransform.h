@@ -0,0 +1,108 @@
+/*
+    Vertex stage of the geometry pipeline: transforms mesh positions to clip space, computes the clip planes they are outside of and projects
+    those that won't need clipping to fixed-point screen space.
+    Transformed vertices are kept as structure of arrays streams, so SIMD paths process 8 (AVX2) or 4 (SSE2) vertices per iteration with
+    plain vector loads & stores. Streams are aligned to 32 bytes and padded to a multiple of 8 vertices, so those are aligned, and the last
+    vertices of a mesh get transformed as a whole block as well. Mesh positions stay interleaved, as every other part of the Engine reads them one vertex at a time: SIMD
+    paths deinterleave them in registers.
+*/
+
+#ifndef VERTEX_TRANSFORM_H
+#define VERTEX_TRANSFORM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "VectorMath.h"
+#include "Rasterizer.h"
+#include "MemoryArena.h"
+
+namespace VertexTransform
+{
+    // Clip codes: one bit per clip space plane a vertex is outside of.
+    // View frustum planes allow trivially rejecting triangles fully outside the view. Near & guard band planes require actual clipping.
+    enum ClipCode : uint16_t
+    {
+        CLIP_NEAR = 1 << 0,
+        CLIP_FAR = 1 << 1,
+        CLIP_LEFT = 1 << 2,
+        CLIP_RIGHT = 1 << 3,
+        CLIP_BOTTOM = 1 << 4,
+        CLIP_TOP = 1 << 5,
+        CLIP_GUARD_LEFT = 1 << 6,
+        CLIP_GUARD_RIGHT = 1 << 7,
+        CLIP_GUARD_BOTTOM = 1 << 8,
+        CLIP_GUARD_TOP = 1 << 9,
+
+        CLIP_VIEW_MASK = CLIP_NEAR | CLIP_FAR | CLIP_LEFT | CLIP_RIGHT | CLIP_BOTTOM | CLIP_TOP,
+        CLIP_REQUIRED_MASK = CLIP_NEAR | CLIP_GUARD_LEFT | CLIP_GUARD_RIGHT | CLIP_GUARD_BOTTOM | CLIP_GUARD_TOP
+    };
+
+    /// @brief Viewport vertices get projected into.
+    struct Viewport
+    {
+        float Width;
+        float Height;
+        // Clip space X & Y bounds (as a multiple of W) matching the rasterizer's guard band.
+        float GuardBandScale;
+    };
+
+    // Streams hold a multiple of this many vertices.
+    const uint32_t STREAM_PADDING = 8;
+
+    /// @brief Transformed vertices, one element per mesh vertex in every stream, plus padding up to a multiple of STREAM_PADDING.
+    struct TransformedVertices
+    {
+        /// @param arena Arena streams get allocated from, the heap when null.
+        explicit TransformedVertices(MemoryArena* arena = nullptr)
+            : ClipX(arena), ClipY(arena), ClipZ(arena), ClipW(arena), ClipCodes(arena), ScreenX(arena), ScreenY(arena), ScreenZ(arena),
+            VertexCount(0)
+        {}
+
+        // Clip space positions.
+        SimdArenaVector<float> ClipX, ClipY, ClipZ, ClipW;
+        SimdArenaVector<uint16_t> ClipCodes;
+        // Screen space positions (see RasterVertex). Only valid for vertices that don't require clipping.
+        SimdArenaVector<int32_t> ScreenX, ScreenY;
+        SimdArenaVector<float> ScreenZ;
+        // Mesh vertices in the streams, padding excluded.
+        uint32_t VertexCount;
+
+        /// @brief Resizes every stream to hold the passed amount of vertices plus padding, keeping elements of vertices still in range.
+        void Resize(size_t vertexCount);
+
+        inline Vector4 GetClipPosition(uint32_t vertex) const { return Vector4{ ClipX[vertex], ClipY[vertex], ClipZ[vertex], ClipW[vertex] }; }
+        inline RasterVertex GetScreenVertex(uint32_t vertex) const { return RasterVertex{ ScreenX[vertex], ScreenY[vertex], ScreenZ[vertex] }; }
+    };
+
+    /// @brief Transforms a range of mesh vertices. Elements of other mesh vertices are left untouched, so ranges can be processed
+    /// concurrently.
+    /// @param positions Mesh vertex positions.
+    /// @param firstVertex First vertex of the range.
+    /// @param endVertex One past the last vertex of the range.
+    /// @param viewProjection Matrix transforming mesh space to clip space, with clip space depth in [0, w].
+    /// @param viewport Viewport vertices get projected into.
+    /// @param outVertices Transformed vertices, already sized for every vertex of the range.
+    /// @param simdPaths SIMD paths the CPU supports, see CpuFeatures::DetectSimdPaths.
+    void TransformVertices(const Vector3* positions, uint32_t firstVertex, uint32_t endVertex, const Matrix4x4& viewProjection, const Viewport& viewport,
+        TransformedVertices& outVertices, const SimdPaths& simdPaths);
+
+    /// @brief Projects a clip space position to a fixed-point screen space vertex. Matches the projection TransformVertices applies.
+    RasterVertex ProjectToScreen(const Vector4& clipPosition, const Viewport& viewport);
+
+    /// @brief Returns the name of the SIMD instruction set the vertex stage runs with the passed paths, for debugging purposes.
+    const char* GetSimdPathName(const SimdPaths& simdPaths);
+
+#if defined(ENGINE_AVX2_KERNELS)
+    namespace Avx2
+    {
+        /// @brief TransformVertices compiled for AVX2 (see VertexTransformAvx2.cpp). TransformVertices calls it when SimdPaths allow AVX2,
+        /// nothing else should.
+        ENGINE_AVX2_TARGET void TransformVertices(const Vector3* positions, uint32_t firstVertex, uint32_t endVertex, const Matrix4x4& viewProjection,
+            const Viewport& viewport, TransformedVertices& outVertices);
+    }
+#endif
+}
+
+#endif // VERTEX_TRANSFORM_H
@@ -0,0 +1,62 @@
+#include "VertexTransform.h"
+
+#include <cmath>
+
+// AVX2 vertex transform, compiled for AVX2 whatever the target so VertexTransform.cpp can pick it at startup.
+#if defined(ENGINE_AVX2_KERNELS) && !defined(VERTEX_TRANSFORM_FORCE_SCALAR)
+
+#include <immintrin.h>
+
+ENGINE_AVX2_BEGIN
+
+namespace
+{
+    // Thin AVX2 wrappers over the intrinsics the block kernel of VertexTransformKernels.h is written with.
+    typedef __m256 FloatLanes;
+    typedef __m256i IntLanes;
+    const uint32_t LANE_COUNT = 8;
+
+    inline FloatLanes Splat(float value) { return _mm256_set1_ps(value); }
+    inline IntLanes SplatInt(int32_t value) { return _mm256_set1_epi32(value); }
+    inline FloatLanes Add(FloatLanes a, FloatLanes b) { return _mm256_add_ps(a, b); }
+    inline FloatLanes Sub(FloatLanes a, FloatLanes b) { return _mm256_sub_ps(a, b); }
+    inline FloatLanes Mul(FloatLanes a, FloatLanes b) { return _mm256_mul_ps(a, b); }
+    inline FloatLanes Div(FloatLanes a, FloatLanes b) { return _mm256_div_ps(a, b); }
+    inline IntLanes BitIfLess(FloatLanes a, FloatLanes b, IntLanes bit) { return _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)), bit); }
+    inline IntLanes Or(IntLanes a, IntLanes b) { return _mm256_or_si256(a, b); }
+    inline IntLanes RoundToInt(FloatLanes a) { return _mm256_cvtps_epi32(a); }
+    inline void Store(float* destination, FloatLanes a) { _mm256_store_ps(destination, a); }
+    inline void StoreInt(int32_t* destination, IntLanes a) { _mm256_store_si256(reinterpret_cast<__m256i*>(destination), a); }
+
+    inline void StoreClipCodes(uint16_t* destination, IntLanes codes)
+    {
+        // Codes fit in 10 bits, so signed saturation packs them losslessly.
+        _mm_store_si128(reinterpret_cast<__m128i*>(destination), _mm_packs_epi32(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1)));
+    }
+
+    /// Loads 8 interleaved positions and deinterleaves them. Each 128-bit half deinterleaves 4 positions the same way the SSE2 path does.
+    inline void LoadPositions(const Vector3* positions, FloatLanes& outX, FloatLanes& outY, FloatLanes& outZ)
+    {
+        const float* p = &positions[0].x;
+        const __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 12), 1); // x0 y0 z0 x1
+        const __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1); // y1 z1 x2 y2
+        const __m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1); // z2 x3 y3 z3
+
+        outX = _mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        outY = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        outZ = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm256_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    }
+}
+
+#define VERTEX_TRANSFORM_SIMD_LANES
+#include "VertexTransformKernels.h"
+
+ENGINE_AVX2_END
+
+ENGINE_AVX2_TARGET void VertexTransform::Avx2::TransformVertices(const Vector3* positions, uint32_t firstVertex, uint32_t endVertex,
+    const Matrix4x4& viewProjection, const Viewport& viewport, TransformedVertices& outVertices)
+{
+    TransformVertexRange(positions, firstVertex, endVertex, viewProjection, viewport, outVertices);
+}
+
+#endif
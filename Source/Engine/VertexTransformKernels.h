@@ -0,0 +1,136 @@
+/*
+    Vertex transform kernels shared by VertexTransform.cpp & VertexTransformAvx2.cpp, each file compiling them for its own instruction set.
+    SIMD kernels are written once over thin wrappers of the intrinsics: files define the wrappers, along with VERTEX_TRANSFORM_SIMD_LANES,
+    before including this one. Everything has internal linkage, so each file keeps its own copy whatever it got compiled for.
+*/
+
+#ifndef VERTEX_TRANSFORM_KERNELS_H
+#define VERTEX_TRANSFORM_KERNELS_H
+
+#include "VertexTransform.h"
+
+#include <algorithm>
+
+namespace
+{
+    inline uint16_t ComputeClipCode(const Vector4& p, float guardBandScale)
+    {
+        using namespace VertexTransform;
+        const float guardW = p.w * guardBandScale;
+        return static_cast<uint16_t>(
+              (p.z < 0.0f ? CLIP_NEAR : 0) | (p.z > p.w ? CLIP_FAR : 0)
+            | (p.x < -p.w ? CLIP_LEFT : 0) | (p.x > p.w ? CLIP_RIGHT : 0)
+            | (p.y < -p.w ? CLIP_BOTTOM : 0) | (p.y > p.w ? CLIP_TOP : 0)
+            | (p.x < -guardW ? CLIP_GUARD_LEFT : 0) | (p.x > guardW ? CLIP_GUARD_RIGHT : 0)
+            | (p.y < -guardW ? CLIP_GUARD_BOTTOM : 0) | (p.y > guardW ? CLIP_GUARD_TOP : 0));
+    }
+
+    /// Transforms a single vertex. Used as the scalar path and for vertices left over by SIMD blocks.
+    inline void TransformVertexScalar(const Vector3& position, uint32_t vertex, const Matrix4x4& viewProjection,
+        const VertexTransform::Viewport& viewport, VertexTransform::TransformedVertices& outVertices)
+    {
+        const Vector4 clipPosition = viewProjection.TransformPoint(position);
+        const uint16_t clipCode = ComputeClipCode(clipPosition, viewport.GuardBandScale);
+        outVertices.ClipX[vertex] = clipPosition.x;
+        outVertices.ClipY[vertex] = clipPosition.y;
+        outVertices.ClipZ[vertex] = clipPosition.z;
+        outVertices.ClipW[vertex] = clipPosition.w;
+        outVertices.ClipCodes[vertex] = clipCode;
+        if ((clipCode & VertexTransform::CLIP_REQUIRED_MASK) == 0)
+        {
+            const RasterVertex screenVertex = VertexTransform::ProjectToScreen(clipPosition, viewport);
+            outVertices.ScreenX[vertex] = screenVertex.X;
+            outVertices.ScreenY[vertex] = screenVertex.Y;
+            outVertices.ScreenZ[vertex] = screenVertex.Z;
+        }
+    }
+
+#if defined(VERTEX_TRANSFORM_SIMD_LANES)
+    /// Transforms LANE_COUNT vertices starting at the passed one, a multiple of LANE_COUNT so stores are aligned. Unlike the scalar path,
+    /// screen positions get written for every vertex, those of vertices requiring clipping being meaningless. Every operation matches the
+    /// scalar path's, in the same order, so both paths give the same results.
+    /// @param blockPositions Positions of the block's vertices.
+    inline void TransformVertexBlock(const Vector3* blockPositions, uint32_t firstVertex, const Matrix4x4& viewProjection,
+        const VertexTransform::Viewport& viewport, VertexTransform::TransformedVertices& outVertices)
+    {
+        using namespace VertexTransform;
+
+        FloatLanes x, y, z;
+        LoadPositions(blockPositions, x, y, z);
+
+        FloatLanes clip[4];
+        for (int row = 0; row < 4; row++)
+        {
+            const float (&m)[4] = viewProjection.m[row];
+            clip[row] = Add(Add(Add(Mul(Splat(m[0]), x), Mul(Splat(m[1]), y)), Mul(Splat(m[2]), z)), Splat(m[3]));
+        }
+        Store(&outVertices.ClipX[firstVertex], clip[0]);
+        Store(&outVertices.ClipY[firstVertex], clip[1]);
+        Store(&outVertices.ClipZ[firstVertex], clip[2]);
+        Store(&outVertices.ClipW[firstVertex], clip[3]);
+
+        const FloatLanes zero = Splat(0.0f);
+        const FloatLanes w = clip[3];
+        const FloatLanes negativeW = Sub(zero, w);
+        const FloatLanes guardW = Mul(w, Splat(viewport.GuardBandScale));
+        const FloatLanes negativeGuardW = Sub(zero, guardW);
+        IntLanes codes = BitIfLess(clip[2], zero, SplatInt(CLIP_NEAR));
+        codes = Or(codes, BitIfLess(w, clip[2], SplatInt(CLIP_FAR)));
+        codes = Or(codes, BitIfLess(clip[0], negativeW, SplatInt(CLIP_LEFT)));
+        codes = Or(codes, BitIfLess(w, clip[0], SplatInt(CLIP_RIGHT)));
+        codes = Or(codes, BitIfLess(clip[1], negativeW, SplatInt(CLIP_BOTTOM)));
+        codes = Or(codes, BitIfLess(w, clip[1], SplatInt(CLIP_TOP)));
+        codes = Or(codes, BitIfLess(clip[0], negativeGuardW, SplatInt(CLIP_GUARD_LEFT)));
+        codes = Or(codes, BitIfLess(guardW, clip[0], SplatInt(CLIP_GUARD_RIGHT)));
+        codes = Or(codes, BitIfLess(clip[1], negativeGuardW, SplatInt(CLIP_GUARD_BOTTOM)));
+        codes = Or(codes, BitIfLess(guardW, clip[1], SplatInt(CLIP_GUARD_TOP)));
+        StoreClipCodes(&outVertices.ClipCodes[firstVertex], codes);
+
+        const FloatLanes half = Splat(0.5f);
+        const FloatLanes subPixelScale = Splat(static_cast<float>(Rasterizer::SUBPIXEL_SCALE));
+        const FloatLanes inverseW = Div(Splat(1.0f), w);
+        const FloatLanes screenX = Mul(Add(Mul(Mul(clip[0], inverseW), half), half), Splat(viewport.Width));
+        const FloatLanes screenY = Mul(Sub(half, Mul(Mul(clip[1], inverseW), half)), Splat(viewport.Height));
+        StoreInt(&outVertices.ScreenX[firstVertex], RoundToInt(Mul(screenX, subPixelScale)));
+        StoreInt(&outVertices.ScreenY[firstVertex], RoundToInt(Mul(screenY, subPixelScale)));
+        Store(&outVertices.ScreenZ[firstVertex], Mul(clip[2], inverseW));
+    }
+#endif
+
+    /// Transforms a range of vertices, LANE_COUNT at a time when SIMD lanes are available. Vertices before the first aligned block, and
+    /// those after the last one unless the range ends the mesh, get transformed one at a time.
+    inline void TransformVertexRange(const Vector3* positions, uint32_t firstVertex, uint32_t endVertex, const Matrix4x4& viewProjection,
+        const VertexTransform::Viewport& viewport, VertexTransform::TransformedVertices& outVertices)
+    {
+        uint32_t vertex = firstVertex;
+#if defined(VERTEX_TRANSFORM_SIMD_LANES)
+        for (; vertex < endVertex && vertex % LANE_COUNT != 0; vertex++)
+        {
+            TransformVertexScalar(positions[vertex], vertex, viewProjection, viewport, outVertices);
+        }
+        for (; vertex + LANE_COUNT <= endVertex; vertex += LANE_COUNT)
+        {
+            TransformVertexBlock(positions + vertex, vertex, viewProjection, viewport, outVertices);
+        }
+
+        // Past the last vertex of the mesh, the block only covers stream padding no other range writes to. Positions can't be read past
+        // the end of the mesh though, so the block reads a copy repeating the last one.
+        if (vertex < endVertex && endVertex == outVertices.VertexCount)
+        {
+            Vector3 blockPositions[LANE_COUNT];
+            for (uint32_t lane = 0; lane < LANE_COUNT; lane++)
+            {
+                blockPositions[lane] = positions[std::min(vertex + lane, endVertex - 1)];
+            }
+            TransformVertexBlock(blockPositions, vertex, viewProjection, viewport, outVertices);
+            vertex = endVertex;
+        }
+#endif
+        for (; vertex < endVertex; vertex++)
+        {
+            TransformVertexScalar(positions[vertex], vertex, viewProjection, viewport, outVertices);
+        }
+    }
+}
+
+#endif // VERTEX_TRANSFORM_KERNELS_H
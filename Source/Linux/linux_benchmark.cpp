@@ -0,0 +1,617 @@
+/*
+    Linux Headless Platform benchmark suite: micro-benchmarks of the Engine's hot paths, and JSON results files runs get compared against
+    so performance regressions fail the run instead of going unnoticed.
+*/
+
+#include "linux_platform.h"
+#include "Engine/Camera.h"
+#include "Engine/CpuFeatures.h"
+#include "Engine/Json.h"
+#include "Engine/JobSystem.h"
+#include "Engine/Mesh.h"
+#include "Engine/MeshBvh.h"
+#include "Engine/MeshLod.h"
+#include "Engine/MeshRenderer.h"
+#include "Engine/ModelLoader.h"
+#include "Engine/Rasterizer.h"
+#include "Engine/Texture.h"
+#include "Engine/VertexTransform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace
+{
+    // Frame arena of the micro-benchmarks. Only touched pages get backed by memory.
+    const size_t BENCHMARK_FRAME_ARENA_SIZE = size_t(256) << 20;
+
+    // Untimed & timed runs of each micro-benchmark. Loads take much longer than frames, so they get fewer runs, except cache loads which
+    // take about a millisecond and get more runs to steady their median.
+    const uint32_t FRAME_WARMUP_RUN_COUNT = 3;
+    const uint32_t FRAME_TIMED_RUN_COUNT = 15;
+    const uint32_t LOAD_WARMUP_RUN_COUNT = 1;
+    const uint32_t LOAD_TIMED_RUN_COUNT = 5;
+    const uint32_t CACHE_LOAD_WARMUP_RUN_COUNT = 3;
+    const uint32_t CACHE_LOAD_TIMED_RUN_COUNT = 31;
+
+    // Rings & segments of the generated spheres rasterized, from 1K to 1M triangles, and of the sphere written to model files.
+    const uint32_t RASTER_SPHERE_SIZES[][2] = { { 16, 32 }, { 64, 128 }, { 256, 512 }, { 512, 1024 } };
+    const uint32_t LOAD_SPHERE_SIZE[2] = { 256, 512 };
+
+    // Width & height of the generated texture sampled, large enough for its level 0 not to fit in cache.
+    const uint32_t TEXTURE_SIZE = 2048;
+
+    /// Runs a benchmark body a few times untimed so caches & buffers settle, then returns the median duration of its timed runs in
+    /// milliseconds. The median keeps a single preempted run from skewing results.
+    template<typename Functor>
+    double MeasureMedianMs(uint32_t warmupRunCount, uint32_t timedRunCount, const Functor& body)
+    {
+        for (uint32_t runIndex = 0; runIndex < warmupRunCount; runIndex++)
+        {
+            body();
+        }
+
+        std::vector<double> runTimesMs(timedRunCount);
+        for (double& runTimeMs : runTimesMs)
+        {
+            const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            body();
+            runTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        std::nth_element(runTimesMs.begin(), runTimesMs.begin() + timedRunCount / 2, runTimesMs.end());
+        return runTimesMs[timedRunCount / 2];
+    }
+
+    /// Debugger handed to the Engine code under benchmark, which only lets warnings & errors through to the platform debugger so repeated
+    /// loads don't flood the log.
+    class BenchmarkDebugger : public PlatformDebugger
+    {
+    public:
+
+        BenchmarkDebugger(PlatformDebugger& platformDebugger) : m_platformDebugger(platformDebugger)
+        {}
+
+        using PlatformDebugger::DisplayDebugMessage;
+        virtual void DisplayDebugMessage(DebugLogMessage&& message) override
+        {
+            if (message.LogCategory >= DebugLogMessage::Category::WARNING)
+            {
+                m_platformDebugger.DisplayDebugMessage(std::move(message));
+            }
+        }
+
+        virtual void DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments) override
+        {
+            if (category >= DebugLogMessage::Category::WARNING)
+            {
+                m_platformDebugger.DisplayFormattedDebugMessage(category, format, arguments);
+            }
+        }
+
+    private:
+
+        PlatformDebugger& m_platformDebugger;
+    };
+
+    bool WriteFile(const std::string& filePath, const std::string& data)
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        return static_cast<bool>(file.write(data.data(), data.size()));
+    }
+
+    template<typename T>
+    void AppendBytes(std::string& outData, const T& value)
+    {
+        outData.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /// Writes a mesh's positions & triangles as a Wavefront OBJ file.
+    bool WriteObjFile(const Mesh& mesh, const std::string& filePath)
+    {
+        std::string data;
+        char line[128];
+        for (size_t vertexIndex = 0; vertexIndex < mesh.GetVertexCount(); vertexIndex++)
+        {
+            const Vector3& position = mesh.Positions.GetData()[vertexIndex];
+            data.append(line, snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", position.x, position.y, position.z));
+        }
+
+        // OBJ indices start at 1.
+        const uint32_t* indices = mesh.Indices.GetData();
+        for (size_t triangleIndex = 0; triangleIndex < mesh.GetTriangleCount(); triangleIndex++)
+        {
+            data.append(line, snprintf(line, sizeof(line), "f %u %u %u\n", indices[triangleIndex * 3] + 1, indices[triangleIndex * 3 + 1] + 1,
+                indices[triangleIndex * 3 + 2] + 1));
+        }
+        return WriteFile(filePath, data);
+    }
+
+    /// Writes a mesh's triangles as a binary STL file, with null facet normals as readers recompute them anyway.
+    bool WriteStlFile(const Mesh& mesh, const std::string& filePath)
+    {
+        std::string data(80, '\0');
+        AppendBytes(data, static_cast<uint32_t>(mesh.GetTriangleCount()));
+
+        const Vector3 nullNormal = { 0.0f, 0.0f, 0.0f };
+        const uint32_t* indices = mesh.Indices.GetData();
+        for (size_t triangleIndex = 0; triangleIndex < mesh.GetTriangleCount(); triangleIndex++)
+        {
+            AppendBytes(data, nullNormal);
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                AppendBytes(data, mesh.Positions.GetData()[indices[triangleIndex * 3 + corner]]);
+            }
+            AppendBytes(data, static_cast<uint16_t>(0));
+        }
+        return WriteFile(filePath, data);
+    }
+
+    /// Writes a mesh's positions & indices as a binary glTF file holding a single primitive.
+    bool WriteGlbFile(const Mesh& mesh, const std::string& filePath)
+    {
+        const size_t positionsSize = mesh.Positions.GetSizeInBytes();
+        const size_t indicesSize = mesh.Indices.GetSizeInBytes();
+
+        char jsonBuffer[1024];
+        std::string json(jsonBuffer, snprintf(jsonBuffer, sizeof(jsonBuffer),
+            "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":%zu}],"
+            "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\",\"min\":[%g,%g,%g],\"max\":[%g,%g,%g]},"
+            "{\"bufferView\":1,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}],"
+            "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}]}",
+            positionsSize + indicesSize, positionsSize, positionsSize, indicesSize, mesh.GetVertexCount(),
+            mesh.Bounds.Min.x, mesh.Bounds.Min.y, mesh.Bounds.Min.z, mesh.Bounds.Max.x, mesh.Bounds.Max.y, mesh.Bounds.Max.z, mesh.Indices.GetCount()));
+        // Chunks must be 4 byte aligned, JSON being padded with spaces. Binary data already is, being made of 4 byte elements.
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+        std::string data;
+        AppendBytes(data, static_cast<uint32_t>(0x46546C67)); // "glTF"
+        AppendBytes(data, static_cast<uint32_t>(2));
+        AppendBytes(data, static_cast<uint32_t>(12 + 8 + json.size() + 8 + positionsSize + indicesSize));
+        AppendBytes(data, static_cast<uint32_t>(json.size()));
+        AppendBytes(data, static_cast<uint32_t>(0x4E4F534A)); // "JSON"
+        data += json;
+        AppendBytes(data, static_cast<uint32_t>(positionsSize + indicesSize));
+        AppendBytes(data, static_cast<uint32_t>(0x004E4942)); // "BIN\0"
+        data.append(reinterpret_cast<const char*>(mesh.Positions.GetData()), positionsSize);
+        data.append(reinterpret_cast<const char*>(mesh.Indices.GetData()), indicesSize);
+        return WriteFile(filePath, data);
+    }
+
+    /// Sums every 32-bit word of a buffer. Reads all of its memory, which pages mapped buffers in.
+    template<typename T>
+    uint32_t ChecksumBuffer(const MeshBuffer<T>& buffer)
+    {
+        static_assert(sizeof(T) % sizeof(uint32_t) == 0, "Buffer elements must be made of 32-bit words.");
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer.GetData());
+        uint32_t checksum = 0;
+        for (size_t offset = 0; offset < buffer.GetSizeInBytes(); offset += sizeof(uint32_t))
+        {
+            uint32_t word;
+            memcpy(&word, bytes + offset, sizeof(word));
+            checksum += word;
+        }
+        return checksum;
+    }
+
+    /// Checksums every buffer of a loaded model, as rendering it would read them.
+    uint32_t ChecksumModel(const Mesh& mesh, const MeshBvh& bvh, const MeshLods& lods)
+    {
+        return ChecksumBuffer(mesh.Positions) + ChecksumBuffer(mesh.Normals) + ChecksumBuffer(mesh.TexCoords) + ChecksumBuffer(mesh.Indices)
+            + ChecksumBuffer(bvh.Nodes) + ChecksumBuffer(bvh.Chunks) + ChecksumBuffer(bvh.ChunkOrder) + ChecksumBuffer(bvh.Clusters)
+            + ChecksumBuffer(lods.Indices) + ChecksumBuffer(lods.Levels);
+    }
+
+    /// Deletes a directory along with every file in it.
+    void RemoveDirectory(const std::string& directoryPath)
+    {
+        DIR* directory = opendir(directoryPath.c_str());
+        if (directory != nullptr)
+        {
+            while (const dirent* entry = readdir(directory))
+            {
+                if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+                {
+                    unlink((directoryPath + "/" + entry->d_name).c_str());
+                }
+            }
+            closedir(directory);
+        }
+        rmdir(directoryPath.c_str());
+    }
+
+    /// Appends a string to JSON output as a string literal.
+    void AppendJsonString(const std::string& str, std::string& outJson)
+    {
+        outJson += '"';
+        for (char character : str)
+        {
+            if (character == '"' || character == '\\')
+            {
+                outJson += '\\';
+            }
+            outJson += static_cast<unsigned char>(character) < 0x20 ? ' ' : character;
+        }
+        outJson += '"';
+    }
+}
+
+// LINUX BENCHMARK RESULTS
+
+void LinuxBenchmarkResults::Linux_AddMetric(const std::string& name, double value, const std::string& unit, bool bHigherIsBetter)
+{
+    m_metrics.push_back(Metric{ name, value, unit, bHigherIsBetter });
+}
+
+bool LinuxBenchmarkResults::Linux_WriteJson(const std::string& filePath, const LinuxPlatform::RunParameters& params) const
+{
+    char number[128];
+    std::string json = "{\n\"parameters\":{\"width\":";
+    snprintf(number, sizeof(number), "%u,\"height\":%u,\"frames\":%u,\"warmup\":%u,\"workers\":%d,\"model\":", params.DisplayWidth,
+        params.DisplayHeight, params.FrameCount, params.WarmupFrameCount, params.WorkerThreadCount);
+    json += number;
+    AppendJsonString(params.ModelFilePath, json);
+    json += "},\n\"metrics\":[";
+
+    for (size_t metricIndex = 0; metricIndex < m_metrics.size(); metricIndex++)
+    {
+        const Metric& metric = m_metrics[metricIndex];
+        json += metricIndex == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+        AppendJsonString(metric.Name, json);
+        snprintf(number, sizeof(number), ",\"value\":%.9g,\"unit\":", metric.Value);
+        json += number;
+        AppendJsonString(metric.Unit, json);
+        json += metric.bHigherIsBetter ? ",\"higher_is_better\":true}" : ",\"higher_is_better\":false}";
+    }
+    json += "\n]}\n";
+
+    return WriteFile(filePath, json);
+}
+
+bool LinuxBenchmarkResults::Linux_CompareToBaseline(const std::string& filePath, double maxRegressionPercent, PlatformDebugger& debugger) const
+{
+    std::ifstream file(filePath, std::ios::binary);
+    std::stringstream fileContents;
+    fileContents << file.rdbuf();
+    const std::string baselineText = fileContents.str();
+
+    JsonValue baseline;
+    std::string parseError;
+    if (!file || !JsonValue::Parse(baselineText.data(), baselineText.size(), baseline, parseError))
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot read benchmark baseline '%s': %s", filePath,
+            file ? parseError : std::string("file could not be opened."));
+        return false;
+    }
+
+    const JsonValue* baselineMetrics = baseline.FindMember("metrics");
+    if (baselineMetrics == nullptr || !baselineMetrics->IsArray())
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Cannot read benchmark baseline '%s': it has no metrics.", filePath);
+        return false;
+    }
+
+    debugger.Log<DebugLogMessage::Category::LOG>("Comparing against benchmark baseline '%s' (%.1f%% regression allowed):", filePath, maxRegressionPercent);
+    uint32_t regressedMetricCount = 0;
+    for (const Metric& metric : m_metrics)
+    {
+        const JsonValue* baselineMetric = nullptr;
+        for (const JsonValue& element : baselineMetrics->GetElements())
+        {
+            const JsonValue* name = element.FindMember("name");
+            if (name != nullptr && name->GetString() == metric.Name)
+            {
+                baselineMetric = &element;
+                break;
+            }
+        }
+
+        const JsonValue* baselineValue = baselineMetric != nullptr ? baselineMetric->FindMember("value") : nullptr;
+        if (baselineValue == nullptr || !baselineValue->IsNumber())
+        {
+            debugger.Log<DebugLogMessage::Category::WARNING>("  %-36s %12.3f %-12s not in baseline", metric.Name, metric.Value, metric.Unit);
+            continue;
+        }
+
+        // Metrics measured differently than when the baseline was written can't be compared, whatever they are named.
+        const JsonValue* baselineUnit = baselineMetric->FindMember("unit");
+        const JsonValue* baselineHigherIsBetter = baselineMetric->FindMember("higher_is_better");
+        const std::string baselineUnitName = baselineUnit != nullptr ? baselineUnit->GetString() : metric.Unit;
+        const bool bBaselineHigherIsBetter = baselineHigherIsBetter != nullptr ? baselineHigherIsBetter->GetBoolean(metric.bHigherIsBetter) : metric.bHigherIsBetter;
+        if (baselineUnitName != metric.Unit || bBaselineHigherIsBetter != metric.bHigherIsBetter)
+        {
+            debugger.Log<DebugLogMessage::Category::WARNING>("  %-36s %12.3f %-12s not comparable: baseline in %s, %s is better", metric.Name, metric.Value,
+                metric.Unit, baselineUnitName, bBaselineHigherIsBetter ? "higher" : "lower");
+            continue;
+        }
+
+        // Change in the direction that makes the metric worse, relative to the baseline. Baselines of zero (such as heap allocations)
+        // allow no regression at all.
+        const double baselineNumber = baselineValue->GetNumber();
+        const double worsening = metric.bHigherIsBetter ? baselineNumber - metric.Value : metric.Value - baselineNumber;
+        const double changePercent = baselineNumber != 0.0 ? 100.0 * (metric.Value - baselineNumber) / std::fabs(baselineNumber) : 0.0;
+        const bool bRegressed = baselineNumber != 0.0 ? 100.0 * worsening / std::fabs(baselineNumber) > maxRegressionPercent : worsening > 0.0;
+
+        if (bRegressed)
+        {
+            regressedMetricCount++;
+            debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("  %-36s %12.3f %-12s baseline %12.3f (%+.1f%%) REGRESSED", metric.Name,
+                metric.Value, metric.Unit, baselineNumber, changePercent);
+        }
+        else
+        {
+            debugger.Log<DebugLogMessage::Category::LOG>("  %-36s %12.3f %-12s baseline %12.3f (%+.1f%%)", metric.Name, metric.Value, metric.Unit,
+                baselineNumber, changePercent);
+        }
+    }
+
+    for (const JsonValue& element : baselineMetrics->GetElements())
+    {
+        const JsonValue* name = element.FindMember("name");
+        const std::string baselineName = name != nullptr ? name->GetString() : std::string();
+        if (std::none_of(m_metrics.begin(), m_metrics.end(), [&](const Metric& metric) { return metric.Name == baselineName; }))
+        {
+            debugger.Log<DebugLogMessage::Category::WARNING>("  %-36s not measured by this run", baselineName);
+        }
+    }
+
+    if (regressedMetricCount > 0)
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("%u metrics regressed by more than %.1f%%.", regressedMetricCount, maxRegressionPercent);
+        return false;
+    }
+    debugger.Log<DebugLogMessage::Category::SUCCESS>("No metric regressed by more than %.1f%%.", maxRegressionPercent);
+    return true;
+}
+
+// LINUX MICRO-BENCHMARKS
+
+void Linux_RunMicroBenchmarks(LinuxPlatform& platform, LinuxBenchmarkResults& outResults)
+{
+    const LinuxPlatform::RunParameters& params = platform.Linux_GetRunParameters();
+    PlatformDebugger& debugger = *platform.Linux_GetDebugger();
+    BenchmarkDebugger benchmarkDebugger(debugger);
+
+    // Same amount of worker threads as the Engine will use.
+    uint32_t workerThreadCount = static_cast<uint32_t>(params.WorkerThreadCount);
+    if (params.WorkerThreadCount < 0)
+    {
+        const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+        workerThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+    }
+    JobSystem jobSystem;
+    jobSystem.Initialize(workerThreadCount);
+    // Same SIMD paths as the Engine will take.
+    const SimdPaths simdPaths = CpuFeatures::DetectSimdPaths();
+
+    void* frameArenaMemory = mmap(nullptr, BENCHMARK_FRAME_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (frameArenaMemory == MAP_FAILED)
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to reserve micro-benchmark memory, skipping them.");
+        return;
+    }
+
+    debugger.Log<DebugLogMessage::Category::LOG>("Running micro-benchmarks at %ux%u with %u worker threads, texture sampling SIMD path: %s...",
+        params.DisplayWidth, params.DisplayHeight, jobSystem.GetWorkerThreadCount(), Texture::GetSimdPathName(simdPaths));
+    platform.Linux_DebuggerUpdate();
+
+    auto addMetric = [&](const std::string& name, double value, const char* unit, bool bHigherIsBetter)
+    {
+        outResults.Linux_AddMetric(name, value, unit, bHigherIsBetter);
+        debugger.Log<DebugLogMessage::Category::LOG>("  %-36s %12.3f %s", name, value, unit);
+        platform.Linux_DebuggerUpdate();
+    };
+
+    {
+        MemoryArena frameArena(frameArenaMemory, BENCHMARK_FRAME_ARENA_SIZE);
+        std::vector<Pixel_RGBA> colorBuffer(static_cast<size_t>(params.DisplayWidth) * params.DisplayHeight);
+        const MeshBvh emptyBvh;
+        const MeshLods emptyLods;
+        MeshRenderer meshRenderer;
+        meshRenderer.SetSimdPaths(simdPaths);
+
+        // FRAME CLEAR: rendering nothing still clears every tile of the color & depth buffers.
+        {
+            const Mesh emptyMesh;
+            const Camera camera;
+            const double clearMs = MeasureMedianMs(FRAME_WARMUP_RUN_COUNT, FRAME_TIMED_RUN_COUNT, [&]()
+            {
+                meshRenderer.Render(emptyMesh, emptyBvh, emptyLods, camera, colorBuffer.data(), params.DisplayWidth, params.DisplayHeight, frameArena,
+                    jobSystem);
+                frameArena.Reset();
+            });
+            addMetric("clear", colorBuffer.size() / (clearMs * 1e3), "Mpixels/s", true);
+        }
+
+        // RASTERIZATION: whole spheres filling the display, rendered without hierarchy so every triangle goes through the pipeline.
+        for (const uint32_t* sphereSize : RASTER_SPHERE_SIZES)
+        {
+            const Mesh sphere = Mesh::CreateUVSphere(sphereSize[0], sphereSize[1]);
+            Camera camera;
+            camera.FrameBounds(sphere.Bounds);
+            const double renderMs = MeasureMedianMs(FRAME_WARMUP_RUN_COUNT, FRAME_TIMED_RUN_COUNT, [&]()
+            {
+                meshRenderer.Render(sphere, emptyBvh, emptyLods, camera, colorBuffer.data(), params.DisplayWidth, params.DisplayHeight, frameArena,
+                    jobSystem);
+                frameArena.Reset();
+            });
+            addMetric("raster.sphere_" + std::to_string(sphere.GetTriangleCount()) + "_triangles", renderMs, "ms", false);
+        }
+    }
+
+    // VERTEX TRANSFORM: the largest sphere's vertices on a single thread, isolating the SIMD path from job scheduling.
+    {
+        const uint32_t* sphereSize = RASTER_SPHERE_SIZES[sizeof(RASTER_SPHERE_SIZES) / sizeof(RASTER_SPHERE_SIZES[0]) - 1];
+        const Mesh sphere = Mesh::CreateUVSphere(sphereSize[0], sphereSize[1]);
+        Camera camera;
+        camera.FrameBounds(sphere.Bounds);
+
+        VertexTransform::Viewport viewport;
+        viewport.Width = params.DisplayWidth;
+        viewport.Height = params.DisplayHeight;
+        viewport.GuardBandScale = 2.0f * Rasterizer::GUARD_BAND_PIXELS / std::max(params.DisplayWidth, params.DisplayHeight) - 1.0f;
+        const Matrix4x4 viewProjection = camera.GetProjectionMatrix(viewport.Width / viewport.Height) * camera.GetViewMatrix();
+
+        VertexTransform::TransformedVertices transformedVertices;
+        transformedVertices.Resize(sphere.GetVertexCount());
+        const double transformMs = MeasureMedianMs(FRAME_WARMUP_RUN_COUNT, FRAME_TIMED_RUN_COUNT, [&]()
+        {
+            VertexTransform::TransformVertices(sphere.Positions.GetData(), 0, static_cast<uint32_t>(sphere.GetVertexCount()), viewProjection, viewport,
+                transformedVertices, simdPaths);
+        });
+        addMetric("vertex_transform", sphere.GetVertexCount() / (transformMs * 1e3), "Mvertices/s", true);
+    }
+
+    // TEXTURE SAMPLING: a generated texture stored & mipmapped, then sampled over the whole display on a single thread, walked one texel per
+    // pixel at several angles and minified. Tiled storage should keep throughput about the same whichever way the texture gets walked.
+    // Throughput counts the 4 texels each bilinear sample fetches.
+    {
+        std::vector<Pixel_RGBA> texels(static_cast<size_t>(TEXTURE_SIZE) * TEXTURE_SIZE);
+        for (uint32_t y = 0; y < TEXTURE_SIZE; y++)
+        {
+            for (uint32_t x = 0; x < TEXTURE_SIZE; x++)
+            {
+                texels[static_cast<size_t>(y) * TEXTURE_SIZE + x].pixel = (x * 0x9E3779B1u) ^ (y * 0x85EBCA77u);
+            }
+        }
+
+        Texture texture;
+        const double createMs = MeasureMedianMs(LOAD_WARMUP_RUN_COUNT, LOAD_TIMED_RUN_COUNT, [&]()
+        {
+            texture.Create(texels.data(), TEXTURE_SIZE, TEXTURE_SIZE, jobSystem);
+        });
+        addMetric("texture.create", texels.size() / (createMs * 1e3), "Mtexels/s", true);
+
+        struct TextureWalk
+        {
+            const char* MetricName;
+            float AngleRadians;
+            float TexelsPerPixel;
+        };
+        const TextureWalk textureWalks[] =
+        {
+            { "texture.sample_0_degrees", 0.0f, 1.0f },
+            { "texture.sample_45_degrees", 0.785398f, 1.0f },
+            { "texture.sample_90_degrees", 1.570796f, 1.0f },
+            { "texture.sample_minified", 0.523599f, 3.0f }
+        };
+
+        // UVs of every pixel quad of the display, quads row-major like a rasterizer walks them.
+        const uint32_t quadColumnCount = params.DisplayWidth / 2;
+        const uint32_t quadCount = quadColumnCount * (params.DisplayHeight / 2);
+        std::vector<float> u(static_cast<size_t>(quadCount) * 4);
+        std::vector<float> v(static_cast<size_t>(quadCount) * 4);
+        std::vector<Pixel_RGBA> sampledPixels(static_cast<size_t>(quadCount) * 4);
+        for (const TextureWalk& walk : textureWalks)
+        {
+            const float scale = walk.TexelsPerPixel / TEXTURE_SIZE;
+            const float cosine = std::cos(walk.AngleRadians) * scale;
+            const float sine = std::sin(walk.AngleRadians) * scale;
+            for (uint32_t quad = 0; quad < quadCount; quad++)
+            {
+                for (uint32_t corner = 0; corner < 4; corner++)
+                {
+                    const float pixelX = static_cast<float>(2 * (quad % quadColumnCount) + (corner & 1));
+                    const float pixelY = static_cast<float>(2 * (quad / quadColumnCount) + (corner >> 1));
+                    u[quad * 4 + corner] = cosine * pixelX - sine * pixelY;
+                    v[quad * 4 + corner] = sine * pixelX + cosine * pixelY;
+                }
+            }
+
+            const double sampleMs = MeasureMedianMs(FRAME_WARMUP_RUN_COUNT, FRAME_TIMED_RUN_COUNT, [&]()
+            {
+                texture.SampleQuads(u.data(), v.data(), quadCount, sampledPixels.data(), simdPaths);
+            });
+            addMetric(walk.MetricName, quadCount * 4.0 * 4.0 / (sampleMs * 1e3), "Mtexels/s", true);
+        }
+    }
+
+    // MODEL LOADING: the same sphere written in every supported format, loaded without optimization nor levels of detail so the metrics
+    // follow format loaders. Every load includes reading all of the loaded model's buffers, as rendering would. The cache metric then loads
+    // the cache written from the OBJ file: it only maps the cache, so reading its buffers is most of the work, and it gets reported as a
+    // time rather than as a throughput of a file it doesn't read.
+    char temporaryDirectoryPath[] = "/tmp/model_viewer_benchmark_XXXXXX";
+    if (mkdtemp(temporaryDirectoryPath) == nullptr)
+    {
+        debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to create a temporary directory, skipping model loading micro-benchmarks.");
+    }
+    else
+    {
+        const std::string directoryPath = temporaryDirectoryPath;
+        const Mesh sphere = Mesh::CreateUVSphere(LOAD_SPHERE_SIZE[0], LOAD_SPHERE_SIZE[1]);
+
+        struct ModelFormat
+        {
+            const char* MetricName;
+            const char* FileName;
+            bool (*WriteModelFile)(const Mesh&, const std::string&);
+            bool bUseCache;
+        };
+        const ModelFormat modelFormats[] =
+        {
+            { "load.obj_read", "sphere.obj", WriteObjFile, false },
+            { "load.stl_read", "sphere.stl", WriteStlFile, false },
+            { "load.glb_read", "sphere.glb", WriteGlbFile, false },
+            { "load.cache_read_ms", "sphere.obj", nullptr, true }
+        };
+
+        for (const ModelFormat& format : modelFormats)
+        {
+            const std::string filePath = directoryPath + "/" + format.FileName;
+            PlatformFileSystem::FileInfo fileInfo;
+            if ((format.WriteModelFile != nullptr && !format.WriteModelFile(sphere, filePath)) || !platform.Linux_GetFileSystem()->GetFileInfo(filePath, fileInfo))
+            {
+                debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to write '%s', skipping its micro-benchmark.", filePath);
+                continue;
+            }
+
+            ModelLoader::LoadSettings loadSettings;
+            loadSettings.bOptimizeMesh = false;
+            loadSettings.bGenerateLods = false;
+            loadSettings.bUseCache = format.bUseCache;
+            loadSettings.CacheDirectoryPath = directoryPath;
+
+            bool bLoaded = true;
+            // Keeps checksums from getting optimized away.
+            volatile uint32_t checksum = 0;
+            const double loadMs = MeasureMedianMs(format.bUseCache ? CACHE_LOAD_WARMUP_RUN_COUNT : LOAD_WARMUP_RUN_COUNT,
+                format.bUseCache ? CACHE_LOAD_TIMED_RUN_COUNT : LOAD_TIMED_RUN_COUNT, [&]()
+            {
+                Mesh mesh;
+                MeshBvh bvh;
+                MeshLods lods;
+                bLoaded &= ModelLoader::LoadModel(filePath, loadSettings, *platform.Linux_GetFileSystem(), benchmarkDebugger, jobSystem, mesh, bvh, lods);
+                checksum = ChecksumModel(mesh, bvh, lods);
+            });
+
+            if (bLoaded && format.bUseCache)
+            {
+                addMetric(format.MetricName, loadMs, "ms", false);
+            }
+            else if (bLoaded)
+            {
+                addMetric(format.MetricName, fileInfo.Size / (loadMs * 1e3), "MB/s", true);
+            }
+            else
+            {
+                debugger.Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to load '%s', skipping its micro-benchmark.", filePath);
+                platform.Linux_DebuggerUpdate();
+            }
+        }
+
+        RemoveDirectory(directoryPath);
+    }
+
+    munmap(frameArenaMemory, BENCHMARK_FRAME_ARENA_SIZE);
+}
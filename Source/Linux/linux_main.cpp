@@ -0,0 +1,958 @@
+/*
+    Main Linux Headless Platform Entry Point & Implementation file.
+    See the README for build instructions and command line arguments.
+*/
+
+#include "linux_platform.h"
+#include "Engine/Engine.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <cerrno>
+#include <cmath>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// Static Memory pointers to Platform & Engine.
+
+std::shared_ptr<LinuxPlatform> Linux_Platform;
+std::shared_ptr<Engine> Linux_Engine;
+
+// LINUX PLATFORM IMPLEMENTATION
+
+namespace
+{
+    /// Parses a whole argument value as an integer within [minValue, maxValue], reporting values that aren't.
+    bool ParseIntegerArgument(const char* arg, const char* value, long long minValue, long long maxValue, long long& outValue)
+    {
+        char* valueEnd = nullptr;
+        errno = 0;
+        outValue = strtoll(value, &valueEnd, 10);
+        if (valueEnd == value || *valueEnd != '\0' || errno == ERANGE || outValue < minValue || outValue > maxValue)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << value << " (expected an integer from " << minValue << " to " << maxValue << ")\n";
+            return false;
+        }
+        return true;
+    }
+
+    /// Parses a whole argument value as a finite number of at least minValue, reporting values that aren't.
+    bool ParseFloatArgument(const char* arg, const char* value, float minValue, float& outValue)
+    {
+        char* valueEnd = nullptr;
+        errno = 0;
+        outValue = strtof(value, &valueEnd);
+        if (valueEnd == value || *valueEnd != '\0' || errno == ERANGE || !std::isfinite(outValue) || outValue < minValue)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << value << " (expected a number of at least " << minValue << ")\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool LinuxPlatform::Linux_ParseCommandLine(int argc, char** argv, RunParameters& outParams)
+{
+    bool bValid = true;
+    for (int argIndex = 1; argIndex < argc && bValid; argIndex++)
+    {
+        const char* arg = argv[argIndex];
+        const char* value = argIndex + 1 < argc ? argv[argIndex + 1] : nullptr;
+
+        if (strcmp(arg, "--width") == 0 && value != nullptr)
+        {
+            long long width = 0;
+            bValid = ParseIntegerArgument(arg, value, 1, UINT16_MAX, width);
+            outParams.DisplayWidth = static_cast<uint16_t>(width);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--height") == 0 && value != nullptr)
+        {
+            long long height = 0;
+            bValid = ParseIntegerArgument(arg, value, 1, UINT16_MAX, height);
+            outParams.DisplayHeight = static_cast<uint16_t>(height);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--frames") == 0 && value != nullptr)
+        {
+            long long frameCount = 0;
+            bValid = ParseIntegerArgument(arg, value, 1, UINT32_MAX, frameCount);
+            outParams.FrameCount = static_cast<uint32_t>(frameCount);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--warmup") == 0 && value != nullptr)
+        {
+            long long warmupFrameCount = 0;
+            bValid = ParseIntegerArgument(arg, value, 0, UINT32_MAX, warmupFrameCount);
+            outParams.WarmupFrameCount = static_cast<uint32_t>(warmupFrameCount);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--dump-frames") == 0 && value != nullptr)
+        {
+            outParams.FrameDumpDirectory = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--dump-interval") == 0 && value != nullptr)
+        {
+            long long dumpInterval = 0;
+            bValid = ParseIntegerArgument(arg, value, 1, UINT32_MAX, dumpInterval);
+            outParams.FrameDumpInterval = static_cast<uint32_t>(dumpInterval);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--target-fps") == 0 && value != nullptr)
+        {
+            bValid = ParseFloatArgument(arg, value, 0.0f, outParams.TargetFrameRate);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--frame-time") == 0 && value != nullptr)
+        {
+            bValid = ParseFloatArgument(arg, value, 0.0f, outParams.SimulatedFrameTimeMs);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--workers") == 0 && value != nullptr)
+        {
+            long long workerCount = 0;
+            bValid = ParseIntegerArgument(arg, value, 0, INT32_MAX, workerCount);
+            outParams.WorkerThreadCount = static_cast<int32_t>(workerCount);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--model") == 0 && value != nullptr)
+        {
+            outParams.ModelFilePath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--cache-dir") == 0 && value != nullptr)
+        {
+            outParams.ModelCacheDirectory = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--no-cache") == 0)
+        {
+            outParams.bUseModelCache = false;
+        }
+        else if (strcmp(arg, "--no-optimize") == 0)
+        {
+            outParams.bOptimizeModel = false;
+        }
+        else if (strcmp(arg, "--no-lod") == 0)
+        {
+            outParams.bGenerateModelLods = false;
+        }
+        else if (strcmp(arg, "--lod-error") == 0 && value != nullptr)
+        {
+            bValid = ParseFloatArgument(arg, value, 0.0f, outParams.LodErrorPixels);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--profile") == 0 && value != nullptr)
+        {
+            outParams.ProfileTraceFilePath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--suite") == 0)
+        {
+            outParams.bRunBenchmarkSuite = true;
+        }
+        else if (strcmp(arg, "--results") == 0 && value != nullptr)
+        {
+            outParams.BenchmarkResultsFilePath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--baseline") == 0 && value != nullptr)
+        {
+            outParams.BenchmarkBaselineFilePath = value;
+            argIndex++;
+        }
+        else if (strcmp(arg, "--max-regression") == 0 && value != nullptr)
+        {
+            bValid = ParseFloatArgument(arg, value, 0.0f, outParams.MaxRegressionPercent);
+            argIndex++;
+        }
+        else if (strcmp(arg, "--on-demand") == 0)
+        {
+            outParams.bRenderOnDemand = true;
+        }
+        else if (strcmp(arg, "--no-orbit") == 0)
+        {
+            outParams.bAutoOrbit = false;
+        }
+        else if (strcmp(arg, "--pick") == 0 && value != nullptr && argIndex + 2 < argc)
+        {
+            long long pickX = 0;
+            long long pickY = 0;
+            bValid = ParseIntegerArgument(arg, value, 0, UINT16_MAX, pickX) && ParseIntegerArgument(arg, argv[argIndex + 2], 0, UINT16_MAX, pickY);
+            outParams.bPick = true;
+            outParams.PickX = static_cast<uint16_t>(pickX);
+            outParams.PickY = static_cast<uint16_t>(pickY);
+            argIndex += 2;
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+            bValid = false;
+        }
+    }
+
+    if (!bValid)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--width W] [--height H] [--frames N] [--warmup N]"
+            << " [--dump-frames DIRECTORY] [--dump-interval N] [--target-fps FPS] [--frame-time MS] [--workers N] [--model FILE]"
+            << " [--cache-dir DIRECTORY] [--no-cache] [--no-optimize] [--no-lod] [--lod-error PIXELS] [--profile FILE]"
+            << " [--suite] [--results FILE] [--baseline FILE] [--max-regression PERCENT] [--on-demand] [--no-orbit]"
+            << " [--pick X Y]\n";
+    }
+
+    return bValid;
+}
+
+LinuxPlatform::~LinuxPlatform()
+{
+    m_persistentArena.reset();
+    m_frameArenas[0].reset();
+    m_frameArenas[1].reset();
+    if (m_engineMemoryBlock != nullptr)
+    {
+        munmap(m_engineMemoryBlock, m_engineMemoryBlockSize);
+    }
+}
+
+bool LinuxPlatform::Linux_InitSubsystems()
+{
+    m_debugger = std::make_shared<LinuxPlatformDebugger>();
+    m_renderer = std::make_shared<LinuxPlatformRenderer>();
+    m_renderer->Linux_ResizeRendererDisplay(m_params.DisplayWidth, m_params.DisplayHeight);
+    m_fileSystem = std::make_shared<LinuxPlatformFileSystem>();
+    const bool bRealTime = m_params.TargetFrameRate > 0.0f || m_params.SimulatedFrameTimeMs <= 0.0f;
+    m_clock = std::make_shared<LinuxPlatformClock>(bRealTime ? 0 : static_cast<uint64_t>(m_params.SimulatedFrameTimeMs * 1e6 + 0.5));
+
+    // The main thread runs the Engine, so registering it profiles the Engine's job workers too.
+    if (!m_params.ProfileTraceFilePath.empty())
+    {
+        if (Profiler::IsCompiledIn())
+        {
+            m_profiler = std::make_unique<Profiler>();
+            m_profiler->RegisterCurrentThread("Main");
+        }
+        else
+        {
+            std::cerr << "Profiling is compiled out, build with -DENGINE_PROFILING=1 to write '" << m_params.ProfileTraceFilePath << "'.\n";
+        }
+    }
+
+    // Reserve every Engine arena in a single mapping. MAP_NORESERVE keeps untouched pages from counting against the commit limit.
+    m_engineMemoryBlockSize = PERSISTENT_ARENA_SIZE + 2 * FRAME_ARENA_SIZE;
+    void* engineMemoryBlock = mmap(nullptr, m_engineMemoryBlockSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (engineMemoryBlock == MAP_FAILED)
+    {
+        std::cerr << "Failed to reserve " << (m_engineMemoryBlockSize >> 20) << " MB of Engine memory: " << strerror(errno) << "\n";
+        return false;
+    }
+    m_engineMemoryBlock = engineMemoryBlock;
+
+    uint8_t* arenaMemory = static_cast<uint8_t*>(m_engineMemoryBlock);
+    m_persistentArena = std::make_unique<MemoryArena>(arenaMemory, PERSISTENT_ARENA_SIZE);
+    m_frameArenas[0] = std::make_unique<MemoryArena>(arenaMemory + PERSISTENT_ARENA_SIZE, FRAME_ARENA_SIZE);
+    m_frameArenas[1] = std::make_unique<MemoryArena>(arenaMemory + PERSISTENT_ARENA_SIZE + FRAME_ARENA_SIZE, FRAME_ARENA_SIZE);
+    return true;
+}
+
+EngineMemory LinuxPlatform::Linux_GetEngineMemory() const
+{
+    EngineMemory memory;
+    memory.PersistentArena = m_persistentArena.get();
+    memory.FrameArenas[0] = m_frameArenas[0].get();
+    memory.FrameArenas[1] = m_frameArenas[1].get();
+    return memory;
+}
+
+void LinuxPlatform::Linux_DebuggerUpdate()
+{
+    PROFILE_ZONE("Linux_DebuggerUpdate");
+    m_debugger->Linux_FlushDebugLogQueue();
+}
+
+void LinuxPlatform::Linux_WriteProfile()
+{
+    if (m_profiler == nullptr)
+    {
+        return;
+    }
+
+    std::string trace;
+    m_profiler->WriteChromeTrace(trace);
+    std::ofstream traceFile(m_params.ProfileTraceFilePath, std::ios::binary);
+    if (!traceFile.write(trace.data(), trace.size()))
+    {
+        m_debugger->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to write profiling trace to '%s'.", m_params.ProfileTraceFilePath);
+        return;
+    }
+
+    std::string summary;
+    m_profiler->WriteSummary(summary);
+    m_debugger->Log<DebugLogMessage::Category::SUCCESS>("Wrote profiling trace to '%s' (%llu zones dropped). Zones by call path:",
+        m_params.ProfileTraceFilePath, m_profiler->GetDroppedZoneCount());
+    // Logged line by line, as messages have a size limit.
+    size_t lineStart = 0;
+    while (lineStart < summary.size())
+    {
+        const size_t lineEnd = summary.find('\n', lineStart);
+        m_debugger->Log<DebugLogMessage::Category::LOG>("%s", summary.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd == std::string::npos ? summary.size() : lineEnd + 1;
+    }
+}
+
+void LinuxPlatformDebugger::DisplayDebugMessage(DebugLogMessage&& message)
+{
+    m_debugMessageQueue.Push(message.LogCategory, nullptr, message.LogMessage.data(), message.LogMessage.size());
+}
+
+void LinuxPlatformDebugger::DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments)
+{
+    m_debugMessageQueue.Push(category, format, arguments.GetData(), arguments.GetSize());
+}
+
+void LinuxPlatformDebugger::Linux_FlushDebugLogQueue()
+{
+    // Only color the output when it goes to an actual terminal, so redirected benchmark logs stay readable.
+    const bool bUseColors = isatty(STDOUT_FILENO);
+
+    // Gather every queued message and write them with a single call.
+    m_flushBuffer.clear();
+    m_debugMessageQueue.Flush([&](DebugLogMessage::Category category, const char* format, const void* data, size_t size)
+    {
+        const char* colorCode;
+        switch(category)
+        {
+            case(DebugLogMessage::Category::VERBOSE):
+                colorCode = "\033[90m";
+            break;
+            case(DebugLogMessage::Category::SUCCESS):
+                colorCode = "\033[92m";
+            break;
+            default:
+            case(DebugLogMessage::Category::LOG):
+                colorCode = "\033[0m";
+            break;
+            case(DebugLogMessage::Category::WARNING):
+                colorCode = "\033[33m";
+            break;
+            case(DebugLogMessage::Category::ERROR_NONFATAL):
+                colorCode = "\033[31m";
+            break;
+            case(DebugLogMessage::Category::ERROR_FATAL):
+                colorCode = "\033[91m";
+            break;
+        }
+
+        if (bUseColors)
+        {
+            m_flushBuffer.append(colorCode);
+        }
+        if (format != nullptr)
+        {
+            DebugLog::FormatMessage(format, static_cast<const uint8_t*>(data), size, m_formattedMessage);
+            m_flushBuffer.append(m_formattedMessage);
+        }
+        else
+        {
+            m_flushBuffer.append(static_cast<const char*>(data), size);
+        }
+        m_flushBuffer.append(bUseColors ? "\033[0m\n" : "\n");
+    });
+
+    const uint64_t droppedMessageCount = m_debugMessageQueue.TakeDroppedMessageCount();
+    if (droppedMessageCount > 0)
+    {
+        char buff[128];
+        snprintf(buff, sizeof(buff), "%s%llu debug messages were dropped, the debug message queue was full.%s\n", bUseColors ? "\033[33m" : "",
+            static_cast<unsigned long long>(droppedMessageCount), bUseColors ? "\033[0m" : "");
+        m_flushBuffer.append(buff);
+    }
+
+    if (!m_flushBuffer.empty())
+    {
+        std::cout.write(m_flushBuffer.data(), m_flushBuffer.size());
+        std::cout.flush();
+    }
+}
+
+void LinuxPlatformSignal::Notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_Notified);
+        m_bNotified = true;
+    }
+    m_notifiedCondition.notify_one();
+}
+
+bool LinuxPlatformSignal::Wait(uint32_t timeoutMilliseconds)
+{
+    std::unique_lock<std::mutex> lock(m_mutex_Notified);
+    if (timeoutMilliseconds == INFINITE_TIMEOUT)
+    {
+        m_notifiedCondition.wait(lock, [this]() { return m_bNotified; });
+    }
+    else if (!m_notifiedCondition.wait_for(lock, std::chrono::milliseconds(timeoutMilliseconds), [this]() { return m_bNotified; }))
+    {
+        return false;
+    }
+    m_bNotified = false;
+    return true;
+}
+
+uint64_t LinuxPlatformClock::GetTicks() const
+{
+    if (Linux_IsSimulated())
+    {
+        return m_simulatedTime.load(std::memory_order_relaxed);
+    }
+
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+}
+
+void LinuxPlatformRenderer::Linux_ResizeRendererDisplay(uint16_t width, uint16_t height)
+{
+    std::lock_guard<std::mutex> lock(m_mutex_RenderResources);
+
+    m_displayWidth = width;
+    m_displayHeight = height;
+    m_presentedFrame.assign(static_cast<size_t>(width) * height, Pixel_RGBA{});
+    m_displayVersion.fetch_add(1, std::memory_order_release);
+}
+
+PlatformRenderer::MemoryMapDrawer* LinuxPlatformRenderer::AcquireDisplayDrawer()
+{
+    const int32_t bufferIndex = m_swapchain.AcquireBuffer();
+    if (bufferIndex < 0)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex_RenderResources);
+
+    // Drawers only get recreated when the display got resized since they were last acquired.
+    MemoryMapDrawerHeadless& drawerHeadless = m_swapchainDrawers[bufferIndex];
+    if (drawerHeadless.drawer == nullptr || drawerHeadless.drawer->GetWidth() != m_displayWidth || drawerHeadless.drawer->GetHeight() != m_displayHeight)
+    {
+        drawerHeadless.pixelBuffer.assign(static_cast<size_t>(m_displayWidth) * m_displayHeight, Pixel_RGBA{});
+        drawerHeadless.drawer = std::make_unique<PlatformRenderer::MemoryMapDrawer>(m_displayWidth, m_displayHeight, 0, 0,
+            drawerHeadless.pixelBuffer.data());
+    }
+    return drawerHeadless.drawer.get();
+}
+
+void LinuxPlatformRenderer::PresentDisplayDrawer(MemoryMapDrawer* drawer, const DisplayDamage& damage)
+{
+    for (uint32_t bufferIndex = 0; bufferIndex < DisplaySwapchain::BUFFER_COUNT; bufferIndex++)
+    {
+        if (m_swapchainDrawers[bufferIndex].drawer.get() == drawer)
+        {
+            m_swapchain.QueueBuffer(bufferIndex, damage);
+            return;
+        }
+    }
+}
+
+void LinuxPlatformRenderer::RenderUpdate()
+{
+    const int32_t bufferIndex = m_swapchain.BeginPresentingBuffer(m_presentedDamage);
+    if (bufferIndex < 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex_RenderResources);
+
+        // Copy the drawer's damaged pixels to the presented frame, clipped to the display.
+        const MemoryMapDrawerHeadless& drawerHeadless = m_swapchainDrawers[bufferIndex];
+        const PlatformRenderer::MemoryMapDrawer& drawer = *drawerHeadless.drawer;
+        for (uint32_t rectIndex = 0; rectIndex < m_presentedDamage.GetRectCount(); rectIndex++)
+        {
+            const DisplayRect& rect = m_presentedDamage.GetRect(rectIndex);
+            const uint32_t displayX = static_cast<uint32_t>(drawer.GetOffsetX()) + rect.X;
+            const uint32_t displayY = static_cast<uint32_t>(drawer.GetOffsetY()) + rect.Y;
+            if (displayX >= m_displayWidth || displayY >= m_displayHeight || rect.X >= drawer.GetWidth() || rect.Y >= drawer.GetHeight())
+            {
+                continue;
+            }
+
+            const uint32_t copyWidth = std::min<uint32_t>(std::min<uint32_t>(rect.Width, m_displayWidth - displayX), drawer.GetWidth() - rect.X);
+            const uint32_t copyHeight = std::min<uint32_t>(std::min<uint32_t>(rect.Height, m_displayHeight - displayY), drawer.GetHeight() - rect.Y);
+            for (uint32_t y = 0; y < copyHeight; y++)
+            {
+                memcpy(&m_presentedFrame[static_cast<size_t>(displayY + y) * m_displayWidth + displayX],
+                    &drawerHeadless.pixelBuffer[static_cast<size_t>(rect.Y + y) * drawer.GetWidth() + rect.X],
+                    copyWidth * sizeof(Pixel_RGBA));
+            }
+
+            m_presentedByteCount += static_cast<uint64_t>(copyWidth) * copyHeight * sizeof(Pixel_RGBA);
+        }
+        m_presentedFrameCount++;
+    }
+
+    m_swapchain.EndPresentingBuffer(bufferIndex);
+    m_presentSignal.Notify();
+}
+
+bool LinuxPlatformRenderer::Linux_DumpPresentedFrame(const std::string& filePath) const
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "P6\n" << m_displayWidth << " " << m_displayHeight << "\n255\n";
+
+    // Pixels are laid out as 0xAARRGGBB words, matching what the Win32 GDI platform displays.
+    std::vector<uint8_t> rowBytes(static_cast<size_t>(m_displayWidth) * 3);
+    for (uint16_t y = 0; y < m_displayHeight; y++)
+    {
+        for (uint16_t x = 0; x < m_displayWidth; x++)
+        {
+            const uint32_t pixel = m_presentedFrame[static_cast<size_t>(y) * m_displayWidth + x].pixel;
+            rowBytes[x * 3 + 0] = static_cast<uint8_t>(pixel >> 16);
+            rowBytes[x * 3 + 1] = static_cast<uint8_t>(pixel >> 8);
+            rowBytes[x * 3 + 2] = static_cast<uint8_t>(pixel);
+        }
+        file.write(reinterpret_cast<const char*>(rowBytes.data()), rowBytes.size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+// LINUX BENCHMARK REPORTING
+
+/// @brief Returns the value at the given percentile (0 - 100) of an ascending sorted sample set, using nearest-rank.
+double Linux_Percentile(const std::vector<double>& sortedSamples, double percentile)
+{
+    if (sortedSamples.empty())
+    {
+        return 0.0;
+    }
+
+    size_t rank = static_cast<size_t>(percentile / 100.0 * sortedSamples.size() + 0.5);
+    rank = std::min(std::max<size_t>(rank, 1), sortedSamples.size());
+    return sortedSamples[rank - 1];
+}
+
+void Linux_ReportFrameTimes(std::vector<double> frameTimesMs, double totalSeconds, uint64_t renderedFrameCount, const RenderStatistics& statisticsSum,
+    double trianglesSubmittedSum, uint64_t heapAllocationSum, LinuxBenchmarkResults& outResults)
+{
+    const LinuxPlatform::RunParameters& params = Linux_Platform->Linux_GetRunParameters();
+
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+
+    double sumMs = 0.0;
+    for (double frameTimeMs : frameTimesMs)
+    {
+        sumMs += frameTimeMs;
+    }
+
+    const double frameCount = static_cast<double>(frameTimesMs.size());
+    // Render statistics only cover updates that rendered a frame, which is all of them unless rendering on demand.
+    const double renderedCount = static_cast<double>(std::max<uint64_t>(renderedFrameCount, 1));
+    const double framesPerSecond = totalSeconds > 0.0 ? frameCount / totalSeconds : 0.0;
+    const double megaPixelsPerSecond = framesPerSecond * params.DisplayWidth * params.DisplayHeight / 1e6;
+
+    // Presented bytes against what presenting every frame whole would have taken, which damage tracking saves the rest of.
+    const std::shared_ptr<LinuxPlatformRenderer> renderer = Linux_Platform->Linux_GetRenderer();
+    const double fullFrameBytes = static_cast<double>(renderer->Linux_GetPresentedFrameCount()) * params.DisplayWidth * params.DisplayHeight * sizeof(Pixel_RGBA);
+    const double presentedPercentage = fullFrameBytes > 0.0 ? 100.0 * renderer->Linux_GetPresentedByteCount() / fullFrameBytes : 0.0;
+
+    const EngineMemory engineMemory = Linux_Platform->Linux_GetEngineMemory();
+    const size_t frameArenaPeakSize = std::max(engineMemory.FrameArenas[0]->GetPeakUsedSize(), engineMemory.FrameArenas[1]->GetPeakUsedSize());
+
+    Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>(
+        "Headless benchmark: %zu frames at %ux%u\n"
+        "  frame time (ms): mean %.3f | min %.3f | p50 %.3f | p99 %.3f | max %.3f\n"
+        "  throughput: %.1f frames/s | %.1f Mpixels/s | %.1f MB presented (%.1f%% of whole frames)\n"
+        "  chunks per rendered frame: %.1f rendered | %.1f simplified | %.1f occlusion culled | %.1f frustum culled\n"
+        "  clusters per rendered frame: %.1f tested | %.1f backface culled | %.1f frustum culled\n"
+        "  triangles per rendered frame: %.0f submitted\n"
+        "  memory per frame: %.2f heap allocations | %.1f MB frame arena peak | %.1f MB persistent arena",
+        frameTimesMs.size(), params.DisplayWidth, params.DisplayHeight,
+        sumMs / frameCount, frameTimesMs.front(), Linux_Percentile(frameTimesMs, 50.0), Linux_Percentile(frameTimesMs, 99.0), frameTimesMs.back(),
+        framesPerSecond, megaPixelsPerSecond, renderer->Linux_GetPresentedByteCount() / 1e6, presentedPercentage,
+        statisticsSum.ChunksRendered / renderedCount, statisticsSum.ChunksSimplified / renderedCount, statisticsSum.ChunksOcclusionCulled / renderedCount,
+        statisticsSum.ChunksFrustumCulled / renderedCount, statisticsSum.ClustersTested / renderedCount, statisticsSum.ClustersBackfaceCulled / renderedCount,
+        statisticsSum.ClustersFrustumCulled / renderedCount, trianglesSubmittedSum / renderedCount,
+        heapAllocationSum / frameCount, frameArenaPeakSize / 1e6, engineMemory.PersistentArena->GetUsedSize() / 1e6);
+
+    outResults.Linux_AddMetric("frames.mean", sumMs / frameCount, "ms", false);
+    outResults.Linux_AddMetric("frames.p99", Linux_Percentile(frameTimesMs, 99.0), "ms", false);
+    outResults.Linux_AddMetric("frames.heap_allocations", heapAllocationSum / frameCount, "per frame", false);
+
+    if (params.bRenderOnDemand)
+    {
+        Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>("  render on demand: %llu of %zu updates rendered a frame, %llu skipped it.",
+            renderedFrameCount, frameTimesMs.size(), static_cast<uint64_t>(frameTimesMs.size()) - renderedFrameCount);
+    }
+
+    // The Engine's own rolling statistics also account for time spent between updates, such as pacing. Simulated time would make them moot.
+    if (!Linux_Platform->Linux_GetClock()->Linux_IsSimulated())
+    {
+        const FrameTimeStatistics& engineFrameTimes = Linux_Engine->GetFrameTimeStatistics();
+        Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>(
+            "  engine update to update time over the last %u updates (ms): mean %.3f | min %.3f | p50 %.3f | p99 %.3f | max %.3f",
+            engineFrameTimes.GetFrameCount(), engineFrameTimes.GetMean() * 1000.0, engineFrameTimes.GetMinimum() * 1000.0,
+            engineFrameTimes.GetPercentile(50.0) * 1000.0, engineFrameTimes.GetPercentile(99.0) * 1000.0, engineFrameTimes.GetMaximum() * 1000.0);
+    }
+}
+
+// LINUX FILE SYSTEM IMPLEMENTATION
+
+std::shared_ptr<PlatformFileSystem::MappedFile> LinuxPlatformFileSystem::MapFileReadOnly(const std::string& filePath)
+{
+    const int fileDescriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+    {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    // Empty files can't be mapped, but are valid files nonetheless.
+    const size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+    if (fileSize == 0)
+    {
+        return std::make_shared<LinuxMappedFile>(fileDescriptor, nullptr, 0);
+    }
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    // Loaders go through whole files right away, so let the kernel start reading ahead of them.
+    madvise(mapping, fileSize, MADV_WILLNEED);
+
+    return std::make_shared<LinuxMappedFile>(fileDescriptor, static_cast<const uint8_t*>(mapping), fileSize);
+}
+
+LinuxPlatformFileSystem::LinuxMappedFile::~LinuxMappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    close(m_fileDescriptor);
+}
+
+std::shared_ptr<PlatformFileSystem::FileReader> LinuxPlatformFileSystem::OpenFileForReading(const std::string& filePath)
+{
+    const int fileDescriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+    {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return std::make_shared<LinuxFileReader>(fileDescriptor, static_cast<uint64_t>(fileStatus.st_size));
+}
+
+LinuxPlatformFileSystem::LinuxFileReader::~LinuxFileReader()
+{
+    close(m_fileDescriptor);
+}
+
+size_t LinuxPlatformFileSystem::LinuxFileReader::Read(uint8_t* buffer, size_t size)
+{
+    // read() may return less than asked for (signals, large requests), so keep going until done or at the end of the file.
+    size_t totalReadSize = 0;
+    while (totalReadSize < size)
+    {
+        const ssize_t readSize = read(m_fileDescriptor, buffer + totalReadSize, size - totalReadSize);
+        if (readSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (readSize <= 0)
+        {
+            break;
+        }
+        totalReadSize += static_cast<size_t>(readSize);
+    }
+    return totalReadSize;
+}
+
+std::shared_ptr<PlatformFileSystem::FileWriter> LinuxPlatformFileSystem::CreateFileForWriting(const std::string& filePath)
+{
+    // The process ID keeps concurrent instances writing the same file from sharing a temporary file.
+    const std::string temporaryFilePath = filePath + ".tmp" + std::to_string(getpid());
+    const int fileDescriptor = open(temporaryFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<LinuxFileWriter>(fileDescriptor, temporaryFilePath, filePath);
+}
+
+bool LinuxPlatformFileSystem::GetFileInfo(const std::string& filePath, FileInfo& outInfo)
+{
+    struct stat fileStatus;
+    if (stat(filePath.c_str(), &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+    {
+        return false;
+    }
+
+    outInfo.Size = static_cast<uint64_t>(fileStatus.st_size);
+    outInfo.ModificationTime = static_cast<uint64_t>(fileStatus.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64_t>(fileStatus.st_mtim.tv_nsec);
+    return true;
+}
+
+LinuxPlatformFileSystem::LinuxFileWriter::~LinuxFileWriter()
+{
+    if (m_fileDescriptor >= 0)
+    {
+        close(m_fileDescriptor);
+        unlink(m_temporaryFilePath.c_str());
+    }
+}
+
+bool LinuxPlatformFileSystem::LinuxFileWriter::Write(const uint8_t* data, size_t size)
+{
+    if (m_fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    // write() may write less than asked for, so keep going until done.
+    size_t totalWrittenSize = 0;
+    while (totalWrittenSize < size)
+    {
+        const ssize_t writtenSize = write(m_fileDescriptor, data + totalWrittenSize, size - totalWrittenSize);
+        if (writtenSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (writtenSize <= 0)
+        {
+            return false;
+        }
+        totalWrittenSize += static_cast<size_t>(writtenSize);
+    }
+    return true;
+}
+
+bool LinuxPlatformFileSystem::LinuxFileWriter::Commit()
+{
+    if (m_fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    // Closing can report delayed write errors, in which case the file must not replace the destination.
+    const bool bClosed = close(m_fileDescriptor) == 0;
+    m_fileDescriptor = -1;
+    if (!bClosed || rename(m_temporaryFilePath.c_str(), m_filePath.c_str()) != 0)
+    {
+        unlink(m_temporaryFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// LINUX MAIN ENTRY POINT
+
+int main(int argc, char** argv)
+{
+    LinuxPlatform::RunParameters runParams;
+    if (!LinuxPlatform::Linux_ParseCommandLine(argc, argv, runParams))
+    {
+        return 1;
+    }
+
+    // Create Platform & Engine control objects.
+    Linux_Platform = std::make_shared<LinuxPlatform>(runParams);
+    Linux_Engine = std::make_shared<Engine>();
+
+    if (!Linux_Platform->Linux_InitSubsystems())
+    {
+        return 1;
+    }
+    Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>("Linux Headless Platform Initialized !");
+
+    // Micro-benchmarks run first, so they have the machine to themselves.
+    LinuxBenchmarkResults benchmarkResults;
+    if (runParams.bRunBenchmarkSuite)
+    {
+        Linux_RunMicroBenchmarks(*Linux_Platform, benchmarkResults);
+    }
+
+    // #NOTE: The headless platform has no window messages to poll and presents synchronously, so the Engine simply runs on the main thread.
+    // This keeps measured frame times free of any cross-thread hand-off noise.
+    EngineConfiguration engineConfiguration;
+    engineConfiguration.WorkerThreadCount = runParams.WorkerThreadCount;
+    if (runParams.TargetFrameRate > 0.0f)
+    {
+        engineConfiguration.Pacing = EngineConfiguration::FramePacing::TARGET_RATE;
+        engineConfiguration.TargetFrameRate = runParams.TargetFrameRate;
+    }
+    engineConfiguration.ModelFilePath = runParams.ModelFilePath;
+    engineConfiguration.ModelLoading.bOptimizeMesh = runParams.bOptimizeModel;
+    engineConfiguration.ModelLoading.bUseCache = runParams.bUseModelCache;
+    engineConfiguration.ModelLoading.CacheDirectoryPath = runParams.ModelCacheDirectory;
+    engineConfiguration.ModelLoading.bGenerateLods = runParams.bGenerateModelLods;
+    engineConfiguration.LodErrorPixels = runParams.LodErrorPixels;
+    engineConfiguration.bRenderOnDemand = runParams.bRenderOnDemand;
+    engineConfiguration.bAutoOrbit = runParams.bAutoOrbit;
+    Linux_Engine->Initialize(   std::dynamic_pointer_cast<PlatformDebugger>(Linux_Platform->Linux_GetDebugger()),
+                                std::dynamic_pointer_cast<PlatformRenderer>(Linux_Platform->Linux_GetRenderer()),
+                                std::dynamic_pointer_cast<PlatformFileSystem>(Linux_Platform->Linux_GetFileSystem()),
+                                std::dynamic_pointer_cast<PlatformClock>(Linux_Platform->Linux_GetClock()),
+                                Linux_Platform->Linux_GetEngineMemory(),
+                                engineConfiguration);
+
+    Linux_Platform->Linux_DebuggerUpdate();
+
+    std::vector<double> frameTimesMs;
+    frameTimesMs.reserve(runParams.FrameCount);
+    // Chunk & cluster culling counters summed over measured frames. Triangle counts get summed separately, as they would overflow.
+    RenderStatistics statisticsSum;
+    double trianglesSubmittedSum = 0.0;
+    // Heap allocations made by measured Engine updates, and amount of them that rendered a frame.
+    uint64_t heapAllocationSum = 0;
+    uint64_t renderedFrameCount = 0;
+
+    const uint32_t totalFrameCount = runParams.WarmupFrameCount + runParams.FrameCount;
+    std::chrono::steady_clock::time_point measureStartTime = std::chrono::steady_clock::now();
+    for (uint32_t frameIndex = 0; frameIndex < totalFrameCount && !Linux_Engine->ShouldShutdown(); frameIndex++)
+    {
+        if (frameIndex == runParams.WarmupFrameCount)
+        {
+            measureStartTime = std::chrono::steady_clock::now();
+        }
+
+        Linux_Platform->Linux_GetClock()->Linux_AdvanceFrame();
+
+        const uint64_t frameStartAllocationCount = Linux_HeapAllocationCount.load(std::memory_order_relaxed);
+        const uint64_t frameStartRenderedFrameCount = Linux_Engine->GetRenderedFrameCount();
+        std::chrono::steady_clock::time_point frameStartTime = std::chrono::steady_clock::now();
+        Linux_Engine->Update();
+        std::chrono::steady_clock::time_point frameEndTime = std::chrono::steady_clock::now();
+        const uint64_t frameAllocationCount = Linux_HeapAllocationCount.load(std::memory_order_relaxed) - frameStartAllocationCount;
+
+        const bool bMeasured = frameIndex >= runParams.WarmupFrameCount;
+        if (bMeasured)
+        {
+            frameTimesMs.push_back(std::chrono::duration<double, std::milli>(frameEndTime - frameStartTime).count());
+            heapAllocationSum += frameAllocationCount;
+
+            // Updates skipping rendering leave the statistics of the last rendered frame, which mustn't be counted twice.
+            if (Linux_Engine->GetRenderedFrameCount() != frameStartRenderedFrameCount)
+            {
+                const RenderStatistics& frameStatistics = Linux_Engine->GetLastFrameStatistics();
+                statisticsSum.ChunksRendered += frameStatistics.ChunksRendered;
+                statisticsSum.ChunksSimplified += frameStatistics.ChunksSimplified;
+                statisticsSum.ChunksOcclusionCulled += frameStatistics.ChunksOcclusionCulled;
+                statisticsSum.ChunksFrustumCulled += frameStatistics.ChunksFrustumCulled;
+                statisticsSum.ClustersTested += frameStatistics.ClustersTested;
+                statisticsSum.ClustersBackfaceCulled += frameStatistics.ClustersBackfaceCulled;
+                statisticsSum.ClustersFrustumCulled += frameStatistics.ClustersFrustumCulled;
+                trianglesSubmittedSum += frameStatistics.TrianglesSubmitted;
+                renderedFrameCount++;
+            }
+
+            const uint32_t measuredFrameIndex = frameIndex - runParams.WarmupFrameCount;
+            if (!runParams.FrameDumpDirectory.empty() && measuredFrameIndex % runParams.FrameDumpInterval == 0)
+            {
+                char fileName[64];
+                snprintf(fileName, sizeof(fileName), "/frame_%06u.ppm", measuredFrameIndex);
+                if (!Linux_Platform->Linux_GetRenderer()->Linux_DumpPresentedFrame(runParams.FrameDumpDirectory + fileName))
+                {
+                    Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to dump frame to %s%s",
+                        runParams.FrameDumpDirectory, fileName);
+                }
+            }
+        }
+
+        // Flushing the debug log is platform work and is kept out of the measured frame time.
+        Linux_Platform->Linux_DebuggerUpdate();
+    }
+    const double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStartTime).count();
+
+    if (!frameTimesMs.empty())
+    {
+        Linux_ReportFrameTimes(std::move(frameTimesMs), totalSeconds, renderedFrameCount, statisticsSum, trianglesSubmittedSum, heapAllocationSum, benchmarkResults);
+    }
+    Linux_Platform->Linux_WriteProfile();
+    Linux_Platform->Linux_DebuggerUpdate();
+
+    if (!runParams.BenchmarkResultsFilePath.empty() && !benchmarkResults.Linux_WriteJson(runParams.BenchmarkResultsFilePath, runParams))
+    {
+        Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to write benchmark results to '%s'.",
+            runParams.BenchmarkResultsFilePath);
+    }
+    const bool bRegressed = !runParams.BenchmarkBaselineFilePath.empty()
+        && !benchmarkResults.Linux_CompareToBaseline(runParams.BenchmarkBaselineFilePath, runParams.MaxRegressionPercent, *Linux_Platform->Linux_GetDebugger());
+    Linux_Platform->Linux_DebuggerUpdate();
+
+    if (runParams.bPick && !Linux_Engine->ShouldShutdown())
+    {
+        // Pixel centers, so picking the pixel a frame dump shows.
+        const float normalizedX = (runParams.PickX + 0.5f) / runParams.DisplayWidth;
+        const float normalizedY = (runParams.PickY + 0.5f) / runParams.DisplayHeight;
+
+        RaycastHit hit;
+        const std::chrono::steady_clock::time_point pickStartTime = std::chrono::steady_clock::now();
+        const bool bHit = Linux_Engine->PickTriangle(normalizedX, normalizedY, hit);
+        const double pickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pickStartTime).count();
+
+        if (bHit)
+        {
+            Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Picked triangle %u at pixel (%u, %u), distance %.4f, in %.3f ms.",
+                hit.TriangleIndex, runParams.PickX, runParams.PickY, hit.Distance, pickMs);
+        }
+        else
+        {
+            Linux_Platform->Linux_GetDebugger()->Log<DebugLogMessage::Category::LOG>("No triangle at pixel (%u, %u), found in %.3f ms.",
+                runParams.PickX, runParams.PickY, pickMs);
+        }
+        Linux_Platform->Linux_DebuggerUpdate();
+    }
+
+    // The run is over: shut the Engine down like a user would have requested it, unless it already did so on its own.
+    if (!Linux_Engine->ShouldShutdown())
+    {
+        Linux_Engine->TriggerShutdown(Engine::ShutdownReason::REQUESTED);
+    }
+    Linux_Engine->OnShutdown();
+
+    // Final flush of the Debug Logging Queue so any messages left (sent as part of shutdowns) will be displayed.
+    Linux_Platform->Linux_DebuggerUpdate();
+
+    // Regressions get their own exit code, so scripts can tell them apart from failed runs.
+    if (Linux_Engine->GetShutdownReason() != Engine::ShutdownReason::REQUESTED)
+    {
+        return 1;
+    }
+    return bRegressed ? 2 : 0;
+}
@@ -0,0 +1,54 @@
+/*
+    Linux Headless Platform replacement of the global allocation functions, counting allocations made through operator new so benchmarks can
+    report how many Engine updates make. Kept in its own file so the compiler doesn't pair these with inlined callers.
+*/
+
+#include "linux_platform.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+std::atomic<uint64_t> Linux_HeapAllocationCount(0);
+
+void* operator new(size_t size)
+{
+    Linux_HeapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    Linux_HeapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = nullptr;
+    if (posix_memalign(&memory, std::max(static_cast<size_t>(alignment), sizeof(void*)), size > 0 ? size : 1) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    free(memory);
+}
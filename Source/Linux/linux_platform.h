@@ -0,0 +1,389 @@
+/*
+    Main Linux Headless Platform Implementation Header. Contains includes required by Linux implementation files broadly
+    as well as the LinuxPlatform class declaration.
+    The headless platform has no window: it renders to plain memory buffers and drives the Engine for a fixed amount of frames,
+    which makes it usable on render hosts and for measuring frame times.
+*/
+
+#ifndef LINUX_PLATFORM_H
+#define LINUX_PLATFORM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#include "Engine/Platform.h"
+#include "Engine/DebugLogQueue.h"
+#include "Engine/DisplaySwapchain.h"
+#include "Engine/MemoryArena.h"
+#include "Engine/Profiler.h"
+
+// Amount of allocations made through operator new since startup (see linux_memory.cpp). Benchmarks report the ones made by Engine updates,
+// which should be none once warmed up.
+extern std::atomic<uint64_t> Linux_HeapAllocationCount;
+
+class LinuxPlatformDebugger : public PlatformDebugger
+{
+public:
+
+    // #NOTE: Messages get flushed by the main thread, which also runs the Engine: blocking on a full queue could never be resolved, so
+    // overflowing messages get dropped (and reported) instead.
+    LinuxPlatformDebugger() : m_debugMessageQueue(DEBUG_MESSAGE_SLOT_COUNT, DebugLogQueue::OverflowPolicy::DROP)
+    {}
+
+    // Make sure Platform's overloads are visible in this scope for overload resolution.
+    using PlatformDebugger::DisplayDebugMessage;
+    virtual void DisplayDebugMessage(DebugLogMessage&& message) override;
+    virtual void DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments) override;
+
+    // Triggers a flush of all Debug Log Messages in queue to standard output.
+    void Linux_FlushDebugLogQueue();
+
+private:
+
+    static constexpr uint32_t DEBUG_MESSAGE_SLOT_COUNT = 4096;
+
+    DebugLogQueue m_debugMessageQueue;
+    // Formatted messages get formatted here, by the thread flushing the queue.
+    std::string m_formattedMessage;
+    // Batch of formatted messages written to standard output at once.
+    std::string m_flushBuffer;
+};
+
+/// @brief Linux signal, a flag guarded by a mutex and waited for through a condition variable.
+class LinuxPlatformSignal : public PlatformSignal
+{
+public:
+
+    LinuxPlatformSignal() : m_bNotified(false)
+    {}
+
+    virtual void Notify() override;
+    virtual bool Wait(uint32_t timeoutMilliseconds = INFINITE_TIMEOUT) override;
+
+private:
+
+    std::mutex m_mutex_Notified;
+    std::condition_variable m_notifiedCondition;
+    bool m_bNotified;
+};
+
+class LinuxPlatformRenderer : public PlatformRenderer
+{
+public:
+
+    LinuxPlatformRenderer() : m_displayWidth(0), m_displayHeight(0), m_displayVersion(0), m_presentedFrameCount(0), m_presentedByteCount(0)
+    {}
+
+    /// @brief Sets the size of the offscreen display the renderer works with. The presented frame buffer is reallocated and cleared, and
+    /// swapchain drawers get recreated as they are next acquired.
+    /// @param width Width in pixels of display.
+    /// @param height Height in pixels of display.
+    void Linux_ResizeRendererDisplay(uint16_t width, uint16_t height);
+
+    virtual MemoryMapDrawer* AcquireDisplayDrawer() override;
+    virtual void PresentDisplayDrawer(MemoryMapDrawer* drawer, const DisplayDamage& damage) override;
+
+    // Linux headless implementation performs the render update synchronously on the calling thread: damaged regions of the latest presented
+    // drawer are copied to the presented frame buffer, which stands in for the display.
+    virtual void RenderUpdate() override;
+
+    virtual PlatformSignal& GetPresentSignal() override { return m_presentSignal; }
+
+    virtual uint64_t GetDisplayVersion() const override { return m_displayVersion.load(std::memory_order_acquire); }
+
+    /// @brief Writes the currently presented frame to a binary PPM (P6) image file.
+    /// @param filePath Path of the image file to write.
+    /// @return True if the file was written successfully.
+    bool Linux_DumpPresentedFrame(const std::string& filePath) const;
+
+    uint64_t Linux_GetPresentedFrameCount() const { return m_presentedFrameCount; }
+    uint64_t Linux_GetPresentedByteCount() const { return m_presentedByteCount; }
+
+private:
+
+    /// @brief Wrapper for a Memory Map Drawer owning the plain memory pixel buffer it points to.
+    struct MemoryMapDrawerHeadless
+    {
+        std::vector<Pixel_RGBA> pixelBuffer;
+
+        // Null until first acquired.
+        std::unique_ptr<MemoryMapDrawer> drawer;
+    };
+
+    // Display data
+    uint16_t m_displayWidth;
+    uint16_t m_displayHeight;
+    // Incremented by every resize.
+    std::atomic<uint64_t> m_displayVersion;
+
+    // Pixels of the last presented frame, standing in for the display surface.
+    std::vector<Pixel_RGBA> m_presentedFrame;
+
+    DisplaySwapchain m_swapchain;
+    MemoryMapDrawerHeadless m_swapchainDrawers[DisplaySwapchain::BUFFER_COUNT];
+    // Damage of the drawer being presented.
+    DisplayDamage m_presentedDamage;
+    // Notified after each presentation.
+    LinuxPlatformSignal m_presentSignal;
+
+    // Statistics about presentation, used by benchmark reports.
+    uint64_t m_presentedFrameCount;
+    uint64_t m_presentedByteCount;
+
+    // Locked by the platform when performing a Render update or resizing the display, or by the Engine when acquiring a drawer.
+    std::mutex m_mutex_RenderResources;
+};
+
+/// @brief Linux clock, counting nanoseconds of CLOCK_MONOTONIC. For runs to be reproducible, it can instead simulate time advancing by a
+/// fixed amount per frame.
+class LinuxPlatformClock : public PlatformClock
+{
+public:
+
+    /// @param simulatedFrameNanoseconds Time the clock advances by on each Linux_AdvanceFrame call. Zero follows real time instead.
+    LinuxPlatformClock(uint64_t simulatedFrameNanoseconds) : m_simulatedFrameNanoseconds(simulatedFrameNanoseconds), m_simulatedTime(0)
+    {}
+
+    virtual uint64_t GetTicks() const override;
+    virtual uint64_t GetTicksPerSecond() const override { return 1000000000; }
+
+    /// @brief Advances simulated time by a frame, before the platform runs an Engine update. Does nothing when following real time.
+    void Linux_AdvanceFrame() { m_simulatedTime.fetch_add(m_simulatedFrameNanoseconds, std::memory_order_relaxed); }
+
+    bool Linux_IsSimulated() const { return m_simulatedFrameNanoseconds > 0; }
+
+private:
+
+    uint64_t m_simulatedFrameNanoseconds;
+    std::atomic<uint64_t> m_simulatedTime;
+};
+
+/// @brief Linux file system service, mapping files with mmap.
+class LinuxPlatformFileSystem : public PlatformFileSystem
+{
+public:
+
+    virtual std::shared_ptr<MappedFile> MapFileReadOnly(const std::string& filePath) override;
+    virtual std::shared_ptr<FileReader> OpenFileForReading(const std::string& filePath) override;
+    virtual std::shared_ptr<FileWriter> CreateFileForWriting(const std::string& filePath) override;
+    virtual bool GetFileInfo(const std::string& filePath, FileInfo& outInfo) override;
+
+private:
+
+    /// @brief Mapped file owning its mapping & file descriptor, both released on destruction.
+    class LinuxMappedFile : public MappedFile
+    {
+    public:
+
+        LinuxMappedFile(int fileDescriptor, const uint8_t* data, size_t size) : MappedFile(data, size), m_fileDescriptor(fileDescriptor)
+        {}
+
+        virtual ~LinuxMappedFile() override;
+
+    private:
+
+        int m_fileDescriptor;
+    };
+
+    /// @brief File reader owning its file descriptor, closed on destruction.
+    class LinuxFileReader : public FileReader
+    {
+    public:
+
+        LinuxFileReader(int fileDescriptor, uint64_t size) : FileReader(size), m_fileDescriptor(fileDescriptor)
+        {}
+
+        virtual ~LinuxFileReader() override;
+
+        virtual size_t Read(uint8_t* buffer, size_t size) override;
+
+    private:
+
+        int m_fileDescriptor;
+    };
+
+    /// @brief File writer owning the file descriptor of its temporary file, which is renamed to the destination path on commit.
+    class LinuxFileWriter : public FileWriter
+    {
+    public:
+
+        LinuxFileWriter(int fileDescriptor, const std::string& temporaryFilePath, const std::string& filePath) : m_fileDescriptor(fileDescriptor),
+            m_temporaryFilePath(temporaryFilePath), m_filePath(filePath)
+        {}
+
+        virtual ~LinuxFileWriter() override;
+
+        virtual bool Write(const uint8_t* data, size_t size) override;
+        virtual bool Commit() override;
+
+    private:
+
+        // -1 once committed.
+        int m_fileDescriptor;
+        std::string m_temporaryFilePath;
+        std::string m_filePath;
+    };
+};
+
+/// @brief The Linux Headless Platform runs the Engine without any window or input, for a set amount of frames at a set resolution.
+/// It measures the time taken by every Engine update and reports latency percentiles and throughput once done.
+class LinuxPlatform
+{
+public:
+
+    /// @brief Run configuration of the headless platform, usually read from the command line.
+    struct RunParameters
+    {
+        uint16_t DisplayWidth = 1280;
+        uint16_t DisplayHeight = 720;
+
+        // Amount of measured frames.
+        uint32_t FrameCount = 600;
+        // Amount of frames ran before measurement starts, so caches and allocations settle.
+        uint32_t WarmupFrameCount = 30;
+
+        // When not empty, presented frames get dumped as PPM images into that directory.
+        std::string FrameDumpDirectory;
+        // Interval in frames between two frame dumps.
+        uint32_t FrameDumpInterval = 1;
+
+        // When strictly positive, the Engine paces its updates to that rate instead of running them back to back. Pacing happens in real
+        // time, so the platform clock then follows real time as well.
+        float TargetFrameRate = 0.0f;
+
+        // Time the platform clock advances by per frame, in milliseconds, so runs are reproducible. Zero follows real time instead.
+        float SimulatedFrameTimeMs = 10.0f;
+
+        // Amount of Engine worker threads. Negative means one per hardware thread.
+        int32_t WorkerThreadCount = -1;
+
+        // Path of the model file the Engine views. Empty means the Engine's generated test model.
+        std::string ModelFilePath;
+
+        // Whether the Engine optimizes loaded models.
+        bool bOptimizeModel = true;
+
+        // Whether the Engine generates simplified levels of detail for models, and the on-screen error in pixels they may introduce.
+        bool bGenerateModelLods = true;
+        float LodErrorPixels = 1.0f;
+
+        // Whether the Engine caches loaded models, and the directory caches go to. Empty means next to model files.
+        bool bUseModelCache = true;
+        std::string ModelCacheDirectory;
+
+        // When not empty, profiling zones of the run get written to that file as a Chrome trace, and summarized. Requires a profiling build.
+        std::string ProfileTraceFilePath;
+
+        // Whether micro-benchmarks of the Engine's hot paths run before the Engine does (see Linux_RunMicroBenchmarks).
+        bool bRunBenchmarkSuite = false;
+        // When not empty, metrics of the run get written to that file as JSON.
+        std::string BenchmarkResultsFilePath;
+        // When not empty, metrics of the run get compared against those of that results file, and the run fails if any of them got worse
+        // by more than the allowed percentage.
+        std::string BenchmarkBaselineFilePath;
+        float MaxRegressionPercent = 10.0f;
+
+        // Whether the Engine skips rendering updates during which nothing changed, and whether its camera orbits on its own, which changes
+        // the view every update. Both off, a run measures what an idle viewer costs.
+        bool bRenderOnDemand = false;
+        bool bAutoOrbit = true;
+
+        // When set, the triangle under that pixel of the last frame gets picked and reported after the run.
+        bool bPick = false;
+        uint16_t PickX = 0;
+        uint16_t PickY = 0;
+    };
+
+    /// @brief Reads run parameters from command line arguments. Unknown arguments are reported and make parsing fail.
+    /// @return True if the arguments were valid, false otherwise (in which case usage has been printed).
+    static bool Linux_ParseCommandLine(int argc, char** argv, RunParameters& outParams);
+
+    LinuxPlatform(const RunParameters& params) : m_params(params), m_engineMemoryBlock(nullptr), m_engineMemoryBlockSize(0)
+    {}
+
+    ~LinuxPlatform();
+
+    /// @brief Initializes subsystems (debugging, offscreen rendering, file system, clock & Engine memory).
+    /// @return True if subsystems initialized appropriately.
+    bool Linux_InitSubsystems();
+
+    /// @brief Updates platform debugging.
+    void Linux_DebuggerUpdate();
+
+    /// @brief Writes profiling zones recorded so far to the trace file of the run parameters, and logs their summary.
+    void Linux_WriteProfile();
+
+    const RunParameters& Linux_GetRunParameters() const { return m_params; }
+
+    std::shared_ptr<LinuxPlatformDebugger> Linux_GetDebugger() const { return m_debugger; }
+    std::shared_ptr<LinuxPlatformRenderer> Linux_GetRenderer() const { return m_renderer; }
+    std::shared_ptr<LinuxPlatformFileSystem> Linux_GetFileSystem() const { return m_fileSystem; }
+    std::shared_ptr<LinuxPlatformClock> Linux_GetClock() const { return m_clock; }
+
+    /// @brief Returns the arenas the Engine allocates from, reserved by Linux_InitSubsystems.
+    EngineMemory Linux_GetEngineMemory() const;
+
+private:
+
+    // Virtual address space reserved for each Engine arena. Pages only get backed by memory once touched, so generous sizes cost nothing.
+    static constexpr size_t PERSISTENT_ARENA_SIZE = size_t(1) << 30;
+    static constexpr size_t FRAME_ARENA_SIZE = size_t(256) << 20;
+
+    RunParameters m_params;
+
+    std::shared_ptr<LinuxPlatformDebugger> m_debugger;
+    std::shared_ptr<LinuxPlatformRenderer> m_renderer;
+    std::shared_ptr<LinuxPlatformFileSystem> m_fileSystem;
+    std::shared_ptr<LinuxPlatformClock> m_clock;
+    // Null unless profiling was requested.
+    std::unique_ptr<Profiler> m_profiler;
+
+    // Anonymous mapping all Engine arenas live in, and the arenas themselves.
+    void* m_engineMemoryBlock;
+    size_t m_engineMemoryBlockSize;
+    std::unique_ptr<MemoryArena> m_persistentArena;
+    std::unique_ptr<MemoryArena> m_frameArenas[2];
+};
+
+/// @brief Metrics measured by a headless run, written to a JSON results file so later runs can be compared against them.
+class LinuxBenchmarkResults
+{
+public:
+
+    struct Metric
+    {
+        std::string Name;
+        double Value;
+        std::string Unit;
+        bool bHigherIsBetter;
+    };
+
+    void Linux_AddMetric(const std::string& name, double value, const std::string& unit, bool bHigherIsBetter);
+
+    const std::vector<Metric>& Linux_GetMetrics() const { return m_metrics; }
+
+    /// @brief Writes every metric to a JSON results file, along with the run parameters they were measured with.
+    /// @return True if the file was written successfully.
+    bool Linux_WriteJson(const std::string& filePath, const LinuxPlatform::RunParameters& params) const;
+
+    /// @brief Compares metrics against those of a results file and logs how each of them changed. Metrics missing from either side are
+    /// reported but don't fail the comparison.
+    /// @param maxRegressionPercent How much worse than its baseline a metric may get before counting as a regression.
+    /// @return True if the baseline could be read and no metric regressed, false otherwise.
+    bool Linux_CompareToBaseline(const std::string& filePath, double maxRegressionPercent, PlatformDebugger& debugger) const;
+
+private:
+
+    std::vector<Metric> m_metrics;
+};
+
+/// @brief Measures the Engine's hot paths in isolation: frame clears, rasterization of generated spheres of increasing triangle counts,
+/// vertex transform and model loading of each supported format. Runs on its own job system & arenas, so must be called before the Engine
+/// initializes to keep the two from competing for threads.
+void Linux_RunMicroBenchmarks(LinuxPlatform& platform, LinuxBenchmarkResults& outResults);
+
+#endif // LINUX_PLATFORM_H
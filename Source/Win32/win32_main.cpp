@@ -5,7 +5,13 @@
 #include "win32_platform.h"
 #include "Engine/Engine.h"
 #include <iostream>
+#include <fstream>
 #include <thread>
+#include <algorithm>
+
+#include <shellapi.h>
+#include <windowsx.h>
+#pragma comment(lib, "Shell32.lib")
 
 // Forward decs & Defines
 
@@ -20,13 +26,49 @@ std::shared_ptr<Engine> Win32_Engine;
 
 // WIN32 PLATFORM IMPLEMENTATION
 
+Win32Platform::~Win32Platform()
+{
+    m_persistentArena.reset();
+    m_frameArenas[0].reset();
+    m_frameArenas[1].reset();
+    if (m_engineMemoryBlock != NULL)
+    {
+        VirtualFree(m_engineMemoryBlock, 0, MEM_RELEASE);
+    }
+}
+
 bool Win32Platform::Win32_InitSubsystems()
 {
     m_debugger = std::make_shared<Win32PlatformDebugger>();
     m_renderer = std::make_shared<Win32PlatformRenderer>();
+    m_fileSystem = std::make_shared<Win32PlatformFileSystem>();
+    m_clock = std::make_shared<Win32PlatformClock>();
+
+    // Reserve & commit every Engine arena in a single block.
+    const size_t engineMemoryBlockSize = PERSISTENT_ARENA_SIZE + 2 * FRAME_ARENA_SIZE;
+    m_engineMemoryBlock = VirtualAlloc(NULL, engineMemoryBlockSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (m_engineMemoryBlock == NULL)
+    {
+        std::cerr << "Failed to allocate " << (engineMemoryBlockSize >> 20) << " MB of Engine memory ! Error Code = " << GetLastError() << "\n";
+        return false;
+    }
+
+    uint8_t* arenaMemory = static_cast<uint8_t*>(m_engineMemoryBlock);
+    m_persistentArena = std::make_unique<MemoryArena>(arenaMemory, PERSISTENT_ARENA_SIZE);
+    m_frameArenas[0] = std::make_unique<MemoryArena>(arenaMemory + PERSISTENT_ARENA_SIZE, FRAME_ARENA_SIZE);
+    m_frameArenas[1] = std::make_unique<MemoryArena>(arenaMemory + PERSISTENT_ARENA_SIZE + FRAME_ARENA_SIZE, FRAME_ARENA_SIZE);
     return true;
 }
 
+EngineMemory Win32Platform::Win32_GetEngineMemory() const
+{
+    EngineMemory memory;
+    memory.PersistentArena = m_persistentArena.get();
+    memory.FrameArenas[0] = m_frameArenas[0].get();
+    memory.FrameArenas[1] = m_frameArenas[1].get();
+    return memory;
+}
+
 bool Win32Platform::Win32_InitWindow()
 {
     // Create window class if necessary and instantiate main window.
@@ -53,10 +95,17 @@ bool Win32Platform::Win32_InitWindow()
     return true;
 }
 
-void Win32Platform::Win32_PollNextMessage()
+void Win32Platform::Win32_PollMessages()
 {
+    // Sleep until messages arrive rather than polling for them. MWMO_INPUTAVAILABLE also wakes up for messages that were already in the queue
+    // when it was last peeked at, so none of them waits for the timeout.
+    MsgWaitForMultipleObjectsEx(0, NULL, MESSAGE_WAIT_TIMEOUT_MS, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+    // Empty the queue before sleeping again. Messages of the whole thread are taken, not only the window's, as any of them left in the queue
+    // would wake the wait above right away.
+    PROFILE_ZONE("Win32_PollMessages");
     MSG message;
-    if (PeekMessage(&message, m_mainWindowHandle, 0, 0, PM_REMOVE) > 0)
+    while (PeekMessage(&message, NULL, 0, 0, PM_REMOVE))
     {
         TranslateMessage(&message);
         DispatchMessage(&message);
@@ -65,14 +114,83 @@ void Win32Platform::Win32_PollNextMessage()
 
 void Win32Platform::Win32_RendererUpdate()
 {
+    m_renderer->Win32_WaitForRenderUpdate();
     m_renderer->Win32_TryRunRenderUpdate();
 }
 
 void Win32Platform::Win32_DebuggerUpdate()
 {
+    m_debugger->Win32_WaitForDebugMessages(MESSAGE_WAIT_TIMEOUT_MS);
+
+    PROFILE_ZONE("Win32_DebuggerUpdate");
     m_debugger->Win32_FlushDebugLogQueue();
 }
 
+void Win32Platform::Win32_WriteProfile()
+{
+    if (!Profiler::IsCompiledIn())
+    {
+        return;
+    }
+
+    std::string trace;
+    m_profiler.WriteChromeTrace(trace);
+    std::ofstream traceFile(PROFILE_TRACE_FILE_PATH, std::ios::binary);
+    if (!traceFile.write(trace.data(), trace.size()))
+    {
+        m_debugger->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Failed to write profiling trace to '%s'.", PROFILE_TRACE_FILE_PATH);
+        return;
+    }
+
+    std::string summary;
+    m_profiler.WriteSummary(summary);
+    m_debugger->Log<DebugLogMessage::Category::SUCCESS>("Wrote profiling trace to '%s' (%llu zones dropped). Zones by call path:",
+        PROFILE_TRACE_FILE_PATH, m_profiler.GetDroppedZoneCount());
+    // Logged line by line, as messages have a size limit.
+    size_t lineStart = 0;
+    while (lineStart < summary.size())
+    {
+        const size_t lineEnd = summary.find('\n', lineStart);
+        m_debugger->Log<DebugLogMessage::Category::LOG>("%s", summary.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd == std::string::npos ? summary.size() : lineEnd + 1;
+    }
+}
+
+void Win32Platform::Win32_WakeUpdateThreads()
+{
+    m_renderer->Win32_WakeRenderThread();
+    m_debugger->Win32_WakeFlushThread();
+}
+
+namespace
+{
+    /// Maps a virtual key code to the Engine key it stands for, InputKey::COUNT if none.
+    InputKey GetInputKey(WPARAM virtualKeyCode)
+    {
+        switch(virtualKeyCode)
+        {
+            case(VK_LEFT):
+                return InputKey::ORBIT_LEFT;
+            case(VK_RIGHT):
+                return InputKey::ORBIT_RIGHT;
+            case(VK_UP):
+                return InputKey::ORBIT_UP;
+            case(VK_DOWN):
+                return InputKey::ORBIT_DOWN;
+            case(VK_ADD):
+            case(VK_OEM_PLUS):
+                return InputKey::ZOOM_IN;
+            case(VK_SUBTRACT):
+            case(VK_OEM_MINUS):
+                return InputKey::ZOOM_OUT;
+            case(VK_HOME):
+                return InputKey::RESET_VIEW;
+            default:
+                return InputKey::COUNT;
+        }
+    }
+}
+
 bool Win32Platform::Win32_ProcessWindowMessage(int messageType, WPARAM wParam, LPARAM lParam)
 {
     switch(messageType)
@@ -80,11 +198,77 @@ bool Win32Platform::Win32_ProcessWindowMessage(int messageType, WPARAM wParam, L
         case(WM_SIZE):
             m_renderer->Win32_ResizeRendererDisplay(m_mainWindowHandle, LOWORD(lParam), HIWORD(lParam));
             return false;
+        case(WM_PAINT):
+            // Part of the window needs drawing again. Let the default handler validate it, the next present will blit the whole drawer.
+            m_renderer->Win32_InvalidateWindow();
+            return false;
+        case(WM_KEYDOWN):
+        case(WM_KEYUP):
+        {
+            // Held keys repeat key down messages, while the Engine only cares about presses & releases.
+            const bool bRepeat = messageType == WM_KEYDOWN && (lParam & (1 << 30)) != 0;
+            const InputKey key = GetInputKey(wParam);
+            if (key != InputKey::COUNT && !bRepeat)
+            {
+                Win32_PushInputEvent(InputEvent::MakeKey(messageType == WM_KEYDOWN ? InputEventType::KEY_DOWN : InputEventType::KEY_UP, key));
+            }
+            return false;
+        }
+        case(WM_LBUTTONDOWN):
+        case(WM_RBUTTONDOWN):
+        case(WM_MBUTTONDOWN):
+        case(WM_LBUTTONUP):
+        case(WM_RBUTTONUP):
+        case(WM_MBUTTONUP):
+        {
+            const bool bDown = messageType == WM_LBUTTONDOWN || messageType == WM_RBUTTONDOWN || messageType == WM_MBUTTONDOWN;
+            const InputMouseButton button = messageType == WM_LBUTTONDOWN || messageType == WM_LBUTTONUP ? InputMouseButton::LEFT
+                : messageType == WM_RBUTTONDOWN || messageType == WM_RBUTTONUP ? InputMouseButton::RIGHT : InputMouseButton::MIDDLE;
+            Win32_PushInputEvent(InputEvent::MakeMouseButton(bDown ? InputEventType::MOUSE_BUTTON_DOWN : InputEventType::MOUSE_BUTTON_UP, button,
+                GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)));
+
+            // Capture the mouse while any button is held, so drags keep being received outside of the window.
+            if (bDown)
+            {
+                SetCapture(m_mainWindowHandle);
+            }
+            else if ((wParam & (MK_LBUTTON | MK_RBUTTON | MK_MBUTTON)) == 0)
+            {
+                ReleaseCapture();
+            }
+            return false;
+        }
+        case(WM_MOUSEMOVE):
+        {
+            const int32_t cursorX = GET_X_LPARAM(lParam);
+            const int32_t cursorY = GET_Y_LPARAM(lParam);
+            if (m_bCursorPositionKnown)
+            {
+                Win32_PushInputEvent(InputEvent::MakeMouseMove(cursorX, cursorY, static_cast<float>(cursorX - m_lastCursorX),
+                    static_cast<float>(cursorY - m_lastCursorY)));
+            }
+            m_lastCursorX = cursorX;
+            m_lastCursorY = cursorY;
+            m_bCursorPositionKnown = true;
+            return false;
+        }
+        case(WM_MOUSEWHEEL):
+        {
+            // Wheel messages carry the cursor position in screen coordinates.
+            POINT cursorPosition = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+            ScreenToClient(m_mainWindowHandle, &cursorPosition);
+            Win32_PushInputEvent(InputEvent::MakeMouseWheel(cursorPosition.x, cursorPosition.y,
+                static_cast<float>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA));
+            return false;
+        }
+        case(WM_KILLFOCUS):
+            Win32_PushInputEvent(InputEvent::MakeFocusLost());
+            m_bCursorPositionKnown = false;
+            return false;
         case(WM_QUIT):
         case(WM_CLOSE):
             // Close Main window, triggering the whole app to shut down.
-            m_debugger->DisplayDebugMessage("Win32 Platform Main Window received Close or Quit message ! Closing window and shutting down Engine...",
-                DebugLogMessage::Category::WARNING);
+            m_debugger->Log<DebugLogMessage::Category::WARNING>("Win32 Platform Main Window received Close or Quit message ! Closing window and shutting down Engine...");
             Win32_CloseWindow();
             return true; // Make sure nothing further happens. We need to handle the actual closing of the window ourselves.
         default:
@@ -98,57 +282,128 @@ void Win32Platform::Win32_CloseWindow()
     m_mainWindowHandle = NULL;
 }
 
+void Win32Platform::Win32_PushInputEvent(const InputEvent& event)
+{
+    // Events only get dropped if the Engine stops draining them, which it reports itself.
+    Win32_Engine->GetInputEventQueue().Push(event);
+}
+
 void Win32PlatformDebugger::DisplayDebugMessage(DebugLogMessage&& message)
 {
-    std::lock_guard<std::mutex> queueLock(m_mutex_DebugMessageQueue);
-    m_debugMessageQueue.push(message);
+    m_debugMessageQueue.Push(message.LogCategory, nullptr, message.LogMessage.data(), message.LogMessage.size());
+    NotifyMessageQueued();
 }
 
-void Win32PlatformDebugger::Win32_FlushDebugLogQueue()
+void Win32PlatformDebugger::DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments)
 {
-    // #NOTE(Marc): Using a single mutex and buffer both for feeding in messages and flushing to screen means that if the Engine or any other thread tries to request a message to
-    // be displayed, it will have to wait for however long it takes to flush every message to screen. I don't mind it for now, because the platform thread in charge of this should
-    // be quite short-looped which, outside cases where the Engine prints many messages sequentially, means the queue will never get too long anyway.
-    // If this were to change, I can think of multiple solutions: a single sort of "circular" buffer with a "consumption" and "production" cursor that can work in parallel, or
-    // some way to interrupt the flushing process if something is waiting for the mutex to be unlocked.
-    std::lock_guard<std::mutex> messageQueueLock(m_mutex_DebugMessageQueue);
-    while(!m_debugMessageQueue.empty())
+    m_debugMessageQueue.Push(category, format, arguments.GetData(), arguments.GetSize());
+    NotifyMessageQueued();
+}
+
+void Win32PlatformDebugger::Win32_WaitForDebugMessages(uint32_t timeoutMilliseconds)
+{
+    // Flag waiting before checking the queue: a producer pushing after the check is then sure to see the flag and notify.
+    m_bFlushThreadWaiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_debugMessageQueue.HasQueuedMessages())
     {
-        DebugLogMessage& message = m_debugMessageQueue.front();
+        m_messageSignal.Wait(timeoutMilliseconds);
+    }
+    m_bFlushThreadWaiting.store(false);
+}
 
-        switch(message.LogCategory)
+void Win32PlatformDebugger::NotifyMessageQueued()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_bFlushThreadWaiting.load() && m_bFlushThreadWaiting.exchange(false))
+    {
+        m_messageSignal.Notify();
+    }
+}
+
+namespace
+{
+    WORD GetDebugLogCategoryTextAttribute(DebugLogMessage::Category category)
+    {
+        switch(category)
         {
+            case(DebugLogMessage::Category::VERBOSE):
+                return FOREGROUND_INTENSITY;
             case(DebugLogMessage::Category::SUCCESS):
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-            break;
+                return FOREGROUND_GREEN | FOREGROUND_INTENSITY;
             default:
             case(DebugLogMessage::Category::LOG):
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED);
-            break;
+                return FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED;
             case(DebugLogMessage::Category::WARNING):
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_GREEN | FOREGROUND_RED);
-            break;
+                return FOREGROUND_GREEN | FOREGROUND_RED;
             case(DebugLogMessage::Category::ERROR_NONFATAL):
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_RED);
-            break;
+                return FOREGROUND_RED;
             case(DebugLogMessage::Category::ERROR_FATAL):
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_RED | FOREGROUND_INTENSITY);
-            break;
+                return FOREGROUND_RED | FOREGROUND_INTENSITY;
+        }
+    }
+}
+
+void Win32PlatformDebugger::Win32_FlushDebugLogQueue()
+{
+    // Messages get popped from the queue without any lock, so Engine threads keep logging while the console gets written to. They are
+    // gathered into batches of the same category, each written with a single call.
+    const HANDLE outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+    DebugLogMessage::Category batchCategory = DebugLogMessage::Category::LOG;
+    m_flushBuffer.clear();
+
+    auto writeBatch = [&]()
+    {
+        if (!m_flushBuffer.empty())
+        {
+            SetConsoleTextAttribute(outputHandle, GetDebugLogCategoryTextAttribute(batchCategory));
+            std::cout.write(m_flushBuffer.data(), m_flushBuffer.size());
+            std::cout.flush();
+            m_flushBuffer.clear();
         }
-        // Use standard out to output all messages. Always add a line break (triggering a flush) to each message.
-        // #TODO(Marc): Add facility for multi-line and parameterized messages to be built on the Engine side.
-        std::cout << message.LogMessage << "\n";
-        m_debugMessageQueue.pop();
+    };
+
+    while (m_debugMessageQueue.Flush([&](DebugLogMessage::Category category, const char* format, const void* data, size_t size)
+        {
+            if (category != batchCategory)
+            {
+                writeBatch();
+                batchCategory = category;
+            }
+            if (format != nullptr)
+            {
+                DebugLog::FormatMessage(format, static_cast<const uint8_t*>(data), size, m_formattedMessage);
+                m_flushBuffer.append(m_formattedMessage);
+            }
+            else
+            {
+                m_flushBuffer.append(static_cast<const char*>(data), size);
+            }
+            m_flushBuffer.append("\n");
+        }, DEBUG_MESSAGE_BATCH_SIZE) > 0)
+    {
+        writeBatch();
     }
 
     // Reset text attribute to default.
-    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED);
+    SetConsoleTextAttribute(outputHandle, FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED);
+}
+
+Win32PlatformRenderer::~Win32PlatformRenderer()
+{
+    for (MemoryMapDrawerGDI& drawerGDI : m_swapchainDrawers)
+    {
+        FreeDrawerGDI(drawerGDI);
+    }
 }
 
 void Win32PlatformRenderer::Win32_ResizeRendererDisplay(HWND windowHandle, uint16_t width, uint16_t height)
 {
+    std::lock_guard<std::mutex> lock(m_mutex_RenderResources);
+
     m_displayWidth = width;
     m_displayHeight = height;
+    m_displayVersion.fetch_add(1, std::memory_order_release);
 
     if (m_windowHandle != windowHandle)
     {
@@ -158,89 +413,352 @@ void Win32PlatformRenderer::Win32_ResizeRendererDisplay(HWND windowHandle, uint1
         m_windowDeviceContext = GetDC(windowHandle);
         if (m_windowDeviceContext == NULL)
         {
-            char buff[256];
-            sprintf(buff, "Arrrghh here's the error: %d", GetLastError());
-            Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage(buff);
+            Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::ERROR_NONFATAL>("Could not get the window's device context, error %u.", GetLastError());
             return;
         }
     }
 }
 
-std::shared_ptr<PlatformRenderer::MemoryMapDrawer> Win32PlatformRenderer::AllocateFullDisplayDrawer()
+PlatformRenderer::MemoryMapDrawer* Win32PlatformRenderer::AcquireDisplayDrawer()
 {
-    std::lock_guard<std::mutex> lock(m_mutex_RenderResources);
+    const int32_t bufferIndex = m_swapchain.AcquireBuffer();
+    if (bufferIndex < 0)
+    {
+        return nullptr;
+    }
+
+    // Drawers only get recreated when the display got resized since they were last acquired.
+    MemoryMapDrawerGDI& drawerGDI = m_swapchainDrawers[bufferIndex];
+    const uint16_t displayWidth = m_displayWidth;
+    const uint16_t displayHeight = m_displayHeight;
+    if (drawerGDI.drawer != nullptr && drawerGDI.drawer->GetWidth() == displayWidth && drawerGDI.drawer->GetHeight() == displayHeight)
+    {
+        return drawerGDI.drawer.get();
+    }
+    FreeDrawerGDI(drawerGDI);
 
-    MemoryMapDrawerGDI newDrawerGDI = {};
     BITMAPINFO bmpInfo = {};
     {
         bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFO);
-        bmpInfo.bmiHeader.biWidth = m_displayWidth;
-        bmpInfo.bmiHeader.biHeight = -m_displayHeight;
+        bmpInfo.bmiHeader.biWidth = displayWidth;
+        bmpInfo.bmiHeader.biHeight = -displayHeight;
         bmpInfo.bmiHeader.biPlanes = 1;
         bmpInfo.bmiHeader.biBitCount = 32;
         bmpInfo.bmiHeader.biCompression = BI_RGB;
     }
 
-    Pixel_RGBA* pixelBuffer;
-    newDrawerGDI.bmpInfo = bmpInfo;
-    newDrawerGDI.bmpHandle = CreateDIBSection(m_windowDeviceContext, &bmpInfo, DIB_RGB_COLORS, reinterpret_cast<void**>(&pixelBuffer), NULL, NULL);
+    // #NOTE: The device context is only used by CreateDIBSection for palette colors, so the window's isn't needed and this doesn't
+    // have to wait on the render thread.
+    Pixel_RGBA* pixelBuffer = nullptr;
+    drawerGDI.bmpInfo = bmpInfo;
+    drawerGDI.bmpHandle = CreateDIBSection(NULL, &bmpInfo, DIB_RGB_COLORS, reinterpret_cast<void**>(&pixelBuffer), NULL, NULL);
     
     if (pixelBuffer == nullptr)
     {
-        // DIB Section creation has failed ! Fail creation of Memory Map Drawer & return immediately.
+        // DIB Section creation has failed ! Give the drawer back to the swapchain & return immediately.
         // #TODO(Marc): Assert system.
+        drawerGDI.bmpHandle = NULL;
+        m_swapchain.ReleaseBuffer(bufferIndex);
+        return nullptr;
+    }
+
+    drawerGDI.DIBContext = CreateCompatibleDC(NULL);
+    SelectObject(drawerGDI.DIBContext, drawerGDI.bmpHandle);
+
+    drawerGDI.drawer = std::make_unique<PlatformRenderer::MemoryMapDrawer>(displayWidth, displayHeight, 0, 0, pixelBuffer);
+    return drawerGDI.drawer.get();
+}
+
+void Win32PlatformRenderer::PresentDisplayDrawer(MemoryMapDrawer* drawer, const DisplayDamage& damage)
+{
+    for (uint32_t bufferIndex = 0; bufferIndex < DisplaySwapchain::BUFFER_COUNT; bufferIndex++)
+    {
+        if (m_swapchainDrawers[bufferIndex].drawer.get() == drawer)
+        {
+            m_swapchain.QueueBuffer(bufferIndex, damage);
+            return;
+        }
+    }
+}
+
+void Win32PlatformRenderer::PerformRenderUpdate()
+{
+    PROFILE_ZONE("Win32PlatformRenderer::PerformRenderUpdate");
+    const int32_t bufferIndex = m_swapchain.BeginPresentingBuffer(m_presentedDamage);
+    if (bufferIndex < 0)
+    {
+        return;
+    }
+
+    // Blit damaged regions only, the rest of the window already shows the same pixels unless it got invalidated.
+    const MemoryMapDrawerGDI& drawerGDI = m_swapchainDrawers[bufferIndex];
+    const PlatformRenderer::MemoryMapDrawer& drawer = *drawerGDI.drawer;
+    if (m_bWindowInvalidated.exchange(false))
+    {
+        m_presentedDamage.Clear();
+        m_presentedDamage.AddRect(DisplayRect{ 0, 0, drawer.GetWidth(), drawer.GetHeight() });
+    }
+    for (uint32_t rectIndex = 0; rectIndex < m_presentedDamage.GetRectCount(); rectIndex++)
+    {
+        const DisplayRect& rect = m_presentedDamage.GetRect(rectIndex);
+        BitBlt(m_windowDeviceContext, drawer.GetOffsetX() + rect.X, drawer.GetOffsetY() + rect.Y, rect.Width, rect.Height,
+            drawerGDI.DIBContext, rect.X, rect.Y, SRCCOPY);
+    }
+
+    m_swapchain.EndPresentingBuffer(bufferIndex);
+    m_presentSignal.Notify();
+}
+
+void Win32PlatformRenderer::FreeDrawerGDI(MemoryMapDrawerGDI& drawerGDI)
+{
+    if (drawerGDI.DIBContext != NULL)
+    {
+        // Free DIB DC
+        SelectObject(drawerGDI.DIBContext, NULL);
+        DeleteDC(drawerGDI.DIBContext);
+        drawerGDI.DIBContext = NULL;
+    }
+    if (drawerGDI.bmpHandle != NULL)
+    {
+        // Free Bitmap
+        DeleteObject(drawerGDI.bmpHandle);
+        drawerGDI.bmpHandle = NULL;
+    }
+    drawerGDI.drawer.reset();
+}
+
+// WIN32 MAIN ENTRY POINT & THREADS
 
+// WIN32 FILE SYSTEM IMPLEMENTATION
+
+std::wstring Win32PlatformFileSystem::Win32_ToWidePath(const std::string& filePath)
+{
+    const int wideLength = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, NULL, 0);
+    if (wideLength <= 1)
+    {
+        return std::wstring();
+    }
+    std::wstring widePath(static_cast<size_t>(wideLength), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], wideLength);
+    widePath.pop_back(); // Null terminator.
+    return widePath;
+}
+
+HANDLE Win32PlatformFileSystem::Win32_OpenFileForReading(const std::string& filePath)
+{
+    const std::wstring widePath = Win32_ToWidePath(filePath);
+    if (widePath.empty())
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+}
+
+std::shared_ptr<PlatformFileSystem::MappedFile> Win32PlatformFileSystem::MapFileReadOnly(const std::string& filePath)
+{
+    HANDLE fileHandle = Win32_OpenFileForReading(filePath);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
         return nullptr;
     }
 
-    newDrawerGDI.DIBContext = CreateCompatibleDC(m_windowDeviceContext);
-    SelectObject(newDrawerGDI.DIBContext, newDrawerGDI.bmpHandle);
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
 
-    std::shared_ptr<PlatformRenderer::MemoryMapDrawer> newDrawer = 
-        std::make_shared<PlatformRenderer::MemoryMapDrawer>(m_displayWidth, m_displayHeight, 0, 0, pixelBuffer);
+    // Empty files can't be mapped, but are valid files nonetheless.
+    if (fileSize.QuadPart == 0)
+    {
+        return std::make_shared<Win32MappedFile>(fileHandle, static_cast<HANDLE>(NULL), nullptr, 0);
+    }
 
-    newDrawerGDI.drawer = newDrawer;
+    HANDLE fileMappingHandle = CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (fileMappingHandle == NULL)
+    {
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    const void* view = MapViewOfFile(fileMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        CloseHandle(fileMappingHandle);
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
 
-    m_memoryMapDrawers.emplace_back(newDrawerGDI);
-    return newDrawer;
+    return std::make_shared<Win32MappedFile>(fileHandle, fileMappingHandle, static_cast<const uint8_t*>(view),
+        static_cast<size_t>(fileSize.QuadPart));
 }
 
-void Win32PlatformRenderer::PerformRenderUpdate()
+Win32PlatformFileSystem::Win32MappedFile::~Win32MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_fileMappingHandle != NULL)
+    {
+        CloseHandle(m_fileMappingHandle);
+    }
+    CloseHandle(m_fileHandle);
+}
+
+std::shared_ptr<PlatformFileSystem::FileReader> Win32PlatformFileSystem::OpenFileForReading(const std::string& filePath)
 {
-    // Draw loop for Bitmap drawers
-    for(auto drawerIt = m_memoryMapDrawers.begin(); drawerIt != m_memoryMapDrawers.end(); drawerIt++)
+    HANDLE fileHandle = Win32_OpenFileForReading(filePath);
+    if (fileHandle == INVALID_HANDLE_VALUE)
     {
-        std::shared_ptr<PlatformRenderer::MemoryMapDrawer>& drawer = drawerIt->drawer;
-        if (drawer->IsReadyToDraw())
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    return std::make_shared<Win32FileReader>(fileHandle, static_cast<uint64_t>(fileSize.QuadPart));
+}
+
+Win32PlatformFileSystem::Win32FileReader::~Win32FileReader()
+{
+    CloseHandle(m_fileHandle);
+}
+
+size_t Win32PlatformFileSystem::Win32FileReader::Read(uint8_t* buffer, size_t size)
+{
+    // ReadFile takes 32 bit sizes, so large reads are split.
+    size_t totalReadSize = 0;
+    while (totalReadSize < size)
+    {
+        const DWORD requestSize = static_cast<DWORD>(std::min<size_t>(size - totalReadSize, 1u << 30));
+        DWORD readSize = 0;
+        if (!ReadFile(m_fileHandle, buffer + totalReadSize, requestSize, &readSize, NULL) || readSize == 0)
         {
-            BitBlt(m_windowDeviceContext, drawer->GetOffsetX(), drawer->GetOffsetY(), drawer->GetWidth(), drawer->GetHeight(),
-                drawerIt->DIBContext, 0, 0, SRCCOPY);
+            break;
         }
+        totalReadSize += readSize;
     }
+    return totalReadSize;
+}
 
-    // Erase loop for discarded Bitmap drawers
-    for(auto drawerIt = m_memoryMapDrawers.begin(); drawerIt != m_memoryMapDrawers.end();)
+std::shared_ptr<PlatformFileSystem::FileWriter> Win32PlatformFileSystem::CreateFileForWriting(const std::string& filePath)
+{
+    const std::wstring widePath = Win32_ToWidePath(filePath);
+    if (widePath.empty())
     {
-        // Discard drawer if marked for discarding.
-        if (drawerIt->drawer->ShouldDiscard())
-        {
-            // Free DIB DC
-            SelectObject(drawerIt->DIBContext, NULL);
-            DeleteDC(drawerIt->DIBContext);
+        return nullptr;
+    }
 
-            // Free Bitmap
-            DeleteObject(drawerIt->bmpHandle);
+    // The process ID keeps concurrent instances writing the same file from sharing a temporary file.
+    const std::wstring temporaryFilePath = widePath + L".tmp" + std::to_wstring(GetCurrentProcessId());
+    HANDLE fileHandle = CreateFileW(temporaryFilePath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
 
-            drawerIt = m_memoryMapDrawers.erase(drawerIt);
-        }
-        else
+    return std::make_shared<Win32FileWriter>(fileHandle, temporaryFilePath, widePath);
+}
+
+bool Win32PlatformFileSystem::GetFileInfo(const std::string& filePath, FileInfo& outInfo)
+{
+    const std::wstring widePath = Win32_ToWidePath(filePath);
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (widePath.empty() || !GetFileAttributesExW(widePath.c_str(), GetFileExInfoStandard, &attributes)
+        || (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        return false;
+    }
+
+    outInfo.Size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    outInfo.ModificationTime = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+Win32PlatformFileSystem::Win32FileWriter::~Win32FileWriter()
+{
+    if (m_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_fileHandle);
+        DeleteFileW(m_temporaryFilePath.c_str());
+    }
+}
+
+bool Win32PlatformFileSystem::Win32FileWriter::Write(const uint8_t* data, size_t size)
+{
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    // WriteFile takes 32 bit sizes, so large writes are split.
+    size_t totalWrittenSize = 0;
+    while (totalWrittenSize < size)
+    {
+        const DWORD requestSize = static_cast<DWORD>(std::min<size_t>(size - totalWrittenSize, 1u << 30));
+        DWORD writtenSize = 0;
+        if (!WriteFile(m_fileHandle, data + totalWrittenSize, requestSize, &writtenSize, NULL) || writtenSize == 0)
         {
-            drawerIt++;
+            return false;
         }
+        totalWrittenSize += writtenSize;
     }
+    return true;
 }
 
-// WIN32 MAIN ENTRY POINT & THREADS
+bool Win32PlatformFileSystem::Win32FileWriter::Commit()
+{
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    CloseHandle(m_fileHandle);
+    m_fileHandle = INVALID_HANDLE_VALUE;
+    if (!MoveFileExW(m_temporaryFilePath.c_str(), m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        DeleteFileW(m_temporaryFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/// @brief Reads the model file path from the process command line (first argument), as UTF-8.
+/// @return The model file path, or an empty string if none was passed.
+std::string Win32_GetModelFilePathArgument()
+{
+    // The ANSI command line WinMain receives can't represent every path, so read the wide one instead.
+    int argumentCount = 0;
+    LPWSTR* arguments = CommandLineToArgvW(GetCommandLineW(), &argumentCount);
+    if (arguments == NULL)
+    {
+        return std::string();
+    }
+
+    std::string modelFilePath;
+    if (argumentCount > 1)
+    {
+        const int utf8Length = WideCharToMultiByte(CP_UTF8, 0, arguments[1], -1, NULL, 0, NULL, NULL);
+        if (utf8Length > 1)
+        {
+            modelFilePath.resize(static_cast<size_t>(utf8Length));
+            WideCharToMultiByte(CP_UTF8, 0, arguments[1], -1, &modelFilePath[0], utf8Length, NULL, NULL);
+            modelFilePath.pop_back(); // Null terminator.
+        }
+    }
+
+    LocalFree(arguments);
+    return modelFilePath;
+}
 
 // Threads & synchronization events.
 std::thread Win32_PlatformMainThread;
@@ -256,20 +774,26 @@ HANDLE Win32_EngineInitCompleteEventHandle; // Set when Engine is done initializ
 HANDLE Win32_EngineShutdownCompleteEventHandle; // Set when Engine is done shutting down.
 
 // Main thread function for the Win32 Engine thread.
-void Win32_EngineThreadMainFunc()
+void Win32_EngineThreadMainFunc(EngineConfiguration engineConfiguration)
 {
+    // Registered before initializing, so job workers the Engine spawns get profiled too.
+    Win32_Platform->Win32_RegisterProfiledThread("Engine");
+
     // Initialize Engine.
     Win32_Engine->Initialize(   std::dynamic_pointer_cast<PlatformDebugger>(Win32_Platform->Win32_GetDebugger()),
-                                std::dynamic_pointer_cast<PlatformRenderer>(Win32_Platform->Win32_GetRenderer()));
+                                std::dynamic_pointer_cast<PlatformRenderer>(Win32_Platform->Win32_GetRenderer()),
+                                std::dynamic_pointer_cast<PlatformFileSystem>(Win32_Platform->Win32_GetFileSystem()),
+                                std::dynamic_pointer_cast<PlatformClock>(Win32_Platform->Win32_GetClock()),
+                                Win32_Platform->Win32_GetEngineMemory(),
+                                engineConfiguration);
 
     // Set Engine Init Complete event.
     SetEvent(Win32_EngineInitCompleteEventHandle);
 
-    // Update the Engine so long as it hasn't been flagged for shutdown.
+    // Update the Engine so long as it hasn't been flagged for shutdown. Updates measure time on the platform clock & pace themselves as
+    // configured.
     while (!Win32_Engine->ShouldShutdown())
     {
-        // #TODO(Marc): Measure passage of time on the platform and give the Engine some idea of relationship between ticks
-        // and real time so real-time features may exist.
         Win32_Engine->Update();
     }
 
@@ -296,37 +820,37 @@ LRESULT CALLBACK Win32_MsgProc(HWND window, UINT msgType, WPARAM wParam, LPARAM
 
 void Win32_PlatformThreadRenderFunc()
 {
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Win32 Render Thread has started.");
-
-    // Constantly attempt to run render updates on the platform.
-    // #NOTE(Marc): While I don't usually like active waiting like this (by "constantly retrying"), I think it's fine in this case because
-    // render updates should be ran at a very high rate compared to the time they take anyway.
+    Win32_Platform->Win32_RegisterProfiledThread("Render");
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Win32 Render Thread has started.");
 
+    // Run render updates on the platform as they get requested, sleeping in between.
     while (!Win32_PlatformShutdownFlag)
     {
         Win32_Platform->Win32_RendererUpdate();
     }
 
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Win32 Render Thread has ended.");
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Win32 Render Thread has ended.");
 }
 
 void Win32_PlatformThreadDebuggingFunc()
 {
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Win32 Debugger Thread has started.");
+    Win32_Platform->Win32_RegisterProfiledThread("Debugger");
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Win32 Debugger Thread has started.");
 
-    // #TOTHINK(Marc): It may be worth adding an extra Event object so that this thread does not constantly lock / unlock the debug message buffer mutex.
+    // Flush debug messages as they get queued, sleeping in between.
     while (!Win32_PlatformShutdownFlag)
     {
         Win32_Platform->Win32_DebuggerUpdate();
     }
 
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Win32 Debugger Thread has ended.");
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Win32 Debugger Thread has ended.");
 }
 
 // Main thread function for the Platform thread.
 void Win32_PlatformThreadMainFunc()
 {
     // Initialize platform.
+    Win32_Platform->Win32_RegisterProfiledThread("Platform");
     Win32_Platform->Win32_InitWindow();
 
     // Make sure Shutdown flag is set to false.
@@ -346,7 +870,7 @@ void Win32_PlatformThreadMainFunc()
             && Win32_Engine->GetState() != Engine::State::SHUTDOWN_COMPLETE)
     {
         // Perform message polling on this thread as this is the thread that owns the window.
-        Win32_Platform->Win32_PollNextMessage();
+        Win32_Platform->Win32_PollMessages();
     }
 
     // Platform has been shut down. If for some reason the Engine is not shutting down yet, make it do so immediately.
@@ -360,6 +884,7 @@ void Win32_PlatformThreadMainFunc()
 
     // Set the Platform Shutdown Flag so our child threads will stop, and wait for them to do so.
     Win32_PlatformShutdownFlag = true;
+    Win32_Platform->Win32_WakeUpdateThreads();
     Win32_PlatformRenderThread.join();
     Win32_PlatformDebuggingThread.join();
 
@@ -381,8 +906,11 @@ int APIENTRY WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR commandLi
     Win32_Platform = std::make_shared<Win32Platform>(instance);
     Win32_Engine = std::make_shared<Engine>();
 
-    Win32_Platform->Win32_InitSubsystems();
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Initializing Platform...");
+    if (!Win32_Platform->Win32_InitSubsystems())
+    {
+        return 1;
+    }
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Initializing Platform...");
 
     // Create synchronization events.
     {
@@ -409,19 +937,28 @@ int APIENTRY WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR commandLi
         // If not, then shut everything down immediately by jumping to PROGRAM_END.
         if (!Win32_Platform->Win32_IsMainWindowActive())
         {
-            Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Win32 Platform has failed to initialize !", DebugLogMessage::Category::ERROR_FATAL);
+            Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::ERROR_FATAL>("Win32 Platform has failed to initialize !");
             goto PROGRAM_END;
         }
     }
 
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Platform Initialized !", DebugLogMessage::Category::SUCCESS);
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>("Platform Initialized !");
 
-    Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Initializing & Starting Engine...");
+    Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::LOG>("Initializing & Starting Engine...");
 
     // ENGINE STARTUP
     {
+        EngineConfiguration engineConfiguration;
+        engineConfiguration.ModelFilePath = Win32_GetModelFilePathArgument();
+        // GDI presents aren't synchronized to the display, so cap updates at a usual display refresh rate rather than drawing frames nobody
+        // sees.
+        engineConfiguration.Pacing = EngineConfiguration::FramePacing::TARGET_RATE;
+        engineConfiguration.TargetFrameRate = 60.0f;
+        // A viewer sitting idle shows the same frame over & over: keep it from drawing it again, so idle windows cost next to nothing.
+        engineConfiguration.bRenderOnDemand = true;
+
         // Start Engine Thread.
-        Win32_EngineMainThread = std::thread(Win32_EngineThreadMainFunc);
+        Win32_EngineMainThread = std::thread(Win32_EngineThreadMainFunc, engineConfiguration);
 
         // Wait for Engine initialization to complete.
         WaitForSingleObject(Win32_EngineInitCompleteEventHandle, INFINITE);
@@ -431,7 +968,7 @@ int APIENTRY WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR commandLi
     // indicating the failure as part of its standard shutdown routine.
     if (!Win32_Engine->ShouldShutdown())
     {
-        Win32_Platform->Win32_GetDebugger()->DisplayDebugMessage("Engine initialized and running !", DebugLogMessage::Category::SUCCESS);
+        Win32_Platform->Win32_GetDebugger()->Log<DebugLogMessage::Category::SUCCESS>("Engine initialized and running !");
     }
 
     Sleep(2000);
@@ -442,6 +979,9 @@ int APIENTRY WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR commandLi
     // Then again, threads are a very cheap and plentiful ressource on modern machines so it probably doesn't matter.
     Win32_EngineMainThread.join();
     Win32_PlatformMainThread.join();
+
+    // Every profiled thread is done: write where their time went.
+    Win32_Platform->Win32_WriteProfile();
 PROGRAM_END:
 
     // Final flush of the Win32 Platform's Debug Logging Queue so any messages left (sent as part of shutdowns) will be displayed. 
@@ -9,53 +9,134 @@
 #define WIN32_LEAN_AND_MEAN // Only include the bare minimum from Windows to not pollute namespace.
 #include <Windows.h>
 
-#include <queue>
+#include <memory>
 #include <mutex>
+#include <string>
 
 #include "Engine/Platform.h"
+#include "Engine/DebugLogQueue.h"
+#include "Engine/DisplaySwapchain.h"
+#include "Engine/InputEventQueue.h"
+#include "Engine/MemoryArena.h"
+#include "Engine/Profiler.h"
+
+/// @brief Win32 signal, an auto-reset event object.
+class Win32PlatformSignal : public PlatformSignal
+{
+public:
+
+    Win32PlatformSignal() : m_eventHandle(CreateEvent(NULL, false, false, NULL))
+    {}
+
+    virtual ~Win32PlatformSignal() override { CloseHandle(m_eventHandle); }
+
+    virtual void Notify() override { SetEvent(m_eventHandle); }
+
+    // INFINITE_TIMEOUT matches the INFINITE Win32 wait duration.
+    virtual bool Wait(uint32_t timeoutMilliseconds = INFINITE_TIMEOUT) override
+    {
+        return WaitForSingleObject(m_eventHandle, timeoutMilliseconds) == WAIT_OBJECT_0;
+    }
+
+private:
+
+    HANDLE m_eventHandle;
+};
 
 class Win32PlatformDebugger : public PlatformDebugger
 {
 public:
+
+    // Messages get flushed by a dedicated debugger thread, so producers can safely wait for it when the queue is full.
+    Win32PlatformDebugger() : m_debugMessageQueue(DEBUG_MESSAGE_SLOT_COUNT, DebugLogQueue::OverflowPolicy::BLOCK), m_bFlushThreadWaiting(false)
+    {}
+
     // Make sure Platform's overloads are visible in this scope for overload resolution.
     using PlatformDebugger::DisplayDebugMessage;
     virtual void DisplayDebugMessage(DebugLogMessage&& message) override;
+    virtual void DisplayFormattedDebugMessage(DebugLogMessage::Category category, const char* format, const DebugLog::PackedArguments& arguments) override;
 
     // Triggers a flush of all Debug Log Messages in queue.
     void Win32_FlushDebugLogQueue();
 
+    /// @brief Sleeps until messages get queued, or the debugger gets woken up. Must only be called from the thread flushing the queue.
+    /// @param timeoutMilliseconds Time after which to stop waiting regardless.
+    void Win32_WaitForDebugMessages(uint32_t timeoutMilliseconds);
+
+    /// @brief Wakes up the thread waiting for messages, such as for it to notice the platform is shutting down.
+    void Win32_WakeFlushThread() { m_messageSignal.Notify(); }
+
 private:
 
-    std::mutex m_mutex_DebugMessageQueue;
-    std::queue<DebugLogMessage> m_debugMessageQueue;
+    /// @brief Wakes up the flushing thread after a message got queued, if it is waiting. Keeps producers from paying for a signal per message.
+    void NotifyMessageQueued();
+
+    static constexpr uint32_t DEBUG_MESSAGE_SLOT_COUNT = 4096;
+    // Messages flushed per batch. Console colors can only change between writes, so batches are also split wherever the category changes.
+    static constexpr uint32_t DEBUG_MESSAGE_BATCH_SIZE = 64;
+
+    DebugLogQueue m_debugMessageQueue;
+    // Notified when messages get queued while the flushing thread waits, which it flags beforehand.
+    Win32PlatformSignal m_messageSignal;
+    std::atomic<bool> m_bFlushThreadWaiting;
+    // Formatted messages get formatted here, by the thread flushing the queue.
+    std::string m_formattedMessage;
+    // Batch of messages sharing a category, written to the console at once.
+    std::string m_flushBuffer;
 };
 
 class Win32PlatformRenderer : public PlatformRenderer
 {
 public:
 
-    /// @brief Sets the size and other properties of the display the renderer works with.
+    Win32PlatformRenderer() : m_windowHandle(NULL), m_windowDeviceContext(NULL), m_displayWidth(0), m_displayHeight(0), m_displayVersion(0), m_bWindowInvalidated(true),
+        m_shouldUpdateRender(false)
+    {}
+
+    ~Win32PlatformRenderer();
+
+    /// @brief Sets the size and other properties of the display the renderer works with. Swapchain drawers get recreated as they are next
+    /// acquired.
     /// @param windowHandle Handle to Win32 window to draw to.
     /// @param width Width in pixels of display.
     /// @param height Height in pixels of display.
     void Win32_ResizeRendererDisplay(HWND windowHandle, uint16_t width, uint16_t height);
 
-    virtual std::shared_ptr<MemoryMapDrawer> AllocateFullDisplayDrawer() override;
+    /// @brief Marks the whole window as needing to be drawn again, such as when parts of it got uncovered. The next present blits whole
+    /// drawers rather than their damaged regions, and bumping the display version makes sure there is a next present.
+    void Win32_InvalidateWindow()
+    {
+        m_bWindowInvalidated = true;
+        m_displayVersion.fetch_add(1, std::memory_order_release);
+    }
+
+    virtual MemoryMapDrawer* AcquireDisplayDrawer() override;
+    virtual void PresentDisplayDrawer(MemoryMapDrawer* drawer, const DisplayDamage& damage) override;
 
-    // Win32 implementation of this function simply waits for the current render update to be done if needed, then sets the flag to start the next one ASAP.
+    // Win32 implementation of this function simply sets the flag and wakes up the render thread for it to blit damaged regions of the latest
+    // presented drawer ASAP.
     virtual void RenderUpdate() override 
     { 
-        std::lock_guard<std::mutex> lock(m_mutex_RenderResources); 
         m_shouldUpdateRender = true; 
+        m_renderUpdateSignal.Notify();
     };
 
+    virtual PlatformSignal& GetPresentSignal() override { return m_presentSignal; }
+
+    virtual uint64_t GetDisplayVersion() const override { return m_displayVersion.load(std::memory_order_acquire); }
+
+    /// @brief Sleeps until a render update is requested, or the renderer gets woken up.
+    void Win32_WaitForRenderUpdate() { m_renderUpdateSignal.Wait(); }
+
+    /// @brief Wakes up the thread waiting for render updates, such as for it to notice the platform is shutting down.
+    void Win32_WakeRenderThread() { m_renderUpdateSignal.Notify(); }
+
     void Win32_TryRunRenderUpdate()
     {
-        if (m_shouldUpdateRender)
+        if (m_shouldUpdateRender.exchange(false))
         {
             std::lock_guard<std::mutex> lock(m_mutex_RenderResources); 
             PerformRenderUpdate();
-            m_shouldUpdateRender = false;
         }
     }
 
@@ -68,29 +149,150 @@ private:
         BITMAPINFO bmpInfo;
         HBITMAP bmpHandle;
 
-        std::shared_ptr<MemoryMapDrawer> drawer;
+        // Null until first acquired.
+        std::unique_ptr<MemoryMapDrawer> drawer;
     };
 
     void PerformRenderUpdate();
 
+    /// @brief Releases the DIB section & device context of a swapchain drawer.
+    void FreeDrawerGDI(MemoryMapDrawerGDI& drawerGDI);
+
     // Display data
     HWND m_windowHandle;
     HDC m_windowDeviceContext;
 
-    uint16_t m_displayWidth;
-    uint16_t m_displayHeight;
-
-    std::vector<MemoryMapDrawerGDI> m_memoryMapDrawers;
-
-    // When set, the platform should perform a full Render update.
+    // Read by the Engine thread when acquiring drawers without taking the render resources lock, so it never waits on a present.
+    std::atomic<uint16_t> m_displayWidth;
+    std::atomic<uint16_t> m_displayHeight;
+    // Incremented by every resize & window invalidation.
+    std::atomic<uint64_t> m_displayVersion;
+
+    // Swapchain drawers. Each one is only touched by whoever holds it according to the swapchain: the Engine thread while drawing, the
+    // render thread while presenting.
+    DisplaySwapchain m_swapchain;
+    MemoryMapDrawerGDI m_swapchainDrawers[DisplaySwapchain::BUFFER_COUNT] = {};
+    // Damage of the drawer being presented, only touched by the render thread.
+    DisplayDamage m_presentedDamage;
+    // Set when the window lost pixels it showed, so the whole drawer needs to be presented.
+    std::atomic<bool> m_bWindowInvalidated;
+
+    // When set, the platform should perform a full Render update. The render thread sleeps on the signal until then.
     std::atomic<bool> m_shouldUpdateRender;
+    Win32PlatformSignal m_renderUpdateSignal;
+    // Notified after each presentation.
+    Win32PlatformSignal m_presentSignal;
 
-    // Locked by the platform when performing a Render update, or by the Engine when allocating a new render resource or
-    // sending commands to the command buffer.
+    // Locked by the platform when performing a Render update or changing the window the renderer draws to.
     std::mutex m_mutex_RenderResources;
 
 };
 
+/// @brief Win32 clock, reading the performance counter.
+class Win32PlatformClock : public PlatformClock
+{
+public:
+
+    Win32PlatformClock()
+    {
+        // The performance counter frequency is fixed at boot, so query it once.
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        m_ticksPerSecond = static_cast<uint64_t>(frequency.QuadPart);
+    }
+
+    virtual uint64_t GetTicks() const override
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return static_cast<uint64_t>(counter.QuadPart);
+    }
+
+    virtual uint64_t GetTicksPerSecond() const override { return m_ticksPerSecond; }
+
+private:
+
+    uint64_t m_ticksPerSecond;
+};
+
+/// @brief Win32 file system service, mapping files with file mapping objects.
+class Win32PlatformFileSystem : public PlatformFileSystem
+{
+public:
+
+    virtual std::shared_ptr<MappedFile> MapFileReadOnly(const std::string& filePath) override;
+    virtual std::shared_ptr<FileReader> OpenFileForReading(const std::string& filePath) override;
+    virtual std::shared_ptr<FileWriter> CreateFileForWriting(const std::string& filePath) override;
+    virtual bool GetFileInfo(const std::string& filePath, FileInfo& outInfo) override;
+
+private:
+
+    /// @brief Converts a UTF-8 path to UTF-16 for wide Win32 functions, so any path can be accessed.
+    /// @return Wide path, or an empty string if the path is not valid UTF-8.
+    static std::wstring Win32_ToWidePath(const std::string& filePath);
+
+    /// @brief Opens a file for reading.
+    /// @return File handle, or INVALID_HANDLE_VALUE on failure.
+    static HANDLE Win32_OpenFileForReading(const std::string& filePath);
+
+    /// @brief Mapped file owning its view, file mapping object & file handles, all released on destruction.
+    class Win32MappedFile : public MappedFile
+    {
+    public:
+
+        Win32MappedFile(HANDLE fileHandle, HANDLE fileMappingHandle, const uint8_t* data, size_t size) : MappedFile(data, size),
+            m_fileHandle(fileHandle), m_fileMappingHandle(fileMappingHandle)
+        {}
+
+        virtual ~Win32MappedFile() override;
+
+    private:
+
+        HANDLE m_fileHandle;
+        // NULL for empty files, which can't be mapped.
+        HANDLE m_fileMappingHandle;
+    };
+
+    /// @brief File reader owning its file handle, closed on destruction.
+    class Win32FileReader : public FileReader
+    {
+    public:
+
+        Win32FileReader(HANDLE fileHandle, uint64_t size) : FileReader(size), m_fileHandle(fileHandle)
+        {}
+
+        virtual ~Win32FileReader() override;
+
+        virtual size_t Read(uint8_t* buffer, size_t size) override;
+
+    private:
+
+        HANDLE m_fileHandle;
+    };
+
+    /// @brief File writer owning the handle of its temporary file, which is moved to the destination path on commit.
+    class Win32FileWriter : public FileWriter
+    {
+    public:
+
+        Win32FileWriter(HANDLE fileHandle, const std::wstring& temporaryFilePath, const std::wstring& filePath) : m_fileHandle(fileHandle),
+            m_temporaryFilePath(temporaryFilePath), m_filePath(filePath)
+        {}
+
+        virtual ~Win32FileWriter() override;
+
+        virtual bool Write(const uint8_t* data, size_t size) override;
+        virtual bool Commit() override;
+
+    private:
+
+        // INVALID_HANDLE_VALUE once committed.
+        HANDLE m_fileHandle;
+        std::wstring m_temporaryFilePath;
+        std::wstring m_filePath;
+    };
+};
+
 /// @brief The Win32 Platform is meant to run on a Windows 10 and later OS-operated machine. It is centered around a Window
 /// on which all rendering is done and through which all input events are registered.
 /// Uses CPU rendering through the GDI library (#TODO(Marc): Obviously this platform should support hardware acceleration.)
@@ -100,10 +302,13 @@ class Win32Platform
     // WIN32 Internal Platform Functionnality
 public:
 
-    Win32Platform(HINSTANCE processHandle) : m_processHandle(processHandle)
+    Win32Platform(HINSTANCE processHandle) : m_processHandle(processHandle), m_lastCursorX(0), m_lastCursorY(0), m_bCursorPositionKnown(false),
+        m_engineMemoryBlock(NULL)
     {}
 
-    /// @brief Initializes subsystems such as debugging, line & triangle rendering...
+    ~Win32Platform();
+
+    /// @brief Initializes subsystems such as debugging, line & triangle rendering, file access, clock, Engine memory...
     /// @return True if subsystems initialized appropriately.
     bool Win32_InitSubsystems();
 
@@ -112,16 +317,26 @@ public:
     /// @return True if initialization was successful, false otherwise.
     bool Win32_InitWindow();
 
-    /// @brief Polls the next message for the platform main window. Blocks until a message is received. Only processes a single message when multiple are
-    /// received, so this should be called in a loop.
-    void Win32_PollNextMessage();
+    /// @brief Processes every message queued for the thread owning the platform main window. Blocks until a message is received, or for
+    /// MESSAGE_WAIT_TIMEOUT_MS at most so callers get to check whether to keep polling, which they should do in a loop.
+    void Win32_PollMessages();
 
-    /// @brief Updates platform rendering.
+    /// @brief Updates platform rendering, once a render update is requested. Blocks until then.
     void Win32_RendererUpdate();
 
-    /// @brief Updates platform debugging.
+    /// @brief Updates platform debugging, once debug messages get queued. Blocks until then, or for MESSAGE_WAIT_TIMEOUT_MS at most.
     void Win32_DebuggerUpdate();
 
+    /// @brief Wakes up threads blocked updating platform rendering & debugging, so they may notice the platform is shutting down.
+    void Win32_WakeUpdateThreads();
+
+    /// @brief Makes the calling thread record profiling zones under the passed name. Does nothing unless profiling is compiled in.
+    void Win32_RegisterProfiledThread(const std::string& threadName) { m_profiler.RegisterCurrentThread(threadName); }
+
+    /// @brief Writes profiling zones recorded so far to PROFILE_TRACE_FILE_PATH, and logs their summary. Does nothing unless profiling is
+    /// compiled in.
+    void Win32_WriteProfile();
+
     /// @brief Processes a message received from the Platform's Main Window. Returns whether the message was handled. If not,
     /// the default handler for this message type will be called.
     /// @param messageType Type index of the message.
@@ -134,6 +349,11 @@ public:
 
     std::shared_ptr<Win32PlatformDebugger> Win32_GetDebugger() const { return m_debugger; }
     std::shared_ptr<Win32PlatformRenderer> Win32_GetRenderer() const { return m_renderer; }
+    std::shared_ptr<Win32PlatformFileSystem> Win32_GetFileSystem() const { return m_fileSystem; }
+    std::shared_ptr<Win32PlatformClock> Win32_GetClock() const { return m_clock; }
+
+    /// @brief Returns the arenas the Engine allocates from, reserved by Win32_InitSubsystems.
+    EngineMemory Win32_GetEngineMemory() const;
 
     // Handle to the main Window. NULL if inactive, any other value otherwise.
     HWND m_mainWindowHandle;
@@ -142,6 +362,10 @@ private:
     /// @brief Triggers the Window to close. It needs to be initialized again to reappear.
     void Win32_CloseWindow();
 
+    /// @brief Pushes an input event to the Engine. Only called while processing window messages, so the platform thread is the input
+    /// queue's single producer.
+    void Win32_PushInputEvent(const InputEvent& event);
+
     
 
     // Handle to parent process.
@@ -149,7 +373,30 @@ private:
 
     std::shared_ptr<Win32PlatformDebugger> m_debugger;
     std::shared_ptr<Win32PlatformRenderer> m_renderer;
-
+    std::shared_ptr<Win32PlatformFileSystem> m_fileSystem;
+    std::shared_ptr<Win32PlatformClock> m_clock;
+
+    // Cursor position of the last mouse message in client area pixels, which mouse motion is measured from. Unknown until the first one.
+    int32_t m_lastCursorX;
+    int32_t m_lastCursorY;
+    bool m_bCursorPositionKnown;
+
+    // Chrome trace file written by profiling builds on exit, in the working directory.
+    static constexpr const char* PROFILE_TRACE_FILE_PATH = "model_viewer_trace.json";
+    Profiler m_profiler;
+
+    // Longest time message polling & debugging updates block for. Missed wake-ups are merely delayed by it.
+    static constexpr uint32_t MESSAGE_WAIT_TIMEOUT_MS = 100;
+
+    // Size of each Engine arena. Committed pages only get backed by physical memory once touched, but count against the commit limit,
+    // so these stay more modest than on Linux.
+    static constexpr size_t PERSISTENT_ARENA_SIZE = size_t(256) << 20;
+    static constexpr size_t FRAME_ARENA_SIZE = size_t(64) << 20;
+
+    // Virtual memory block all Engine arenas live in, and the arenas themselves.
+    void* m_engineMemoryBlock;
+    std::unique_ptr<MemoryArena> m_persistentArena;
+    std::unique_ptr<MemoryArena> m_frameArenas[2];
 };
 
 #endif // WIN32_PLATFORM_H
\ No newline at end of file